@@ -5,3 +5,4 @@ install(FILES "${CSSEng_PKGCONFIG_FILE}"
         DESTINATION "${LIB_INSTALL_DIR}/pkgconfig"
 )
 
+list(APPEND CSSEng_LIBRARIES Threads::Threads)
@@ -153,6 +153,8 @@ css_error css_stylesheet_get_url(css_stylesheet *sheet, const char **url);
 css_error css_stylesheet_get_title(css_stylesheet *sheet, const char **title);
 css_error css_stylesheet_quirks_allowed(css_stylesheet *sheet, bool *allowed);
 css_error css_stylesheet_used_quirks(css_stylesheet *sheet, bool *quirks);
+css_error css_stylesheet_depends_on_siblings(css_stylesheet *sheet,
+		bool *depends);
 
 css_error css_stylesheet_get_disabled(css_stylesheet *sheet, bool *disabled);
 css_error css_stylesheet_set_disabled(css_stylesheet *sheet, bool disabled);
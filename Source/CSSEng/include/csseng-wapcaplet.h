@@ -133,13 +133,13 @@ extern lwc_error lwc_string_tolower(lwc_string *str, lwc_string **ret);
  * ownership.
  */
 #if defined(_LWC_STMTEXPR)
-#define lwc_string_ref(str) ({lwc_string *__lwc_s = (str); assert(__lwc_s != NULL); __lwc_s->refcnt++; __lwc_s;})
+#define lwc_string_ref(str) ({lwc_string *__lwc_s = (str); assert(__lwc_s != NULL); __atomic_add_fetch(&__lwc_s->refcnt, 1, __ATOMIC_RELAXED); __lwc_s;})
 #else
 static inline lwc_string *
 lwc_string_ref(lwc_string *str)
 {
 	assert(str != NULL);
-	str->refcnt++;
+	__atomic_add_fetch(&str->refcnt, 1, __ATOMIC_RELAXED);
 	return str;
 }
 #endif
@@ -154,16 +154,56 @@ lwc_string_ref(lwc_string *str)
  * @note If the reference count reaches zero then the string will be
  *       freed. (Ref count of 1 where string is its own insensitve match
  *       will also result in the string being freed.)
+ *
+ * @note While more than two references remain, the count is decreased
+ *       atomically without taking any lock; otherwise the string table
+ *       is locked by lwc__string_unref_slow().
  */
 #define lwc_string_unref(str) {						\
 		lwc_string *__lwc_s = (str);				\
 		assert(__lwc_s != NULL);				\
-		__lwc_s->refcnt--;						\
-		if ((__lwc_s->refcnt == 0) ||					\
-		    ((__lwc_s->refcnt == 1) && (__lwc_s->insensitive == __lwc_s)))	\
-			lwc_string_destroy(__lwc_s);				\
+		if (!lwc__string_unref_fast(__lwc_s))			\
+			lwc__string_unref_slow(__lwc_s);		\
 	}
-	
+
+/**
+ * Get the caseless copy of an lwc_string, if it was interned already.
+ *
+ * @note This is for "internal" use; the caseless copy is set once by
+ *       lwc__intern_caseless_string() and may be read by other threads.
+ */
+#define lwc__insensitive(str) \
+	__atomic_load_n(&(str)->insensitive, __ATOMIC_ACQUIRE)
+
+/**
+ * Drop a reference on an lwc_string which is not one of the last two.
+ *
+ * @return true if the reference was dropped, false if the caller should
+ *         call lwc__string_unref_slow() instead.
+ */
+static inline bool
+lwc__string_unref_fast(lwc_string *str)
+{
+	lwc_refcounter refcnt = __atomic_load_n(&str->refcnt, __ATOMIC_RELAXED);
+
+	while (refcnt > 2) {
+		if (__atomic_compare_exchange_n(&str->refcnt, &refcnt,
+				refcnt - 1, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * Drop a reference on an lwc_string, and free it if it was the last one.
+ *
+ * @param str The string to unref.
+ *
+ * @note This is for "internal" use by lwc_string_unref().
+ */
+extern void lwc__string_unref_slow(lwc_string *str);
+
 /**
  * Destroy an unreffed lwc_string.
  *
@@ -215,14 +255,14 @@ lwc__intern_caseless_string(lwc_string *str);
             lwc_string *__lwc_str2 = (_str2);                           \
             bool *__lwc_ret = (_ret);                                   \
                                                                         \
-            if (__lwc_str1->insensitive == NULL) {                      \
+            if (lwc__insensitive(__lwc_str1) == NULL) {                 \
                 __lwc_err = lwc__intern_caseless_string(__lwc_str1);    \
             }                                                           \
-            if (__lwc_err == lwc_error_ok && __lwc_str2->insensitive == NULL) { \
+            if (__lwc_err == lwc_error_ok && lwc__insensitive(__lwc_str2) == NULL) { \
                 __lwc_err = lwc__intern_caseless_string(__lwc_str2);    \
             }                                                           \
             if (__lwc_err == lwc_error_ok)                              \
-                *__lwc_ret = (__lwc_str1->insensitive == __lwc_str2->insensitive); \
+                *__lwc_ret = (lwc__insensitive(__lwc_str1) == lwc__insensitive(__lwc_str2)); \
             __lwc_err;                                                  \
         })
 	
@@ -240,14 +280,14 @@ static inline lwc_error
 lwc_string_caseless_isequal(lwc_string *str1, lwc_string *str2, bool *ret)
 {
        lwc_error err = lwc_error_ok;
-       if (str1->insensitive == NULL) {
+       if (lwc__insensitive(str1) == NULL) {
            err = lwc__intern_caseless_string(str1);
        }
-       if (err == lwc_error_ok && str2->insensitive == NULL) {
+       if (err == lwc_error_ok && lwc__insensitive(str2) == NULL) {
            err = lwc__intern_caseless_string(str2);
        }
        if (err == lwc_error_ok)
-           *ret = (str1->insensitive == str2->insensitive);
+           *ret = (lwc__insensitive(str1) == lwc__insensitive(str2));
        return err;
 }
 #endif
@@ -325,14 +365,14 @@ static inline lwc_hash lwc_string_hash_value(lwc_string *str)
 static inline lwc_error lwc_string_caseless_hash_value(
 	lwc_string *str, lwc_hash *hash)
 {
-	if (str->insensitive == NULL) {
+	if (lwc__insensitive(str) == NULL) {
 		lwc_error err = lwc__intern_caseless_string(str);
 		if (err != lwc_error_ok) {
 			return err;
 		}
 	}
 
-	*hash = str->insensitive->hash;
+	*hash = lwc__insensitive(str)->hash;
 	return lwc_error_ok;
 }
 
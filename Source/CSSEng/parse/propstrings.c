@@ -10,6 +10,7 @@
 #include "select/stylesheet.h"
 
 #include <assert.h>
+#include <pthread.h>
 
 typedef struct stringmap_entry {
 	const char *data;
@@ -23,6 +24,9 @@ typedef struct css__propstrings_ctx {
 
 static css__propstrings_ctx css__propstrings;
 
+/* Stylesheets may be created and destroyed from several threads. */
+static pthread_mutex_t css__propstrings_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /* Must be synchronised with enum in propstrings.h */
 const stringmap_entry stringmap[LAST_KNOWN] = {
 	{ "*", SLEN("*") },
@@ -754,6 +758,7 @@ const stringmap_entry stringmap[LAST_KNOWN] = {
  */
 css_error css__propstrings_get(lwc_string ***strings)
 {
+	pthread_mutex_lock(&css__propstrings_lock);
 	if (css__propstrings.count > 0) {
 		css__propstrings.count++;
 	} else {
@@ -766,11 +771,14 @@ css_error css__propstrings_get(lwc_string ***strings)
 					stringmap[i].len,
 					&css__propstrings.strings[i]);
 
-			if (lerror != lwc_error_ok)
+			if (lerror != lwc_error_ok) {
+				pthread_mutex_unlock(&css__propstrings_lock);
 				return CSS_NOMEM;
+			}
 		}
 		css__propstrings.count++;
 	}
+	pthread_mutex_unlock(&css__propstrings_lock);
 
 	*strings = css__propstrings.strings;
 
@@ -784,6 +792,7 @@ css_error css__propstrings_get(lwc_string ***strings)
  */
 void css__propstrings_unref(void)
 {
+	pthread_mutex_lock(&css__propstrings_lock);
 	css__propstrings.count--;
 
 	if (css__propstrings.count == 0) {
@@ -792,4 +801,5 @@ void css__propstrings_unref(void)
 		for (i = 0; i < LAST_KNOWN; i++)
 			lwc_string_unref(css__propstrings.strings[i]);
 	}
+	pthread_mutex_unlock(&css__propstrings_lock);
 }
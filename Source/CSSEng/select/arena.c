@@ -7,6 +7,7 @@
  */
 
 #include <string.h>
+#include <pthread.h>
 
 #include "select/arena.h"
 #include "select/arena_hash.h"
@@ -17,6 +18,9 @@
 
 struct css_computed_style *table_s[TS_SIZE];
 
+/* Serialises the style sharing arena between threads selecting styles. */
+static pthread_mutex_t arena_lock = PTHREAD_MUTEX_INITIALIZER;
+
 
 static inline uint32_t css__arena_hash_style(struct css_computed_style *s)
 {
@@ -161,6 +165,8 @@ css_error css__arena_intern_style(struct css_computed_style **style)
 	index = hash % TS_SIZE;
 	s->bin = index;
 
+	pthread_mutex_lock(&arena_lock);
+
 	if (table_s[index] == NULL) {
 		/* Can just insert */
 		table_s[index] = s;
@@ -179,8 +185,7 @@ css_error css__arena_intern_style(struct css_computed_style **style)
 		} while (l != NULL);
 
 		if (existing != NULL) {
-			css_computed_style_destroy(s);
-			existing->count++;
+			__atomic_add_fetch(&existing->count, 1, __ATOMIC_RELAXED);
 			*style = existing;
 		} else {
 			/* Add to list */
@@ -190,10 +195,34 @@ css_error css__arena_intern_style(struct css_computed_style **style)
 		}
 	}
 
+	pthread_mutex_unlock(&arena_lock);
+
+	/* The duplicate was never interned; free it outside of the lock */
+	if (*style != s) {
+		css_computed_style_destroy(s);
+	}
+
 	return CSS_OK;
 }
 
 
+/* Internally exported function, documented in src/select/arena.h */
+bool css__arena_release_style(struct css_computed_style *style)
+{
+	bool last = true;
+
+	pthread_mutex_lock(&arena_lock);
+	if (__atomic_sub_fetch(&style->count, 1, __ATOMIC_ACQ_REL) == 0) {
+		css__arena_remove_style(style);
+	} else {
+		last = false;
+	}
+	pthread_mutex_unlock(&arena_lock);
+
+	return last;
+}
+
+
 /* Internally exported function, documented in src/select/arena.h */
 enum css_error css__arena_remove_style(struct css_computed_style *style)
 {
@@ -9,6 +9,8 @@
 #ifndef css_select_arena_h_
 #define css_select_arena_h_
 
+#include <stdbool.h>
+
 struct css_computed_style;
 
 /*
@@ -23,6 +25,17 @@ struct css_computed_style;
  */
 enum css_error css__arena_intern_style(struct css_computed_style **style);
 
+/*
+ * Drop a reference to an interned computed style
+ *
+ * The style is removed from the style sharing arena when the last
+ * reference is dropped.  Safe to call while other threads intern styles.
+ *
+ * \params style  The interned style to release
+ * \return true if this was the last reference and the style may be freed.
+ */
+bool css__arena_release_style(struct css_computed_style *style);
+
 /*
  * Remove a computed style from the style sharing arena
  *
@@ -94,12 +94,8 @@ css_error css_computed_style_destroy(css_computed_style *style)
 	if (style == NULL)
 		return CSS_BADPARM;
 
-	if (style->count > 1) {
-		style->count--;
+	if (style->count != 0 && !css__arena_release_style(style)) {
 		return CSS_OK;
-
-	} else if (style->count == 1) {
-		css__arena_remove_style(style);
 	}
 
 	if (style->counter_increment != NULL) {
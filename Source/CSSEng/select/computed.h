@@ -25,7 +25,7 @@ static inline css_computed_style * css__computed_style_ref(
 	if (style == NULL)
 		return NULL;
 
-	style->count++;
+	__atomic_add_fetch(&style->count, 1, __ATOMIC_RELAXED);
 	return style;
 }
 
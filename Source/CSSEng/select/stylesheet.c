@@ -7,6 +7,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include <strings.h>
 #include <stdarg.h>
 
 #include "select/stylesheet.h"
@@ -21,6 +22,7 @@
 static css_error _add_selectors(css_stylesheet *sheet, css_rule *rule);
 static css_error _remove_selectors(css_stylesheet *sheet, css_rule *rule);
 static size_t _rule_size(const css_rule *rule);
+static bool _selector_depends_on_siblings(const css_selector *selector);
 
 /**
  * Add a string to a stylesheet's string vector.
@@ -544,6 +546,26 @@ css_error css_stylesheet_used_quirks(css_stylesheet *sheet, bool *quirks)
 	return CSS_OK;
 }
 
+/**
+ * Determine whether a stylesheet has selectors which depend on the siblings
+ * of elements: the sibling combinators and the structural pseudo classes,
+ * e.g. `a + b`, `a ~ b`, `:first-child`, and `:nth-child()`.
+ *
+ * \param sheet	  The stylesheet to consider
+ * \param depends  Pointer to location to receive the result
+ * \return CSS_OK on success, appropriate error otherwise
+ */
+css_error css_stylesheet_depends_on_siblings(css_stylesheet *sheet,
+		bool *depends)
+{
+	if (sheet == NULL || depends == NULL)
+		return CSS_BADPARM;
+
+	*depends = sheet->sibling_dependent;
+
+	return CSS_OK;
+}
+
 /**
  * Get disabled status of a stylesheet
  *
@@ -1550,6 +1572,9 @@ css_error _add_selectors(css_stylesheet *sheet, css_rule *rule)
 		for (i = 0; i < rule->items; i++) {
 			css_selector *sel = s->selectors[i];
 
+			if (_selector_depends_on_siblings(sel))
+				sheet->sibling_dependent = true;
+
 			error = css__selector_hash_insert(
 					sheet->selectors, sel);
 			if (error != CSS_OK) {
@@ -1590,6 +1615,49 @@ css_error _add_selectors(css_stylesheet *sheet, css_rule *rule)
 	return CSS_OK;
 }
 
+/**
+ * Determine whether a selector depends on the siblings of the elements
+ *
+ * \param selector  The selector to consider
+ * \return true if the selector has a sibling combinator or a structural
+ *	   pseudo class, false otherwise
+ */
+bool _selector_depends_on_siblings(const css_selector *selector)
+{
+	static const char *structural_classes[] = {
+		"first-child", "last-child", "only-child",
+		"first-of-type", "last-of-type", "only-of-type",
+	};
+
+	for (; selector != NULL; selector = selector->combinator) {
+		const css_selector_detail *detail = &selector->data;
+		const char *name;
+		size_t i;
+
+		if (detail->comb == CSS_COMBINATOR_SIBLING ||
+				detail->comb == CSS_COMBINATOR_GENERIC_SIBLING)
+			return true;
+
+		do {
+			if (detail->type != CSS_SELECTOR_PSEUDO_CLASS)
+				continue;
+
+			/* :nth-child(), :nth-of-type(), and so on */
+			if (detail->value_type ==
+					CSS_SELECTOR_DETAIL_VALUE_NTH)
+				return true;
+
+			name = lwc_string_data(detail->qname.name);
+			for (i = 0; i < N_ELEMENTS(structural_classes); i++) {
+				if (strcasecmp(name, structural_classes[i]) == 0)
+					return true;
+			}
+		} while ((detail++)->next);
+	}
+
+	return false;
+}
+
 /**
  * Remove selectors in a rule from the hash
  *
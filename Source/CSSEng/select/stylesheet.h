@@ -190,6 +190,10 @@ struct css_stylesheet {
 
 	bool inline_style;			/**< Is an inline style */
 
+	bool sibling_dependent;			/**< Has selectors matching
+						 * the siblings or the
+						 * positions of elements */
+
 	size_t size;				/**< Size, in bytes */
 
 	css_import_notification_fn import;	/**< Import notification function */
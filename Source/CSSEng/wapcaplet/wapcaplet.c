@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "csseng-wapcaplet.h"
 
@@ -33,14 +34,33 @@ lwc__calculate_hash(const char *str, size_t len)
 #define STR_OF(str) ((char *)(str + 1))
 #define CSTR_OF(str) ((const char *)(str + 1))
 
-#define NR_BUCKETS_DEFAULT	(4091)
+/*
+ * The string table is split into shards so that several threads can
+ * intern strings at the same time.  Each shard owns a read-write lock
+ * and a fixed array of buckets: looking up a string which is already
+ * interned only takes the read lock of its shard, and a new string is
+ * inserted under the write lock.  The reference counters themselves
+ * are updated atomically, see lwc_string_ref() and lwc_string_unref().
+ */
+#define NR_SHARDS_BITS		(6)
+#define NR_SHARDS		(1 << NR_SHARDS_BITS)
+#define NR_BUCKETS_PER_SHARD	(67)
+
+#define LWC_CACHE_LINE_SIZE	(64)
+
+typedef struct lwc_shard_s {
+	pthread_rwlock_t	lock;
+	lwc_string *		buckets[NR_BUCKETS_PER_SHARD];
+} __attribute__((aligned(LWC_CACHE_LINE_SIZE))) lwc_shard;
 
-typedef struct lwc_context_s {
-	lwc_string **		buckets;
-	lwc_hash		bucketcount;
-} lwc_context;
+#define SHARD_INITIALIZER	{ PTHREAD_RWLOCK_INITIALIZER, { NULL } }
 
-static lwc_context *ctx = NULL;
+static lwc_shard shards[NR_SHARDS] = {
+	[0 ... (NR_SHARDS - 1)] = SHARD_INITIALIZER
+};
+
+#define SHARD_OF(h)		(shards + ((h) & (NR_SHARDS - 1)))
+#define BUCKET_OF(h)		(((h) >> NR_SHARDS_BITS) % NR_BUCKETS_PER_SHARD)
 
 #define LWC_ALLOC(s) malloc(s)
 #define LWC_FREE(p) free(p)
@@ -49,31 +69,19 @@ typedef lwc_hash (*lwc_hasher)(const char *, size_t);
 typedef int (*lwc_strncmp)(const char *, const char *, size_t);
 typedef void * (*lwc_memcpy)(void * restrict, const void * restrict, size_t);
 
-static lwc_error
-lwc__initialise(void)
+static inline lwc_string *
+lwc__find(lwc_string *str, const char *s, size_t slen, lwc_hash h,
+	  lwc_strncmp compare)
 {
-	if (ctx != NULL)
-		return lwc_error_ok;
-
-	ctx = LWC_ALLOC(sizeof(lwc_context));
-
-	if (ctx == NULL)
-		return lwc_error_oom;
-
-	memset(ctx, 0, sizeof(lwc_context));
-
-	ctx->bucketcount = NR_BUCKETS_DEFAULT;
-	ctx->buckets = LWC_ALLOC(sizeof(lwc_string *) * ctx->bucketcount);
-
-	if (ctx->buckets == NULL) {
-		LWC_FREE(ctx);
-		ctx = NULL;
-		return lwc_error_oom;
+	while (str != NULL) {
+		if ((str->hash == h) && (str->len == slen)) {
+			if (compare(CSTR_OF(str), s, slen) == 0)
+				return str;
+		}
+		str = str->next;
 	}
 
-	memset(ctx->buckets, 0, sizeof(lwc_string *) * ctx->bucketcount);
-
-	return lwc_error_ok;
+	return NULL;
 }
 
 static lwc_error
@@ -84,47 +92,46 @@ lwc__intern(const char *s, size_t slen,
 	   lwc_memcpy copy)
 {
 	lwc_hash h;
-	lwc_hash bucket;
+	lwc_string **bucket;
+	lwc_shard *shard;
 	lwc_string *str;
-	lwc_error eret;
 
 	assert((s != NULL) || (slen == 0));
 	assert(ret);
 
-	if (ctx == NULL) {
-		eret = lwc__initialise();
-		if (eret != lwc_error_ok)
-			return eret;
-		if (ctx == NULL)
-			return lwc_error_oom;
-	}
-
 	h = hasher(s, slen);
-	bucket = h % ctx->bucketcount;
-	str = ctx->buckets[bucket];
-
-	while (str != NULL) {
-		if ((str->hash == h) && (str->len == slen)) {
-			if (compare(CSTR_OF(str), s, slen) == 0) {
-				str->refcnt++;
-				*ret = str;
-				return lwc_error_ok;
-			}
-		}
-		str = str->next;
+	shard = SHARD_OF(h);
+	bucket = shard->buckets + BUCKET_OF(h);
+
+	/* Fast path: the string is already interned. */
+	pthread_rwlock_rdlock(&shard->lock);
+	str = lwc__find(*bucket, s, slen, h, compare);
+	if (str != NULL) {
+		__atomic_add_fetch(&str->refcnt, 1, __ATOMIC_RELAXED);
+		pthread_rwlock_unlock(&shard->lock);
+		*ret = str;
+		return lwc_error_ok;
+	}
+	pthread_rwlock_unlock(&shard->lock);
+
+	/* Slow path: another thread may have interned the same string
+	 * between the two locks, so search the bucket again. */
+	pthread_rwlock_wrlock(&shard->lock);
+	str = lwc__find(*bucket, s, slen, h, compare);
+	if (str != NULL) {
+		__atomic_add_fetch(&str->refcnt, 1, __ATOMIC_RELAXED);
+		pthread_rwlock_unlock(&shard->lock);
+		*ret = str;
+		return lwc_error_ok;
 	}
 
 	/* Add one for the additional NUL. */
-	*ret = str = LWC_ALLOC(sizeof(lwc_string) + slen + 1);
+	str = LWC_ALLOC(sizeof(lwc_string) + slen + 1);
 
-	if (str == NULL)
+	if (str == NULL) {
+		pthread_rwlock_unlock(&shard->lock);
 		return lwc_error_oom;
-
-	str->prevptr = &(ctx->buckets[bucket]);
-	str->next = ctx->buckets[bucket];
-	if (str->next != NULL)
-		str->next->prevptr = &(str->next);
-	ctx->buckets[bucket] = str;
+	}
 
 	str->len = slen;
 	str->hash = h;
@@ -136,6 +143,15 @@ lwc__intern(const char *s, size_t slen,
 	/* Guarantee NUL termination */
 	STR_OF(str)[slen] = '\0';
 
+	str->prevptr = bucket;
+	str->next = *bucket;
+	if (str->next != NULL)
+		str->next->prevptr = &(str->next);
+	*bucket = str;
+
+	pthread_rwlock_unlock(&shard->lock);
+
+	*ret = str;
 	return lwc_error_ok;
 }
 
@@ -172,29 +188,31 @@ lwc_string_tolower(lwc_string *str, lwc_string **ret)
 
 	/* Internally make use of knowledge that insensitive strings
 	 * are lower case. */
-	if (str->insensitive == NULL) {
+	if (lwc__insensitive(str) == NULL) {
 		lwc_error error = lwc__intern_caseless_string(str);
 		if (error != lwc_error_ok) {
 			return error;
 		}
 	}
 
-	*ret = lwc_string_ref(str->insensitive);
+	*ret = lwc_string_ref(lwc__insensitive(str));
 	return lwc_error_ok;
 }
 
-void
-lwc_string_destroy(lwc_string *str)
+static void
+lwc__string_unlink(lwc_string *str)
 {
-	assert(str);
-
 	*(str->prevptr) = str->next;
 
 	if (str->next != NULL)
 		str->next->prevptr = str->prevptr;
+}
 
-	if (str->insensitive != NULL && str->refcnt == 0)
-		lwc_string_unref(str->insensitive);
+static void
+lwc__string_free(lwc_string *str, lwc_string *insensitive)
+{
+	if (insensitive != NULL && insensitive != str)
+		lwc_string_unref(insensitive);
 
 #ifndef NDEBUG
 	memset(str, 0xA5, sizeof(*str) + str->len);
@@ -203,6 +221,51 @@ lwc_string_destroy(lwc_string *str)
 	LWC_FREE(str);
 }
 
+void
+lwc_string_destroy(lwc_string *str)
+{
+	lwc_shard *shard;
+	lwc_string *insensitive = NULL;
+
+	assert(str);
+
+	shard = SHARD_OF(str->hash);
+	pthread_rwlock_wrlock(&shard->lock);
+	lwc__string_unlink(str);
+	if (__atomic_load_n(&str->refcnt, __ATOMIC_ACQUIRE) == 0)
+		insensitive = lwc__insensitive(str);
+	pthread_rwlock_unlock(&shard->lock);
+
+	lwc__string_free(str, insensitive);
+}
+
+void
+lwc__string_unref_slow(lwc_string *str)
+{
+	lwc_shard *shard;
+	lwc_string *insensitive;
+	lwc_refcounter refcnt;
+
+	assert(str);
+
+	/* The last references are dropped under the write lock of the
+	 * shard, so that no lookup can resurrect a string going away. */
+	shard = SHARD_OF(str->hash);
+	pthread_rwlock_wrlock(&shard->lock);
+
+	refcnt = __atomic_sub_fetch(&str->refcnt, 1, __ATOMIC_ACQ_REL);
+	insensitive = lwc__insensitive(str);
+	if (refcnt != 0 && !(refcnt == 1 && insensitive == str)) {
+		pthread_rwlock_unlock(&shard->lock);
+		return;
+	}
+
+	lwc__string_unlink(str);
+	pthread_rwlock_unlock(&shard->lock);
+
+	lwc__string_free(str, refcnt == 0 ? insensitive : NULL);
+}
+
 /**** Shonky caseless bits ****/
 
 static inline char
@@ -254,14 +317,29 @@ lwc__lcase_memcpy(void *restrict _target, const void *restrict _source, size_t n
 lwc_error
 lwc__intern_caseless_string(lwc_string *str)
 {
+	lwc_string *insensitive;
+	lwc_string *expected = NULL;
+	lwc_error error;
+
 	assert(str);
-	assert(str->insensitive == NULL);
 
-	return lwc__intern(CSTR_OF(str),
-			   str->len, &(str->insensitive),
+	error = lwc__intern(CSTR_OF(str),
+			   str->len, &insensitive,
 			   lwc__calculate_lcase_hash,
 			   lwc__lcase_strncmp,
 			   lwc__lcase_memcpy);
+	if (error != lwc_error_ok)
+		return error;
+
+	/* Another thread may have set the caseless string meanwhile;
+	 * keep the first one and drop our reference. */
+	if (!__atomic_compare_exchange_n(&str->insensitive, &expected,
+			insensitive, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		assert(expected == insensitive);
+		lwc_string_unref(insensitive);
+	}
+
+	return lwc_error_ok;
 }
 
 /**** Iteration ****/
@@ -269,24 +347,18 @@ lwc__intern_caseless_string(lwc_string *str)
 void
 lwc_iterate_strings(lwc_iteration_callback_fn cb, void *pw)
 {
+	lwc_shard *shard;
 	lwc_hash n;
 	lwc_string *str;
-	bool found = false;
 
-	if (ctx == NULL)
-		return;
-
-	for (n = 0; n < ctx->bucketcount; ++n) {
-		for (str = ctx->buckets[n]; str != NULL; str = str->next) {
-			found = true;
-			cb(str, pw);
+	for (shard = shards; shard < shards + NR_SHARDS; ++shard) {
+		pthread_rwlock_rdlock(&shard->lock);
+		for (n = 0; n < NR_BUCKETS_PER_SHARD; ++n) {
+			for (str = shard->buckets[n]; str != NULL;
+					str = str->next) {
+				cb(str, pw);
+			}
 		}
-	}
-
-	if (found == false) {
-		/* We found no strings, so remove the global context. */
-		free(ctx->buckets);
-		free(ctx);
-		ctx = NULL;
+		pthread_rwlock_unlock(&shard->lock);
 	}
 }
@@ -72,6 +72,11 @@
 #define DOMRULER_NOT_SUPPORT        10
 #define DOMRULER_SELECT_STYLE_ERR   11
 
+/* the flags for domruler_mark_dirty() */
+#define DOMRULER_DIRTY_STYLE        0x01    /* the style attribute changed */
+#define DOMRULER_DIRTY_ATTRS        0x02    /* the id, class or other attributes changed */
+#define DOMRULER_DIRTY_CHILDREN     0x04    /* some children inserted or removed */
+
 // error code end
 
 // common attribute
@@ -515,6 +520,33 @@ int domruler_append_css(struct DOMRulerCtxt *ctxt, const char *css,
 int domruler_layout(struct DOMRulerCtxt *ctxt, void *root_node,
         DOMRulerNodeOp *op);
 
+/**
+ * Mark a node dirty after it changed. The next domruler_layout() call for
+ * the same root only selects the styles of the changed nodes and lays out
+ * the boxes affected by them; otherwise the whole tree is laid out.
+ *
+ * @param ctxt: the pointer to the DOMRulerCtxt
+ * @param node: the pointer to the changed node
+ * @param flags: the DOMRULER_DIRTY_XXX flags telling what changed
+ *
+ * Returns: zero if success; an error code (!=0) otherwise.
+ *
+ * Since: 1.2.2
+ */
+int domruler_mark_dirty(struct DOMRulerCtxt *ctxt, void *node,
+        uint32_t flags);
+
+/**
+ * Forget a node and its descendants before the node is removed from
+ * the DOM tree, and mark the parent dirty.
+ *
+ * @param ctxt: the pointer to the DOMRulerCtxt
+ * @param node: the pointer to the node to remove
+ *
+ * Since: 1.2.2
+ */
+void domruler_remove_node(struct DOMRulerCtxt *ctxt, void *node);
+
 /**
  * Get HLBox of the node
  *
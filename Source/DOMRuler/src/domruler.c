@@ -64,7 +64,8 @@ struct DOMRulerCtxt *domruler_create(uint32_t width, uint32_t height,
 
     ctxt->node_map = g_hash_table_new_full(g_direct_hash,
             g_direct_equal, NULL, cb_hl_layout_node_destroy);
-    if (ctxt->node_map == NULL) {
+    ctxt->dirty_nodes = g_hash_table_new(g_direct_hash, g_direct_equal);
+    if (ctxt->node_map == NULL || ctxt->dirty_nodes == NULL) {
         domruler_destroy(ctxt);
         return NULL;
     }
@@ -83,12 +84,20 @@ int domruler_append_css(struct DOMRulerCtxt *ctxt, const char *css,
             return DOMRULER_NOMEM;
         }
     }
+
+    // the styles of all nodes may change
+    ctxt->root = NULL;
     return domruler_css_append_data(ctxt->css, css, nr_css);
 }
 
 int domruler_layout(struct DOMRulerCtxt *ctxt, void *root_node,
         DOMRulerNodeOp *op)
 {
+    if (ctxt->root && ctxt->origin_root == root_node &&
+            ctxt->origin_op == op && g_hash_table_size(ctxt->dirty_nodes)) {
+        return hl_layout_do_relayout(ctxt);
+    }
+
     ctxt->origin_root = root_node;
     ctxt->origin_op = op;
     HLLayoutNode *layout_node = hl_layout_node_from_origin_node(ctxt, root_node);
@@ -113,6 +122,10 @@ void domruler_destroy(struct DOMRulerCtxt *ctxt)
         domruler_css_destroy(ctxt->css);
     }
 
+    if (ctxt->dirty_nodes) {
+        g_hash_table_destroy(ctxt->dirty_nodes);
+    }
+
     if (ctxt->node_map) {
         g_hash_table_destroy(ctxt->node_map);
     }
@@ -124,7 +137,50 @@ void domruler_reset_nodes(struct DOMRulerCtxt *ctxt)
 {
     if (ctxt && ctxt->node_map) {
         g_hash_table_remove_all(ctxt->node_map);
+        g_hash_table_remove_all(ctxt->dirty_nodes);
+        ctxt->root = NULL;
+    }
+}
+
+int domruler_mark_dirty(struct DOMRulerCtxt *ctxt, void *node,
+        uint32_t flags)
+{
+    if (!ctxt || !node) {
+        return DOMRULER_BADPARM;
+    }
+
+    flags |= GPOINTER_TO_UINT(g_hash_table_lookup(ctxt->dirty_nodes, node));
+    g_hash_table_insert(ctxt->dirty_nodes, node, GUINT_TO_POINTER(flags));
+    return DOMRULER_OK;
+}
+
+static void forget_node(struct DOMRulerCtxt *ctxt, void *node)
+{
+    void *child = ctxt->origin_op->first_child(node);
+    while (child) {
+        forget_node(ctxt, child);
+        child = ctxt->origin_op->next(child);
+    }
+
+    g_hash_table_remove(ctxt->dirty_nodes, node);
+    g_hash_table_remove(ctxt->node_map, node);
+}
+
+void domruler_remove_node(struct DOMRulerCtxt *ctxt, void *node)
+{
+    if (!ctxt || !node || !ctxt->origin_op) {
+        return;
+    }
+
+    void *parent = ctxt->origin_op->get_parent(node);
+    if (parent) {
+        domruler_mark_dirty(ctxt, parent, DOMRULER_DIRTY_CHILDREN);
+    }
+
+    if (ctxt->root && ctxt->root->origin == node) {
+        ctxt->root = NULL;
     }
+    forget_node(ctxt, node);
 }
 
 int domruler_layout_hldom_elements(struct DOMRulerCtxt *ctxt,
@@ -73,6 +73,10 @@ struct DOMRulerCtxt {
     DOMRulerNodeOp *origin_op;
 
     GHashTable *node_map; // key(origin node pointer) -> value(HLLayoutNode *)
+
+    // the nodes marked dirty since the last layout:
+    // key(origin node pointer) -> value(DOMRULER_DIRTY_XXX flags)
+    GHashTable *dirty_nodes;
 };
 
 typedef void (*cb_free_attach_data) (void *data);
@@ -534,6 +534,9 @@ int hl_block_find_dimensions(struct DOMRulerCtxt *ctx,
             &max_height,
             &min_height
             );
+    /* solve the margins from scratch, so that laying out a node again
+       gives the same result */
+    node->margin[HL_LEFT] = node->margin[HL_RIGHT] = 0;
     int sw = hl_solve_width(node, container_width, width, 0, 0,
             max_width, min_width);
     int sh = height;
@@ -630,6 +633,10 @@ int hl_layout_node(struct DOMRulerCtxt *ctx, HLLayoutNode *node, int x, int y,
 
     node->box_values.x = x;
     node->box_values.y = y;
+    node->container_width = container_width;
+    node->container_height = container_height;
+    node->level = level;
+    node->laid_out = true;
 
     hl_computed_z_index(node);
     hl_find_background(node);
@@ -810,23 +817,33 @@ int hl_layout_node(struct DOMRulerCtxt *ctx, HLLayoutNode *node, int x, int y,
     return DOMRULER_OK;
 }
 
+static void hl_layout_prepare_media(struct DOMRulerCtxt *ctxt, css_media *m)
+{
+    hl_set_media_dpi(ctxt, ctxt->dpi);
+    hl_set_baseline_pixel_density(ctxt, ctxt->density);
+
+    m->type = CSS_MEDIA_SCREEN;
+    m->width  = hl_css_pixels_physical_to_css(ctxt, INTTOFIX(ctxt->width));
+    m->height = hl_css_pixels_physical_to_css(ctxt, INTTOFIX(ctxt->height));
+    ctxt->vw = m->width;
+    ctxt->vh = m->height;
+}
+
 int hl_layout_do_layout(struct DOMRulerCtxt *ctxt, HLLayoutNode *root)
 {
     if (ctxt == NULL || ctxt->css == NULL || ctxt->css->sheet == NULL) {
         return DOMRULER_BADPARM;
     }
 
-    hl_set_media_dpi(ctxt, ctxt->dpi);
-    hl_set_baseline_pixel_density(ctxt, ctxt->density);
-
     css_media m;
-    m.type = CSS_MEDIA_SCREEN;
-    m.width  = hl_css_pixels_physical_to_css(ctxt, INTTOFIX(ctxt->width));
-    m.height = hl_css_pixels_physical_to_css(ctxt, INTTOFIX(ctxt->height));
-    ctxt->vw = m.width;
-    ctxt->vh = m.height;
+    hl_layout_prepare_media(ctxt, &m);
     ctxt->root = root;
 
+    // the whole tree will be selected and laid out
+    if (ctxt->dirty_nodes) {
+        g_hash_table_remove_all(ctxt->dirty_nodes);
+    }
+
     // create css select context
     css_select_ctx *select_ctx = hl_css_select_ctx_create(ctxt->css);
 
@@ -843,4 +860,146 @@ int hl_layout_do_layout(struct DOMRulerCtxt *ctxt, HLLayoutNode *root)
     return ret;
 }
 
+static void hl_reset_select_data(HLLayoutNode *node)
+{
+    // the css select data of the node caches the ancestors and siblings
+    if (node->inner_data) {
+        hl_layout_node_set_inner_data(node, HL_INNER_CSS_SELECT_ATTACH,
+                NULL, NULL);
+    }
+
+    HLLayoutNode *child = hl_layout_node_first_child(node);
+    while (child) {
+        hl_reset_select_data(child);
+        child = hl_layout_node_next(child);
+    }
+}
+
+static bool hl_has_ancestor_in(GHashTable *nodes, HLLayoutNode *node)
+{
+    HLLayoutNode *parent = hl_layout_node_get_parent(node);
+    while (parent) {
+        if (g_hash_table_contains(nodes, parent)) {
+            return true;
+        }
+        parent = hl_layout_node_get_parent(parent);
+    }
+    return false;
+}
+
+/*
+ * The size of a box only depends on its style and its container, not on
+ * the children, so laying out the parent again covers the changes of
+ * a node and the following siblings. The children of a grid are placed
+ * by the grid, so the grid itself has to be laid out again.
+ */
+static HLLayoutNode *hl_find_layout_boundary(HLLayoutNode *node)
+{
+    HLLayoutNode *parent = hl_layout_node_get_parent(node);
+    while (parent) {
+        if (parent->laid_out && parent->layout_type != LAYOUT_GRID &&
+                parent->layout_type != LAYOUT_INLINE_GRID) {
+            break;
+        }
+        node = parent;
+        parent = hl_layout_node_get_parent(node);
+    }
+
+    return parent ? parent : node;
+}
+
+int hl_layout_do_relayout(struct DOMRulerCtxt *ctxt)
+{
+    if (ctxt == NULL || ctxt->css == NULL || ctxt->css->sheet == NULL ||
+            ctxt->root == NULL) {
+        return DOMRULER_BADPARM;
+    }
+
+    int ret = DOMRULER_OK;
+    GHashTable *restyle = g_hash_table_new(g_direct_hash, g_direct_equal);
+    GHashTable *relayout = g_hash_table_new(g_direct_hash, g_direct_equal);
+    if (restyle == NULL || relayout == NULL) {
+        ret = DOMRULER_NOMEM;
+        goto out;
+    }
+
+    // collect the nodes to select style for and the nodes to lay out
+    GHashTableIter iter;
+    gpointer key, value;
+    g_hash_table_iter_init(&iter, ctxt->dirty_nodes);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        HLLayoutNode *node = hl_layout_node_from_origin_node(ctxt, key);
+        uint32_t flags = GPOINTER_TO_UINT(value);
+        if (node == NULL) {
+            continue;
+        }
+
+        if (flags & DOMRULER_DIRTY_ATTRS) {
+            hl_layout_node_reload_inner_attrs(node);
+        }
+
+        if (flags & (DOMRULER_DIRTY_STYLE | DOMRULER_DIRTY_ATTRS)) {
+            g_hash_table_add(restyle, node);
+            g_hash_table_add(relayout, hl_find_layout_boundary(node));
+        }
+
+        if (flags & DOMRULER_DIRTY_CHILDREN) {
+            HLLayoutNode *child = hl_layout_node_first_child(node);
+            while (child) {
+                g_hash_table_add(restyle, child);
+                child = hl_layout_node_next(child);
+            }
+            g_hash_table_add(relayout,
+                    node->laid_out ? node : hl_find_layout_boundary(node));
+        }
+    }
+    g_hash_table_remove_all(ctxt->dirty_nodes);
+
+    css_media m;
+    hl_layout_prepare_media(ctxt, &m);
+
+    css_select_ctx *select_ctx = hl_css_select_ctx_create(ctxt->css);
+    if (select_ctx == NULL) {
+        ret = DOMRULER_SELECT_STYLE_ERR;
+        goto out;
+    }
 
+    // the descendants are selected along with the ancestor
+    g_hash_table_iter_init(&iter, restyle);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+        HLLayoutNode *node = key;
+        if (hl_has_ancestor_in(restyle, node)) {
+            continue;
+        }
+
+        hl_reset_select_data(node);
+        ret = hl_select_child_style(&m, select_ctx, node);
+        if (ret != DOMRULER_OK) {
+            HL_LOGD("%s|select child style failed.|code=%d\n", __func__, ret);
+            hl_css_select_ctx_destroy(select_ctx);
+            goto out;
+        }
+    }
+    ctxt->root_style = ctxt->root->computed_style;
+
+    g_hash_table_iter_init(&iter, relayout);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+        HLLayoutNode *node = key;
+        if (hl_has_ancestor_in(relayout, node)) {
+            continue;
+        }
+
+        hl_layout_node(ctxt, node, node->box_values.x, node->box_values.y,
+                node->container_width, node->container_height, node->level);
+    }
+    hl_css_select_ctx_destroy(select_ctx);
+
+out:
+    if (restyle) {
+        g_hash_table_destroy(restyle);
+    }
+    if (relayout) {
+        g_hash_table_destroy(relayout);
+    }
+    return ret;
+}
@@ -32,6 +32,7 @@ extern "C" {
 int hl_computed_z_index(HLLayoutNode *node);
 
 int hl_layout_do_layout(struct DOMRulerCtxt* ctx, HLLayoutNode *root);
+int hl_layout_do_relayout(struct DOMRulerCtxt* ctx);
 int hl_layout_child_node_grid(struct DOMRulerCtxt* ctx, HLLayoutNode *node,
         int level);
 
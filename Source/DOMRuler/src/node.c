@@ -46,6 +46,70 @@ HLLayoutNode *hl_layout_node_create(void)
     return node;
 }
 
+static void hl_layout_node_clear_inner_attrs(HLLayoutNode *node)
+{
+    if (node->inner_tag) {
+        lwc_string_unref(node->inner_tag);
+    }
+    if (node->inner_id) {
+        lwc_string_unref(node->inner_id);
+    }
+
+    if (node->inner_classes) {
+        for (int i = 0; i < node->nr_inner_classes; i++) {
+            lwc_string_unref(node->inner_classes[i]);
+        }
+        free(node->inner_classes);
+    }
+
+    node->inner_tag = NULL;
+    node->inner_id = NULL;
+    node->inner_classes = NULL;
+    node->nr_inner_classes = 0;
+}
+
+static void hl_layout_node_load_inner_attrs(HLLayoutNode *layout)
+{
+    struct DOMRulerCtxt *ctxt = layout->ctxt;
+    void *origin = layout->origin;
+
+    // inner_id
+    const char *id = ctxt->origin_op->get_id(origin);
+    if (id) {
+        layout->inner_id = hl_lwc_string_dup(id);
+    }
+
+    // inner_tag
+    const char *name = ctxt->origin_op->get_name(origin);
+    if (name) {
+        layout->inner_tag = hl_lwc_string_dup(name);
+    }
+    // inner_classes
+    char **classes = NULL;
+    int nr_classes = ctxt->origin_op->get_classes(origin, &classes);
+    if (nr_classes > 0) {
+        layout->inner_classes = (lwc_string**)calloc(nr_classes,
+                sizeof(lwc_string*));
+        for (int i = 0; i < nr_classes; i++) {
+            // VM FIXED
+            // layout->inner_classes[i++]= hl_lwc_string_dup(classes[i]);
+            layout->inner_classes[i]= hl_lwc_string_dup(classes[i]);
+            free(classes[i]);
+        }
+        layout->nr_inner_classes = nr_classes;
+        free(classes);
+    }
+    else if (classes) {
+        free(classes);
+    }
+}
+
+void hl_layout_node_reload_inner_attrs(HLLayoutNode *node)
+{
+    hl_layout_node_clear_inner_attrs(node);
+    hl_layout_node_load_inner_attrs(node);
+}
+
 void hl_layout_node_destroy(HLLayoutNode *node)
 {
     if (!node) {
@@ -76,19 +140,7 @@ void hl_layout_node_destroy(HLLayoutNode *node)
         free(node->attach_data);
     }
 
-    if (node->inner_tag) {
-        lwc_string_unref(node->inner_tag);
-    }
-    if (node->inner_id) {
-        lwc_string_unref(node->inner_id);
-    }
-
-    if (node->inner_classes) {
-        for (int i = 0; i < node->nr_inner_classes; i++) {
-            lwc_string_unref(node->inner_classes[i]);
-        }
-        free(node->inner_classes);
-    }
+    hl_layout_node_clear_inner_attrs(node);
     free(node);
 }
 
@@ -483,40 +535,9 @@ HLLayoutNode *hl_layout_node_from_origin_node(struct DOMRulerCtxt *ctxt,
         return NULL;
     }
     layout->ctxt = ctxt;
-
-    // inner_id
-    const char *id = ctxt->origin_op->get_id(origin);
-    if (id) {
-        layout->inner_id = hl_lwc_string_dup(id);
-    }
-
-    // inner_tag
-    const char *name = ctxt->origin_op->get_name(origin);
-    if (name) {
-        layout->inner_tag = hl_lwc_string_dup(name);
-    }
-    // inner_classes
-    char **classes = NULL;
-    int nr_classes = ctxt->origin_op->get_classes(origin, &classes);
-    if (nr_classes > 0) {
-        layout->inner_classes = (lwc_string**)calloc(nr_classes,
-                sizeof(lwc_string*));
-        for (int i = 0; i < nr_classes; i++) {
-            // VM FIXED
-            // layout->inner_classes[i++]= hl_lwc_string_dup(classes[i]);
-            layout->inner_classes[i]= hl_lwc_string_dup(classes[i]);
-            free(classes[i]);
-        }
-        layout->nr_inner_classes = nr_classes;
-        free(classes);
-    }
-    else if (classes) {
-        free(classes);
-    }
-
-
     layout->origin = origin;
-    layout->ctxt = ctxt;
+    hl_layout_node_load_inner_attrs(layout);
+
     g_hash_table_insert(ctxt->node_map, (gpointer)origin, (gpointer)layout);
     return layout;
 }
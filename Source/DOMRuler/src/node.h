@@ -111,6 +111,13 @@ typedef struct HLLayoutNode {
     void *origin;
 
     struct DOMRulerCtxt *ctxt;
+
+    // begin for relayout: the arguments of the last layout of this node
+    int container_width;
+    int container_height;
+    int level;
+    bool laid_out;
+    // end for relayout
 } HLLayoutNode;
 
 #ifdef __cplusplus
@@ -143,6 +150,9 @@ void hl_for_each_child(struct DOMRulerCtxt *ctx, HLLayoutNode *node,
 
 void cb_hl_layout_node_destroy(void *n);
 
+// reload the tag name, id and classes after the attributes changed
+void hl_layout_node_reload_inner_attrs(HLLayoutNode *node);
+
 // BEGIN: HLLayoutNode  < ----- > Origin Node
 HLLayoutNode *hl_layout_node_from_origin_node(struct DOMRulerCtxt *ctxt,
         void *origin);
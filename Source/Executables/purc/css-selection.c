@@ -1398,21 +1398,28 @@ set_node_data(void *pw, void *n, void *node_data)
     purc_document_t doc = udom->doc;
     pcdoc_node node = { PCDOC_NODE_ELEMENT, { n } };
 
+    /* the styles of sibling subtrees may be selected in parallel, and
+       CSSEng looks up the node data of the siblings and the cousins. */
+    pthread_mutex_lock(&udom->lock);
     pcdoc_node_set_user_data(doc, node, node_data);
 
     /* we save the node data in udom->ele2nodedata in order to manage
        the changes of documment and release the node data when we are done. */
     sorted_array_add(udom->elem2nodedata, PTR2U64(n), node_data);
+    pthread_mutex_unlock(&udom->lock);
     return CSS_OK;
 }
 
 static css_error
 get_node_data(void *pw, void *n, void **node_data)
 {
-    purc_document_t doc = ((pcmcth_udom *)pw)->doc;
+    pcmcth_udom *udom = pw;
+    purc_document_t doc = udom->doc;
     pcdoc_node node = { PCDOC_NODE_ELEMENT, { n } };
 
+    pthread_mutex_lock(&udom->lock);
     pcdoc_node_get_user_data(doc, node, node_data);
+    pthread_mutex_unlock(&udom->lock);
     return CSS_OK;
 }
 
@@ -76,19 +76,23 @@ bool foil_page_content_init(pcmcth_page *page, int cols, int rows,
         foil_page_content_cleanup(page);
 
     page->cells = calloc(rows, sizeof(struct foil_tty_cell *));
-    if (page->cells == NULL)
-        return false;
+    page->flushed = calloc(rows, sizeof(struct foil_tty_cell *));
+    if (page->cells == NULL || page->flushed == NULL)
+        goto failed;
 
+    /* set rows for foil_page_content_cleanup() */
+    page->rows = rows;
     for (int i = 0; i < rows; i++) {
         page->cells[i] = calloc(cols, sizeof(struct foil_tty_cell));
-        if (page->cells[i] == NULL) {
-            foil_page_content_cleanup(page);
+        page->flushed[i] = malloc(cols * sizeof(struct foil_tty_cell));
+        if (page->cells[i] == NULL || page->flushed[i] == NULL) {
+            goto failed;
         }
     }
 
-    page->rows = rows;
     page->cols = cols;
     page->udom = NULL;
+    foil_page_invalidate_flushed(page);
 
     page->attrs = FOIL_CHAR_ATTR_NULL;
     page->color_mode = FOIL_TTY_COLOR_STD_16C; /* TODO */
@@ -98,6 +102,10 @@ bool foil_page_content_init(pcmcth_page *page, int cols, int rows,
 
     foil_page_fill_rect(page, NULL, FOIL_UCHAR_SPACE);
     return true;
+
+failed:
+    foil_page_content_cleanup(page);
+    return false;
 }
 
 void foil_page_content_cleanup(pcmcth_page *page)
@@ -110,9 +118,30 @@ void foil_page_content_cleanup(pcmcth_page *page)
         free(page->cells);
     }
 
+    if (page->flushed) {
+        for (int i = 0; i < page->rows; i++) {
+            if (page->flushed[i])
+                free(page->flushed[i]);
+        }
+        free(page->flushed);
+    }
+
     page->rows = 0;
     page->cols = 0;
     page->cells = NULL;
+    page->flushed = NULL;
+}
+
+void foil_page_invalidate_flushed(pcmcth_page *page)
+{
+    /* no color value has all bits set */
+    for (int y = 0; y < page->rows; y++) {
+        struct foil_tty_cell *line = page->flushed[y];
+        for (int x = 0; x < page->cols; x++) {
+            line[x].fgc = -1;
+            line[x].bgc = -1;
+        }
+    }
 }
 
 /* An anonymous page resides in an orphan widget */
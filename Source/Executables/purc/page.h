@@ -80,6 +80,10 @@ struct pcmcth_page {
 
     pcmcth_udom *udom;
     struct foil_tty_cell **cells;
+
+    /* the cells last flushed to the terminal; the output only contains
+       the cells which differ from them. */
+    struct foil_tty_cell **flushed;
 };
 
 #ifdef __cplusplus
@@ -117,6 +121,10 @@ bool foil_page_fill_rect(pcmcth_page *page, const foil_rect *rc, uint32_t uc);
 bool foil_page_erase_rect(pcmcth_page *page, const foil_rect *rc);
 bool foil_page_expose(pcmcth_page *page);
 
+/* Forgets the cells flushed to the terminal, so that the next flush
+   outputs all cells in the dirty rectangle. */
+void foil_page_invalidate_flushed(pcmcth_page *page);
+
 #ifdef __cplusplus
 }
 #endif
@@ -158,6 +158,10 @@ void foil_rdrbox_block_box_cleanup(struct _block_box_data *data);
 void foil_rdrbox_list_item_cleanup(struct _list_item_data *data);
 void foil_rdrbox_inline_block_box_cleanup(struct _inline_block_data *data);
 
+/* Frees the formatting contexts and clears the geometry of a box laid out
+   already, so that the box can be laid out again. */
+void foil_rdrbox_reset_layout(foil_rdrbox *box);
+
 static inline struct _inline_fmt_ctxt *
 foil_rdrbox_inline_fmt_ctxt(foil_rdrbox *box)
 {
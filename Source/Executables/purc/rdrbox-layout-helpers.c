@@ -66,6 +66,10 @@ struct _inline_fmt_ctxt *foil_rdrbox_inline_fmt_ctxt_new(void)
 
 static void free_inline_formatting_context(struct _inline_fmt_ctxt *ctxt)
 {
+    /* the context may have been freed by foil_rdrbox_reset_layout() */
+    if (ctxt == NULL)
+        return;
+
     for (size_t i = 0; i < ctxt->nr_lines; i++) {
         if (ctxt->lines[i].runs)
             free(ctxt->lines[i].runs);
@@ -91,6 +95,40 @@ void foil_rdrbox_inline_block_box_cleanup(struct _inline_block_data *data)
     free_inline_formatting_context(data->lfmt_ctxt);
 }
 
+void foil_rdrbox_reset_layout(foil_rdrbox *box)
+{
+    struct _inline_fmt_ctxt **lfmt_ctxt = NULL;
+
+    if (box->type == FOIL_RDRBOX_TYPE_BLOCK)
+        lfmt_ctxt = &box->block_data->lfmt_ctxt;
+    else if (box->type == FOIL_RDRBOX_TYPE_LIST_ITEM)
+        lfmt_ctxt = &box->list_item_data->lfmt_ctxt;
+    else if (box->type == FOIL_RDRBOX_TYPE_INLINE_BLOCK)
+        lfmt_ctxt = &box->inline_block_data->lfmt_ctxt;
+
+    if (lfmt_ctxt && *lfmt_ctxt) {
+        free_inline_formatting_context(*lfmt_ctxt);
+        *lfmt_ctxt = NULL;
+    }
+
+    if (box->block_fmt_ctxt) {
+        foil_rdrbox_block_fmt_ctxt_delete(box->block_fmt_ctxt);
+        box->block_fmt_ctxt = NULL;
+    }
+
+    box->is_width_resolved = 0;
+    box->is_height_resolved = 0;
+    box->is_in_flow = 0;
+    box->is_in_normal_flow = 0;
+
+    box->nr_block_level_children = 0;
+    box->nr_inline_level_children = 0;
+    box->nr_floating_children = 0;
+    box->nr_abspos_children = 0;
+
+    foil_rect_empty(&box->ctnt_rect);
+}
+
 #define SZ_IN_STACK_BUFF    128
 
 int foil_rdrbox_inline_calc_preferred_width(foil_rdrbox *box)
@@ -2016,6 +2016,27 @@ void foil_rdrbox_resolve_height(foil_layout_ctxt *ctxt, foil_rdrbox *box)
 #endif
 }
 
+bool foil_rdrbox_is_layout_boundary(const foil_rdrbox *box)
+{
+    if (box->is_initial)
+        return true;
+
+    if (box->type != FOIL_RDRBOX_TYPE_BLOCK || !box->is_block_level ||
+            !box->is_principal || box->is_root || !box->is_in_normal_flow ||
+            box->computed_style == NULL)
+        return false;
+
+    /* the width does not depend on the contents; if the height is `auto`,
+       the caller lays out the boundary containing this one again when
+       the height changes. */
+    css_fixed l;
+    css_unit u;
+    if (css_computed_width(box->computed_style, &l, &u) == CSS_WIDTH_AUTO)
+        return false;
+
+    return true;
+}
+
 void foil_rdrbox_containing_block(const foil_rdrbox *box, foil_rect *rc)
 {
     assert(box->cblock_creator);
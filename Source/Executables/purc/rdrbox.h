@@ -694,6 +694,12 @@ void foil_rdrbox_lay_block_in_container(foil_layout_ctxt *ctxt,
         const foil_rdrbox *container, foil_rdrbox *block);
 void foil_rdrbox_lay_marker_box(foil_layout_ctxt *ctxt, foil_rdrbox *box);
 
+/* Returns true if the box is a layout boundary: the width of the box does
+   not depend on its contents, so the descendants can be laid out again
+   without changing the other boxes, as long as the height does not
+   change either. */
+bool foil_rdrbox_is_layout_boundary(const foil_rdrbox *box);
+
 void foil_rdrbox_containing_block(const foil_rdrbox *box, foil_rect *rc);
 void foil_rdrbox_containing_block_from_inlines(const foil_rdrbox *box,
         foil_rect *rc);
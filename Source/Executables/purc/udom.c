@@ -32,12 +32,106 @@
 #include "rdrbox-internal.h"
 #include "util/sorted-array.h"
 #include "util/list.h"
+#include "util/task-pool.h"
 #include "unicode/unicode.h"
 
 #include <assert.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* the maximal number of threads to select styles in parallel */
+#define FOIL_STYLE_MAX_WORKERS      8
+
+/* the maximal number of linked style sheets kept in the cache
+   when no uDOM uses them */
+#define FOIL_CSS_CACHE_MAX_IDLE     16
 
 static css_stylesheet *def_ua_sheet;
 
+/* A style sheet loaded from a file; it is parsed once and shared by
+   all uDOMs linking to the file until the file changes. */
+struct foil_css_cache_entry {
+    char               *path;
+    css_stylesheet     *sheet;
+
+    /* the status of the file when it was loaded */
+    struct timespec     mtime;
+    off_t               size;
+    ino_t               ino;
+
+    /* the number of uDOMs using the sheet */
+    unsigned int        refc;
+
+    /* the node in idle_css_sheets if refc is zero */
+    struct list_head    idle;
+
+    /* true if the entry has been removed from the cache */
+    bool                stale;
+};
+
+/* the cached style sheets keyed by the path of the file */
+static struct kvlist css_cache;
+
+/* the cached style sheets not used by any uDOM; the least recently used
+   one comes first */
+static LIST_HEAD(idle_css_sheets);
+static unsigned int nr_idle_css_sheets;
+
+/* the pool of threads selecting the styles of sibling subtrees in parallel;
+   NULL if there is only one processor online. */
+static struct task_pool *style_pool;
+
+/* the app name of Foil, for the PurC instances of the style workers */
+static char style_app_name[PURC_LEN_APP_NAME + 1];
+
+/*
+ * The style workers read a document owned by the instance of the renderer,
+ * but they touch no state of that instance:
+ *
+ *  - select_element_style() and the handlers in css-selection.c only call
+ *    the read-only accessors of the document: pcdoc_element_get_tag_name(),
+ *    _get_attribute(), _class(), _id(), _travel_attributes(),
+ *    _children_count(), _first_child(), pcdoc_node_get_parent(),
+ *    _prev_sibling(), _next_sibling(), and _get_user_data(). For an HTML
+ *    document they walk the DOM nodes and the static tag table only; they
+ *    make no variant, intern no atom, and set no error.
+ *  - pcdoc_node_set_user_data() is the only write, and it is serialized by
+ *    udom->lock.
+ *  - CSSEng allocates with malloc(); the interned strings and the property
+ *    strings are guarded by their own locks, and the selection context and
+ *    the computed style of the parent are only read.
+ *
+ * A worker still initializes a PurC instance of its own, so that its log
+ * messages, or an error set on a path not listed above, never go to the
+ * instance of the renderer. style_worker_exit() checks in debug builds that
+ * no error was set. A worker failed to get an instance exits at once, and
+ * its tasks are run by the other workers or the waiting thread.
+ */
+static int style_worker_start(unsigned int idx, void *ctxt)
+{
+    (void)ctxt;
+    char run_name[PURC_LEN_RUNNER_NAME + 1];
+
+    snprintf(run_name, sizeof(run_name), "foilStyler%u", idx);
+    if (purc_init_ex(PURC_MODULE_HTML, style_app_name, run_name, NULL)) {
+        LOG_WARN("Failed to init the PurC instance for style worker %u\n",
+                idx);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int style_worker_exit(unsigned int idx, void *ctxt)
+{
+    (void)idx;
+    (void)ctxt;
+    /* see the comment on style_worker_start() */
+    assert(purc_get_last_error() == PURC_ERROR_OK);
+    purc_cleanup();
+    return 0;
+}
+
 /* copy from https://www.w3.org/TR/2011/REC-CSS2-20110607/sample.html#q22.0 */
 static const char *def_style_sheet = ""
     "html, address,"
@@ -179,21 +273,299 @@ int foil_udom_module_init(pcmcth_renderer *rdr)
 
     css_stylesheet_data_done(def_ua_sheet);
 
+    kvlist_init(&css_cache, NULL);
+
+    long nr_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *endpoint = purc_get_endpoint(NULL);
+    if (nr_cpus > 1 && endpoint &&
+            purc_extract_app_name(endpoint, style_app_name) > 0) {
+        style_pool = task_pool_new(MIN(nr_cpus - 1, FOIL_STYLE_MAX_WORKERS),
+                style_worker_start, style_worker_exit, NULL);
+        if (style_pool == NULL) {
+            LOG_WARN("Failed to create the pool for selecting styles\n");
+        }
+    }
+
     return 0;
 }
 
+static void css_cache_entry_delete(struct foil_css_cache_entry *entry)
+{
+    css_stylesheet_destroy(entry->sheet);
+    free(entry->path);
+    free(entry);
+}
+
 void foil_udom_module_cleanup(pcmcth_renderer *rdr)
 {
+    if (style_pool) {
+        task_pool_delete(style_pool);
+        style_pool = NULL;
+    }
+
     if (def_ua_sheet)
         css_stylesheet_destroy(def_ua_sheet);
 
+    const char *name;
+    void *next, *data;
+    kvlist_for_each_safe(&css_cache, name, next, data) {
+        struct foil_css_cache_entry *entry;
+        entry = *(struct foil_css_cache_entry **)data;
+
+        kvlist_delete(&css_cache, name);
+        if (entry->refc > 0) {
+            /* destroyed when released */
+            LOG_WARN("Cached style sheet still in use: %p\n", entry);
+            entry->stale = true;
+        }
+        else {
+            css_cache_entry_delete(entry);
+        }
+    }
+    kvlist_free(&css_cache);
+    INIT_LIST_HEAD(&idle_css_sheets);
+    nr_idle_css_sheets = 0;
+
     foil_rdrbox_module_cleanup(rdr);
 }
 
+static css_error create_author_sheet(const char *url, css_stylesheet **sheet)
+{
+    css_stylesheet_params params;
+
+    memset(&params, 0, sizeof(params));
+    params.params_version = CSS_STYLESHEET_PARAMS_VERSION_1;
+    params.level = CSS_LEVEL_DEFAULT;
+    params.charset = FOIL_DEF_CHARSET;
+    params.url = url;
+    params.title = url;
+    params.resolve = resolve_url;
+
+    return css_stylesheet_create(&params, sheet);
+}
+
+/* remove an idle entry from the cache and destroy it */
+static void css_cache_evict(struct foil_css_cache_entry *entry)
+{
+    assert(entry->refc == 0 && !entry->stale);
+
+    list_del(&entry->idle);
+    nr_idle_css_sheets--;
+    kvlist_delete(&css_cache, entry->path);
+    css_cache_entry_delete(entry);
+}
+
+static struct foil_css_cache_entry *
+load_css_file(const char *path, const struct stat *st)
+{
+    struct foil_css_cache_entry *entry = NULL;
+    purc_rwstream_t rws;
+    const char *css;
+    char *loaded = NULL;
+    size_t length;
+
+    LOG_DEBUG("Try to load CSS from file: %s\n", path);
+
+    /* parse the style sheet from the mapping of the file in place */
+    rws = purc_rwstream_new_from_file_mapped(path);
+    if (rws == NULL)
+        return NULL;
+
+    css = purc_rwstream_get_mem_buffer(rws, &length);
+    if (css == NULL) {
+        /* no mmap() on this platform */
+        css = loaded = purc_load_file_contents(path, &length);
+        if (css == NULL)
+            goto failed;
+    }
+
+    entry = calloc(1, sizeof(*entry));
+    if (entry == NULL)
+        goto failed;
+
+    entry->path = strdup(path);
+    if (entry->path == NULL)
+        goto failed;
+
+    css_error err = create_author_sheet(path, &entry->sheet);
+    if (err != CSS_OK) {
+        LOG_ERROR("Failed to create author style sheet: %d\n", err);
+        goto failed;
+    }
+
+    err = css_stylesheet_append_data(entry->sheet,
+            (const unsigned char *)css, length);
+    if (err != CSS_OK && err != CSS_NEEDDATA) {
+        LOG_WARN("Failed to append css data from file: %d\n", err);
+    }
+    css_stylesheet_data_done(entry->sheet);
+    free(loaded);
+    purc_rwstream_destroy(rws);
+
+    entry->mtime = st->st_mtim;
+    entry->size = st->st_size;
+    entry->ino = st->st_ino;
+    entry->refc = 1;
+    INIT_LIST_HEAD(&entry->idle);
+    return entry;
+
+failed:
+    if (entry) {
+        if (entry->path)
+            free(entry->path);
+        free(entry);
+    }
+    free(loaded);
+    purc_rwstream_destroy(rws);
+    return NULL;
+}
+
+/* get the parsed style sheet of a CSS file from the cache, or load it;
+   the file is loaded again if it has been changed since it was cached. */
+static struct foil_css_cache_entry *css_cache_acquire(const char *path)
+{
+    struct foil_css_cache_entry *entry;
+    struct stat st;
+
+    if (stat(path, &st)) {
+        LOG_WARN("Failed to stat CSS file: %s\n", path);
+        return NULL;
+    }
+
+    void *data = kvlist_get(&css_cache, path);
+    if (data) {
+        entry = *(struct foil_css_cache_entry **)data;
+        if (entry->mtime.tv_sec == st.st_mtim.tv_sec &&
+                entry->mtime.tv_nsec == st.st_mtim.tv_nsec &&
+                entry->size == st.st_size &&
+                entry->ino == st.st_ino) {
+            if (entry->refc == 0) {
+                list_del(&entry->idle);
+                nr_idle_css_sheets--;
+            }
+            entry->refc++;
+            return entry;
+        }
+
+        /* the file changed; the uDOMs using the old sheet keep it */
+        if (entry->refc == 0) {
+            css_cache_evict(entry);
+        }
+        else {
+            kvlist_delete(&css_cache, path);
+            entry->stale = true;
+        }
+    }
+
+    entry = load_css_file(path, &st);
+    if (entry && !kvlist_set(&css_cache, path, &entry)) {
+        /* use it without caching */
+        entry->stale = true;
+    }
+
+    return entry;
+}
+
+static void css_cache_release(struct foil_css_cache_entry *entry)
+{
+    assert(entry->refc > 0);
+    if (--entry->refc > 0)
+        return;
+
+    if (entry->stale) {
+        css_cache_entry_delete(entry);
+        return;
+    }
+
+    list_add_tail(&entry->idle, &idle_css_sheets);
+    nr_idle_css_sheets++;
+    if (nr_idle_css_sheets > FOIL_CSS_CACHE_MAX_IDLE) {
+        css_cache_evict(list_first_entry(&idle_css_sheets,
+                    struct foil_css_cache_entry, idle));
+    }
+}
+
+static int append_author_sheet(pcmcth_udom *udom, css_stylesheet *sheet,
+        struct foil_css_cache_entry *cached)
+{
+    struct foil_author_sheet *sheets;
+
+    sheets = realloc(udom->author_sheets,
+            sizeof(*sheets) * (udom->nr_author_sheets + 1));
+    if (sheets == NULL)
+        return -1;
+
+    sheets[udom->nr_author_sheets].sheet = sheet;
+    sheets[udom->nr_author_sheets].cached = cached;
+    udom->author_sheets = sheets;
+    udom->nr_author_sheets++;
+    return 0;
+}
+
+/* get the sheet to append the contents of a `style` element to; a new one
+   is created if the last author sheet is a linked one to keep the order. */
+static css_stylesheet *inline_author_sheet(pcmcth_udom *udom)
+{
+    css_stylesheet *sheet;
+
+    if (udom->nr_author_sheets > 0) {
+        struct foil_author_sheet *last;
+        last = udom->author_sheets + udom->nr_author_sheets - 1;
+        if (last->cached == NULL)
+            return last->sheet;
+    }
+
+    css_error err = create_author_sheet("foo", &sheet);
+    if (err != CSS_OK) {
+        LOG_ERROR("Failed to create author style sheet: %d\n", err);
+        return NULL;
+    }
+
+    if (append_author_sheet(udom, sheet, NULL)) {
+        css_stylesheet_destroy(sheet);
+        return NULL;
+    }
+
+    return sheet;
+}
+
+static void destroy_author_sheets(pcmcth_udom *udom)
+{
+    for (size_t i = 0; i < udom->nr_author_sheets; i++) {
+        struct foil_author_sheet *author = udom->author_sheets + i;
+        if (author->cached)
+            css_cache_release(author->cached);
+        else
+            css_stylesheet_destroy(author->sheet);
+    }
+
+    free(udom->author_sheets);
+    udom->author_sheets = NULL;
+    udom->nr_author_sheets = 0;
+}
+
 extern css_select_handler foil_css_select_handler;
 
+static void destroy_precomputed_styles(pcmcth_udom *udom)
+{
+    size_t n = sorted_array_count(udom->elem2styles);
+
+    /* the styles of the elements skipped when creating the boxes */
+    for (size_t i = 0; i < n; i++) {
+        void *result;
+        sorted_array_get(udom->elem2styles, i, &result);
+        css_select_results_destroy(result);
+    }
+
+    sorted_array_destroy(udom->elem2styles);
+    udom->elem2styles = NULL;
+}
+
 static void udom_cleanup(pcmcth_udom *udom)
 {
+    if (udom->elem2styles)
+        destroy_precomputed_styles(udom);
+
     if (udom->elem2nodedata) {
         size_t n = sorted_array_count(udom->elem2nodedata);
 
@@ -210,19 +582,33 @@ static void udom_cleanup(pcmcth_udom *udom)
 
     if (udom->elem2rdrbox)
         sorted_array_destroy(udom->elem2rdrbox);
+    if (udom->box2hidden)
+        sorted_array_destroy(udom->box2hidden);
     if (udom->title_ucs)
         free(udom->title_ucs);
     if (udom->base)
         pcutils_broken_down_url_delete(udom->base);
-    if (udom->author_sheet)
-        css_stylesheet_destroy(udom->author_sheet);
     if (udom->select_ctx)
         css_select_ctx_destroy(udom->select_ctx);
+    if (udom->author_sheets)
+        destroy_author_sheets(udom);
     if (udom->root_stk_ctxt) {
         foil_stacking_context_delete(udom->root_stk_ctxt);
     }
     if (udom->initial_cblock)
         foil_rdrbox_delete_deep(udom->initial_cblock);
+
+    pthread_mutex_destroy(&udom->lock);
+}
+
+/* whether the styles of an element depend on its siblings */
+static void check_sibling_dependent(pcmcth_udom *udom, css_stylesheet *sheet)
+{
+    bool depends;
+
+    if (css_stylesheet_depends_on_siblings(sheet, &depends) == CSS_OK &&
+            depends)
+        udom->sibling_dependent = true;
 }
 
 pcmcth_udom *foil_udom_new(pcmcth_page *page)
@@ -233,6 +619,7 @@ pcmcth_udom *foil_udom_new(pcmcth_page *page)
     }
 
     udom->page = page;
+    pthread_mutex_init(&udom->lock, NULL);
 
     udom->elem2nodedata = sorted_array_create(SAFLAG_DEFAULT, 8, NULL, NULL);
     if (udom->elem2nodedata == NULL) {
@@ -244,6 +631,12 @@ pcmcth_udom *foil_udom_new(pcmcth_page *page)
         goto failed;
     }
 
+    udom->box2hidden = sorted_array_create(SAFLAG_DUPLCATE_SORTV, 8,
+            NULL, NULL);
+    if (udom->box2hidden == NULL) {
+        goto failed;
+    }
+
     udom->base = pcutils_broken_down_url_new();
     if (udom->base == NULL) {
         goto failed;
@@ -259,6 +652,7 @@ pcmcth_udom *foil_udom_new(pcmcth_page *page)
     if (err != CSS_OK) {
         goto failed;
     }
+    check_sibling_dependent(udom, def_ua_sheet);
 
     foil_widget *widget = foil_widget_from_page(page);
     int cols = foil_widget_client_width(widget);
@@ -359,14 +753,13 @@ pcmcth_udom *foil_udom_from_rdrbox(foil_rdrbox *box)
 
 static void load_css(struct pcmcth_udom *udom, const char *href)
 {
-    char *css = NULL;
-    size_t length;
+    struct foil_css_cache_entry *cached = NULL;
 
     if (href[0] == '/' && href[1] != '/' && udom->base &&
             strcasecmp(udom->base->schema, "file") == 0) {
 
         LOG_DEBUG("Try to load CSS from file (absolute path): %s\n", href);
-        css = purc_load_file_contents(href, &length);
+        cached = css_cache_acquire(href);
     }
     else if (strchr(href, ':')) {
         /* href contains an absolute URL */
@@ -378,7 +771,7 @@ static void load_css(struct pcmcth_udom *udom, const char *href)
         if (strcasecmp(broken_down.schema, "file") == 0) {
             LOG_DEBUG("Try to load CSS from file (absolute path): %s\n",
                     broken_down.path);
-            css = purc_load_file_contents(broken_down.path, &length);
+            cached = css_cache_acquire(broken_down.path);
         }
         else {
             LOG_WARN("Loading CSS from remote URL is not suppored: %s\n",
@@ -397,18 +790,12 @@ static void load_css(struct pcmcth_udom *udom, const char *href)
         strcat(path, href);
 
         LOG_DEBUG("Try to load CSS from file (relative path): %s\n", path);
-        css = purc_load_file_contents(path, &length);
+        cached = css_cache_acquire(path);
     }
 
-    if (css) {
-        css_error err;
-        err = css_stylesheet_append_data(udom->author_sheet,
-                (const unsigned char *)css, length);
-        if (err != CSS_OK && err != CSS_NEEDDATA) {
-            LOG_WARN("Failed to append css data from file: %d\n", err);
-        }
-
-        free(css);
+    if (cached && append_author_sheet(udom, cached->sheet, cached)) {
+        LOG_ERROR("Failed to append linked style sheet: %s\n", href);
+        css_cache_release(cached);
     }
 }
 
@@ -492,8 +879,12 @@ head_walker(purc_document_t doc, pcdoc_element_t element, void *ctxt)
 
                 if (pcdoc_text_content_get_text(doc, child.text_node,
                             &text, &len) == 0 && len > 0) {
+                    css_stylesheet *sheet = inline_author_sheet(udom);
+                    if (sheet == NULL)
+                        return -1;
+
                     css_error err;
-                    err = css_stylesheet_append_data(udom->author_sheet,
+                    err = css_stylesheet_append_data(sheet,
                             (const unsigned char *)text, len);
                     if (err != CSS_OK && err != CSS_NEEDDATA) {
                         LOG_ERROR("Failed to append css data: %d\n", err);
@@ -537,7 +928,7 @@ done:
 static css_select_results *
 select_element_style(const css_media *media, css_select_ctx *select_ctx,
         pcmcth_udom *udom, pcdoc_element_t element,
-        foil_rdrbox *parent_box)
+        const css_computed_style *parent_style)
 {
     // prepare inline style
     css_error err;
@@ -604,9 +995,9 @@ select_element_style(const css_media *media, css_select_ctx *select_ctx,
        This is not a smart way. One can optimize this by introducing
        reference count to the values of these complex properties. */
     css_computed_style *composed = NULL;
-    if (parent_box && parent_box->computed_style) {
+    if (parent_style) {
         err = css_computed_style_compose(
-                parent_box->computed_style,
+                parent_style,
                 result->styles[CSS_PSEUDO_ELEMENT_NONE],
                 foil_css_select_handler.compute_font_size, NULL,
                 &composed);
@@ -670,6 +1061,135 @@ failed:
     return NULL;
 }
 
+static void select_subtree_styles(struct task_pool *pool, void *arg);
+
+struct style_task {
+    struct task_batch          *batch;
+    pcmcth_udom                *udom;
+    pcdoc_element_t             elem;
+    const css_computed_style   *parent_style;
+};
+
+static int submit_style_task(struct task_pool *pool,
+        struct task_batch *batch, pcmcth_udom *udom,
+        pcdoc_element_t elem, const css_computed_style *parent_style)
+{
+    struct style_task *task = malloc(sizeof(*task));
+    if (task == NULL)
+        return -1;
+
+    task->batch = batch;
+    task->udom = udom;
+    task->elem = elem;
+    task->parent_style = parent_style;
+    if (task_pool_submit(pool, batch, select_subtree_styles, task)) {
+        free(task);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Selects the style of an element, then submits the children as new tasks:
+   the sibling subtrees are styled in parallel, and the computed style of
+   the parent is only read by the tasks of its children. */
+static void select_subtree_styles(struct task_pool *pool, void *arg)
+{
+    struct style_task *task = arg;
+    pcmcth_udom *udom = task->udom;
+    css_select_results *result;
+
+    result = select_element_style(&udom->media, udom->select_ctx, udom,
+            task->elem, task->parent_style);
+    if (result == NULL) {
+        /* make_rdrtree() will try again and report the error */
+        goto done;
+    }
+
+    pthread_mutex_lock(&udom->lock);
+    sorted_array_add(udom->elem2styles, PTR2U64(task->elem), result);
+    pthread_mutex_unlock(&udom->lock);
+
+    /* no box will be created for the descendants */
+    const css_computed_style *style = result->styles[CSS_PSEUDO_ELEMENT_NONE];
+    if (css_computed_display(style, task->parent_style == NULL) ==
+            CSS_DISPLAY_NONE)
+        goto done;
+
+    pcdoc_node node = pcdoc_element_first_child(udom->doc, task->elem);
+    while (node.type != PCDOC_NODE_VOID) {
+        if (node.type == PCDOC_NODE_ELEMENT) {
+            /* the child will be styled by make_rdrtree() on failure */
+            submit_style_task(pool, task->batch, udom, node.elem, style);
+        }
+
+        node = pcdoc_node_next_sibling(udom->doc, node);
+    }
+
+done:
+    free(task);
+}
+
+/* Computes the styles of the whole element tree with the style pool,
+   before creating the rendering tree; returns false if the styles should
+   be selected element by element in make_rdrtree(). */
+static bool
+select_styles_in_parallel(struct foil_create_ctxt *ctxt)
+{
+    pcmcth_udom *udom = ctxt->udom;
+    struct task_batch batch = { 0 };
+
+    if (style_pool == NULL)
+        return false;
+
+    udom->elem2styles = sorted_array_create(SAFLAG_DEFAULT, 64, NULL, NULL);
+    if (udom->elem2styles == NULL)
+        return false;
+
+    if (submit_style_task(style_pool, &batch, udom, ctxt->root,
+                ctxt->parent_box->computed_style)) {
+        sorted_array_destroy(udom->elem2styles);
+        udom->elem2styles = NULL;
+        return false;
+    }
+
+    /* only wait for the tasks of this document */
+    task_pool_wait(style_pool, &batch);
+    return true;
+}
+
+static css_select_results *
+take_precomputed_style(pcmcth_udom *udom, pcdoc_element_t element)
+{
+    css_select_results *result = NULL;
+
+    if (udom->elem2styles) {
+        ssize_t idx = sorted_array_find(udom->elem2styles,
+                PTR2U64(element), (void **)&result);
+        if (idx >= 0)
+            sorted_array_delete(udom->elem2styles, idx);
+    }
+
+    return result;
+}
+
+/* Records the descendants of an element whose contents generate no box,
+   so that their node data can be forgotten with the box; the styles of
+   them may have been selected in parallel. */
+static void
+hide_descendants(pcmcth_udom *udom, foil_rdrbox *box, pcdoc_element_t elem)
+{
+    pcdoc_node node = pcdoc_element_first_child(udom->doc, elem);
+    while (node.type != PCDOC_NODE_VOID) {
+        if (node.type == PCDOC_NODE_ELEMENT) {
+            sorted_array_add(udom->box2hidden, PTR2U64(box), node.elem);
+            hide_descendants(udom, box, node.elem);
+        }
+
+        node = pcdoc_node_next_sibling(udom->doc, node);
+    }
+}
+
 static int
 make_rdrtree(struct foil_create_ctxt *ctxt, pcdoc_element_t ancestor)
 {
@@ -677,9 +1197,13 @@ make_rdrtree(struct foil_create_ctxt *ctxt, pcdoc_element_t ancestor)
     foil_rdrbox *box;
     css_select_results *result = NULL;
 
-    result = select_element_style(&ctxt->udom->media,
-            ctxt->udom->select_ctx, ctxt->udom, ancestor,
-            ctxt->parent_box);
+    result = take_precomputed_style(ctxt->udom, ancestor);
+    if (result == NULL) {
+        result = select_element_style(&ctxt->udom->media,
+                ctxt->udom->select_ctx, ctxt->udom, ancestor,
+                ctxt->parent_box ? ctxt->parent_box->computed_style : NULL);
+    }
+
     if (result) {
         const char *name;
         size_t len;
@@ -699,6 +1223,8 @@ make_rdrtree(struct foil_create_ctxt *ctxt, pcdoc_element_t ancestor)
         if ((box = foil_rdrbox_create_principal(ctxt)) == NULL) {
             LOG_WARN("Non principal rdrbox created fo element %s\n",
                     ctxt->tag_name);
+            sorted_array_add(ctxt->udom->box2hidden,
+                    PTR2U64(ctxt->parent_box), ancestor);
             goto done;
         }
 
@@ -720,6 +1246,7 @@ make_rdrtree(struct foil_create_ctxt *ctxt, pcdoc_element_t ancestor)
     pcdoc_node node;
     if (box->is_replaced || box->is_control) {
         /* skip contents if the element is a replaced one or a control */
+        hide_descendants(ctxt->udom, box, ancestor);
         node.type = PCDOC_NODE_VOID;
         node.elem = NULL;
     }
@@ -1102,6 +1629,48 @@ static void dump_udom(pcmcth_udom *udom)
     dump_rdrtree(&render_ctxt, udom->initial_cblock, 0);
 }
 
+/* create the box tree for the whole document */
+static int build_rdrtree(pcmcth_udom *udom)
+{
+    foil_create_ctxt ctxt = { udom,
+        udom->initial_cblock,           /* initial box */
+        NULL,                           /* root box */
+        udom->initial_cblock,           /* parent box */
+        purc_document_root(udom->doc),  /* root element */
+        purc_document_body(udom->doc),  /* body element */
+        NULL, NULL, NULL, NULL };
+
+    /* select the styles of the sibling subtrees in parallel if we can;
+       the boxes are still created on this thread in document order. */
+    bool parallel = select_styles_in_parallel(&ctxt);
+    int ret = make_rdrtree(&ctxt, ctxt.root);
+    if (parallel)
+        destroy_precomputed_styles(udom);
+    if (ret)
+        return -1;
+
+    /* check and create anonymous block box if need */
+    LOG_DEBUG("Calling normalize_rdrtree...\n");
+    return normalize_rdrtree(&ctxt, udom->initial_cblock);
+}
+
+/* determine the geometries of boxes and lay out the boxes */
+static void layout_udom(pcmcth_udom *udom)
+{
+    foil_layout_ctxt layout_ctxt = { udom, udom->initial_cblock };
+    LOG_DEBUG("Calling pre_layout_rdrtree...\n");
+    pre_layout_rdrtree(&layout_ctxt, udom->initial_cblock);
+
+    LOG_DEBUG("Calling resolve_widths...\n");
+    resolve_widths(&layout_ctxt, udom->initial_cblock);
+
+    LOG_DEBUG("Calling resolve_heights...\n");
+    resolve_heights(&layout_ctxt, udom->initial_cblock);
+
+    LOG_DEBUG("Calling layout_rdrtree...\n");
+    layout_rdrtree(&layout_ctxt, udom->initial_cblock);
+}
+
 pcmcth_udom *
 foil_udom_load_edom(pcmcth_page *page, purc_variant_t edom, int *retv)
 {
@@ -1145,75 +1714,31 @@ foil_udom_load_edom(pcmcth_page *page, purc_variant_t edom, int *retv)
     pcdoc_element_t head;
     head = purc_document_head(edom_doc);
     if (head) {
-        css_error err;
-
-        css_stylesheet_params params;
-        memset(&params, 0, sizeof(params));
-        params.params_version = CSS_STYLESHEET_PARAMS_VERSION_1;
-        params.level = CSS_LEVEL_DEFAULT;
-        params.charset = FOIL_DEF_CHARSET;
-        params.url = "foo";
-        params.title = "foo";
-        params.resolve = resolve_url;
-
-        err = css_stylesheet_create(&params, &udom->author_sheet);
-        if (err != CSS_OK) {
-            *retv = PCRDR_SC_INSUFFICIENT_STORAGE;
-            LOG_ERROR("Failed to create default user agent sheet: %d\n", err);
-            goto failed;
-        }
-
         size_t n;
         pcdoc_travel_descendant_elements(edom_doc, head, head_walker,
                 udom, &n);
 
-        size_t sz;
-        css_stylesheet_size(udom->author_sheet, &sz);
-        if (sz == 0) {
-            css_stylesheet_destroy(udom->author_sheet);
-            udom->author_sheet = NULL;
-        }
-        else {
-            css_stylesheet_data_done(udom->author_sheet);
-            err = css_select_ctx_append_sheet(udom->select_ctx,
-                    udom->author_sheet, CSS_ORIGIN_AUTHOR, NULL);
+        /* the linked sheets are shared and have been done */
+        for (size_t i = 0; i < udom->nr_author_sheets; i++) {
+            struct foil_author_sheet *author = udom->author_sheets + i;
+            if (author->cached == NULL)
+                css_stylesheet_data_done(author->sheet);
+
+            css_error err = css_select_ctx_append_sheet(udom->select_ctx,
+                    author->sheet, CSS_ORIGIN_AUTHOR, NULL);
             if (err != CSS_OK) {
                 *retv = PCRDR_SC_INSUFFICIENT_STORAGE;
                 LOG_ERROR("Failed to append author style sheet: %d\n", err);
                 goto failed;
             }
+            check_sibling_dependent(udom, author->sheet);
         }
     }
 
-    /* create the box tree */
-    foil_create_ctxt ctxt = { udom,
-        udom->initial_cblock,           /* initial box */
-        NULL,                           /* root box */
-        udom->initial_cblock,           /* parent box */
-        purc_document_root(edom_doc),   /* root element */
-        purc_document_body(edom_doc),   /* body element */
-        NULL, NULL, NULL, NULL };
-    if (make_rdrtree(&ctxt, ctxt.root))
-        goto failed;
-
-    /* check and create anonymous block box if need */
-    LOG_DEBUG("Calling normalize_rdrtree...\n");
-    if (normalize_rdrtree(&ctxt, udom->initial_cblock))
+    if (build_rdrtree(udom))
         goto failed;
 
-    /* determine the geometries of boxes and lay out the boxes */
-    foil_layout_ctxt layout_ctxt = { udom, udom->initial_cblock };
-    LOG_DEBUG("Calling pre_layout_rdrtree...\n");
-    pre_layout_rdrtree(&layout_ctxt, udom->initial_cblock);
-
-    LOG_DEBUG("Calling resolve_widths...\n");
-    resolve_widths(&layout_ctxt, udom->initial_cblock);
-
-    LOG_DEBUG("Calling resolve_heights...\n");
-    resolve_heights(&layout_ctxt, udom->initial_cblock);
-
-    LOG_DEBUG("Calling layout_rdrtree...\n");
-    layout_rdrtree(&layout_ctxt, udom->initial_cblock);
+    layout_udom(udom);
 
 #ifndef NDEBUG
     dump_udom(udom);
@@ -1253,6 +1778,339 @@ foil_rdrbox *foil_udom_find_rdrbox(pcmcth_udom *udom,
     return data;
 }
 
+/* release the node data of an element kept by CSSEng; the element
+   may have been removed from the document if `alive` is false. */
+static void
+forget_node_data(pcmcth_udom *udom, pcdoc_element_t elem, bool alive)
+{
+    void *node_data;
+
+    if (sorted_array_find(udom->elem2nodedata, PTR2U64(elem), &node_data) < 0)
+        return;
+
+    sorted_array_remove(udom->elem2nodedata, PTR2U64(elem));
+    if (alive) {
+        pcdoc_node node = { PCDOC_NODE_ELEMENT, { elem } };
+        pcdoc_node_set_user_data(udom->doc, node, NULL);
+    }
+
+    css_node_data_handler(&foil_css_select_handler, CSS_NODE_DELETED,
+            udom, elem, NULL, node_data);
+}
+
+static void
+forget_node_data_deep(pcmcth_udom *udom, pcdoc_element_t elem)
+{
+    forget_node_data(udom, elem, true);
+
+    pcdoc_node node = pcdoc_element_first_child(udom->doc, elem);
+    while (node.type != PCDOC_NODE_VOID) {
+        if (node.type == PCDOC_NODE_ELEMENT)
+            forget_node_data_deep(udom, node.elem);
+
+        node = pcdoc_node_next_sibling(udom->doc, node);
+    }
+}
+
+/* Forgets the elements which generated the boxes in the subtree, and the
+   ones styled without a box under them. The elements removed from the
+   document are only reachable from the old boxes, so their node data are
+   released here without walking the document. */
+static void forget_rdrboxes(pcmcth_udom *udom, foil_rdrbox *box)
+{
+    if (box->is_principal) {
+        sorted_array_remove(udom->elem2rdrbox, PTR2U64(box->owner));
+        forget_node_data(udom, box->owner, false);
+    }
+
+    void *elem;
+    ssize_t idx;
+    while ((idx = sorted_array_find(udom->box2hidden, PTR2U64(box),
+                    &elem)) >= 0) {
+        sorted_array_delete(udom->box2hidden, idx);
+        forget_node_data(udom, elem, false);
+    }
+
+    foil_rdrbox *child = box->first;
+    while (child) {
+        forget_rdrboxes(udom, child);
+        child = child->next;
+    }
+}
+
+/* whether the boxes in the subtree do not take part in the counters,
+   the list numbering, or the stacking contexts shared with other boxes */
+static bool is_rdrbox_self_contained(const foil_rdrbox *box)
+{
+    if (box->stacking_ctxt || box->counter_reset || box->counter_incrm ||
+            box->counters_table || box->type == FOIL_RDRBOX_TYPE_LIST_ITEM ||
+            box->type == FOIL_RDRBOX_TYPE_MARKER)
+        return false;
+
+    const foil_rdrbox *child = box->first;
+    while (child) {
+        if (!is_rdrbox_self_contained(child))
+            return false;
+        child = child->next;
+    }
+
+    return true;
+}
+
+/* Creates the boxes of an element again in place. Returns the layout
+   boundary containing the boxes, or NULL if the whole rendering tree
+   needs to be created again. */
+static foil_rdrbox *
+recreate_element_boxes(pcmcth_udom *udom, foil_rdrbox *box)
+{
+    pcdoc_element_t elem = box->owner;
+    foil_rdrbox *parent = box->parent;
+
+    if (box->is_root || parent->is_anonymous || !parent->is_principal)
+        return NULL;
+
+    /* the boxes of the pseudo elements may be the siblings of
+       the principal box */
+    foil_rdrbox *anchor = NULL, *child, *next;
+    bool found = false;
+    for (child = parent->first; child; child = child->next) {
+        if (child == box || child->principal == box) {
+            if (!is_rdrbox_self_contained(child))
+                return NULL;
+            found = true;
+        }
+        else if (!found) {
+            anchor = child;
+        }
+    }
+
+    bool was_inline = box->is_inline_level;
+    for (child = parent->first; child; child = next) {
+        next = child->next;
+        if (child == box || child->principal == box)
+            foil_rdrbox_delete_deep(child);
+    }
+
+    foil_rdrbox *last = parent->last;
+    foil_create_ctxt ctxt = { udom,
+        udom->initial_cblock,           /* initial box */
+        udom->initial_cblock->first,    /* root box */
+        parent,                         /* parent box */
+        purc_document_root(udom->doc),  /* root element */
+        purc_document_body(udom->doc),  /* body element */
+        NULL, NULL, NULL, NULL };
+
+    if (make_rdrtree(&ctxt, elem))
+        return NULL;
+
+    /* move the new boxes (appended to the parent) to the old place;
+       the level must not change or the parent needs anonymous boxes. */
+    foil_rdrbox *after = anchor;
+    for (child = last ? last->next : parent->first; child; child = next) {
+        next = child->next;
+        if (child->is_inline_level != was_inline ||
+                !is_rdrbox_self_contained(child))
+            return NULL;
+
+        foil_rdrbox_remove_from_tree(child);
+        if (after)
+            foil_rdrbox_insert_after(after, child);
+        else
+            foil_rdrbox_prepend_child(parent, child);
+        after = child;
+    }
+
+    box = foil_udom_find_rdrbox(udom, PTR2U64(elem));
+    if (box && box->first) {
+        if (box->is_inline_box) {
+            /* block-level boxes in an inline box split the parent */
+            for (child = box->first; child; child = child->next) {
+                if (child->is_block_level)
+                    return NULL;
+            }
+        }
+
+        if (normalize_rdrtree(&ctxt, box))
+            return NULL;
+    }
+
+    while (!foil_rdrbox_is_layout_boundary(parent))
+        parent = parent->parent;
+    return parent;
+}
+
+/* create the rendering tree again from scratch */
+static int rebuild_rdrtree(pcmcth_udom *udom)
+{
+    foil_rdrbox *initial = udom->initial_cblock;
+
+    /* the stacking contexts refer to their creators */
+    if (udom->root_stk_ctxt) {
+        foil_stacking_context_delete(udom->root_stk_ctxt);
+        udom->root_stk_ctxt = NULL;
+    }
+
+    while (initial->first)
+        foil_rdrbox_delete_deep(initial->first);
+    sorted_array_cleanup(udom->elem2rdrbox);
+    sorted_array_cleanup(udom->box2hidden);
+
+    initial->nr_child_list_items = 0;
+    if (initial->counters_table) {
+        g_hash_table_destroy(initial->counters_table);
+        initial->counters_table = NULL;
+    }
+
+    return build_rdrtree(udom);
+}
+
+static void reset_layout_deep(foil_rdrbox *box)
+{
+    foil_rdrbox_reset_layout(box);
+
+    foil_rdrbox *child = box->first;
+    while (child) {
+        reset_layout_deep(child);
+        child = child->next;
+    }
+}
+
+/* Lays out the descendants of a layout boundary again. Returns false if
+   the size of the boundary changed, e.g., the height of a boundary with
+   `height: auto`, and the boundary containing it should be laid out. */
+static bool
+relayout_boundary(pcmcth_udom *udom, foil_rdrbox *boundary)
+{
+    foil_layout_ctxt ctxt = { udom, udom->initial_cblock };
+    foil_rect rc = boundary->ctnt_rect;
+    int width = boundary->width, height = boundary->height;
+    unsigned in_flow = boundary->is_in_flow;
+    unsigned in_normal_flow = boundary->is_in_normal_flow;
+
+    foil_rdrbox *child;
+    for (child = boundary->first; child; child = child->next)
+        reset_layout_deep(child);
+
+    /* keep the flags determined when the parent was laid out */
+    foil_rdrbox_reset_layout(boundary);
+    boundary->is_in_flow = in_flow;
+    boundary->is_in_normal_flow = in_normal_flow;
+
+    for (child = boundary->first; child; child = child->next)
+        pre_layout_rdrtree(&ctxt, child);
+    resolve_widths(&ctxt, boundary);
+    resolve_heights(&ctxt, boundary);
+
+    if (boundary->width != width || boundary->height != height)
+        return false;
+
+    /* the position of the boundary does not change */
+    boundary->ctnt_rect = rc;
+    layout_rdrtree(&ctxt, boundary);
+    return true;
+}
+
+static void relayout_udom(pcmcth_udom *udom)
+{
+    foil_rdrbox *initial = udom->initial_cblock;
+
+    for (foil_rdrbox *child = initial->first; child; child = child->next)
+        reset_layout_deep(child);
+
+    /* the width of the initial containing block is always resolved */
+    foil_rdrbox_reset_layout(initial);
+    initial->is_width_resolved = 1;
+    initial->width = udom->vw;
+    initial->height = udom->vh;
+    foil_rect_set(&initial->ctnt_rect, 0, 0, udom->vw, udom->vh);
+
+    layout_udom(udom);
+}
+
+static bool repaint_udom(pcmcth_udom *udom)
+{
+    pcmcth_page *page = udom->page;
+    foil_rdrbox *initial = udom->initial_cblock;
+
+    int cols = initial->width / FOIL_PX_GRID_CELL_W;
+    int rows = initial->height / FOIL_PX_GRID_CELL_H;
+    if (cols != page->cols || rows != page->rows) {
+        /* foil_page_content_init() resets the uDOM of the page */
+        pcmcth_udom *page_udom = page->udom;
+        if (!foil_page_content_init(page, cols, rows,
+                    initial->color, initial->background_color)) {
+            LOG_ERROR("Failed to initialize page content\n");
+            return false;
+        }
+        page->udom = page_udom;
+    }
+    else {
+        foil_page_set_fgc(page, initial->color);
+        foil_page_set_bgc(page, initial->background_color);
+        foil_page_erase_rect(page, NULL);
+    }
+
+    foil_udom_render_to_page(udom);
+    foil_page_expose(page);
+    return true;
+}
+
+/* Restyles an element and its descendants after the element or its
+   contents changed, lays out the boxes in the nearest layout boundary
+   again, and repaints the boundary only. If the style sheets have selectors
+   matching the siblings, the subtree of the parent is restyled instead,
+   so that the following siblings get their styles selected again. */
+static int restyle_element(pcmcth_udom *udom, foil_rdrbox *box)
+{
+    assert(box->is_principal);
+
+    if (udom->sibling_dependent && !box->is_root) {
+        pcdoc_node node = { PCDOC_NODE_ELEMENT, { box->owner } };
+        pcdoc_element_t parent = pcdoc_node_get_parent(udom->doc, node);
+        foil_rdrbox *parent_box = parent ?
+            foil_udom_find_rdrbox(udom, PTR2U64(parent)) : NULL;
+        if (parent_box == NULL) {
+            /* the parent generates no principal box */
+            parent = purc_document_root(udom->doc);
+            parent_box = foil_udom_find_rdrbox(udom, PTR2U64(parent));
+        }
+
+        if (parent_box)
+            box = parent_box;
+    }
+
+    forget_node_data_deep(udom, box->owner);
+    forget_rdrboxes(udom, box);
+
+    foil_rdrbox *boundary = recreate_element_boxes(udom, box);
+    if (boundary == NULL) {
+        LOG_DEBUG("Creating the whole rendering tree again\n");
+        if (rebuild_rdrtree(udom))
+            return PCRDR_SC_INSUFFICIENT_STORAGE;
+        boundary = udom->initial_cblock;
+    }
+
+    /* the boxes following a boundary whose size changed move, so the
+       boundary containing it is laid out again, up to the initial one */
+    while (boundary != udom->initial_cblock &&
+            !relayout_boundary(udom, boundary)) {
+        boundary = boundary->parent;
+        while (!foil_rdrbox_is_layout_boundary(boundary))
+            boundary = boundary->parent;
+    }
+
+    if (boundary != udom->initial_cblock) {
+        foil_udom_invalidate_rdrbox(udom, boundary);
+        return PCRDR_SC_OK;
+    }
+
+    relayout_udom(udom);
+    if (!repaint_udom(udom))
+        return PCRDR_SC_INSUFFICIENT_STORAGE;
+
+    return PCRDR_SC_OK;
+}
+
 int foil_udom_update_rdrbox(pcmcth_udom *udom, foil_rdrbox *rdrbox,
         int op, const char *property, purc_variant_t ref_info)
 {
@@ -1265,20 +2123,21 @@ int foil_udom_update_rdrbox(pcmcth_udom *udom, foil_rdrbox *rdrbox,
 
     if (strncasecmp(property, "attr.", 5) == 0) {
         const char *attr = property + 5;
-        if (strcasecmp(attr, "style") == 0) {
-            // TODO: the style changed.
-        }
-        else if (rdrbox->tailor_ops && rdrbox->tailor_ops->on_attr_changed) {
+        if (strcasecmp(attr, "style") != 0 &&
+                rdrbox->tailor_ops && rdrbox->tailor_ops->on_attr_changed) {
             foil_update_ctxt ctxt = { udom, element };
             rdrbox->tailor_ops->on_attr_changed(&ctxt, rdrbox);
             r = PCRDR_SC_OK;
         }
+        else {
+            /* the style attribute, or an attribute which may be matched by
+               the selectors, e.g., `class` and `id`. */
+            r = restyle_element(udom, rdrbox);
+        }
     }
-    else if (strcasecmp(property, "textContent") == 0) {
-        // TODO:
-    }
-    else if (strcasecmp(property, "contents") == 0) {
-        // TODO:
+    else if (strcasecmp(property, "textContent") == 0 ||
+            strcasecmp(property, "contents") == 0) {
+        r = restyle_element(udom, rdrbox);
     }
     else {
         LOG_WARN("Unknown property: %s\n", property);
@@ -32,10 +32,22 @@
 #include "util/list.h"
 
 #include <purc/purc-document.h>
+#include <pthread.h>
 #include <glib.h>
 
 #define FOIL_DEF_RGNRCHEAP_SZ   16
 
+struct foil_css_cache_entry;
+
+/* an author-defined style sheet of a uDOM */
+struct foil_author_sheet {
+    css_stylesheet *sheet;
+
+    /* the cache entry if the sheet is a linked one shared with other uDOMs;
+       NULL if the sheet is made of the contents of `style` elements. */
+    struct foil_css_cache_entry *cached;
+};
+
 struct pcmcth_udom {
     /* the page in which the uDOM located */
     pcmcth_page *page;
@@ -46,17 +58,35 @@ struct pcmcth_udom {
     /* the sorted array of eDOM element and the corresponding rendering box. */
     struct sorted_array *elem2rdrbox;
 
+    /* the sorted array of rendering box and the elements styled without
+       a box under it, e.g., the ones with `display: none`; a box may have
+       more than one such element. */
+    struct sorted_array *box2hidden;
+
+    /* the sorted array of eDOM element and the selection results computed
+       in parallel before creating the rendering tree; NULL if not used. */
+    struct sorted_array *elem2styles;
+
+    /* the lock for elem2nodedata and elem2styles, which are changed by
+       the threads selecting styles in parallel. */
+    pthread_mutex_t lock;
+
     /* purc_document */
     purc_document_t doc;
 
     struct purc_broken_down_url *base;
 
-    /* author-defined style sheet */
-    css_stylesheet *author_sheet;
+    /* author-defined style sheets in document order */
+    struct foil_author_sheet *author_sheets;
+    size_t nr_author_sheets;
 
     /* CSS selection context */
     css_select_ctx *select_ctx;
 
+    /* whether the style sheets have selectors matching the siblings of
+       elements, e.g., `a + b`, `a ~ b`, and `:nth-child()` */
+    bool sibling_dependent;
+
     /* the initial containing block,
        it's also the root node of the rendering tree. */
     struct foil_rdrbox *initial_cblock;
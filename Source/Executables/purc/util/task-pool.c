@@ -0,0 +1,359 @@
+/*
+ * task-pool - a simple work-stealing task pool.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "task-pool.h"
+
+struct task {
+    task_pool_fn        fn;
+    void               *arg;
+    struct task_batch  *batch;
+};
+
+/* A deque of tasks: the owner pushes and pops at the bottom (LIFO, which
+   keeps the subtree it is working on hot in cache), the thieves take
+   the oldest tasks from the top. */
+struct task_deque {
+    pthread_mutex_t lock;
+
+    /* the ring buffer of tasks; sz_ring is a power of two */
+    struct task    *ring;
+    size_t          sz_ring;
+
+    /* indices of the top and the bottom; top <= bottom */
+    size_t          top;
+    size_t          bottom;
+} __attribute__((aligned(64)));
+
+struct task_pool {
+    /* the deques: one per worker, and the last one for the waiting thread */
+    struct task_deque  *deques;
+    unsigned int        nr_deques;
+
+    pthread_t          *workers;
+    unsigned int        nr_workers;
+
+    /* the number of queued tasks, and of the tasks not done yet */
+    size_t              nr_queued;
+    size_t              nr_pending;
+
+    task_pool_worker_fn on_start;
+    task_pool_worker_fn on_exit;
+    void               *ctxt;
+
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    unsigned int        nr_sleeping;
+    bool                quit;
+};
+
+struct worker_arg {
+    struct task_pool   *pool;
+    unsigned int        idx;
+};
+
+#define SZ_RING_INIT        64
+
+/* the deque of the calling thread for the pool it is working for */
+static __thread struct task_pool *my_pool;
+static __thread unsigned int my_idx;
+
+static int deque_init(struct task_deque *dq)
+{
+    dq->ring = malloc(sizeof(struct task) * SZ_RING_INIT);
+    if (dq->ring == NULL)
+        return -1;
+
+    dq->sz_ring = SZ_RING_INIT;
+    dq->top = dq->bottom = 0;
+    pthread_mutex_init(&dq->lock, NULL);
+    return 0;
+}
+
+static void deque_cleanup(struct task_deque *dq)
+{
+    pthread_mutex_destroy(&dq->lock);
+    free(dq->ring);
+}
+
+static int deque_push(struct task_deque *dq, const struct task *new_task)
+{
+    pthread_mutex_lock(&dq->lock);
+
+    if (dq->bottom - dq->top == dq->sz_ring) {
+        size_t sz = dq->sz_ring * 2;
+        struct task *ring = malloc(sizeof(struct task) * sz);
+        if (ring == NULL) {
+            pthread_mutex_unlock(&dq->lock);
+            return -1;
+        }
+
+        for (size_t i = dq->top; i < dq->bottom; i++)
+            ring[i & (sz - 1)] = dq->ring[i & (dq->sz_ring - 1)];
+        free(dq->ring);
+        dq->ring = ring;
+        dq->sz_ring = sz;
+    }
+
+    dq->ring[dq->bottom & (dq->sz_ring - 1)] = *new_task;
+    /* top and bottom are peeked at by thieves without the lock */
+    __atomic_store_n(&dq->bottom, dq->bottom + 1, __ATOMIC_RELAXED);
+
+    pthread_mutex_unlock(&dq->lock);
+    return 0;
+}
+
+static bool deque_take(struct task_deque *dq, bool steal, struct task *task)
+{
+    bool found = false;
+
+    /* avoid locking empty deques when looking for a victim */
+    if (steal && __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED) ==
+            __atomic_load_n(&dq->top, __ATOMIC_RELAXED))
+        return false;
+
+    pthread_mutex_lock(&dq->lock);
+    if (dq->top < dq->bottom) {
+        if (steal) {
+            *task = dq->ring[dq->top & (dq->sz_ring - 1)];
+            __atomic_store_n(&dq->top, dq->top + 1, __ATOMIC_RELAXED);
+        }
+        else {
+            __atomic_store_n(&dq->bottom, dq->bottom - 1, __ATOMIC_RELAXED);
+            *task = dq->ring[dq->bottom & (dq->sz_ring - 1)];
+        }
+        found = true;
+    }
+    pthread_mutex_unlock(&dq->lock);
+
+    return found;
+}
+
+static bool take_task(struct task_pool *pool, unsigned int idx,
+        struct task *task)
+{
+    if (deque_take(pool->deques + idx, false, task))
+        goto found;
+
+    for (unsigned int i = 1; i < pool->nr_deques; i++) {
+        unsigned int victim = (idx + i) % pool->nr_deques;
+        if (deque_take(pool->deques + victim, true, task))
+            goto found;
+    }
+
+    return false;
+
+found:
+    __atomic_sub_fetch(&pool->nr_queued, 1, __ATOMIC_ACQ_REL);
+    return true;
+}
+
+static void run_task(struct task_pool *pool, struct task *task)
+{
+    task->fn(pool, task->arg);
+
+    __atomic_sub_fetch(&pool->nr_pending, 1, __ATOMIC_ACQ_REL);
+    if (__atomic_sub_fetch(&task->batch->nr_pending, 1,
+                __ATOMIC_ACQ_REL) == 0) {
+        /* wake up the threads waiting for the batch */
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_broadcast(&pool->cond);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static void *worker_entry(void *arg)
+{
+    struct worker_arg *wa = arg;
+    struct task_pool *pool = wa->pool;
+    unsigned int idx = wa->idx;
+    struct task task;
+
+    free(wa);
+    if (pool->on_start && pool->on_start(idx, pool->ctxt))
+        return NULL;
+
+    my_pool = pool;
+    my_idx = idx;
+
+    while (true) {
+        if (take_task(pool, idx, &task)) {
+            run_task(pool, &task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->quit &&
+                __atomic_load_n(&pool->nr_queued, __ATOMIC_ACQUIRE) == 0) {
+            pool->nr_sleeping++;
+            pthread_cond_wait(&pool->cond, &pool->lock);
+            pool->nr_sleeping--;
+        }
+        bool quit = pool->quit;
+        pthread_mutex_unlock(&pool->lock);
+
+        if (quit)
+            break;
+    }
+
+    if (pool->on_exit)
+        pool->on_exit(idx, pool->ctxt);
+    return NULL;
+}
+
+struct task_pool *task_pool_new(unsigned int nr_workers,
+        task_pool_worker_fn on_start, task_pool_worker_fn on_exit, void *ctxt)
+{
+    struct task_pool *pool = calloc(1, sizeof(*pool));
+    if (pool == NULL)
+        return NULL;
+
+    pool->on_start = on_start;
+    pool->on_exit = on_exit;
+    pool->ctxt = ctxt;
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+
+    pool->nr_deques = nr_workers + 1;
+    if (posix_memalign((void **)&pool->deques, 64,
+                sizeof(struct task_deque) * pool->nr_deques)) {
+        pool->deques = NULL;
+        goto failed;
+    }
+
+    for (unsigned int i = 0; i < pool->nr_deques; i++) {
+        if (deque_init(pool->deques + i)) {
+            pool->nr_deques = i;
+            goto failed;
+        }
+    }
+
+    pool->workers = calloc(nr_workers, sizeof(pthread_t));
+    if (nr_workers > 0 && pool->workers == NULL)
+        goto failed;
+
+    for (unsigned int i = 0; i < nr_workers; i++) {
+        struct worker_arg *wa = malloc(sizeof(*wa));
+        if (wa == NULL)
+            goto failed;
+
+        wa->pool = pool;
+        wa->idx = i;
+        if (pthread_create(pool->workers + i, NULL, worker_entry, wa)) {
+            free(wa);
+            goto failed;
+        }
+        pool->nr_workers++;
+    }
+
+    return pool;
+
+failed:
+    task_pool_delete(pool);
+    return NULL;
+}
+
+void task_pool_delete(struct task_pool *pool)
+{
+    assert(pool->nr_pending == 0);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (unsigned int i = 0; i < pool->nr_workers; i++)
+        pthread_join(pool->workers[i], NULL);
+
+    if (pool->deques) {
+        for (unsigned int i = 0; i < pool->nr_deques; i++)
+            deque_cleanup(pool->deques + i);
+        free(pool->deques);
+    }
+
+    free(pool->workers);
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+unsigned int task_pool_nr_workers(struct task_pool *pool)
+{
+    return pool->nr_workers;
+}
+
+int task_pool_submit(struct task_pool *pool, struct task_batch *batch,
+        task_pool_fn fn, void *arg)
+{
+    /* the threads out of the pool use the last deque */
+    unsigned int idx = (my_pool == pool) ? my_idx : pool->nr_deques - 1;
+    struct task task = { fn, arg, batch };
+
+    __atomic_add_fetch(&pool->nr_pending, 1, __ATOMIC_ACQ_REL);
+    __atomic_add_fetch(&batch->nr_pending, 1, __ATOMIC_ACQ_REL);
+    if (deque_push(pool->deques + idx, &task)) {
+        __atomic_sub_fetch(&batch->nr_pending, 1, __ATOMIC_ACQ_REL);
+        __atomic_sub_fetch(&pool->nr_pending, 1, __ATOMIC_ACQ_REL);
+        return -1;
+    }
+
+    __atomic_add_fetch(&pool->nr_queued, 1, __ATOMIC_ACQ_REL);
+
+    /* wake up a sleeping worker if there is one */
+    pthread_mutex_lock(&pool->lock);
+    if (pool->nr_sleeping > 0)
+        pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    return 0;
+}
+
+void task_pool_wait(struct task_pool *pool, struct task_batch *batch)
+{
+    unsigned int idx = pool->nr_deques - 1;
+    struct task task;
+
+    my_pool = pool;
+    my_idx = idx;
+
+    while (__atomic_load_n(&batch->nr_pending, __ATOMIC_ACQUIRE) > 0) {
+        if (take_task(pool, idx, &task)) {
+            run_task(pool, &task);
+            continue;
+        }
+
+        /* the left tasks are running in the workers */
+        pthread_mutex_lock(&pool->lock);
+        while (__atomic_load_n(&batch->nr_pending, __ATOMIC_ACQUIRE) > 0 &&
+                __atomic_load_n(&pool->nr_queued, __ATOMIC_ACQUIRE) == 0) {
+            pool->nr_sleeping++;
+            pthread_cond_wait(&pool->cond, &pool->lock);
+            pool->nr_sleeping--;
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    my_pool = NULL;
+}
+
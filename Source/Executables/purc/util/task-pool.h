@@ -0,0 +1,71 @@
+/*
+ * task-pool - a simple work-stealing task pool.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#ifndef _purc_util_task_pool_h
+#define _purc_util_task_pool_h
+
+#include <stddef.h>
+
+struct task_pool;
+
+/* A batch of tasks: the tasks submitted for one piece of work, including
+   the tasks submitted by these tasks. Initialize it to zeros. */
+struct task_batch {
+    size_t          nr_pending;
+};
+
+/* the function to run a task; the task may submit new tasks to the pool. */
+typedef void (*task_pool_fn)(struct task_pool *pool, void *arg);
+
+/* the function called in every worker thread when it starts and exits;
+   a worker returning non-zero from the start function exits at once. */
+typedef int  (*task_pool_worker_fn)(unsigned int idx, void *ctxt);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* create a task pool with nr_workers worker threads; NULL on failure.
+   on_start and on_exit (nullable) are called in every worker thread. */
+struct task_pool *task_pool_new(unsigned int nr_workers,
+        task_pool_worker_fn on_start, task_pool_worker_fn on_exit, void *ctxt);
+
+/* stop the worker threads and destroy the task pool;
+   the pool must have no pending tasks. */
+void task_pool_delete(struct task_pool *pool);
+
+/* retrieve the number of the worker threads */
+unsigned int task_pool_nr_workers(struct task_pool *pool);
+
+/* submit a task of a batch; a task submitted by a worker goes to the deque
+   of the worker, and idle workers steal tasks from the others.
+   Returns 0 on success, -1 on memory exhaustion. */
+int task_pool_submit(struct task_pool *pool, struct task_batch *batch,
+        task_pool_fn fn, void *arg);
+
+/* run the pending tasks with the worker threads in the calling thread,
+   and return when all tasks of the batch (including the tasks submitted
+   by the tasks) are done. The tasks of other batches may be run meanwhile,
+   but they are not waited for. */
+void task_pool_wait(struct task_pool *pool, struct task_batch *batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _purc_util_task_pool_h */
+
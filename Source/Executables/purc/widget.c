@@ -32,6 +32,8 @@
 
 #include "purc/purc-utils.h"
 #include <assert.h>
+#include <errno.h>
+#include <unistd.h>
 
 foil_widget *foil_widget_new(foil_widget_type_k type,
         foil_widget_border_k border,
@@ -375,7 +377,158 @@ make_escape_string_line_mode(const struct pcmcth_page *page,
     return mystr.buff;
 }
 
-static void print_dirty_page_area_line_mode(foil_widget *widget)
+/* the number of unchanged cells which are skipped by moving the cursor
+   instead of writing them again */
+#define MIN_CELLS_TO_SKIP       4
+
+struct flush_ctxt {
+    foil_widget *widget;
+    int term_mode;
+
+    /* the screen position of the viewport origin in full screen mode */
+    int ox, oy;
+
+    /* the current colors of the terminal; -1 if unknown */
+    int fgc, bgc;
+    /* the page position of the cursor; -1 if unknown */
+    int x, y;
+
+    struct pcutils_mystring out;
+};
+
+static inline bool
+is_same_cell(const struct foil_tty_cell *a, const struct foil_tty_cell *b)
+{
+    return a->uc == b->uc && a->fgc == b->fgc && a->bgc == b->bgc &&
+        a->attrs == b->attrs && a->latter_half == b->latter_half;
+}
+
+static void move_cursor(struct flush_ctxt *ctxt, int x, int y)
+{
+    foil_widget *widget = ctxt->widget;
+    char buf[64];
+
+    if (ctxt->y == y && ctxt->x >= 0 && x >= ctxt->x) {
+        if (x == ctxt->x)
+            return;
+        snprintf(buf, sizeof(buf), "\x1b[%dC", x - ctxt->x);
+    }
+    else if (ctxt->term_mode == FOIL_TERM_MODE_LINE) {
+        int rel_col = x - widget->vx;
+        int rel_row = widget->vh - y + widget->vy;
+
+        /* restore curosr and move cursor rel_row up lines,
+           move curosr rel_col right lines */
+        snprintf(buf, sizeof(buf), "\0338\x1b[%dA\x1b[%dC",
+                rel_row, rel_col + 1);
+    }
+    else {
+        snprintf(buf, sizeof(buf), "\x1b[%d;%dH",
+                ctxt->oy + y - widget->vy + 1, ctxt->ox + x - widget->vx + 1);
+    }
+
+    pcutils_mystring_append_mchar(&ctxt->out, (unsigned char *)buf, 0);
+    ctxt->x = x;
+    ctxt->y = y;
+}
+
+static void
+write_cells(struct flush_ctxt *ctxt, const struct foil_tty_cell *cell, int n)
+{
+    const pcmcth_page *page = &ctxt->widget->page;
+    char buf[64];
+
+    for (int i = 0; i < n; i++, cell++) {
+        /* the former half of a wide character occupies two columns */
+        if (cell->latter_half)
+            continue;
+
+        if (ctxt->bgc != cell->bgc) {
+            pcutils_mystring_append_mchar(&ctxt->out,
+                    escape_bgc(buf, page, cell->bgc), 0);
+            ctxt->bgc = cell->bgc;
+        }
+
+        if (ctxt->fgc != cell->fgc) {
+            pcutils_mystring_append_mchar(&ctxt->out,
+                    escape_fgc(buf, page, cell->fgc), 0);
+            ctxt->fgc = cell->fgc;
+        }
+
+        pcutils_mystring_append_uchar(&ctxt->out, cell->uc, 1);
+    }
+
+    ctxt->x += n;
+}
+
+/* Writes the runs of changed cells in the row, and
+   merges the runs separated by a few unchanged cells. */
+static void flush_row(struct flush_ctxt *ctxt, int y, int left, int right)
+{
+    pcmcth_page *page = &ctxt->widget->page;
+    struct foil_tty_cell *line = page->cells[y];
+    struct foil_tty_cell *flushed = page->flushed[y];
+
+    int x = left;
+    while (x < right) {
+        if (is_same_cell(line + x, flushed + x)) {
+            x++;
+            continue;
+        }
+
+        int start = x, end = x + 1, nr_same = 0;
+        for (x = end; x < right; x++) {
+            if (!is_same_cell(line + x, flushed + x)) {
+                end = x + 1;
+                nr_same = 0;
+            }
+            else if (++nr_same >= MIN_CELLS_TO_SKIP) {
+                break;
+            }
+        }
+
+        /* do not split a wide character */
+        if (start > 0 && line[start].latter_half)
+            start--;
+        if (end < page->cols && line[end].latter_half)
+            end++;
+
+        move_cursor(ctxt, start, y);
+        write_cells(ctxt, line + start, end - start);
+        memcpy(flushed + start, line + start,
+                sizeof(struct foil_tty_cell) * (end - start));
+        x = end;
+    }
+}
+
+static void write_to_terminal(const char *buf, size_t len)
+{
+    /* the contents buffered by stdio go first */
+    fflush(stdout);
+
+    while (len > 0) {
+        ssize_t n = write(STDOUT_FILENO, buf, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+
+            LOG_ERROR("Failed to write to terminal: %s\n", strerror(errno));
+            break;
+        }
+
+        buf += n;
+        len -= n;
+    }
+}
+
+static int get_term_mode(foil_widget *widget)
+{
+    foil_widget *root = foil_widget_get_root(widget);
+    pcmcth_workspace *workspace = (pcmcth_workspace *)root->user_data;
+    return workspace->rdr->impl->term_mode;
+}
+
+static void print_dirty_page_area(foil_widget *widget)
 {
     pcmcth_page *page = &widget->page;
 
@@ -399,38 +552,35 @@ static void print_dirty_page_area_line_mode(foil_widget *widget)
         return;
     }
 
-    char buf[64];
-    int w = foil_rect_width(&dirty);
-    for (int y = dirty.top; y < dirty.bottom; y++) {
-        int x = dirty.left;
+    struct flush_ctxt ctxt = { widget, get_term_mode(widget),
+        0, 0, -1, -1, -1, -1, { NULL, 0, 0 } };
 
-        int rel_col = x - widget->vx;
-        int rel_row = widget->vh - y + widget->vy;
-        if (rel_row > widget->vh)
-            continue;
+    if (ctxt.term_mode == FOIL_TERM_MODE_FULL_SCREEN) {
+        /* the screen position of the client area */
+        ctxt.ox = widget->client_rc.left;
+        ctxt.oy = widget->client_rc.top;
+        for (foil_widget *w = widget; w; w = w->parent) {
+            ctxt.ox += w->rect.left;
+            ctxt.oy += w->rect.top;
+        }
+    }
 
-        struct foil_tty_cell *cell = page->cells[y] + x;
-        char *escaped_str = make_escape_string_line_mode(page, cell, w);
+    for (int y = dirty.top; y < dirty.bottom; y++) {
+        flush_row(&ctxt, y, dirty.left, dirty.right);
+    }
 
-        LOG_DEBUG("move curosr %d rows up and %d colunms right\n",
-                rel_row, rel_col);
+    if (ctxt.out.nr_bytes == 0) {
+        return;
+    }
 
-        /* restore curosr and move cursor rel_row up lines,
-           move curosr rel_col right lines */
-        snprintf(buf, sizeof(buf), "\0338\x1b[%dA\x1b[%dC", rel_row, rel_col + 1);
-        fputs(buf, stdout);
-        fputs(escaped_str, stdout);
-        free(escaped_str);
-    }
-
-#if 0
-    snprintf(buf, sizeof(buf), "\x1b[%d;%dH\x1b[39m\x1b[49m",
-            widget->vy + page->rows + 1, 0);
-    fputs(buf, stdout);
-#else
-    /* restore cursor position (bottom-left corner of the page). */
-    fputs("\0338", stdout);
-#endif
+    if (ctxt.term_mode == FOIL_TERM_MODE_LINE) {
+        /* restore cursor position (bottom-left corner of the page). */
+        pcutils_mystring_append_mchar(&ctxt.out,
+                (const unsigned char *)"\0338", 0);
+    }
+
+    write_to_terminal(ctxt.out.buff, ctxt.out.nr_bytes);
+    pcutils_mystring_free(&ctxt.out);
 }
 
 static void adjust_viewport_line_mode(foil_widget *widget)
@@ -469,6 +619,22 @@ static void adjust_viewport_line_mode(foil_widget *widget)
     }
 }
 
+static void adjust_viewport_full_screen(foil_widget *widget)
+{
+    int rows = MIN(widget->page.rows, foil_widget_client_height(widget));
+
+    if (widget->vh != rows) {
+        widget->vh = rows;
+        if (widget->vy + rows > widget->page.rows)
+            widget->vy = widget->page.rows - rows;
+
+        /* the cells out of the old viewport are not on the screen */
+        foil_page_invalidate_flushed(&widget->page);
+        foil_rect_set(&widget->page.dirty_rect, 0, 0,
+                widget->page.cols, widget->page.rows);
+    }
+}
+
 #define TIMER_FLUSHER_NAME          "flusher"
 #define TIMER_FLUSHER_INTERVAL      20  // 50 fps
 
@@ -476,8 +642,7 @@ static int flush_contents(const char *name, void *ctxt)
 {
     (void)name;
     foil_widget *widget = ctxt;
-    print_dirty_page_area_line_mode(widget);
-    fflush(stdout);
+    print_dirty_page_area(widget);
 
     foil_rect_empty(&widget->page.dirty_rect);
     return -1;
@@ -485,21 +650,19 @@ static int flush_contents(const char *name, void *ctxt)
 
 void foil_widget_expose(foil_widget *widget)
 {
-    foil_widget *root = foil_widget_get_root(widget);
-    pcmcth_workspace *workspace = (pcmcth_workspace *)root->user_data;
-    if (workspace->rdr->impl->term_mode == FOIL_TERM_MODE_LINE) {
+    if (get_term_mode(widget) == FOIL_TERM_MODE_LINE) {
         adjust_viewport_line_mode(widget);
-
-        pcmcth_renderer *rdr = foil_get_renderer();
-
-        if (foil_timer_find(rdr,
-                    TIMER_FLUSHER_NAME, flush_contents, widget) == NULL) {
-            foil_timer_new(rdr, TIMER_FLUSHER_NAME, flush_contents,
-                    TIMER_FLUSHER_INTERVAL, widget);
-        }
     }
     else {
-        // TODO
+        adjust_viewport_full_screen(widget);
+    }
+
+    pcmcth_renderer *rdr = foil_get_renderer();
+
+    if (foil_timer_find(rdr,
+                TIMER_FLUSHER_NAME, flush_contents, widget) == NULL) {
+        foil_timer_new(rdr, TIMER_FLUSHER_NAME, flush_contents,
+                TIMER_FLUSHER_INTERVAL, widget);
     }
 }
 
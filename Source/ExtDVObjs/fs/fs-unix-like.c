@@ -27,6 +27,7 @@
 #include "private/instance.h"
 #include "private/errors.h"
 #include "private/dvobjs.h"
+#include "private/rwstream.h"
 #include "purc-variant.h"
 
 #if HAVE(SYS_SYSMACROS_H)
@@ -3111,6 +3112,31 @@ file_contents_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         goto failed;
     }
 
+    if (length >= PCRWSTREAM_MAP_THRESHOLD) {
+        // Map a large file and make the variant straight from the mapping
+        purc_rwstream_t rws;
+        rws = purc_rwstream_new_from_file_mapped (string_filename);
+        if (rws) {
+            size_t sz_mapped = 0;
+            const char *mapped = purc_rwstream_get_mem_buffer (rws,
+                    &sz_mapped);
+            if (mapped && (size_t)offset + length <= sz_mapped) {
+                if (flag_binary)
+                    ret_var = purc_variant_make_byte_sequence (
+                            mapped + offset, length);
+                else
+                    ret_var = purc_variant_make_string_ex (
+                            mapped + offset, length, true);
+                purc_rwstream_destroy (rws);
+                if (ret_var)
+                    return ret_var;
+                goto failed;
+            }
+            purc_rwstream_destroy (rws);
+        }
+        // fall back to reading the file via stdio
+    }
+
     bsequence = malloc (length + 1);
     bsequence[length] = 0x0;
 
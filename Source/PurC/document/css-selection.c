@@ -168,7 +168,7 @@ failed:
 
     if (my_classes && nr_classes > 0) {
         for (uint32_t i = 0; i < nr_classes; i++) {
-            lwc_string_destroy(my_classes[i]);
+            lwc_string_unref(my_classes[i]);
         }
 
         free(my_classes);
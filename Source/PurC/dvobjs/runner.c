@@ -152,6 +152,39 @@ rid_getter(purc_variant_t root,
     return purc_variant_make_ulongint(inst->endpoint_atom);
 }
 
+static purc_variant_t
+fetch_cache_getter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+    UNUSED_PARAM(call_flags);
+
+    struct pcintr_fetch_cache_stats stats;
+    pcintr_fetch_cache_get_stats(&stats);
+
+    purc_variant_t vals[] = {
+        purc_variant_make_ulongint(stats.nr_entries),
+        purc_variant_make_ulongint(stats.nr_hits),
+        purc_variant_make_ulongint(stats.nr_misses),
+        purc_variant_make_ulongint(stats.nr_revalidations),
+        purc_variant_make_ulongint(stats.nr_evictions),
+    };
+
+    purc_variant_t retv = purc_variant_make_object_by_static_ckey(
+            PCA_TABLESIZE(vals),
+            "entries", vals[0], "hits", vals[1], "misses", vals[2],
+            "revalidations", vals[3], "evictions", vals[4]);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(vals); i++) {
+        if (vals[i])
+            purc_variant_unref(vals[i]);
+    }
+
+    return retv;
+}
+
 static purc_variant_t
 uri_getter(purc_variant_t root,
         size_t nr_args, purc_variant_t *argv, unsigned call_flags)
@@ -188,6 +221,12 @@ chan_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         return pcchan_make_entity(chan);
     }
 
+    /* not a local channel; try the channels shared by runners */
+    pcchan_shared_t shchan = pcchan_shared_retrieve(chan_name);
+    if (shchan) {
+        return pcchan_shared_make_entity(shchan);
+    }
+
 failed:
     if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
         return purc_variant_make_undefined();
@@ -221,7 +260,48 @@ chan_setter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         }
     }
 
-    PC_DEBUG("chan_setter(%s, %u)\n", chan_name, cap);
+    bool shared = false;
+    if (nr_args > 2) {
+        const char *scope = purc_variant_get_string_const(argv[2]);
+        if (scope == NULL) {
+            pcinst_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+            goto failed;
+        }
+
+        if (strcmp(scope, PCCHAN_SCOPE_SHARED) == 0) {
+            shared = true;
+        }
+        else if (strcmp(scope, PCCHAN_SCOPE_LOCAL)) {
+            pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+            goto failed;
+        }
+    }
+
+    PC_DEBUG("chan_setter(%s, %u, %s)\n", chan_name, cap,
+            shared ? PCCHAN_SCOPE_SHARED : PCCHAN_SCOPE_LOCAL);
+
+    if (shared) {
+        pcchan_shared_t shchan;
+        if (cap == 0) {
+            shchan = pcchan_shared_retrieve(chan_name);
+            if (shchan == NULL) {
+                // error set by pcchan_shared_retrieve()
+                goto failed;
+            }
+            pcchan_shared_close(shchan);
+        }
+        else {
+            // the capacity given by the first opener wins
+            shchan = pcchan_shared_open(chan_name, cap);
+            if (shchan == NULL) {
+                // error set by pcchan_shared_open()
+                goto failed;
+            }
+        }
+
+        pcchan_shared_unref(shchan);
+        return purc_variant_make_boolean(true);
+    }
 
     pcchan_t chan = pcchan_retrieve(chan_name);
     if (chan) {
@@ -259,6 +339,7 @@ purc_dvobj_runner_new(void)
         { "rid",    rid_getter,     NULL },
         { "uri",    uri_getter,     NULL },
         { "chan",   chan_getter,    chan_setter },
+        { "fetch_cache", fetch_cache_getter, NULL },
 #if ENABLE(CHINESE_NAMES)
         { "用户",   user_getter,    user_setter },
         { "应用名", app_getter,     NULL },
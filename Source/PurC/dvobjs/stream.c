@@ -43,8 +43,13 @@
 #include <sys/stat.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
 
 #define BUFFER_SIZE                 1024
+#define RBUF_FILL_SIZE              4096
+#define MAX_RECORD_SIZE             (1024 * 1024 * 16)
 
 #define ENDIAN_PLATFORM             0
 #define ENDIAN_LITTLE               1
@@ -57,6 +62,7 @@
 #define STREAM_EVENT_NAME           "event"
 #define STREAM_SUB_EVENT_READ       "readable"
 #define STREAM_SUB_EVENT_WRITE      "writable"
+#define STREAM_SUB_EVENT_HANGUP     "hangup"
 #define STREAM_SUB_EVENT_ALL        "*"
 
 #define FILE_DEFAULT_MODE           0644
@@ -103,6 +109,14 @@ enum {
     K_KW_ws,
 #define _KW_wss                     "wss"
     K_KW_wss,
+#define _KW_inet                    "inet"
+    K_KW_inet,
+#define _KW_lines                   "lines"
+    K_KW_lines,
+#define _KW_length_prefixed         "length-prefixed"
+    K_KW_length_prefixed,
+#define _KW_json_records            "json-records"
+    K_KW_json_records,
 #define _KW_readstruct              "readstruct"
     K_KW_readstruct,
 #define _KW_writestruct             "writestruct"
@@ -146,6 +160,10 @@ static struct keyword_to_atom {
     { _KW_winsock, 0 },             // "winsock"
     { _KW_ws, 0 },                  // "ws"
     { _KW_wss, 0 },                 // "wss"
+    { _KW_inet, 0 },                // "inet"
+    { _KW_lines, 0 },               // "lines"
+    { _KW_length_prefixed, 0 },     // "length-prefixed"
+    { _KW_json_records, 0 },        // "json-records"
     { _KW_readstruct, 0},           // readstruct
     { _KW_writestruct, 0},          // writestruct
     { _KW_readlines, 0},            // readlines
@@ -169,6 +187,33 @@ enum pcdvobjs_stream_type {
     STREAM_TYPE_WIN_SOCK,
     STREAM_TYPE_WS,
     STREAM_TYPE_WSS,
+    STREAM_TYPE_INET_SOCK,
+};
+
+/* how the bytes read from a stream are split into records */
+enum pcdvobjs_stream_framing {
+    STREAM_FRAMING_NONE,
+    STREAM_FRAMING_LINES,       /* lines ended by LF */
+    STREAM_FRAMING_LENGTH,      /* 32-bit big-endian length + payload */
+    STREAM_FRAMING_JSON,        /* a sequence of JSON objects or arrays */
+};
+
+/*
+ * The bytes read from the underlying stream but not consumed yet.
+ * The pending bytes are kept contiguous (the buffer is compacted before
+ * growing) so that a framed record can be parsed in place.
+ */
+struct stream_rbuf {
+    char   *data;
+    size_t  size;
+    size_t  head;       /* offset of the first pending byte */
+    size_t  tail;       /* offset after the last pending byte */
+
+    /* the scanning state of the current record (relative to head) */
+    size_t  scanned;
+    int     depth;
+    bool    in_string;
+    bool    escaped;
 };
 
 struct pcdvobjs_stream {
@@ -183,6 +228,9 @@ struct pcdvobjs_stream {
 
     pid_t cpid;                 /* only for pipe, the pid of child */
     purc_atom_t cid;
+
+    enum pcdvobjs_stream_framing framing;
+    struct stream_rbuf rbuf;
 };
 
 static
@@ -247,6 +295,9 @@ static void native_stream_close(struct pcdvobjs_stream *stream)
     stream->fd4r = -1;
     stream->fd4w = -1;
 
+    free(stream->rbuf.data);
+    memset(&stream->rbuf, 0, sizeof(stream->rbuf));
+
     if (stream->type == STREAM_TYPE_PIPE && stream->cpid > 0) {
         int status;
         if (waitpid(stream->cpid, &status, WNOHANG) == 0) {
@@ -290,6 +341,251 @@ struct pcdvobjs_stream *get_stream(void *native_entity)
     return (struct pcdvobjs_stream*)native_entity;
 }
 
+static inline size_t rbuf_pending(const struct stream_rbuf *rbuf)
+{
+    return rbuf->tail - rbuf->head;
+}
+
+static void rbuf_consume(struct stream_rbuf *rbuf, size_t len)
+{
+    rbuf->head += len;
+    if (rbuf->head == rbuf->tail) {
+        rbuf->head = rbuf->tail = 0;
+    }
+
+    rbuf->scanned = 0;
+    rbuf->depth = 0;
+    rbuf->in_string = false;
+    rbuf->escaped = false;
+}
+
+static size_t rbuf_take(struct stream_rbuf *rbuf, void *buf, size_t count)
+{
+    size_t len = rbuf_pending(rbuf);
+    if (len > count)
+        len = count;
+
+    if (len > 0) {
+        memcpy(buf, rbuf->data + rbuf->head, len);
+        rbuf_consume(rbuf, len);
+    }
+    return len;
+}
+
+/* make sure there is room for at least `room` bytes after the tail */
+static bool rbuf_reserve(struct stream_rbuf *rbuf, size_t room)
+{
+    if (rbuf->size - rbuf->tail >= room)
+        return true;
+
+    size_t pending = rbuf_pending(rbuf);
+    if (rbuf->head > 0) {
+        memmove(rbuf->data, rbuf->data + rbuf->head, pending);
+        rbuf->head = 0;
+        rbuf->tail = pending;
+        if (rbuf->size - rbuf->tail >= room)
+            return true;
+    }
+
+    size_t size = rbuf->size ? rbuf->size : RBUF_FILL_SIZE;
+    while (size - pending < room)
+        size *= 2;
+
+    if (size > MAX_RECORD_SIZE + RBUF_FILL_SIZE) {
+        purc_set_error(PURC_ERROR_TOO_LARGE_ENTITY);
+        return false;
+    }
+
+    char *data = realloc(rbuf->data, size);
+    if (data == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+
+    rbuf->data = data;
+    rbuf->size = size;
+    return true;
+}
+
+/* read once from the underlying stream into the read buffer;
+   returns the bytes read, 0 on EOF, or -1 on error (e.g. EAGAIN). */
+static ssize_t rbuf_fill(struct pcdvobjs_stream *stream)
+{
+    struct stream_rbuf *rbuf = &stream->rbuf;
+    if (!rbuf_reserve(rbuf, RBUF_FILL_SIZE))
+        return -1;
+
+    ssize_t n = purc_rwstream_read(stream->stm4r, rbuf->data + rbuf->tail,
+            rbuf->size - rbuf->tail);
+    if (n > 0)
+        rbuf->tail += n;
+    return n;
+}
+
+/* read from the buffered bytes first, then from the underlying stream */
+static ssize_t buffered_read(void *ctxt, void *buf, size_t count)
+{
+    struct pcdvobjs_stream *stream = ctxt;
+    size_t got = rbuf_take(&stream->rbuf, buf, count);
+
+    if (got < count) {
+        ssize_t n = purc_rwstream_read(stream->stm4r, (char *)buf + got,
+                count - got);
+        if (n > 0)
+            got += n;
+        else if (got == 0)
+            return n;
+    }
+
+    return got;
+}
+
+/*
+ * The record framed by lines. A line ends with LF; a CR right before the LF
+ * is stripped as well, so that the lines sent with CRLF (as by most network
+ * protocols) read the same as the ones sent with LF. Other CRs are kept.
+ */
+static purc_variant_t next_line_record(struct stream_rbuf *rbuf, bool eof)
+{
+    const char *start = rbuf->data + rbuf->head;
+    size_t pending = rbuf_pending(rbuf);
+    const char *lf = NULL;
+    if (pending > rbuf->scanned)
+        lf = memchr(start + rbuf->scanned, '\n', pending - rbuf->scanned);
+
+    size_t len, consumed;
+    if (lf) {
+        len = lf - start;
+        consumed = len + 1;
+    }
+    else if (eof && pending > 0) {
+        len = consumed = pending;
+    }
+    else {
+        rbuf->scanned = pending;
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (len > 0 && start[len - 1] == '\r')
+        len--;
+
+    purc_variant_t rec = purc_variant_make_string_ex(start, len, false);
+    rbuf_consume(rbuf, consumed);
+    return rec;
+}
+
+static purc_variant_t next_length_record(struct stream_rbuf *rbuf)
+{
+    const unsigned char *start =
+        (const unsigned char *)rbuf->data + rbuf->head;
+    size_t pending = rbuf_pending(rbuf);
+
+    if (pending < 4)
+        return PURC_VARIANT_INVALID;
+
+    size_t len = ((size_t)start[0] << 24) | ((size_t)start[1] << 16) |
+        ((size_t)start[2] << 8) | (size_t)start[3];
+    if (len > MAX_RECORD_SIZE) {
+        purc_set_error(PURC_ERROR_TOO_LARGE_ENTITY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (pending < len + 4)
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t rec = purc_variant_make_byte_sequence(start + 4, len);
+    rbuf_consume(rbuf, len + 4);
+    return rec;
+}
+
+static inline bool is_record_separator(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',';
+}
+
+/* scan from where the last scanning stopped for the end of a JSON record */
+static purc_variant_t next_json_record(struct stream_rbuf *rbuf)
+{
+    size_t pending;
+
+    while ((pending = rbuf_pending(rbuf)) > 0) {
+        const char *start = rbuf->data + rbuf->head;
+
+        if (rbuf->depth == 0) {
+            /* skip the separators between records */
+            size_t i = 0;
+            while (i < pending && is_record_separator(start[i]))
+                i++;
+            if (i > 0) {
+                rbuf_consume(rbuf, i);
+                continue;
+            }
+
+            if (start[0] != '{' && start[0] != '[') {
+                purc_set_error(PURC_ERROR_INVALID_VALUE);
+                return PURC_VARIANT_INVALID;
+            }
+        }
+
+        size_t i;
+        for (i = rbuf->scanned; i < pending; i++) {
+            char c = start[i];
+            if (rbuf->in_string) {
+                if (rbuf->escaped)
+                    rbuf->escaped = false;
+                else if (c == '\\')
+                    rbuf->escaped = true;
+                else if (c == '"')
+                    rbuf->in_string = false;
+            }
+            else if (c == '"') {
+                rbuf->in_string = true;
+            }
+            else if (c == '{' || c == '[') {
+                rbuf->depth++;
+            }
+            else if (c == '}' || c == ']') {
+                if (--rbuf->depth == 0)
+                    break;
+            }
+        }
+
+        if (i == pending) {
+            rbuf->scanned = pending;
+            return PURC_VARIANT_INVALID;
+        }
+
+        purc_variant_t rec = purc_variant_make_from_json_string(start, i + 1);
+        rbuf_consume(rbuf, i + 1);
+        if (rec == PURC_VARIANT_INVALID &&
+                purc_get_last_error() != PURC_ERROR_OUT_OF_MEMORY) {
+            /* balanced but not valid JSON: the eJSON parser reports
+               a PCEJSON_* error; it is a framing error as well */
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+        }
+        return rec;
+    }
+
+    return PURC_VARIANT_INVALID;
+}
+
+/* returns the next whole record in the read buffer if there is one */
+static purc_variant_t next_record(struct pcdvobjs_stream *stream, bool eof)
+{
+    switch (stream->framing) {
+    case STREAM_FRAMING_LINES:
+        return next_line_record(&stream->rbuf, eof);
+    case STREAM_FRAMING_LENGTH:
+        return next_length_record(&stream->rbuf);
+    case STREAM_FRAMING_JSON:
+        return next_json_record(&stream->rbuf);
+    default:
+        break;
+    }
+
+    return PURC_VARIANT_INVALID;
+}
+
 static purc_variant_t
 readstruct_getter(void *native_entity, size_t nr_args, purc_variant_t *argv,
                 unsigned call_flags)
@@ -334,8 +630,21 @@ readstruct_getter(void *native_entity, size_t nr_args, purc_variant_t *argv,
         goto out;
     }
 
-    return purc_dvobj_read_struct(rwstream, formats, formats_left,
-            (call_flags & PCVRT_CALL_FLAG_SILENTLY));
+    if (rbuf_pending(&stream->rbuf) == 0) {
+        return purc_dvobj_read_struct(rwstream, formats, formats_left,
+                (call_flags & PCVRT_CALL_FLAG_SILENTLY));
+    }
+
+    /* consume the buffered bytes first */
+    purc_rwstream_t buffered = purc_rwstream_new_for_read(stream,
+            buffered_read);
+    if (buffered == NULL)
+        goto out;
+
+    purc_variant_t retv = purc_dvobj_read_struct(buffered, formats,
+            formats_left, (call_flags & PCVRT_CALL_FLAG_SILENTLY));
+    purc_rwstream_destroy(buffered);
+    return retv;
 
 out:
     if (call_flags & PCVRT_CALL_FLAG_SILENTLY) {
@@ -422,49 +731,40 @@ out:
     return PURC_VARIANT_INVALID;
 }
 
-#define LINE_FLAG           "\n"
-static int read_lines(purc_rwstream_t stream, int line_num,
+/* read lines ended by LF or CRLF (see next_line_record());
+   the partial line is kept in the read buffer for next read */
+static int read_lines(struct pcdvobjs_stream *stream, int line_num,
         purc_variant_t array)
 {
-    unsigned char buffer[BUFFER_SIZE];
-    ssize_t read_size = 0;
-    size_t length = 0;
-    const char *head = NULL;
-    const char *end = NULL;
-
-    while (line_num) {
-        read_size = purc_rwstream_read(stream, buffer, BUFFER_SIZE);
-        if (read_size < 0)
-            break;
-
-        end = (const char*)(buffer + read_size);
-
-        head = pcutils_get_next_token_len((const char*)buffer, read_size,
-                LINE_FLAG, &length);
-        while (head && head < end) {
-            purc_variant_t var = purc_variant_make_string_ex(head, length,
-                    false);
-            if (!var) {
-                return -1;
-            }
-            if (!purc_variant_array_append(array, var)) {
-                purc_variant_unref(var);
+    bool eof = false;
+
+    while (line_num > 0) {
+        purc_variant_t line = next_line_record(&stream->rbuf, eof);
+        if (line) {
+            bool ok = purc_variant_array_append(array, line);
+            purc_variant_unref(line);
+            if (!ok)
                 return -1;
-            }
-            purc_variant_unref(var);
-            line_num --;
-
-            if (line_num == 0)
-                break;
 
-            head = pcutils_get_next_token_len(head + length, end - head - length,
-                LINE_FLAG, &length);
+            line_num--;
+            continue;
         }
-        if (read_size < BUFFER_SIZE)           // to the end
+
+        if (eof)
             break;
 
-        if (line_num == 0)
+        ssize_t n = rbuf_fill(stream);
+        if (n < 0)
             break;
+        else if (n == 0)
+            eof = true;
+    }
+
+    /* give the bytes not consumed back to a seekable file */
+    size_t pending = rbuf_pending(&stream->rbuf);
+    if (stream->type == STREAM_TYPE_FILE && pending > 0 &&
+            purc_rwstream_seek(stream->stm4r, -(off_t)pending, SEEK_CUR) >= 0) {
+        rbuf_consume(&stream->rbuf, pending);
     }
 
     return 0;
@@ -507,7 +807,7 @@ readlines_getter(void *native_entity, size_t nr_args, purc_variant_t *argv,
     }
 
     if (line_num > 0) {
-        int ret = read_lines(rwstream, line_num, ret_var);
+        int ret = read_lines(stream, line_num, ret_var);
         if (ret != 0) {
             goto out;
         }
@@ -652,14 +952,13 @@ readbytes_getter(void *native_entity, size_t nr_args, purc_variant_t *argv,
     }
     else {
         char * content = malloc(byte_num);
-        size_t size = 0;
 
         if (content == NULL) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
             goto out;
         }
 
-        size = purc_rwstream_read(rwstream, content, byte_num);
+        ssize_t size = buffered_read(stream, content, byte_num);
         if (size > 0) {
             ret_var = purc_variant_make_byte_sequence_reuse_buff(content,
                     size, size);
@@ -907,6 +1206,14 @@ seek_getter(void *native_entity, size_t nr_args, purc_variant_t *argv,
         whence = SEEK_END;
     }
 
+    /* the buffered bytes were not consumed yet */
+    size_t pending = rbuf_pending(&stream->rbuf);
+    if (pending > 0) {
+        if (whence == SEEK_CUR)
+            byte_num -= (int64_t)pending;
+        rbuf_consume(&stream->rbuf, pending);
+    }
+
     off = purc_rwstream_seek(rwstream, byte_num, (int)whence);
     if (off == -1) {
         goto out;
@@ -947,11 +1254,65 @@ struct io_callback_data {
     struct pcdvobjs_stream       *stream;
 };
 
+static void post_stream_event(struct pcdvobjs_stream *stream, const char *sub,
+        purc_variant_t data)
+{
+    pcintr_coroutine_post_event(stream->cid,
+            data ? PCRDR_MSG_EVENT_REDUCE_OPT_KEEP :
+                PCRDR_MSG_EVENT_REDUCE_OPT_IGNORE,
+            stream->observed, STREAM_EVENT_NAME, sub,
+            data, PURC_VARIANT_INVALID);
+}
+
+/* read once and deliver the whole records to the observer */
+static void on_framed_stream_readable(struct pcdvobjs_stream *stream)
+{
+    purc_clr_error();
+
+    ssize_t n = rbuf_fill(stream);
+    bool eof = (n == 0);
+    bool broken = (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK &&
+            errno != EINTR);
+
+    purc_variant_t rec;
+    while ((rec = next_record(stream, eof))) {
+        post_stream_event(stream, STREAM_SUB_EVENT_READ, rec);
+        purc_variant_unref(rec);
+    }
+
+    /* a malformed or too large record also breaks the stream, so does
+       running out of memory when making a record */
+    int err = purc_get_last_error();
+    if (err == PURC_ERROR_TOO_LARGE_ENTITY ||
+            err == PURC_ERROR_INVALID_VALUE ||
+            err == PURC_ERROR_OUT_OF_MEMORY) {
+        purc_clr_error();
+        broken = true;
+    }
+
+    if (eof || broken) {
+        if (stream->monitor4r) {
+            purc_runloop_remove_fd_monitor(purc_runloop_get_current(),
+                    stream->monitor4r);
+            stream->monitor4r = 0;
+        }
+        post_stream_event(stream, STREAM_SUB_EVENT_HANGUP,
+                PURC_VARIANT_INVALID);
+    }
+}
+
 static void on_stream_io_callback(struct io_callback_data *data)
 {
     purc_runloop_io_event event = data->io_event;
     struct pcdvobjs_stream *stream = data->stream;
 
+    if (stream->framing != STREAM_FRAMING_NONE &&
+            (event & PCRUNLOOP_IO_IN) && stream->cid) {
+        on_framed_stream_readable(stream);
+        free(data);
+        return;
+    }
+
     const char* sub = NULL;
     if (event & PCRUNLOOP_IO_IN) {
         sub = STREAM_SUB_EVENT_READ;
@@ -1010,6 +1371,10 @@ on_observe(void *native_entity, const char *event_name,
 
     struct pcdvobjs_stream *stream = (struct pcdvobjs_stream*)native_entity;
     if (event & PCRUNLOOP_IO_IN && stream->fd4r >= 0) {
+        /* `readable` and `hangup` of a framed stream share the monitor */
+        if (stream->monitor4r)
+            return true;
+
         stream->monitor4r = purc_runloop_add_fd_monitor(
                 purc_runloop_get_current(), stream->fd4r, PCRUNLOOP_IO_IN,
                 stream_io_callback, stream);
@@ -1194,7 +1559,8 @@ bool file_exists_and_is_executable(const char* file)
 #define WRITE_FLAG      0x02
 
 static
-int parse_open_option(purc_variant_t option)
+int parse_open_option(purc_variant_t option,
+        enum pcdvobjs_stream_framing *framing)
 {
     purc_atom_t atom = 0;
     size_t parts_len;
@@ -1260,6 +1626,17 @@ int parse_open_option(purc_variant_t option)
             else if (atom == keywords2atoms[K_KW_truncate].atom) {
                 flags |= O_TRUNC;
             }
+            else if (framing && atom == keywords2atoms[K_KW_lines].atom) {
+                *framing = STREAM_FRAMING_LINES;
+            }
+            else if (framing &&
+                    atom == keywords2atoms[K_KW_length_prefixed].atom) {
+                *framing = STREAM_FRAMING_LENGTH;
+            }
+            else if (framing &&
+                    atom == keywords2atoms[K_KW_json_records].atom) {
+                *framing = STREAM_FRAMING_JSON;
+            }
 
             if (parts_len <= length)
                 break;
@@ -1292,7 +1669,7 @@ static
 struct pcdvobjs_stream *create_file_stream(struct purc_broken_down_url *url,
         purc_variant_t option)
 {
-    int flags = parse_open_option(option);
+    int flags = parse_open_option(option, NULL);
     if (flags == -1) {
         return NULL;
     }
@@ -1349,7 +1726,7 @@ struct pcdvobjs_stream *create_pipe_stream(struct purc_broken_down_url *url,
     unsigned nr_args = 0;
     char **argv = NULL;
 
-    int flags = parse_open_option(option);
+    int flags = parse_open_option(option, NULL);
     if (flags == -1) {
         purc_set_error(PURC_ERROR_INVALID_VALUE);
         return NULL;
@@ -1517,7 +1894,7 @@ struct pcdvobjs_stream *create_fifo_stream(struct purc_broken_down_url *url,
     UNUSED_PARAM(url);
     UNUSED_PARAM(option);
 
-    int flags = parse_open_option(option);
+    int flags = parse_open_option(option, NULL);
     if (flags == -1) {
         return NULL;
     }
@@ -1568,55 +1945,134 @@ out_close_fd:
     return NULL;
 }
 
+/* make a stream from a connected socket; the socket is closed on failure */
+static
+struct pcdvobjs_stream *create_sock_stream(enum pcdvobjs_stream_type type,
+        struct purc_broken_down_url *url, purc_variant_t option, int fd)
+{
+    enum pcdvobjs_stream_framing framing = STREAM_FRAMING_NONE;
+    int flags = parse_open_option(option, &framing);
+    if (flags == -1) {
+        goto out_close_fd;
+    }
+
+    if ((flags & O_NONBLOCK) &&
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) == -1) {
+        purc_set_error(purc_error_from_errno(errno));
+        goto out_close_fd;
+    }
+
+    struct pcdvobjs_stream* stream = dvobjs_stream_create(type, url, option);
+    if (!stream) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto out_close_fd;
+    }
+
+    stream->framing = framing;
+    stream->stm4r = purc_rwstream_new_from_unix_fd(fd);
+    if (stream->stm4r == NULL) {
+        goto out_free_stream;
+    }
+    stream->stm4w = stream->stm4r;
+    stream->fd4r = fd;
+    stream->fd4w = fd;
+
+    return stream;
+
+out_free_stream:
+    stream->url = NULL;     /* owned by the caller on failure */
+    native_stream_destroy(stream);
+
+out_close_fd:
+    close(fd);
+    return NULL;
+}
+
 static
 struct pcdvobjs_stream *create_unix_sock_stream(struct purc_broken_down_url *url,
         purc_variant_t option)
 {
-    UNUSED_PARAM(option);
-
     if (!file_exists(url->path)) {
         purc_set_error(PURC_ERROR_INVALID_VALUE);
         return NULL;
     }
+
+    struct sockaddr_un unix_addr;
+    if (strlen(url->path) >= sizeof(unix_addr.sun_path)) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
     int fd = 0;
     if ((fd = socket (AF_UNIX, SOCK_STREAM, 0)) < 0) {
         purc_set_error(PCRDR_ERROR_IO);
         return NULL;
     }
 
-    struct sockaddr_un unix_addr;
     memset (&unix_addr, 0, sizeof(unix_addr));
     unix_addr.sun_family = AF_UNIX;
     strcpy(unix_addr.sun_path, url->path);
     int len = sizeof (unix_addr.sun_family) + strlen (unix_addr.sun_path);
     if (connect(fd, (struct sockaddr *) &unix_addr, len) < 0) {
-        goto out_close_fd;
+        purc_set_error(purc_error_from_errno(errno));
+        close(fd);
+        return NULL;
     }
 
-    struct pcdvobjs_stream* stream = dvobjs_stream_create(STREAM_TYPE_UNIX_SOCK,
-            url, option);
-    if (!stream) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto out_close_fd;
+    return create_sock_stream(STREAM_TYPE_UNIX_SOCK, url, option, fd);
+}
+
+/* inet://<host>:<port>; connects to the first address which accepts */
+static
+struct pcdvobjs_stream *create_inet_sock_stream(struct purc_broken_down_url *url,
+        purc_variant_t option)
+{
+    if (url->host == NULL || url->host[0] == '\0' || url->port == 0 ||
+            url->port > 65535) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
     }
 
-    stream->stm4r = purc_rwstream_new_from_unix_fd(fd);
-    if (stream->stm4r == NULL) {
-        goto out_free_stream;
+    char port[16];
+    snprintf(port, sizeof(port), "%u", url->port);
+
+    struct addrinfo hints, *addrs = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(url->host, port, &hints, &addrs) != 0 || addrs == NULL) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return NULL;
     }
-    stream->stm4w = stream->stm4r;
-    stream->fd4r = fd;
-    stream->fd4w = fd;
 
-    return stream;
+    int fd = -1;
+    int err = 0;
+    for (struct addrinfo *ai = addrs; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            err = errno;
+            continue;
+        }
 
-out_free_stream:
-    native_stream_destroy(stream);
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            break;
 
-out_close_fd:
-    close (fd);
+        err = errno;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addrs);
 
-    return NULL;
+    if (fd < 0) {
+        purc_set_error(purc_error_from_errno(err));
+        return NULL;
+    }
+
+    /* the records are usually small; do not wait to coalesce them */
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    return create_sock_stream(STREAM_TYPE_INET_SOCK, url, option, fd);
 }
 
 static purc_variant_t
@@ -1672,6 +2128,9 @@ stream_open_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     else if (atom == keywords2atoms[K_KW_unix].atom) {
         stream = create_unix_sock_stream(url, option);
     }
+    else if (atom == keywords2atoms[K_KW_inet].atom) {
+        stream = create_inet_sock_stream(url, option);
+    }
 #if 0
     else if (atom == keywords2atoms[K_KW_winsock].atom) {
     }
@@ -280,7 +280,13 @@ join_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         goto fatal;
     }
 
-    for (size_t i = 0; i < nr_args; i++) {
+    /* the other arguments are appended to the first string in place if
+       possible, so accumulating text with $STR.join($buf, ...) is linear */
+    size_t first = 0;
+    if (nr_args > 0 && purc_variant_is_string(argv[0]))
+        first = 1;
+
+    for (size_t i = first; i < nr_args; i++) {
 #if 0
         const char *str;
         size_t len_str;
@@ -307,6 +313,16 @@ join_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
 #endif
     }
 
+    if (first) {
+        size_t sz_content = 0;
+        const char *content = purc_rwstream_get_mem_buffer_ex(rwstream,
+                &sz_content, NULL, false);
+        purc_variant_t retv = pcvariant_string_append(argv[0],
+                content ? content : "", sz_content, false);
+        purc_rwstream_destroy(rwstream);
+        return retv;
+    }
+
     if (purc_rwstream_write(rwstream, "", 1) < 1) {
         goto fatal;
     }
@@ -503,7 +519,6 @@ repeat_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
 {
     UNUSED_PARAM(root);
 
-    purc_rwstream_t rwstream = NULL;
     if (nr_args < 2) {
         purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
         goto failed;
@@ -533,41 +548,34 @@ repeat_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         return purc_variant_make_string_static("", false);
     }
 
-    rwstream = purc_rwstream_new_buffer(LEN_INI_PRINT_BUF, LEN_MAX_PRINT_BUF);
-    if (rwstream == NULL) {
+    /* the size of the result is known: fill it by doubling the copied */
+    if ((uint64_t)times > (SIZE_MAX - 1) / len_str) {
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         goto fatal;
     }
 
-    for (int64_t i=0; i < times; i++) {
-        ssize_t nr_wrotten = purc_rwstream_write(rwstream, str, len_str);
-        if (nr_wrotten < 0 || (size_t)nr_wrotten < len_str) {
-            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            goto fatal;
-        }
-    }
-
-    if (purc_rwstream_write(rwstream, "", 1) < 1) {
+    size_t len = len_str * (size_t)times;
+    char *content = malloc(len + 1);
+    if (content == NULL) {
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         goto fatal;
     }
 
-    size_t sz_buffer = 0;
-    size_t sz_content = 0;
-    char *content = NULL;
-    content = purc_rwstream_get_mem_buffer_ex(rwstream,
-            &sz_content, &sz_buffer, true);
-    purc_rwstream_destroy(rwstream);
+    memcpy(content, str, len_str);
+    for (size_t filled = len_str; filled < len; ) {
+        size_t n = (len - filled < filled) ? (len - filled) : filled;
+        memcpy(content + filled, content, n);
+        filled += n;
+    }
+    content[len] = '\0';
 
-    return purc_variant_make_string_reuse_buff(content, sz_buffer, false);
+    return purc_variant_make_string_reuse_buff(content, len + 1, false);
 
 failed:
     if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
         return purc_variant_make_string_static("", false);
 
 fatal:
-    if (rwstream)
-        purc_rwstream_destroy(rwstream);
     return PURC_VARIANT_INVALID;
 }
 
@@ -751,16 +759,21 @@ implode_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     purc_rwstream_write (rwstream, "\0", 1);
 
     size_t rw_size = 0;
-    const char *rw_string = purc_rwstream_get_mem_buffer (rwstream, &rw_size);
+    size_t sz_buffer = 0;
+    char *rw_string = purc_rwstream_get_mem_buffer_ex (rwstream, &rw_size,
+            &sz_buffer, true);
+    purc_rwstream_destroy (rwstream);
 
-    if ((rw_size == 0) || (rw_string == NULL))
+    /* take the buffer over instead of copying it */
+    if ((rw_size == 0) || (rw_string == NULL)) {
+        free (rw_string);
         ret_var = PURC_VARIANT_INVALID;
+    }
     else {
-        ret_var = purc_variant_make_string (rw_string, false);
+        ret_var = purc_variant_make_string_reuse_buff (rw_string, sz_buffer,
+                false);
     }
 
-    purc_rwstream_destroy (rwstream);
-
     return ret_var;
 }
 
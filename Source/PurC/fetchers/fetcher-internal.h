@@ -27,6 +27,8 @@
 
 #include "private/fetcher.h"
 
+#include <atomic>
+
 #define PCFETCHER_INITIAL_PROGRESS  0.1
 
 #ifdef __cplusplus
@@ -63,7 +65,9 @@ typedef purc_variant_t (*pcfetcher_request_async_fn)(
         pcfetcher_response_handler handler,
         void* ctxt,
         pcfetcher_progress_tracker tracker,
-        void* tracker_ctxt);
+        void* tracker_ctxt,
+        pcfetcher_data_consumer consumer,
+        void* consumer_ctxt);
 
 typedef purc_rwstream_t (*pcfetcher_request_sync_fn)(
         struct pcfetcher* fetcher,
@@ -100,13 +104,17 @@ struct pcfetcher_callback_info {
     purc_rwstream_t rws;
     purc_variant_t req_id;
     volatile bool dispatched;
-    volatile bool cancelled;
+    /* set by the requesting thread, read by the I/O threads */
+    std::atomic<bool> cancelled;
 
     pcfetcher_response_handler handler;
     void *ctxt;
 
     pcfetcher_progress_tracker tracker;
     void *tracker_ctxt;
+
+    pcfetcher_data_consumer consumer;
+    void *consumer_ctxt;
 };
 
 struct pcfetcher* pcfetcher_local_init(size_t max_conns, size_t cache_quota);
@@ -136,7 +144,9 @@ purc_variant_t pcfetcher_local_request_async(
         pcfetcher_response_handler handler,
         void* ctxt,
         pcfetcher_progress_tracker tracker,
-        void* tracker_ctxt);
+        void* tracker_ctxt,
+        pcfetcher_data_consumer consumer,
+        void* consumer_ctxt);
 
 purc_rwstream_t pcfetcher_local_request_sync(
         struct pcfetcher* fetcher,
@@ -182,7 +192,9 @@ purc_variant_t pcfetcher_remote_request_async(
         pcfetcher_response_handler handler,
         void* ctxt,
         pcfetcher_progress_tracker tracker,
-        void* tracker_ctxt);
+        void* tracker_ctxt,
+        pcfetcher_data_consumer consumer,
+        void* consumer_ctxt);
 
 purc_rwstream_t pcfetcher_remote_request_sync(
         struct pcfetcher* fetcher,
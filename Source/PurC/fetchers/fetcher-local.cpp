@@ -25,19 +25,71 @@
 #include "config.h"
 
 #include "fetcher-internal.h"
+#include "private/rwstream.h"
 
 #include <wtf/URL.h>
 #include <wtf/RunLoop.h>
+#include <wtf/Condition.h>
+#include <wtf/Deque.h>
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/Lock.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringHash.h>
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 
+#include <errno.h>
 #include <stdlib.h>
 
+#include <atomic>
+#include <new>
+
+#define LOCAL_IO_THREAD_NAME        "purc-local-io"
+#define LOCAL_MAX_IO_THREADS        8
+
+/* A cached file content; valid as long as the file keeps the same inode,
+   size and modification time. The content is shared by the cache and
+   the streams handed out, and freed when the last one releases it. */
+struct local_cache_entry {
+    String      path;
+    char       *data;
+    size_t      size;
+    ino_t       ino;
+    struct timespec mtime;
+    std::atomic<unsigned> refc { 1 };
+};
+
+/* A file load queued to the I/O threads; the completion is dispatched back
+   to the run loop (and the instance hosted by it) which issued the request. */
+struct local_io_task {
+    struct pcfetcher_callback_info *info;
+    char       *file;
+    RefPtr<RunLoop> runloop;
+    void       *context;
+};
+
 struct pcfetcher_local {
     struct pcfetcher base;
     char* base_uri;
+
+    /* the I/O thread pool, at most max_conns threads */
+    Lock                            io_lock;
+    Condition                       io_cond;
+    Deque<struct local_io_task *>   io_tasks;
+    Vector<RefPtr<Thread>>          io_threads;
+    size_t                          nr_idle_threads { 0 };
+    bool                            io_stopping { false };
+
+    /* the LRU content cache, at most cache_quota bytes */
+    Lock                                        cache_lock;
+    HashMap<String, struct local_cache_entry *> cache_map;
+    ListHashSet<struct local_cache_entry *>     cache_lru;
+    size_t                                      cache_used { 0 };
 };
 
 struct mime_type {
@@ -73,10 +125,272 @@ static const char* get_mime(const char* name)
     return mime_types[0].mime;
 }
 
+/* called in any thread */
+static void cache_entry_release(void *ctxt)
+{
+    struct local_cache_entry *entry = (struct local_cache_entry *)ctxt;
+    if (--entry->refc == 0) {
+        free(entry->data);
+        delete entry;
+    }
+}
+
+static bool cache_entry_is_valid(struct local_cache_entry *entry,
+        const struct stat *st)
+{
+    return entry->ino == st->st_ino && entry->size == (size_t)st->st_size &&
+        entry->mtime.tv_sec == st->st_mtim.tv_sec &&
+        entry->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+/* must be called with cache_lock held */
+static void cache_remove_entry(struct pcfetcher_local *local,
+        struct local_cache_entry *entry)
+{
+    local->cache_map.remove(entry->path);
+    local->cache_lru.remove(entry);
+    local->cache_used -= entry->size;
+    cache_entry_release(entry);
+}
+
+static bool cache_is_cacheable(struct pcfetcher_local *local,
+        const struct stat *st)
+{
+    /* do not let a single file flush most of the cache */
+    return S_ISREG(st->st_mode) &&
+        (size_t)st->st_size <= local->base.cache_quota / 4;
+}
+
+/* hands out a read-only view of the content instead of a copy */
+static purc_rwstream_t cache_entry_open(struct local_cache_entry *entry)
+{
+    entry->refc++;
+    purc_rwstream_t rws = pcrwstream_new_view(entry->data, entry->size,
+            cache_entry_release, entry);
+    if (rws == NULL)
+        cache_entry_release(entry);
+    return rws;
+}
+
+static purc_rwstream_t cache_lookup(struct pcfetcher_local *local,
+        const char *file, const struct stat *st)
+{
+    String key = String::fromUTF8(file);
+    auto locker = holdLock(local->cache_lock);
+
+    auto it = local->cache_map.find(key);
+    if (it == local->cache_map.end())
+        return NULL;
+
+    struct local_cache_entry *entry = it->value;
+    if (!cache_entry_is_valid(entry, st)) {
+        cache_remove_entry(local, entry);
+        return NULL;
+    }
+
+    local->cache_lru.appendOrMoveToLast(entry);
+    return cache_entry_open(entry);
+}
+
+/* takes the ownership of data; returns a view of the stored content */
+static purc_rwstream_t cache_store(struct pcfetcher_local *local,
+        const char *file, const struct stat *st, char *data)
+{
+    struct local_cache_entry *entry = new local_cache_entry;
+    entry->path = String::fromUTF8(file);
+    entry->data = data;
+    entry->size = st->st_size;
+    entry->ino = st->st_ino;
+    entry->mtime = st->st_mtim;
+
+    auto locker = holdLock(local->cache_lock);
+
+    auto it = local->cache_map.find(entry->path);
+    if (it != local->cache_map.end())
+        cache_remove_entry(local, it->value);
+
+    while (!local->cache_lru.isEmpty() &&
+            local->cache_used + entry->size > local->base.cache_quota) {
+        cache_remove_entry(local, local->cache_lru.first());
+    }
+
+    local->cache_map.add(entry->path, entry);
+    local->cache_lru.add(entry);
+    local->cache_used += entry->size;
+    return cache_entry_open(entry);
+}
+
+static char *read_whole_file(const char *file, size_t size)
+{
+    int fd = open(file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+
+    char *data = (char *)malloc(size + 1);
+    size_t nr_read = 0;
+    while (data && nr_read < size) {
+        ssize_t n = read(fd, data + nr_read, size - nr_read);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            free(data);
+            data = NULL;
+            break;
+        }
+        nr_read += n;
+    }
+    close(fd);
+
+    if (data)
+        data[size] = 0;
+    return data;
+}
+
+/* loads a local file via the content cache; called in any thread */
+static purc_rwstream_t local_load_file(struct pcfetcher_local *local,
+        const char *file, struct pcfetcher_resp_header *resp_header)
+{
+    struct stat st;
+    if (stat(file, &st) != 0)
+        return NULL;
+
+    purc_rwstream_t rws = NULL;
+    if (cache_is_cacheable(local, &st)) {
+        rws = cache_lookup(local, file, &st);
+        if (rws == NULL) {
+            char *data = read_whole_file(file, st.st_size);
+            if (data)
+                rws = cache_store(local, file, &st, data);
+        }
+    }
+
+    if (rws == NULL)
+        rws = pcrwstream_new_from_file_for_read(file);
+
+    if (rws && resp_header) {
+        resp_header->ret_code = 200;
+        resp_header->sz_resp = st.st_size;
+        resp_header->mime_type = strdup(get_mime(file));
+    }
+
+    return rws;
+}
+
+static void local_complete_request(struct pcfetcher_callback_info *info)
+{
+    if (info->tracker) {
+        info->tracker(info->req_id, info->tracker_ctxt, 1.0);
+    }
+    if (!info->cancelled && info->consumer && info->rws) {
+        size_t sz_content = 0;
+        const char *data = (const char *)
+            purc_rwstream_get_mem_buffer(info->rws, &sz_content);
+        if (data && sz_content) {
+            info->consumer(info->req_id, info->consumer_ctxt,
+                    data, sz_content);
+        }
+    }
+    if (!info->cancelled) {
+        info->handler(info->req_id, info->ctxt, &info->header,
+                info->rws);
+        info->rws = NULL;
+    }
+    pcfetcher_destroy_callback_info(info);
+}
+
+/* takes over the result of an I/O task in the requesting thread; the header
+   of a cancelled request has been set by pcfetcher_local_cancel_async() */
+static void local_finish_io_task(struct pcfetcher_callback_info *info,
+        purc_rwstream_t rws, const struct pcfetcher_resp_header &header)
+{
+    if (info->cancelled.load(std::memory_order_acquire)) {
+        if (rws)
+            purc_rwstream_destroy(rws);
+        free(header.mime_type);
+    }
+    else {
+        info->rws = rws;
+        info->header = header;
+    }
+
+    local_complete_request(info);
+}
+
+static void local_run_io_task(struct pcfetcher_local *local,
+        struct local_io_task *task)
+{
+    struct pcfetcher_callback_info *info = task->info;
+
+    /* the I/O thread never writes to info: the result is handed over
+       to the requesting thread by the dispatch */
+    purc_rwstream_t rws = NULL;
+    struct pcfetcher_resp_header header = { };
+    if (!info->cancelled.load(std::memory_order_acquire)) {
+        rws = local_load_file(local, task->file, &header);
+    }
+    if (!rws) {
+        header.ret_code = 404;
+    }
+
+    task->runloop->dispatch(RunLoop::bindContext(task->context,
+                [info, rws, header] {
+                local_finish_io_task(info, rws, header);
+            }));
+
+    free(task->file);
+    delete task;
+}
+
+static void local_io_thread_entry(struct pcfetcher_local *local)
+{
+    local->io_lock.lock();
+    while (true) {
+        while (local->io_tasks.isEmpty() && !local->io_stopping)
+            local->io_cond.wait(local->io_lock);
+
+        /* pending tasks are drained before quitting */
+        if (local->io_tasks.isEmpty())
+            break;
+
+        struct local_io_task *task = local->io_tasks.takeFirst();
+        local->nr_idle_threads--;
+        local->io_lock.unlock();
+
+        local_run_io_task(local, task);
+
+        local->io_lock.lock();
+        local->nr_idle_threads++;
+    }
+    local->nr_idle_threads--;
+    local->io_lock.unlock();
+}
+
+static void local_queue_io_task(struct pcfetcher_local *local,
+        struct local_io_task *task)
+{
+    auto locker = holdLock(local->io_lock);
+    local->io_tasks.append(task);
+
+    size_t max_threads = local->base.max_conns;
+    if (max_threads == 0 || max_threads > LOCAL_MAX_IO_THREADS)
+        max_threads = LOCAL_MAX_IO_THREADS;
+
+    /* spawn threads on demand till the pool reaches its bound */
+    if (local->nr_idle_threads < local->io_tasks.size() &&
+            local->io_threads.size() < max_threads) {
+        local->nr_idle_threads++;
+        local->io_threads.append(Thread::create(LOCAL_IO_THREAD_NAME,
+                    [local] {
+                        local_io_thread_entry(local);
+                    }));
+    }
+
+    local->io_cond.notifyOne();
+}
+
 struct pcfetcher* pcfetcher_local_init(size_t max_conns, size_t cache_quota)
 {
-    struct pcfetcher_local* local = (struct pcfetcher_local*)malloc(
-            sizeof(struct pcfetcher_local));
+    struct pcfetcher_local* local = new (std::nothrow) pcfetcher_local;
     if (local == NULL) {
         return NULL;
     }
@@ -107,10 +421,29 @@ int pcfetcher_local_term(struct pcfetcher* fetcher)
     }
 
     struct pcfetcher_local* local = (struct pcfetcher_local*)fetcher;
+
+    Vector<RefPtr<Thread>> threads;
+    {
+        auto locker = holdLock(local->io_lock);
+        local->io_stopping = true;
+        local->io_cond.notifyAll();
+        threads = WTFMove(local->io_threads);
+    }
+    for (auto& thread : threads) {
+        thread->waitForCompletion();
+    }
+
+    {
+        auto locker = holdLock(local->cache_lock);
+        while (!local->cache_lru.isEmpty()) {
+            cache_remove_entry(local, local->cache_lru.first());
+        }
+    }
+
     if (local->base_uri) {
         free(local->base_uri);
     }
-    free(local);
+    delete local;
     return 0;
 }
 
@@ -171,6 +504,24 @@ const char* pcfetcher_cookie_loccal_remove(struct pcfetcher* fetcher,
     return NULL;
 }
 
+/* returns a null CString if the URL does not refer to a local file */
+static CString local_resolve_path(struct pcfetcher_local *local,
+        const char *url)
+{
+    String uri;
+    if (local->base_uri &&
+            strncmp(url, local->base_uri, strlen(local->base_uri)) != 0) {
+        uri.append(local->base_uri);
+    }
+    uri.append(url);
+    PurCWTF::URL wurl(URL(), uri);
+    if (!wurl.isLocalFile()) {
+        return CString();
+    }
+
+    return wurl.path().utf8();
+}
+
 purc_variant_t pcfetcher_local_request_async(
         struct pcfetcher* fetcher,
         const char* url,
@@ -180,73 +531,55 @@ purc_variant_t pcfetcher_local_request_async(
         pcfetcher_response_handler handler,
         void* ctxt,
         pcfetcher_progress_tracker tracker,
-        void* tracker_ctxt)
+        void* tracker_ctxt,
+        pcfetcher_data_consumer consumer,
+        void* consumer_ctxt)
 {
-    UNUSED_PARAM(fetcher);
-    UNUSED_PARAM(url);
     UNUSED_PARAM(method);
     UNUSED_PARAM(params);
     UNUSED_PARAM(timeout);
-    UNUSED_PARAM(handler);
-    UNUSED_PARAM(ctxt);
 
     if (!fetcher || !url || !handler) {
         return PURC_VARIANT_INVALID;
     }
 
+    struct pcfetcher_local* local = (struct pcfetcher_local*)fetcher;
     struct pcfetcher_callback_info *info = pcfetcher_create_callback_info();
-    info->rws = pcfetcher_local_request_sync(fetcher, url, method,
-            params, timeout, &info->header);
     info->handler = handler;
     info->ctxt = ctxt;
     info->tracker = tracker;
     info->tracker_ctxt = tracker_ctxt;
+    info->consumer = consumer;
+    info->consumer_ctxt = consumer_ctxt;
     info->req_id = purc_variant_make_native(info, NULL);
 
-    if (!info->rws) {
-        info->header.ret_code = 404;
-    }
-
     RunLoop *runloop = &RunLoop::current();
     if (info->tracker) {
-#ifdef NDEBUG
         runloop->dispatch([info] {
-#else
-        double tm = 1.0;
-        runloop->dispatchAfter(Seconds(tm), [info] {
-#endif
                 info->tracker(info->req_id, info->tracker_ctxt,
                         PCFETCHER_INITIAL_PROGRESS);
             }
         );
     }
 
-#ifdef NDEBUG
-    runloop->dispatch([info] {
-#else
-    // random
-    double tm = 3.0;
-    runloop->dispatchAfter(Seconds(tm), [info] {
-#endif
-                if (info->tracker) {
-                    info->tracker(info->req_id, info->tracker_ctxt, 1.0);
-                }
-                if (!info->cancelled) {
-                    info->handler(info->req_id, info->ctxt, &info->header,
-                            info->rws);
-                    info->rws = NULL;
-                }
-                pcfetcher_destroy_callback_info(info);
+    /* resolve the path here: base_uri belongs to the calling thread */
+    CString path = local_resolve_path(local, url);
+    if (path.isNull()) {
+        info->header.ret_code = 404;
+        runloop->dispatch([info] {
+                local_complete_request(info);
             });
+        return info->req_id;
+    }
 
-    return info->req_id;
-}
+    struct local_io_task *task = new local_io_task;
+    task->info = info;
+    task->file = strdup(path.data());
+    task->runloop = runloop;
+    task->context = runloop->currentContext();
+    local_queue_io_task(local, task);
 
-off_t filesize(const char* filename)
-{
-    struct stat statbuf;
-    stat(filename,&statbuf);
-    return statbuf.st_size;
+    return info->req_id;
 }
 
 purc_rwstream_t pcfetcher_local_request_sync(
@@ -257,60 +590,36 @@ purc_rwstream_t pcfetcher_local_request_sync(
         uint32_t timeout,
         struct pcfetcher_resp_header *resp_header)
 {
-    UNUSED_PARAM(fetcher);
-    UNUSED_PARAM(url);
     UNUSED_PARAM(method);
     UNUSED_PARAM(params);
     UNUSED_PARAM(timeout);
-    UNUSED_PARAM(resp_header);
 
-    if (!fetcher || !url) {
+    if (!fetcher || !url || !resp_header) {
         return NULL;
     }
     struct pcfetcher_local* local = (struct pcfetcher_local*)fetcher;
-    String uri;
-    if (local->base_uri &&
-            strncmp(url, local->base_uri, strlen(local->base_uri)) != 0) {
-        uri.append(local->base_uri);
-    }
-    uri.append(url);
-    PurCWTF::URL wurl(URL(), uri);
-    if (!wurl.isLocalFile()) {
+    CString path = local_resolve_path(local, url);
+    if (path.isNull()) {
         resp_header->ret_code = 404;
         resp_header->sz_resp = 0;
         resp_header->mime_type = NULL;
         return NULL;
     }
 
-    const StringView path = wurl.path();
-    const CString& cpath = path.utf8();
-
-    const char* file = cpath.data();
-
-    purc_rwstream_t rws = purc_rwstream_new_from_file(file, "r");
-    if (rws && resp_header) {
-        resp_header->ret_code = 200;
-        resp_header->sz_resp = filesize(file);
-        resp_header->mime_type = strdup(get_mime(file));
-        return rws;
-    }
-
-    return NULL;
+    return local_load_file(local, path.data(), resp_header);
 }
 
 void pcfetcher_local_cancel_async(struct pcfetcher* fetcher,
         purc_variant_t request)
 {
     UNUSED_PARAM(fetcher);
-    UNUSED_PARAM(request);
 
-#ifndef NDEBUG
+    /* the completion dispatched to this thread will skip the handler */
     struct pcfetcher_callback_info *info = (struct pcfetcher_callback_info *)
         purc_variant_native_get_entity(request);
-    info->cancelled = true;
+    info->cancelled.store(true, std::memory_order_release);
     info->header.ret_code = RESP_CODE_USER_CANCEL;
     info->handler(info->req_id, info->ctxt, &info->header, NULL);
-#endif
 }
 
 int pcfetcher_local_check_response(struct pcfetcher* fetcher,
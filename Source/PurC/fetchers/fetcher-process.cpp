@@ -302,7 +302,9 @@ purc_variant_t PcFetcherProcess::requestAsync(
         pcfetcher_response_handler handler,
         void* ctxt,
         pcfetcher_progress_tracker tracker,
-        void* tracker_ctxt)
+        void* tracker_ctxt,
+        pcfetcher_data_consumer consumer,
+        void* consumer_ctxt)
 {
     PcFetcherRequest* session = createRequest();
     if (!session) {
@@ -311,7 +313,8 @@ purc_variant_t PcFetcherProcess::requestAsync(
     }
 
     return session->requestAsync(base_uri, url, method,
-            params, timeout, handler, ctxt, tracker, tracker_ctxt);
+            params, timeout, handler, ctxt, tracker, tracker_ctxt,
+            consumer, consumer_ctxt);
 }
 
 purc_rwstream_t PcFetcherProcess::requestSync(
@@ -113,7 +113,9 @@ public:
         pcfetcher_response_handler handler,
         void* ctxt,
         pcfetcher_progress_tracker tracker,
-        void* tracker_ctxt);
+        void* tracker_ctxt,
+        pcfetcher_data_consumer consumer,
+        void* consumer_ctxt);
 
     purc_rwstream_t requestSync(
         const char* base_uri,
@@ -147,12 +147,15 @@ purc_variant_t pcfetcher_remote_request_async(
         pcfetcher_response_handler handler,
         void* ctxt,
         pcfetcher_progress_tracker tracker,
-        void* tracker_ctxt)
+        void* tracker_ctxt,
+        pcfetcher_data_consumer consumer,
+        void* consumer_ctxt)
 {
     struct pcfetcher_remote* remote = (struct pcfetcher_remote*)fetcher;
     return remote->process->requestAsync(
             remote->base_uri,
-            url, method, params, timeout, handler, ctxt, tracker, tracker_ctxt);
+            url, method, params, timeout, handler, ctxt, tracker, tracker_ctxt,
+            consumer, consumer_ctxt);
 }
 
 
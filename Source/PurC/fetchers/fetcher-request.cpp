@@ -72,6 +72,7 @@ PcFetcherRequest::PcFetcherRequest(uint64_t sessionId,
 
     m_connection->open();
     m_runloop = &RunLoop::current();
+    m_context = m_runloop->currentContext();
 }
 
 PcFetcherRequest::~PcFetcherRequest()
@@ -118,7 +119,9 @@ purc_variant_t PcFetcherRequest::requestAsync(
         pcfetcher_response_handler handler,
         void* ctxt,
         pcfetcher_progress_tracker tracker,
-        void* tracker_ctxt)
+        void* tracker_ctxt,
+        pcfetcher_data_consumer consumer,
+        void* consumer_ctxt)
 {
     // TODO send params with http request
     UNUSED_PARAM(params);
@@ -128,6 +131,8 @@ purc_variant_t PcFetcherRequest::requestAsync(
     m_callback->ctxt = ctxt;
     m_callback->tracker = tracker;
     m_callback->tracker_ctxt = tracker_ctxt;
+    m_callback->consumer = consumer;
+    m_callback->consumer_ctxt = consumer_ctxt;
     m_is_async = true;
 
     const char *encode_p = NULL;
@@ -303,7 +308,7 @@ void PcFetcherRequest::stop()
     m_callback = nullptr;
 
     info->header.ret_code = RESP_CODE_USER_STOP;
-    m_runloop->dispatch([info, request=this] {
+    dispatchToRunLoop([info, request=this] {
             info->handler(info->req_id, info->ctxt, &info->header, NULL);
             info->handler = nullptr;
             pcfetcher_destroy_callback_info(info);
@@ -324,7 +329,7 @@ void PcFetcherRequest::cancel()
     m_callback = nullptr;
 
     info->header.ret_code = RESP_CODE_USER_CANCEL;
-    m_runloop->dispatch([info, request=this] {
+    dispatchToRunLoop([info, request=this] {
             info->handler(info->req_id, info->ctxt, &info->header, NULL);
             info->handler = nullptr;
             pcfetcher_destroy_callback_info(info);
@@ -417,7 +422,8 @@ void PcFetcherRequest::didReceiveResponse(
     }
 
     size_t init;
-    if (m_callback->header.sz_resp <= 0) {
+    if (m_callback->header.sz_resp <= 0 ||
+            (m_is_async && m_callback->consumer)) {
         init = DEF_RWS_SIZE;
         m_estimatedLength = progressItemDefaultEstimatedLength;
     }
@@ -429,7 +435,7 @@ void PcFetcherRequest::didReceiveResponse(
     m_progressValue = initialProgressValue;
     if (m_callback->tracker) {
         struct pcfetcher_callback_info *info = m_callback;
-        m_runloop->dispatch([info, progress=m_progressValue] {
+        dispatchToRunLoop([info, progress=m_progressValue] {
                 info->tracker(info->req_id, info->tracker_ctxt, progress);
             }
         );
@@ -462,12 +468,29 @@ void PcFetcherRequest::didReceiveSharedBuffer(
     m_progressValue = std::min(m_progressValue, maxProgressValue);
     if (m_callback->tracker) {
         struct pcfetcher_callback_info *info = m_callback;
-        m_runloop->dispatch([info, progress=m_progressValue] {
+        dispatchToRunLoop([info, progress=m_progressValue] {
                 info->tracker(info->req_id, info->tracker_ctxt, progress);
             }
         );
     }
 
+    /* the consumer takes the body over: it is not collected in rws */
+    if (m_is_async && m_callback->consumer) {
+        if (data.size()) {
+            struct pcfetcher_callback_info *info = m_callback;
+            Vector<char> chunk;
+            chunk.append(data.data(), data.size());
+            dispatchToRunLoop([info, chunk=WTFMove(chunk)] {
+                    if (!info->cancelled) {
+                        info->consumer(info->req_id, info->consumer_ctxt,
+                                chunk.data(), chunk.size());
+                    }
+                }
+            );
+        }
+        return;
+    }
+
     purc_rwstream_write(m_callback->rws, data.data(), data.size());
 }
 
@@ -488,7 +511,7 @@ void PcFetcherRequest::didFinishResourceLoad(
 
     if (m_callback->tracker) {
         struct pcfetcher_callback_info *info = m_callback;
-        m_runloop->dispatch([info, progress=m_progressValue] {
+        dispatchToRunLoop([info, progress=m_progressValue] {
                 info->tracker(info->req_id, info->tracker_ctxt, progress);
             }
         );
@@ -509,7 +532,7 @@ void PcFetcherRequest::didFinishResourceLoad(
     }
     struct pcfetcher_callback_info *info = m_callback;
     m_callback = NULL;
-    m_runloop->dispatch([info, request=this] {
+    dispatchToRunLoop([info, request=this] {
             info->handler(info->req_id, info->ctxt, &info->header,
                     info->rws);
             info->rws = NULL;
@@ -550,7 +573,7 @@ void PcFetcherRequest::didFailResourceLoad(const ResourceError& error)
     }
     struct pcfetcher_callback_info *info = m_callback;
     m_callback = NULL;
-    m_runloop->dispatch([info, request=this] {
+    dispatchToRunLoop([info, request=this] {
             info->handler(info->req_id, info->ctxt, &info->header,
                     info->rws);
             info->rws = NULL;
@@ -72,7 +72,9 @@ public:
         pcfetcher_response_handler handler,
         void* ctxt,
         pcfetcher_progress_tracker tracker,
-        void* tracker_ctxt);
+        void* tracker_ctxt,
+        pcfetcher_data_consumer consumer,
+        void* consumer_ctxt);
 
     purc_rwstream_t requestSync(
         const char* base_uri,
@@ -115,6 +117,12 @@ protected:
     void willSendRequest(ResourceRequest&&,
             IPC::FormDataReference&& requestBody, ResourceResponse&&);
 
+    /* dispatch to the run loop of the requester in its context */
+    void dispatchToRunLoop(Function<void()>&& function)
+    {
+        m_runloop->dispatch(RunLoop::bindContext(m_context, WTFMove(function)));
+    }
+
 private:
     uint64_t m_sessionId;
     uint64_t m_req_id;
@@ -124,6 +132,7 @@ private:
     BinarySemaphore m_waitForSyncReplySemaphore;
 
     RunLoop* m_runloop;
+    void* m_context;
     WorkQueue* m_workQueue;
 
     Lock m_callbackLock;
@@ -0,0 +1,281 @@
+/*
+ * @file fetcher-sql.c
+ * @date 2026/10/19
+ * @brief The decoder of the SQL result sets streamed by the fetchers.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc-variant.h"
+#include "purc-rwstream.h"
+#include "purc-utils.h"
+#include "private/fetcher.h"
+#include "private/dvobjs.h"
+#include "private/errors.h"
+#include "private/variant.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/*
+ * The SQL fetchers (lsql:// and rsql://) stream the result set with
+ * one row per line:
+ *
+ *  {"rows":[
+ *  {"id":1,"name":"foo"},
+ *  {"id":2,"name":"bar"}
+ *  ],"statusCode":200,"errorMsg":null,"rowsAffected":2}
+ *
+ * The lines between a line ending with `"rows":[` and the next line
+ * starting with `]` are the rows. For more than one statement, the results
+ * are wrapped in an array keyed by `result`, one object per statement.
+ *
+ * The rows are decoded as the chunks arrive, and only the other lines are
+ * kept, as the skeleton of the document. When the response completes, the
+ * skeleton is parsed and the arrays of rows are put back in order, so the
+ * body is never held as a whole.
+ */
+#define ROWS_LINE_HEAD      "\"rows\":["
+#define KEY_ROWS            "rows"
+#define KEY_RESULT          "result"
+
+struct pcfetcher_sql_decoder {
+    /* the arrays of rows decoded so far, one per statement,
+       and the array being filled */
+    purc_variant_t      results;
+    purc_variant_t      rows;
+    /* the document without the rows */
+    purc_rwstream_t     skeleton;
+    /* the incomplete last line of the previous chunk */
+    char               *partial;
+    size_t              sz_partial;
+    bool                in_rows;
+};
+
+bool pcfetcher_is_sql_uri(const char *uri)
+{
+    return strncasecmp(uri, "lsql:", 5) == 0 ||
+        strncasecmp(uri, "rsql:", 5) == 0;
+}
+
+struct pcfetcher_sql_decoder *pcfetcher_sql_decoder_create(void)
+{
+    struct pcfetcher_sql_decoder *decoder = calloc(1, sizeof(*decoder));
+    if (decoder == NULL)
+        goto failed;
+
+    decoder->results = purc_variant_make_array_0();
+    decoder->skeleton = purc_rwstream_new_buffer(LEN_INI_PRINT_BUF,
+            LEN_MAX_PRINT_BUF);
+    if (decoder->results == PURC_VARIANT_INVALID || !decoder->skeleton) {
+        pcfetcher_sql_decoder_destroy(decoder);
+        goto failed;
+    }
+
+    return decoder;
+
+failed:
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return NULL;
+}
+
+void pcfetcher_sql_decoder_destroy(struct pcfetcher_sql_decoder *decoder)
+{
+    if (decoder) {
+        PURC_VARIANT_SAFE_CLEAR(decoder->results);
+        PURC_VARIANT_SAFE_CLEAR(decoder->rows);
+        if (decoder->skeleton)
+            purc_rwstream_destroy(decoder->skeleton);
+        free(decoder->partial);
+        free(decoder);
+    }
+}
+
+/* returns 1 for a row, 0 for another line, or -1 for no memory */
+static int
+decode_line(struct pcfetcher_sql_decoder *decoder, const char *line,
+        size_t len)
+{
+    size_t trimmed = len;
+    while (trimmed > 0 && (purc_isspace(line[trimmed - 1]) ||
+                line[trimmed - 1] == ','))
+        trimmed--;
+
+    if (trimmed == 0)
+        return 0;
+
+    if (decoder->in_rows && line[0] != ']') {
+        purc_variant_t row = purc_variant_make_from_json_string(line, trimmed);
+        if (row == PURC_VARIANT_INVALID) {
+            /* a malformed row is skipped */
+            if (purc_get_last_error() == PURC_ERROR_OUT_OF_MEMORY)
+                return -1;
+            purc_clr_error();
+            return 0;
+        }
+
+        bool ok = purc_variant_array_append(decoder->rows, row);
+        purc_variant_unref(row);
+        return ok ? 1 : -1;
+    }
+
+    if (purc_rwstream_write(decoder->skeleton, line, len) < (ssize_t)len ||
+            purc_rwstream_write(decoder->skeleton, "\n", 1) < 1)
+        return -1;
+
+    size_t sz_head = sizeof(ROWS_LINE_HEAD) - 1;
+    if (line[0] == ']') {
+        decoder->in_rows = false;
+    }
+    else if (trimmed >= sz_head &&
+            strncmp(line + trimmed - sz_head, ROWS_LINE_HEAD, sz_head) == 0) {
+        purc_variant_t rows = purc_variant_make_array_0();
+        if (rows == PURC_VARIANT_INVALID)
+            return -1;
+        if (!purc_variant_array_append(decoder->results, rows)) {
+            purc_variant_unref(rows);
+            return -1;
+        }
+        PURC_VARIANT_SAFE_CLEAR(decoder->rows);
+        decoder->rows = rows;
+        decoder->in_rows = true;
+    }
+
+    return 0;
+}
+
+ssize_t pcfetcher_sql_decoder_feed(struct pcfetcher_sql_decoder *decoder,
+        const char *buf, size_t sz_buf)
+{
+    ssize_t nr_rows = 0;
+    int r;
+
+    const char *end = buf + sz_buf;
+    while (buf < end) {
+        const char *eol = memchr(buf, '\n', end - buf);
+        if (eol == NULL) {
+            /* carry the incomplete line over to the next chunk */
+            size_t len = end - buf;
+            char *partial = realloc(decoder->partial,
+                    decoder->sz_partial + len);
+            if (partial == NULL)
+                goto failed;
+            memcpy(partial + decoder->sz_partial, buf, len);
+            decoder->partial = partial;
+            decoder->sz_partial += len;
+            break;
+        }
+
+        if (decoder->sz_partial) {
+            size_t len = eol - buf;
+            char *line = realloc(decoder->partial, decoder->sz_partial + len);
+            if (line == NULL)
+                goto failed;
+            memcpy(line + decoder->sz_partial, buf, len);
+            r = decode_line(decoder, line, decoder->sz_partial + len);
+            free(line);
+            decoder->partial = NULL;
+            decoder->sz_partial = 0;
+        }
+        else {
+            r = decode_line(decoder, buf, eol - buf);
+        }
+
+        if (r < 0)
+            goto failed;
+        nr_rows += r;
+        buf = eol + 1;
+    }
+
+    return nr_rows;
+
+failed:
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return -1;
+}
+
+purc_variant_t pcfetcher_sql_decoder_rows(
+        struct pcfetcher_sql_decoder *decoder)
+{
+    return decoder->rows;
+}
+
+purc_variant_t pcfetcher_sql_decoder_finish(
+        struct pcfetcher_sql_decoder *decoder)
+{
+    if (decoder->sz_partial) {
+        int r = decode_line(decoder, decoder->partial, decoder->sz_partial);
+        free(decoder->partial);
+        decoder->partial = NULL;
+        decoder->sz_partial = 0;
+        if (r < 0) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return PURC_VARIANT_INVALID;
+        }
+    }
+
+    size_t sz_content = 0;
+    const char *skeleton = purc_rwstream_get_mem_buffer(decoder->skeleton,
+            &sz_content);
+    if (skeleton == NULL || sz_content == 0) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    purc_variant_t doc = purc_variant_make_from_json_string(skeleton,
+            sz_content);
+    if (doc == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+    if (!purc_variant_is_object(doc))
+        goto invalid;
+
+    size_t nr_results = purc_variant_array_get_size(decoder->results);
+    if (nr_results == 0)
+        return doc;
+
+    purc_variant_t list = purc_variant_object_get_by_ckey(doc, KEY_RESULT);
+    if (list) {
+        size_t nr = 0;
+        purc_variant_linear_container_size(list, &nr);
+        for (size_t i = 0; i < nr && i < nr_results; i++) {
+            purc_variant_t result = purc_variant_linear_container_get(list, i);
+            if (!purc_variant_is_object(result))
+                goto invalid;
+            if (!purc_variant_object_set_by_static_ckey(result, KEY_ROWS,
+                        purc_variant_array_get(decoder->results, i)))
+                goto failed;
+        }
+    }
+    else {
+        purc_clr_error();
+        if (!purc_variant_object_set_by_static_ckey(doc, KEY_ROWS,
+                    purc_variant_array_get(decoder->results, 0)))
+            goto failed;
+    }
+
+    return doc;
+
+invalid:
+    purc_set_error(PURC_ERROR_INVALID_VALUE);
+failed:
+    purc_variant_unref(doc);
+    return PURC_VARIANT_INVALID;
+}
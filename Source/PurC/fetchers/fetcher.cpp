@@ -88,11 +88,14 @@ purc_variant_t pcfetcher_request_async(
         pcfetcher_response_handler handler,
         void* ctxt,
         pcfetcher_progress_tracker tracker,
-        void* tracker_ctxt)
+        void* tracker_ctxt,
+        pcfetcher_data_consumer consumer,
+        void* consumer_ctxt)
 {
     struct pcfetcher* fetcher = get_fetcher();
     return fetcher ? fetcher->request_async(fetcher, url, method,
-            params, timeout, handler, ctxt, tracker, tracker_ctxt) : PURC_VARIANT_INVALID;
+            params, timeout, handler, ctxt, tracker, tracker_ctxt,
+            consumer, consumer_ctxt) : PURC_VARIANT_INVALID;
 }
 
 purc_rwstream_t pcfetcher_request_sync(
@@ -311,6 +311,7 @@ create_element(struct pcvdom_gen *gen, struct pchvml_token *token)
         if (!element_attr_syntax_detection(elem, name, vcm)) {
             goto end;
         }
+        pcvcm_node_mark_const(vcm);
 
         struct pcvdom_attr *vattr;
         vattr = pcvdom_attr_create(name, op, vcm);
@@ -561,6 +562,7 @@ set_vcm_tree(struct pcvdom_gen *gen, struct pchvml_token *token)
     if (!vcm_content) { // FIXME: why?
         goto out;
     }
+    pcvcm_node_mark_const(vcm_content);
 
     r = pcvdom_element_set_vcm_content(element, vcm_content);
     PC_ASSERT(r == 0);
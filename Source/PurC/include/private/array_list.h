@@ -29,6 +29,9 @@
 
 #include "private/list.h"
 
+#include <stdbool.h>
+#include <stdint.h>
+
 struct pcutils_array_list_node {
     struct list_head             node;
     size_t                       idx;
@@ -199,6 +202,28 @@ pcutils_array_list_sort(struct pcutils_array_list *al,
         void *ud, int (*cmp)(struct pcutils_array_list_node *l,
                 struct pcutils_array_list_node *r, void *ud));
 
+/* Sorts the nodes by the precomputed keys (keys[i] is the key of the i-th
+ * node) with a stable merge sort. Long lists are sorted by the threads of
+ * a pool shared by all instances, so `cmp` should only read the keys.
+ * Returns 0 on success, or -1 when out of memory; the nodes keep their
+ * order in this case. */
+int
+pcutils_array_list_sort_by_keys(struct pcutils_array_list *al,
+        const void **keys, void *ud,
+        int (*cmp)(const void *l, const void *r, void *ud));
+
+/* Sorts the nodes by the unsigned integer keys with a stable radix sort.
+ * Returns 0 on success, or -1 when out of memory. */
+int
+pcutils_array_list_sort_by_integers(struct pcutils_array_list *al,
+        const uint64_t *keys, bool desc);
+
+/* Sorts the nodes by the string keys in the order of strcmp() with
+ * a stable radix sort. Returns 0 on success, or -1 when out of memory. */
+int
+pcutils_array_list_sort_by_strings(struct pcutils_array_list *al,
+        const char **keys, bool desc);
+
 PCA_EXTERN_C_END
 
 #endif // PURC_PRIVATE_ARRAY_LIST_H
@@ -27,11 +27,20 @@
 
 #include <stdbool.h>
 
+#include "purc-pcrdr.h"
 #include "private/list.h"
 #include "private/utils.h"
 
 #define PCCHAN_MAX_LEN_NAME     63
 
+/* the scope keyword of a channel shared by all runners */
+#define PCCHAN_SCOPE_SHARED     "shared"
+/* the scope keyword of a channel local to the current runner (default) */
+#define PCCHAN_SCOPE_LOCAL      "local"
+
+/* the event sent to a coroutine parked on a shared channel */
+#define PCCHAN_EVENT_WAKEUP     "_chanwakeup"
+
 struct pcchan {
     /* the name of the channel */
     char           *name;
@@ -60,6 +69,13 @@ struct pcchan {
 
 typedef struct pcchan *pcchan_t;
 
+/* A channel shared by the runners in different threads; see
+   interpreter/shared-channel.c */
+struct pcchan_shared;
+typedef struct pcchan_shared *pcchan_shared_t;
+
+struct pcinst;
+
 PCA_EXTERN_C_BEGIN
 
 pcchan_t
@@ -77,6 +93,35 @@ pcchan_destroy(pcchan_t chan) WTF_INTERNAL;
 purc_variant_t
 pcchan_make_entity(pcchan_t chan) WTF_INTERNAL;
 
+int
+pcchan_shared_init_once(void) WTF_INTERNAL;
+
+/* Open or join a shared channel; returns a new reference to the channel.
+   The capacity given by the first opener wins. */
+pcchan_shared_t
+pcchan_shared_open(const char *chan_name, unsigned int cap) WTF_INTERNAL;
+
+/* Retrieve a shared channel; returns a new reference to the channel. */
+pcchan_shared_t
+pcchan_shared_retrieve(const char *chan_name) WTF_INTERNAL;
+
+/* Close a shared channel: discard the data and wake up all waiters. */
+void
+pcchan_shared_close(pcchan_shared_t chan) WTF_INTERNAL;
+
+void
+pcchan_shared_unref(pcchan_shared_t chan) WTF_INTERNAL;
+
+/* Make a native entity for the shared channel; takes over the reference. */
+purc_variant_t
+pcchan_shared_make_entity(pcchan_shared_t chan) WTF_INTERNAL;
+
+/* Handle a wakeup event sent by a peer of a shared channel;
+   returns false if the message is not a wakeup event. */
+bool
+pcchan_shared_handle_wakeup(struct pcinst *inst,
+        const pcrdr_msg *msg) WTF_INTERNAL;
+
 static inline unsigned int
 pcchan_capability(pcchan_t chan) {
     return chan->qsize;
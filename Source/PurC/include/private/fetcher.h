@@ -32,6 +32,7 @@
 #include <stdbool.h>
 
 #include <time.h>
+#include <sys/types.h>
 
 enum pcfetcher_request_method {
     PCFETCHER_REQUEST_METHOD_GET = 0,
@@ -46,8 +47,18 @@ struct pcfetcher_resp_header {
     int ret_code;
     char* mime_type;
     size_t sz_resp;
+    /* the body decoded by the requester while it was received, if any;
+       the response stream is empty then */
+    purc_variant_t decoded;
+    /* the error raised while decoding the body, e.g.,
+       PURC_ERROR_OUT_OF_MEMORY; `decoded` is invalid then */
+    int decode_error;
 };
 
+/* The decoder of a SQL result set (lsql:// or rsql://) fed with the chunks
+   of the response body as they arrive; see fetchers/fetcher-sql.c. */
+struct pcfetcher_sql_decoder;
+
 typedef void (*pcfetcher_response_handler)(
         purc_variant_t request_id, void* ctxt,
         const struct pcfetcher_resp_header *resp_header,
@@ -56,6 +67,11 @@ typedef void (*pcfetcher_response_handler)(
 typedef void (*pcfetcher_progress_tracker)(purc_variant_t request_id,
         void* ctxt, double progress);
 
+/* Called in the requesting thread for every chunk of the response body
+   as soon as it arrives; the data is only valid during the call. */
+typedef void (*pcfetcher_data_consumer)(purc_variant_t request_id,
+        void* ctxt, const char *data, size_t sz_data);
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -84,7 +100,9 @@ purc_variant_t pcfetcher_request_async(
         pcfetcher_response_handler handler,
         void* ctxt,
         pcfetcher_progress_tracker tracker,
-        void* tracker_ctxt);
+        void* tracker_ctxt,
+        pcfetcher_data_consumer consumer,
+        void* consumer_ctxt);
 
 purc_rwstream_t pcfetcher_request_sync(
         const char* url,
@@ -97,6 +115,26 @@ void pcfetcher_cancel_async(purc_variant_t request);
 
 int pcfetcher_check_response(uint32_t timeout_ms);
 
+bool pcfetcher_is_sql_uri(const char *uri);
+
+struct pcfetcher_sql_decoder *pcfetcher_sql_decoder_create(void);
+
+void pcfetcher_sql_decoder_destroy(struct pcfetcher_sql_decoder *decoder);
+
+/* Decodes the complete lines of a chunk and keeps the incomplete last one.
+   Returns the number of rows decoded, or -1 with the error set. */
+ssize_t pcfetcher_sql_decoder_feed(struct pcfetcher_sql_decoder *decoder,
+        const char *buf, size_t sz_buf);
+
+/* Returns the array of rows being filled, without a new reference. */
+purc_variant_t pcfetcher_sql_decoder_rows(
+        struct pcfetcher_sql_decoder *decoder);
+
+/* Decodes the rest and returns the whole document with the rows put back,
+   or PURC_VARIANT_INVALID with the error set. */
+purc_variant_t pcfetcher_sql_decoder_finish(
+        struct pcfetcher_sql_decoder *decoder);
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -45,6 +45,7 @@ typedef struct pcmodule pcmodule;
 typedef struct pcmodule *pcmodule_t;
 
 struct pcinst_msg_queue;
+struct pcvcm_eval_pool;
 
 typedef int (*module_init_once_f)(void);
 typedef int (*module_init_instance_f)(struct pcinst *curr_inst,
@@ -61,18 +62,56 @@ struct pcmodule {
     module_cleanup_instance_f  cleanup_instance;
 };
 
+#define PCINST_LEN_ERR_INFO     1023
+#define PCINST_MAX_ERR_ARGS     8
+
+/* an argument of the message recorded by purc_set_error_with_info();
+   the type is given by the conversion of the format */
+struct pcinst_err_arg {
+    union {
+        intmax_t            i;
+        uintmax_t           u;
+        /* the offset of a string copied into err_info */
+        size_t              off;
+    };
+};
+
 struct pcinst {
     int                     errcode;
     purc_atom_t             error_except;
     purc_variant_t          err_exinfo;
     struct pcvdom_element  *err_element;
 
+    /* where the last error was set; the backtrace is made of it only
+       when the error is read (see pcinst_settle_error()) */
+    const char             *err_file;
+    const char             *err_func;
+    int                     err_line;
+
+    /* the message of the exinfo which is made only when it is read:
+       the format (a literal) and the arguments, the strings of which are
+       copied into err_info; or the formatted message if err_fmt is NULL */
+    const char             *err_fmt;
+    struct pcinst_err_arg   err_args[PCINST_MAX_ERR_ARGS];
+    char                    err_info[PCINST_LEN_ERR_INFO + 1];
+
     unsigned int            modules;
     unsigned int            modules_inited;
 
     // flags go here
     unsigned int            enable_remote_fetcher:1;
     unsigned int            is_instmgr:1;
+    /* hosted by a runner worker thread instead of an own thread */
+    unsigned int            is_hosted:1;
+    unsigned int            hosted_stopped:1;
+    /* err_info is pending to be made as err_exinfo */
+    unsigned int            err_info_pending:1;
+    /* err_element and bt are pending to be made */
+    unsigned int            err_loc_pending:1;
+
+    /* the serial number of a hosted instance, which is the context of
+       the callbacks bound to the run loop of the worker */
+    uintptr_t               hosted_serial;
 
     char                   *app_name;
     char                   *runner_name;
@@ -101,6 +140,8 @@ struct pcinst {
 
     struct pcexecutor_heap *executor_heap;
     struct pcintr_heap     *intr_heap;
+    /* the reusable arrays of the VCM evaluator; see vcm/eval.c */
+    struct pcvcm_eval_pool *vcm_eval_pool;
     purc_runloop_t          running_loop;
 
     /* FIXME: enable the fields ONLY when NDEBUG is undefined */
@@ -111,6 +152,15 @@ PCA_EXTERN_C_BEGIN
 
 /* gets the current instance */
 struct pcinst* pcinst_current(void) WTF_INTERNAL;
+
+/* renames the current instance, which must have no coroutine yet;
+   the messages held in the move buffer are discarded. Returns an error
+   code; the renderer connection must be a headless one if any. */
+int pcinst_rename(const char *app_name, const char *runner_name) WTF_INTERNAL;
+
+/* makes the instance hosted by the calling thread current (NULL for
+   the own instance of the thread); returns the previous hosted one. */
+struct pcinst* pcinst_switch(struct pcinst *inst) WTF_INTERNAL;
 pcvarmgr_t pcinst_get_variables(void) WTF_INTERNAL;
 purc_variant_t pcinst_get_variable(const char* name);
 
@@ -123,6 +173,20 @@ pcinst_get_session_variables(const char* name)
 struct pcrdr_msg *pcinst_get_message(void) WTF_INTERNAL;
 void pcinst_put_message(struct pcrdr_msg *msg) WTF_INTERNAL;
 
+/* the function called after a message was moved to the move buffer of
+   the instance `owner`; it is called in the thread moving the message,
+   with the lock of the buffer held, so it must not access the buffer. */
+typedef void (*pcinst_move_buffer_wakeup_f)(purc_atom_t owner, void *ctxt);
+
+/* moves the move buffer of the instance `from` to the instance `to`, and
+   discards the messages held in it */
+int pcinst_rekey_move_buffer(purc_atom_t from, purc_atom_t to) WTF_INTERNAL;
+
+/* sets the wakeup function of the move buffer of the current instance;
+   no call of the old one is in progress when this returns. */
+int pcinst_set_move_buffer_wakeup(pcinst_move_buffer_wakeup_f wakeup,
+        void *ctxt) WTF_INTERNAL;
+
 int
 pcinst_broadcast_event(pcrdr_msg_event_reduce_opt reduce_op,
         purc_variant_t source_uri, purc_variant_t observed,
@@ -131,6 +195,14 @@ pcinst_broadcast_event(pcrdr_msg_event_reduce_opt reduce_op,
 
 void pcinst_clear_error(struct pcinst *inst) WTF_INTERNAL;
 
+/* makes the element, the backtrace and the exinfo of the last error of the
+   instance, which are only recorded when the error is set */
+void pcinst_settle_error(struct pcinst *inst) WTF_INTERNAL;
+
+/* gets the exinfo of the last error of the instance, making it from the
+   pending message set by purc_set_error_with_info() if need be */
+purc_variant_t pcinst_get_error_exinfo(struct pcinst *inst) WTF_INTERNAL;
+
 purc_atom_t
 pcinst_endpoint_get(char *endpoint_name, size_t sz,
         const char *app_name, const char *runner_name) WTF_INTERNAL;
@@ -79,6 +79,7 @@
 #define MSG_SUB_TYPE_CONN_LOST        "connLost"
 #define MSG_SUB_TYPE_OBSERVING        "observing"
 #define MSG_SUB_TYPE_PROGRESS         "progress"
+#define MSG_SUB_TYPE_ROWS             "rows"
 
 #define CRTN_TOKEN_MAIN               "_main"
 #define CRTN_TOKEN_FIRST              "_first"
@@ -118,6 +119,16 @@ struct pcintr_cancel {
     struct list_head             node;
 };
 
+struct pcintr_fetch_cache;
+
+struct pcintr_fetch_cache_stats {
+    size_t              nr_entries;
+    uint64_t            nr_hits;
+    uint64_t            nr_misses;
+    uint64_t            nr_revalidations;
+    uint64_t            nr_evictions;
+};
+
 struct pcintr_heap {
     // owner instance
     struct pcinst      *owner;
@@ -134,9 +145,18 @@ struct pcintr_heap {
     pcutils_map        *name_chan_map;  // name to channel map.
     pcutils_map        *token_crtn_map; // token to crtn map.
 
+    // cache of the parsed responses of `init` and `update`.
+    struct pcintr_fetch_cache *fetch_cache;
+
+    // bumped whenever a named variable is bound, unbound or replaced.
+    uint64_t            var_bindings_gen;
+
     purc_atom_t         move_buff;
     pcintr_timer_t     *event_timer;    // 10ms
 
+    // the timing wheel of the timers in $TIMERS of all coroutines.
+    struct pcintr_timers_wheel *timers_wheel;
+
     purc_cond_handler   cond_handler;
     unsigned int        keep_alive:1;
     double              timestamp;
@@ -238,6 +258,13 @@ struct pcintr_stack {
 
     struct pcvcm_eval_ctxt       *vcm_ctxt;
     int                           vcm_eval_pos;         // -1 content, 0~n attr
+
+    // the values of the constant containers of vDOM: node serial -> variant;
+    // at most PCVCM_MAX_CACHED_NODES entries
+    pcutils_map                  *vcm_const_values;
+    // the resolutions cached for the `getVariable` nodes: node serial -> site;
+    // at most PCVCM_MAX_CACHED_NODES entries
+    pcutils_map                  *vcm_var_sites;
     bool                          timeout;
 
     // for observe
@@ -323,6 +350,9 @@ struct pcintr_coroutine {
     struct list_head            ln_stopped;
     struct list_head            registered_cancels;
 
+    /* the shared channel on which this coroutine is parked */
+    struct pcchan_shared       *waiting_chan;
+
     struct pcinst_msg_queue    *mq;     /* message queue */
     struct list_head            tasks;  /* one event with multiple observers */
 
@@ -547,6 +577,12 @@ void pcintr_stop_coroutine(pcintr_coroutine_t crtn,
 /* resume the specific coroutine */
 void pcintr_resume_coroutine(pcintr_coroutine_t crtn) WTF_INTERNAL;
 
+/* Gets the statistics of the fetch cache of the current instance;
+   returns false if there is no cache yet. */
+bool
+pcintr_fetch_cache_get_stats(struct pcintr_fetch_cache_stats *stats)
+    WTF_INTERNAL;
+
 void pcintr_check_after_execution(void);
 void pcintr_set_current_co_with_location(pcintr_coroutine_t co,
         const char *file, int line, const char *func);
@@ -648,6 +684,21 @@ pcintr_get_scope_variable(purc_coroutine_t cor, pcvdom_element_t elem,
 purc_variant_t
 pcintr_find_named_var(pcintr_stack_t stack, const char* name);
 
+/* The resolution of a named variable cached by a reference site (e.g., a
+   `getVariable` node of VCM) in a stack. The value is not referenced: the
+   entry is only trusted while no binding changed and the frame chain is
+   the same. */
+struct pcintr_var_site {
+    uint64_t            gen;
+    uint64_t            chain;
+    pcvdom_element_t    pos;
+    purc_variant_t      value;
+};
+
+purc_variant_t
+pcintr_find_named_var_at(pcintr_stack_t stack, const char* name,
+        struct pcintr_var_site *site) WTF_INTERNAL;
+
 purc_variant_t
 pcintr_get_symbolized_var (pcintr_stack_t stack, unsigned int number,
         char symbol);
@@ -680,6 +731,11 @@ pcintr_timers_destroy(struct pcintr_timers* timers);
 bool
 pcintr_is_timers(purc_coroutine_t cor, purc_variant_t v);
 
+struct pcintr_timers_wheel;
+
+void
+pcintr_timers_wheel_destroy(struct pcintr_timers_wheel *wheel);
+
 // type:sub_type
 bool
 pcintr_parse_event(const char *event, purc_variant_t *type,
@@ -824,6 +880,16 @@ pcintr_coroutine_get_uri(pcintr_coroutine_t co)
 void
 pcintr_schedule(void *ctxt);
 
+/* runs the ready coroutines and dispatches the events of the instance once
+   without sleeping; returns true if there is more work to do right away. */
+bool
+pcintr_schedule_once(struct pcinst *inst);
+
+/* returns the time (see pcintr_get_current_time()) after which the next
+   idle event will be broadcast, or 0 if no coroutine observes idle events. */
+double
+pcintr_next_idle_event_time(struct pcinst *inst);
+
 void
 pcintr_coroutine_set_result(pcintr_coroutine_t co, purc_variant_t result);
 
@@ -105,6 +105,12 @@ pcrdr_check_operation(const char *op)
     return purc_atom_try_string_ex(ATOM_BUCKET_RDROP, op);
 }
 
+/* changes the names of the headless connection, and moves the default
+   log file after the names */
+int
+pcrdr_headless_rename(struct pcrdr_conn *conn, const char *app_name,
+        const char *runner_name) WTF_INTERNAL;
+
 int
 pcrdr_save_page_handle(struct pcrdr_conn *conn, const char *workspace_name,
         const char *group_name, const char *page_name, pcrdr_page_type_k page_type,
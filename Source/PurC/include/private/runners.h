@@ -70,6 +70,8 @@ struct instmgr_info {
     struct sorted_array *sa_insts;
 };
 
+struct pcinst;
+
 PCA_EXTERN_C_BEGIN
 
 pcrdr_msg *
@@ -86,6 +88,23 @@ pcrun_create_inst_thread(const char *app_name, const char *runner_name,
 void
 pcrun_instmgr_handle_message(void *ctxt) WTF_INTERNAL;
 
+/* claims a pre-warmed instance of the app, renames it after the runner
+   and starts it; returns 0 if there is no suitable instance. */
+purc_atom_t
+pcrun_claim_warm_instance(const char *app_name, const char *runner_name,
+        purc_cond_handler cond_handler,
+        struct purc_instance_extra_info *extra_info, void **th) WTF_INTERNAL;
+
+/* warms up instances of the app in background to fill its pool */
+void
+pcrun_replenish_warm_instances(const char *app_name,
+        const struct purc_instance_extra_info *extra_info) WTF_INTERNAL;
+
+/* stops the run loop of the instance, or retires the instance
+   if it is hosted by a runner worker */
+void
+pcrun_stop_running_loop(struct pcinst *inst) WTF_INTERNAL;
+
 void
 pcrun_notify_instmgr(const char* event, purc_atom_t inst_crtn_id) WTF_INTERNAL;
 
@@ -25,5 +25,34 @@
 #ifndef PURC_PRIVATE_RWSTREAM_H
 #define PURC_PRIVATE_RWSTREAM_H
 
+#include "config.h"
+#include "purc-rwstream.h"
+
+/* Regular files at least this large are mapped instead of read via stdio. */
+#define PCRWSTREAM_MAP_THRESHOLD        (64 * 1024)
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+/* Creates a read-only stream for a local file: a memory-mapped stream if
+ * the file is a regular one not smaller than PCRWSTREAM_MAP_THRESHOLD,
+ * otherwise a stdio stream. */
+purc_rwstream_t
+pcrwstream_new_from_file_for_read(const char *file) WTF_INTERNAL;
+
+typedef void (*pcrws_cb_release)(void *ctxt);
+
+/* Creates a read-only memory stream over a buffer shared with its owner,
+ * e.g., a cache; `release` is called with `ctxt` when the stream is
+ * destroyed, so that the owner can drop its reference to the buffer. */
+purc_rwstream_t
+pcrwstream_new_view(const void *mem, size_t sz,
+        pcrws_cb_release release, void *ctxt) WTF_INTERNAL;
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
 #endif /* not defined PURC_PRIVATE_RWSTREAM_H */
 
@@ -40,6 +40,8 @@ PCA_EXTERN_C_BEGIN
 #define PCVRNT_FLAG_NOFREE          PCVRNT_FLAG_CONSTANT
 #define PCVRNT_FLAG_EXTRA_SIZE      (0x01 << 1)  // when use extra space
 #define PCVRNT_FLAG_STRING_STATIC   (0x01 << 2)  // make_string_static
+#define PCVRNT_FLAG_KEY_INTERNED    (0x01 << 3)  // interned object key
+#define PCVRNT_FLAG_STRING_SHARED   (0x01 << 4)  // in an append-only buffer
 
 #define PVT(t)          (PURC_VARIANT_TYPE##t)
 #define IS_CONTAINER(t) (t == PURC_VARIANT_TYPE_OBJECT || \
@@ -211,10 +213,15 @@ struct pcvariant_heap {
 #else
     struct list_head    v_reserved;
 #endif
+
+    // the interned keys of objects: string -> key variant (weak references)
+    pcutils_uomap      *obj_keys;
 };
 
 // internal interfaces for moving variant.
 purc_variant_t pcvariant_move_heap_in(purc_variant_t v) WTF_INTERNAL;
+purc_variant_t pcvariant_move_heap_in_borrowed(purc_variant_t v,
+        bool *cloned) WTF_INTERNAL;
 purc_variant_t pcvariant_move_heap_out(purc_variant_t v) WTF_INTERNAL;
 
 void pcvariant_use_move_heap(void) WTF_INTERNAL;
@@ -317,6 +324,19 @@ int pcvariant_array_sort(purc_variant_t value, void *ud,
 int pcvariant_set_sort(purc_variant_t value, void *ud,
         int (*cmp)(purc_variant_t l, purc_variant_t r, void *ud));
 
+/* Sort the members of an array or a set by the keys which `get_key` computes
+ * once per member; `cmp` compares two keys. `get_key` returns NULL only
+ * when out of memory. The keys of a long container are sorted by multiple
+ * threads, so `cmp` should only read the keys and `ud`. */
+int pcvariant_array_sort_by_keys(purc_variant_t value, void *ud,
+        void *(*get_key)(purc_variant_t member, void *ud),
+        int (*cmp)(const void *l, const void *r, void *ud),
+        void (*free_key)(void *key));
+int pcvariant_set_sort_by_keys(purc_variant_t value, void *ud,
+        void *(*get_key)(purc_variant_t member, void *ud),
+        int (*cmp)(const void *l, const void *r, void *ud),
+        void (*free_key)(void *key));
+
 int pcvariant_diff(purc_variant_t l, purc_variant_t r);
 int pcvariant_diff_ex(purc_variant_t l, purc_variant_t r,
         enum pcvrnt_compare_method opt);
@@ -371,6 +391,18 @@ char* pcvariant_to_string(purc_variant_t v);
 
 purc_variant_t pcvariant_make_object(size_t nr_kvs, ...);
 
+// return the interned string variant for a key of objects (a new reference)
+purc_variant_t pcvariant_make_object_key(const char *key, bool check_encoding);
+
+// set a member of an object, using the interned key equal to the given one
+bool pcvariant_object_set_with_shared_key(purc_variant_t obj,
+        purc_variant_t key, purc_variant_t val);
+
+// return a new string variant holding the string followed by the bytes;
+// the result shares the append-only buffer of the string when possible
+purc_variant_t pcvariant_string_append(purc_variant_t string,
+        const char *bytes, size_t len, bool check_encoding);
+
 WTF_ATTRIBUTE_PRINTF(1, 2)
 purc_variant_t pcvariant_make_with_printf(const char *fmt, ...);
 
@@ -36,6 +36,8 @@
 #define EXTRA_NULL                                  0x0000
 #define EXTRA_PROTECT_FLAG                          0x0001
 #define EXTRA_SUGAR_FLAG                            0x0002
+/* the largest container made only of literals, see pcvcm_node_mark_const() */
+#define EXTRA_CONST_FLAG                            0x0004
 
 #define PCVCM_EV_DEFAULT_METHOD_NAME                "eval"
 #define PCVCM_EV_CONST_SUFFIX                       "_const"
@@ -103,10 +105,17 @@ enum pcvcm_node_type {
 #define PCVCM_NODE_TYPE_NR \
     (PCVCM_NODE_TYPE_LAST - PCVCM_NODE_TYPE_FIRST + 1)
 
+/* the maximal number of nodes of which a stack caches the values
+   or the variable resolutions */
+#define PCVCM_MAX_CACHED_NODES      1024
+
 struct pcvcm_node {
     struct pctree_node tree_node;
     enum pcvcm_node_type type;
     uint32_t extra;
+    /* unique in the process, unlike the address of a node freed and
+       then reused; it keys what a stack caches for the node */
+    uint64_t serial;
     uintptr_t attach;
     int32_t   idx;
     int32_t   nr_nodes; /* nr_nodes of the tree */
@@ -261,6 +270,14 @@ char *pcvcm_node_serialize(struct pcvcm_node *node, size_t *nr_bytes);
  */
 void pcvcm_node_destroy(struct pcvcm_node *root);
 
+/*
+ * Marks the largest non-empty objects, arrays and tuples of the tree which
+ * contain only literals with EXTRA_CONST_FLAG, so that their values can be
+ * built once and copied by the evaluator. This should be called before the
+ * tree is shared, e.g., when the vDOM is constructed.
+ */
+void pcvcm_node_mark_const(struct pcvcm_node *root);
+
 
 typedef purc_variant_t(*find_var_fn) (void *ctxt, const char *name);
 
@@ -289,6 +306,12 @@ purc_variant_t pcvcm_eval_sub_expr(struct pcvcm_node *tree,
 void
 pcvcm_eval_ctxt_destroy(struct pcvcm_eval_ctxt *ctxt);
 
+struct pcvcm_eval_pool;
+
+/* Frees the arrays kept by the evaluator for reuse in an instance. */
+void
+pcvcm_eval_pool_destroy(struct pcvcm_eval_pool *pool);
+
 int
 pcvcm_eval_ctxt_error_code(struct pcvcm_eval_ctxt *ctxt);
 
@@ -87,6 +87,27 @@ PCA_EXPORT purc_rwstream_t purc_rwstream_new_from_mem (void* mem, size_t sz);
 PCA_EXPORT purc_rwstream_t
 purc_rwstream_new_from_file (const char* file, const char* mode);
 
+/**
+ * Creates a new read-only purc_rwstream_t by mapping the whole given file
+ * into memory. Reading from the stream copies straight out of the page
+ * cache, and @purc_rwstream_get_mem_buffer returns the mapping itself
+ * without copying the content (note that it is not null-terminated).
+ *
+ * On a platform without mmap(), this function falls back to
+ * @purc_rwstream_new_from_file with mode "r".
+ *
+ * @param file: the file will be mapped
+ *
+ * @return A purc_rwstream_t on success, @NULL on failure and the error code
+ *         is set to indicate the error. The error code:
+ *  - @PURC_ERROR_BAD_SYSTEM_CALL: Bad system call
+ *  - @PURC_ERROR_OUT_OF_MEMORY: Out of memory
+ *
+ * Since: 0.9.6
+ */
+PCA_EXPORT purc_rwstream_t
+purc_rwstream_new_from_file_mapped (const char* file);
+
 /**
  * Creates a new purc_rwstream_t for the given FILE pointer.
  *
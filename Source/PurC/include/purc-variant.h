@@ -326,8 +326,14 @@ purc_variant_make_string_ex(const char* str_utf8, size_t len,
  * Note that you should not change the contents in the buffer
  * pointed to by the return value.
  *
+ * A string made by appending to another one may share the buffer of that
+ * string, and is copied to a buffer of its own when its contents are got
+ * for the first time. So this function may fail for a valid string under
+ * memory pressure.
+ *
  * Returns: The pointer to the string in UTF-8 encoding, or %NULL if
- *      the variant does not respresent a string, an atom, or an exception.
+ *      the variant does not respresent a string, an atom, or an exception,
+ *      or if out of memory (%PURC_ERROR_OUT_OF_MEMORY).
  *
  * Since: 0.1.0
  */
@@ -346,7 +352,8 @@ purc_variant_get_string_const_ex(purc_variant_t value, size_t *length);
  * pointed to by the return value.
  *
  * Returns: The pointer to the string in UTF-8 encoding, or %NULL if
- *      the variant does not respresent a string, an atom, or an exception.
+ *      the variant does not respresent a string, an atom, or an exception,
+ *      or if out of memory (see purc_variant_get_string_const_ex()).
  *
  * Since: 0.0.1
  */
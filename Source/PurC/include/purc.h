@@ -834,6 +834,31 @@ purc_get_rid_by_cid(purc_atom_t cid);
 PCA_EXPORT purc_atom_t
 purc_get_instmgr_rid(void);
 
+#define PURC_ENVV_RUNNER_WORKERS    "PURC_RUNNER_WORKERS"
+#define PURC_ENVV_RUNNER_POOL_SIZE  "PURC_RUNNER_POOL_SIZE"
+#define PURC_ENVV_FETCH_CACHE_TTL   "PURC_FETCH_CACHE_TTL"
+
+/**
+ * purc_get_warm_runner_stats:
+ *
+ * @nr_hits (nullable): The buffer to receive the number of the instances
+ *      created by claiming a pre-warmed instance.
+ * @nr_misses (nullable): The buffer to receive the number of the instances
+ *      created when no pre-warmed instance could be claimed.
+ * @nr_warm (nullable): The buffer to receive the number of the pre-warmed
+ *      instances waiting for a claim.
+ *
+ * Gets the statistics of the pools of the pre-warmed instances, which are
+ *  enabled by the environment variable `PURC_RUNNER_POOL_SIZE`.
+ *
+ * Returns: 0 for success; -1 if the pools are not enabled.
+ *
+ * Since 0.9.6
+ */
+PCA_EXPORT int
+purc_get_warm_runner_stats(unsigned *nr_hits, unsigned *nr_misses,
+        unsigned *nr_warm);
+
 /**
  * purc_inst_create_or_get:
  *
@@ -849,6 +874,18 @@ purc_get_instmgr_rid(void);
  * Creates a new PurC instance or gets the atom value of the existing
  * PurC instance.
  *
+ * By default, every new instance runs in its own thread. If the environment
+ * variable `PURC_RUNNER_WORKERS` is set to a positive number (since 0.9.6),
+ * the new instances are hosted by a fixed pool of that many worker threads
+ * instead; a worker runs the coroutines of its instances in turn and sleeps
+ * when all of them are idle.
+ *
+ * If the environment variable `PURC_RUNNER_POOL_SIZE` is set to a positive
+ * number (since 0.9.6), the instance manager keeps up to that many idle
+ * instances initialized in background for every app which has created
+ * a runner, and a new headless instance without a workspace claims one of
+ * them and takes the runner name instead of being initialized from scratch.
+ *
  * Returns: The atom representing the new PurC instance, 0 for error.
  *
  * Since 0.2.0
@@ -33,6 +33,8 @@
 #include "private/interpreter.h" // FIXME:
 
 #include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
 #include <errno.h>
 
 #ifndef NDEBUG                     /* { */
@@ -209,9 +211,9 @@ int purc_get_last_error(void)
 
 purc_variant_t purc_get_last_error_ex(void)
 {
-    const struct pcinst* inst = pcinst_current();
+    struct pcinst* inst = pcinst_current();
     if (inst) {
-        return inst->err_exinfo;
+        return pcinst_get_error_exinfo(inst);
     }
 
     return PURC_VARIANT_INVALID;
@@ -318,18 +320,33 @@ set_error_exinfo_with_debug(int errcode, purc_variant_t exinfo,
     inst->errcode = errcode;
     PURC_VARIANT_SAFE_CLEAR(inst->err_exinfo);
     inst->err_exinfo = exinfo;
+    inst->err_info_pending = 0;
+    inst->err_loc_pending = 0;
 
     inst->err_element = NULL;
 
-    pcintr_stack_t stack = pcintr_get_stack();
-    if (stack) {
-        struct pcintr_stack_frame *frame;
-        frame = pcintr_stack_get_bottom_frame(stack);
-        if (frame) {
-            inst->err_element = frame->pos;
-        }
+    /* clearing the error is on the hot path of every successful lookup:
+       there is no location or backtrace worth recording for it. */
+    if (errcode == PURC_ERROR_OK && exinfo == PURC_VARIANT_INVALID) {
+        const struct err_msg_info* info = get_error_info(errcode);
+        if (info)
+            inst->error_except = info->except_atom;
+        return PURC_ERROR_OK;
     }
 
+    /* the element is taken at once, since the frame may be popped before
+       the error is read; the backtrace is made by pcinst_settle_error() */
+    struct pcintr_heap *heap = inst->intr_heap;
+    pcintr_coroutine_t co = heap ? heap->running_coroutine : NULL;
+    struct pcintr_stack_frame *frame;
+    frame = co ? pcintr_stack_get_bottom_frame(&co->stack) : NULL;
+    inst->err_element = frame ? frame->pos : NULL;
+
+    inst->err_file = file;
+    inst->err_line = line;
+    inst->err_func = func;
+    inst->err_loc_pending = 1;
+
     const struct err_msg_info* info = get_error_info(errcode);
     if (info == NULL ||
             ((info->flags & PURC_EXCEPT_FLAGS_REQUIRED) && !exinfo)) {
@@ -341,8 +358,6 @@ set_error_exinfo_with_debug(int errcode, purc_variant_t exinfo,
         inst->error_except = info->except_atom;
     }
 
-    backtrace_snapshot(inst, file, line, func);
-
     return PURC_ERROR_OK;
 #undef PRINT_ERRCODE
 }
@@ -355,33 +370,253 @@ purc_set_error_exinfo_with_debug(int errcode, purc_variant_t exinfo,
     return set_error_exinfo_with_debug(errcode, exinfo, file, lineno, func);
 }
 
+/*
+ * The message of purc_set_error_with_info() is not formatted when the error
+ * is set, since many callers are probes expecting a miss, which clear the
+ * error at once. Only the plain conversions used in the tree are recorded:
+ * %s, %c, and %d, %i, %u, %x with the length modifiers l, ll and z. A format
+ * with anything else (flags, width, precision, floats) is formatted at once.
+ */
+
+/* parses the conversion after a '%' and advances fmt over it; returns the
+   conversion character, or 0 for one which is not recorded */
+static char
+next_err_conv(const char **fmt, char *length)
+{
+    const char *p = *fmt;
+
+    *length = 0;
+    if (*p == 'l') {
+        *length = 'l';
+        if (*++p == 'l') {
+            *length = 'q';
+            p++;
+        }
+    }
+    else if (*p == 'z') {
+        *length = 'z';
+        p++;
+    }
+
+    switch (*p) {
+    case 'd': case 'i': case 'u': case 'x':
+        break;
+    case 's': case 'c': case '%':
+        if (*length)
+            return 0;
+        break;
+    default:
+        return 0;
+    }
+
+    *fmt = p + 1;
+    return *p;
+}
+
+static intmax_t
+fetch_signed_arg(char length, va_list *ap)
+{
+    switch (length) {
+    case 'l':
+        return va_arg(*ap, long);
+    case 'q':
+        return va_arg(*ap, long long);
+    case 'z':
+        return va_arg(*ap, ssize_t);
+    default:
+        return va_arg(*ap, int);
+    }
+}
+
+static uintmax_t
+fetch_unsigned_arg(char length, va_list *ap)
+{
+    switch (length) {
+    case 'l':
+        return va_arg(*ap, unsigned long);
+    case 'q':
+        return va_arg(*ap, unsigned long long);
+    case 'z':
+        return va_arg(*ap, size_t);
+    default:
+        return va_arg(*ap, unsigned int);
+    }
+}
+
+/* records the arguments; returns false if the format is not supported or
+   the arguments do not fit, to format the message at once instead */
+static bool
+record_err_args(struct pcinst *inst, const char *fmt, va_list *ap)
+{
+    size_t nr_args = 0;
+    size_t len_strs = 0;
+    char length;
+
+    while ((fmt = strchr(fmt, '%'))) {
+        fmt++;
+        char conv = next_err_conv(&fmt, &length);
+        if (conv == 0)
+            return false;
+        if (conv == '%')
+            continue;
+
+        if (nr_args == PCINST_MAX_ERR_ARGS)
+            return false;
+
+        struct pcinst_err_arg *arg = inst->err_args + nr_args++;
+        switch (conv) {
+        case 'd': case 'i':
+            arg->i = fetch_signed_arg(length, ap);
+            break;
+
+        case 'u': case 'x':
+            arg->u = fetch_unsigned_arg(length, ap);
+            break;
+
+        case 'c':
+            arg->i = va_arg(*ap, int);
+            break;
+
+        case 's': {
+            const char *str = va_arg(*ap, const char *);
+            if (str == NULL)
+                str = "(null)";
+
+            size_t len = strlen(str);
+            if (len_strs + len + 1 > sizeof(inst->err_info))
+                return false;
+
+            memcpy(inst->err_info + len_strs, str, len + 1);
+            arg->off = len_strs;
+            len_strs += len + 1;
+            break;
+        }
+        }
+    }
+
+    return true;
+}
+
+/* formats the message recorded by record_err_args() into buf */
+static void
+format_err_info(struct pcinst *inst, char *buf, size_t sz)
+{
+    const char *fmt = inst->err_fmt;
+    const struct pcinst_err_arg *arg = inst->err_args;
+    size_t len = 0;
+    char length;
+
+    while (*fmt && len < sz - 1) {
+        if (*fmt != '%') {
+            buf[len++] = *fmt++;
+            continue;
+        }
+
+        fmt++;
+        char *out = buf + len;
+        size_t left = sz - len;
+        int r;
+
+        /* the integers are recorded in the widest types */
+        switch (next_err_conv(&fmt, &length)) {
+        case '%':
+            r = snprintf(out, left, "%%");
+            break;
+        case 'c':
+            r = snprintf(out, left, "%c", (int)(arg++)->i);
+            break;
+        case 's':
+            r = snprintf(out, left, "%s", inst->err_info + (arg++)->off);
+            break;
+        case 'u':
+            r = snprintf(out, left, "%ju", (arg++)->u);
+            break;
+        case 'x':
+            r = snprintf(out, left, "%jx", (arg++)->u);
+            break;
+        default:
+            r = snprintf(out, left, "%jd", (arg++)->i);
+            break;
+        }
+
+        if (r < 0)
+            break;
+        len += ((size_t)r < left) ? (size_t)r : left - 1;
+    }
+
+    buf[len] = '\0';
+}
+
 int
 purc_set_error_with_info_debug(int err_code,
         const char *file, int lineno, const char *func,
         const char *fmt, ...)
 {
-    char buf[1024];
+    struct pcinst* inst = pcinst_current();
+    if (inst == NULL) {
+        _noinst_errcode = err_code;
+        return PURC_ERROR_NO_INSTANCE;
+    }
 
+    int r = set_error_exinfo_with_debug(err_code, PURC_VARIANT_INVALID,
+            file, lineno, func);
+
+    /* the format is a literal given by purc_set_error_with_info() */
     va_list ap;
     va_start(ap, fmt);
-    int r = vsnprintf(buf, sizeof(buf), fmt, ap);
-    // TODO: remove below 2 lines
-    PC_ASSERT(r >= 0);
-    PC_ASSERT((size_t)r < sizeof(buf));
-    (void)r;
+    bool recorded = record_err_args(inst, fmt, &ap);
     va_end(ap);
 
-    purc_variant_t v;
-    // FIXME: set-error-recursive
-    v = purc_variant_make_string(buf, true);
-    PC_ASSERT(v != PURC_VARIANT_INVALID);
-
-    r = set_error_exinfo_with_debug(err_code, v,
-            file, lineno, func);
+    if (recorded) {
+        inst->err_fmt = fmt;
+    }
+    else {
+        va_start(ap, fmt);
+        int n = vsnprintf(inst->err_info, sizeof(inst->err_info), fmt, ap);
+        va_end(ap);
+        PC_ASSERT(n >= 0 && (size_t)n < sizeof(inst->err_info));
+        (void)n;
+        inst->err_fmt = NULL;
+    }
 
+    inst->err_info_pending = 1;
     return r;
 }
 
+void pcinst_settle_error(struct pcinst *inst)
+{
+    if (inst->err_loc_pending) {
+        inst->err_loc_pending = 0;
+        backtrace_snapshot(inst, inst->err_file, inst->err_line,
+                inst->err_func);
+    }
+
+    if (inst->err_info_pending) {
+        inst->err_info_pending = 0;
+
+        purc_variant_t v;
+        if (inst->err_fmt) {
+            char buf[PCINST_LEN_ERR_INFO + 1];
+            format_err_info(inst, buf, sizeof(buf));
+            v = purc_variant_make_string(buf, true);
+        }
+        else {
+            v = purc_variant_make_string(inst->err_info, true);
+        }
+
+        if (v != PURC_VARIANT_INVALID) {
+            PURC_VARIANT_SAFE_CLEAR(inst->err_exinfo);
+            inst->err_exinfo = v;
+        }
+    }
+}
+
+purc_variant_t pcinst_get_error_exinfo(struct pcinst *inst)
+{
+    pcinst_settle_error(inst);
+    return inst->err_exinfo;
+}
+
 static LIST_HEAD(_err_msg_seg_list);
 
 /* Error Messages */
@@ -856,14 +1091,14 @@ pcinst_dump_err_except_info(purc_variant_t err_except_info)
 void
 pcinst_dump_err_info(void)
 {
-    const struct pcinst* inst = pcinst_current();
+    struct pcinst* inst = pcinst_current();
     if (!inst) {
         fprintf(stderr, "warning: NO instance at all\n");
         return;
     }
 
     purc_atom_t     error_except    = inst->error_except;
-    purc_variant_t  err_except_info = inst->err_exinfo;
+    purc_variant_t  err_except_info = pcinst_get_error_exinfo(inst);
     struct pcdebug_backtrace *bt    = inst->bt;
 
     if (bt) {
@@ -35,6 +35,7 @@
 #include "private/ejson.h"
 #include "private/html.h"
 #include "private/vdom.h"
+#include "private/vcm.h"
 #include "private/dom.h"
 #include "private/dvobjs.h"
 #include "private/executor.h"
@@ -324,10 +325,33 @@ static inline void init_once(void)
 
 PURC_DEFINE_THREAD_LOCAL(struct pcinst, inst);
 
+/* the instance hosted by the runner worker which is the calling thread */
+PURC_DEFINE_THREAD_LOCAL(struct pcinst *, hosted_inst);
+
+static struct pcinst *inst_storage(void)
+{
+    struct pcinst **hosted = PURC_GET_THREAD_LOCAL(hosted_inst);
+    if (hosted && *hosted)
+        return *hosted;
+
+    return PURC_GET_THREAD_LOCAL(inst);
+}
+
+struct pcinst* pcinst_switch(struct pcinst *inst)
+{
+    struct pcinst **hosted = PURC_GET_THREAD_LOCAL(hosted_inst);
+    if (hosted == NULL)
+        return NULL;
+
+    struct pcinst *old = *hosted;
+    *hosted = inst;
+    return old;
+}
+
 struct pcinst* pcinst_current(void)
 {
     struct pcinst* curr_inst;
-    curr_inst = PURC_GET_THREAD_LOCAL(inst);
+    curr_inst = inst_storage();
 
     if (curr_inst == NULL || curr_inst->app_name == NULL) {
         return NULL;
@@ -391,6 +415,8 @@ static int init_modules(struct pcinst *curr_inst,
 static void cleanup_modules(struct pcinst *curr_inst)
 {
     PURC_VARIANT_SAFE_CLEAR(curr_inst->err_exinfo);
+    curr_inst->err_info_pending = 0;
+    curr_inst->err_loc_pending = 0;
 
     // cleanup modules
     for (size_t i = PCA_TABLESIZE(_pc_modules); i > 0; ) {
@@ -419,6 +445,11 @@ static void cleanup_instance(struct pcinst *curr_inst)
         curr_inst->bt = NULL;
     }
 
+    if (curr_inst->vcm_eval_pool) {
+        pcvcm_eval_pool_destroy(curr_inst->vcm_eval_pool);
+        curr_inst->vcm_eval_pool = NULL;
+    }
+
     purc_atom_remove_string_ex(PURC_ATOM_BUCKET_DEF,
             curr_inst->endpoint_name);
 
@@ -502,7 +533,7 @@ int purc_init_ex(unsigned int modules,
     if (!_init_ok)
         return PURC_ERROR_NO_INSTANCE;
 
-    struct pcinst *curr_inst = PURC_GET_THREAD_LOCAL(inst);
+    struct pcinst *curr_inst = inst_storage();
     if (curr_inst == NULL) {
         return PURC_ERROR_OUT_OF_MEMORY;
     }
@@ -574,7 +605,7 @@ bool purc_cleanup(void)
 {
     struct pcinst* curr_inst;
 
-    curr_inst = PURC_GET_THREAD_LOCAL(inst);
+    curr_inst = inst_storage();
     if (curr_inst == NULL || curr_inst->app_name == NULL)
         return false;
 
@@ -590,7 +621,7 @@ const char *purc_get_endpoint(purc_atom_t *atom)
 {
     struct pcinst* curr_inst;
 
-    curr_inst = PURC_GET_THREAD_LOCAL(inst);
+    curr_inst = inst_storage();
     if (curr_inst == NULL || curr_inst->app_name == NULL
             || curr_inst->endpoint_atom == 0)
         return NULL;
@@ -600,6 +631,84 @@ const char *purc_get_endpoint(purc_atom_t *atom)
     return curr_inst->endpoint_name;
 }
 
+int
+pcinst_rename(const char *app_name, const char *runner_name)
+{
+    struct pcinst *curr_inst = pcinst_current();
+    if (curr_inst == NULL)
+        return PURC_ERROR_NO_INSTANCE;
+
+    if (!purc_is_valid_app_name(app_name) ||
+            !purc_is_valid_runner_name(runner_name))
+        return PURC_ERROR_INVALID_VALUE;
+
+    char endpoint_name[PURC_LEN_ENDPOINT_NAME + 1];
+    int n = purc_assemble_endpoint_name_ex(PCRDR_LOCALHOST,
+            app_name, runner_name, endpoint_name, sizeof(endpoint_name));
+    if (n == 0)
+        return PURC_ERROR_INVALID_VALUE;
+    if ((size_t)n >= sizeof(endpoint_name))
+        return PURC_ERROR_TOO_SMALL_BUFF;
+
+    bool is_mine;
+    purc_atom_t atom = purc_atom_from_string_ex2(PURC_ATOM_BUCKET_DEF,
+            endpoint_name, &is_mine);
+    if (!is_mine)
+        return PURC_ERROR_DUPLICATED;
+
+    char *new_app = strdup(app_name);
+    char *new_runner = strdup(runner_name);
+    if (new_app == NULL || new_runner == NULL) {
+        free(new_app);
+        free(new_runner);
+        purc_atom_remove_string_ex(PURC_ATOM_BUCKET_DEF, endpoint_name);
+        return PURC_ERROR_OUT_OF_MEMORY;
+    }
+
+    int ret = pcinst_rekey_move_buffer(curr_inst->endpoint_atom, atom);
+    if (ret && ret != PURC_ERROR_NOT_EXISTS)
+        goto failed;
+
+    if (curr_inst->conn_to_rdr) {
+        /* the renderer connection refers to the names */
+        ret = pcrdr_headless_rename(curr_inst->conn_to_rdr,
+                new_app, new_runner);
+        if (ret) {
+            pcinst_rekey_move_buffer(atom, curr_inst->endpoint_atom);
+            goto failed;
+        }
+    }
+
+    if (curr_inst->intr_heap &&
+            curr_inst->intr_heap->move_buff == curr_inst->endpoint_atom)
+        curr_inst->intr_heap->move_buff = atom;
+
+    purc_atom_remove_string_ex(PURC_ATOM_BUCKET_DEF,
+            curr_inst->endpoint_name);
+    strcpy(curr_inst->endpoint_name, endpoint_name);
+    curr_inst->endpoint_atom = atom;
+
+    free(curr_inst->app_name);
+    free(curr_inst->runner_name);
+    curr_inst->app_name = new_app;
+    curr_inst->runner_name = new_runner;
+
+    /* reopen the log file named after the app and the runner */
+    if (curr_inst->fp_log && curr_inst->fp_log != LOG_FILE_SYSLOG) {
+        fclose(curr_inst->fp_log);
+        curr_inst->fp_log = NULL;
+        purc_enable_log(true, false);
+    }
+
+    return PURC_ERROR_OK;
+
+failed:
+    free(new_app);
+    free(new_runner);
+    purc_atom_remove_string_ex(PURC_ATOM_BUCKET_DEF, endpoint_name);
+    return ret;
+}
+
 bool
 purc_set_local_data(const char* data_name, uintptr_t local_data,
         cb_free_local_data cb_free)
@@ -712,6 +821,8 @@ void pcinst_clear_error(struct pcinst *inst)
 
     inst->errcode = 0;
     PURC_VARIANT_SAFE_CLEAR(inst->err_exinfo);
+    inst->err_info_pending = 0;
+    inst->err_loc_pending = 0;
 
     if (inst->bt) {
         pcdebug_backtrace_unref(inst->bt);
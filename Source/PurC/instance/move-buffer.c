@@ -56,6 +56,10 @@ struct pcinst_move_buffer {
     unsigned int        flags;
     size_t              max_nr_msgs;
     size_t              nr_msgs;
+
+    /* called after a message was moved in */
+    pcinst_move_buffer_wakeup_f wakeup;
+    void               *wakeup_ctxt;
 };
 
 /* the header of the struct pcrdr_msg */
@@ -212,6 +216,8 @@ purc_inst_create_move_buffer(unsigned int flags, size_t max_msgs)
 
     mb->flags = flags;
     mb->nr_msgs = 0;
+    mb->wakeup = NULL;
+    mb->wakeup_ctxt = NULL;
     mb->max_nr_msgs = (max_msgs > 0) ? max_msgs : NR_DEF_MAX_MSGS;
     list_head_init(&mb->msgs);
 
@@ -323,8 +329,13 @@ do_move_message(struct pcinst* inst, pcrdr_msg *msg)
     hdr->origin = inst->endpoint_atom;
 
     for (int i = 0; i < PCRDR_NR_MSG_VARIANTS; i++) {
-        if (msg->variants[i])
-            msg->variants[i] = pcvariant_move_heap_in(msg->variants[i]);
+        if (msg->variants[i]) {
+            purc_variant_t v = pcvariant_move_heap_in(msg->variants[i]);
+            /* the variant is dropped from the message if out of memory */
+            if (v == PURC_VARIANT_INVALID)
+                purc_variant_unref(msg->variants[i]);
+            msg->variants[i] = v;
+        }
     }
 }
 
@@ -375,15 +386,19 @@ purc_inst_move_message(purc_atom_t inst_to, pcrdr_msg *msg)
         struct pcrdr_msg_hdr *hdr = (struct pcrdr_msg_hdr *)msg;
         list_add_tail(&hdr->ln, &mb->msgs);
         mb->nr_msgs++;
+        /* call it with the lock held, so that the context is still valid
+           when the owner resets the function */
+        if (mb->wakeup)
+            mb->wakeup(inst_to, mb->wakeup_ctxt);
         purc_rwlock_writer_unlock(&mb->lock);
-
         nr++;
     }
     else {
         size_t count = pcutils_sorted_array_count(mb_atom2buff_map);
 
         for (size_t i = 0; i < count; i++) {
-            pcutils_sorted_array_get(mb_atom2buff_map, i, (void **)&mb);
+            const void *owner = pcutils_sorted_array_get(mb_atom2buff_map, i,
+                    (void **)&mb);
             if (mb->flags & PCINST_MOVE_BUFFER_BROADCAST &&
                     mb->nr_msgs < mb->max_nr_msgs) {
 
@@ -410,6 +425,8 @@ purc_inst_move_message(purc_atom_t inst_to, pcrdr_msg *msg)
                 struct pcrdr_msg_hdr *hdr = (struct pcrdr_msg_hdr *)my_msg;
                 list_add_tail(&hdr->ln, &mb->msgs);
                 mb->nr_msgs++;
+                if (mb->wakeup)
+                    mb->wakeup((purc_atom_t)(uintptr_t)owner, mb->wakeup_ctxt);
                 purc_rwlock_writer_unlock(&mb->lock);
                 nr++;
             }
@@ -426,6 +443,90 @@ done:
     return nr;
 }
 
+int
+pcinst_rekey_move_buffer(purc_atom_t from, purc_atom_t to)
+{
+    int errcode = 0;
+    struct pcinst_move_buffer *mb;
+
+    purc_rwlock_writer_lock(&mb_lock);
+
+    if (!pcutils_sorted_array_find(mb_atom2buff_map,
+                (void *)(uintptr_t)from, (void **)&mb, NULL)) {
+        errcode = PURC_ERROR_NOT_EXISTS;
+        goto done;
+    }
+
+    if (pcutils_sorted_array_find(mb_atom2buff_map,
+                (void *)(uintptr_t)to, NULL, NULL)) {
+        errcode = PURC_ERROR_DUPLICATED;
+        goto done;
+    }
+
+    pcutils_sorted_array_remove(mb_atom2buff_map, (void *)(uintptr_t)from);
+    if (pcutils_sorted_array_add(mb_atom2buff_map,
+                (void *)(uintptr_t)to, mb, NULL) < 0) {
+        pcutils_sorted_array_add(mb_atom2buff_map,
+                (void *)(uintptr_t)from, mb, NULL);
+        errcode = PURC_ERROR_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    /* the messages were sent to the old owner */
+    struct list_head *p, *n;
+    purc_rwlock_writer_lock(&mb->lock);
+    pcvariant_use_move_heap();
+    list_for_each_safe(p, n, &mb->msgs) {
+        struct pcrdr_msg_hdr *hdr;
+
+        hdr = list_entry(p, struct pcrdr_msg_hdr, ln);
+        list_del(p);
+        mb->nr_msgs--;
+        pcinst_grind_message((pcrdr_msg *)hdr);
+    }
+    pcvariant_use_norm_heap();
+    purc_rwlock_writer_unlock(&mb->lock);
+
+done:
+    purc_rwlock_writer_unlock(&mb_lock);
+    return errcode;
+}
+
+int
+pcinst_set_move_buffer_wakeup(pcinst_move_buffer_wakeup_f wakeup, void *ctxt)
+{
+    struct pcinst* inst = pcinst_current();
+    if (inst == NULL) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return PURC_ERROR_NO_INSTANCE;
+    }
+
+    int errcode = 0;
+    struct pcinst_move_buffer *mb;
+
+    purc_rwlock_reader_lock(&mb_lock);
+
+    if (!pcutils_sorted_array_find(mb_atom2buff_map,
+                (void *)(uintptr_t)inst->endpoint_atom, (void **)&mb, NULL)) {
+        errcode = PURC_ERROR_NOT_EXISTS;
+        goto done;
+    }
+
+    purc_rwlock_writer_lock(&mb->lock);
+    mb->wakeup = wakeup;
+    mb->wakeup_ctxt = ctxt;
+    purc_rwlock_writer_unlock(&mb->lock);
+
+done:
+    purc_rwlock_reader_unlock(&mb_lock);
+
+    if (errcode) {
+        purc_set_error(errcode);
+    }
+
+    return errcode;
+}
+
 int
 purc_inst_holding_messages_count(size_t *nr)
 {
@@ -619,6 +720,23 @@ purc_inst_move_message(purc_atom_t inst_to, pcrdr_msg *msg)
     return 0;
 }
 
+int
+pcinst_rekey_move_buffer(purc_atom_t from, purc_atom_t to)
+{
+    UNUSED_PARAM(from);
+    UNUSED_PARAM(to);
+    return PURC_ERROR_NOT_SUPPORTED;
+}
+
+int
+pcinst_set_move_buffer_wakeup(pcinst_move_buffer_wakeup_f wakeup, void *ctxt)
+{
+    UNUSED_PARAM(wakeup);
+    UNUSED_PARAM(ctxt);
+    purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+    return PURC_ERROR_NOT_SUPPORTED;
+}
+
 int
 purc_inst_holding_messages_count(size_t *nr)
 {
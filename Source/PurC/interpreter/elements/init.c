@@ -76,11 +76,13 @@ struct ctxt_for_init {
     int                           ret_code;
     int                           err;
     purc_rwstream_t               resp;
+    purc_variant_t                decoded;
     char                         *mime_type;
 
     enum VIA                      via;
     purc_variant_t                v_for;
     purc_variant_t                params;
+    char                         *cache_key;
 
     unsigned int                  under_head:1;
     unsigned int                  temporarily:1;
@@ -110,6 +112,7 @@ ctxt_for_init_destroy(struct ctxt_for_init *ctxt)
         PURC_VARIANT_SAFE_CLEAR(ctxt->sync_id);
         PURC_VARIANT_SAFE_CLEAR(ctxt->v_for);
         PURC_VARIANT_SAFE_CLEAR(ctxt->params);
+        PURC_VARIANT_SAFE_CLEAR(ctxt->decoded);
         if (ctxt->resp) {
             purc_rwstream_destroy(ctxt->resp);
             ctxt->resp = NULL;
@@ -118,6 +121,7 @@ ctxt_for_init_destroy(struct ctxt_for_init *ctxt)
             free(ctxt->mime_type);
             ctxt->mime_type = NULL;
         }
+        free(ctxt->cache_key);
         free(ctxt);
     }
 }
@@ -539,6 +543,9 @@ static void on_sync_complete(purc_variant_t request_id, void *ud,
 
     ctxt->ret_code = resp_header->ret_code;
     ctxt->resp = resp;
+    if (resp_header->decoded)
+        ctxt->decoded = purc_variant_ref(resp_header->decoded);
+    ctxt->err = resp_header->decode_error;
     if (resp_header->mime_type) {
         ctxt->mime_type = strdup(resp_header->mime_type);
     }
@@ -711,12 +718,20 @@ observer_handle(pcintr_coroutine_t cor, struct pcintr_observer *observer,
         goto out;
     }
 
-    purc_variant_t ret = build_variant_by_mime(ctxt->resp, ctxt->mime_type);
+    if (ctxt->err) {
+        frame->next_step = NEXT_STEP_ON_POPPING;
+        purc_set_error(ctxt->err);
+        goto out;
+    }
+
+    purc_variant_t ret = ctxt->decoded ? purc_variant_ref(ctxt->decoded) :
+        build_variant_by_mime(ctxt->resp, ctxt->mime_type);
     if (ret == PURC_VARIANT_INVALID) {
         frame->next_step = NEXT_STEP_ON_POPPING;
         goto out;
     }
 
+    pcintr_fetch_cache_put(&cor->stack, ctxt->cache_key, ctxt->from_uri, ret);
     r = post_process(cor, frame, ret);
     PURC_VARIANT_SAFE_CLEAR(ret);
     if (r) {
@@ -767,7 +782,7 @@ process_from_sync(pcintr_coroutine_t co, pcintr_stack_frame_t frame)
     params = params_from_with(ctxt);
 
     ctxt->co = co;
-    purc_variant_t v = pcintr_load_from_uri_async(stack, ctxt->from_uri,
+    purc_variant_t v = pcintr_load_data_from_uri_async(stack, ctxt->from_uri,
             method, params, on_sync_complete, frame, PURC_VARIANT_INVALID);
     if (v == PURC_VARIANT_INVALID)
         return -1;
@@ -801,7 +816,10 @@ struct load_data {
     int                       ret_code;
     int                       err;
     purc_rwstream_t           resp;
+    purc_variant_t            decoded;
     char                     *mime_type;
+    char                     *from_uri;
+    char                     *cache_key;
 
     purc_variant_t            as;
     purc_variant_t            at;
@@ -821,6 +839,7 @@ static void load_data_release(struct load_data *data)
         PURC_VARIANT_SAFE_CLEAR(data->as);
         PURC_VARIANT_SAFE_CLEAR(data->at);
         PURC_VARIANT_SAFE_CLEAR(data->against);
+        PURC_VARIANT_SAFE_CLEAR(data->decoded);
         if (data->resp) {
             purc_rwstream_destroy(data->resp);
             data->resp = NULL;
@@ -829,6 +848,10 @@ static void load_data_release(struct load_data *data)
             free(data->mime_type);
             data->mime_type = NULL;
         }
+        free(data->from_uri);
+        data->from_uri = NULL;
+        free(data->cache_key);
+        data->cache_key = NULL;
     }
 }
 
@@ -861,10 +884,18 @@ static void on_async_resume_on_frame_pseudo(pcintr_coroutine_t co,
         return;
     }
 
-    purc_variant_t ret = build_variant_by_mime(data->resp, data->mime_type);
+    if (data->err) {
+        purc_set_error(data->err);
+        return;
+    }
+
+    purc_variant_t ret = data->decoded ? purc_variant_ref(data->decoded) :
+        build_variant_by_mime(data->resp, data->mime_type);
     if (ret == PURC_VARIANT_INVALID)
         return;
 
+    pcintr_fetch_cache_put(stack, data->cache_key, data->from_uri, ret);
+
     bool caseless = data->casesensitively ? false : true;
     purc_variant_t src;
     src = _generate_src(data->against, data->uniquely, caseless, ret);
@@ -954,6 +985,9 @@ static void on_async_complete(purc_variant_t request_id, void *ud,
 
     data->ret_code = resp_header->ret_code;
     data->resp = resp;
+    if (resp_header->decoded)
+        data->decoded = purc_variant_ref(resp_header->decoded);
+    data->err = resp_header->decode_error;
     if (resp_header->mime_type) {
         data->mime_type = strdup(resp_header->mime_type);
     }
@@ -1021,7 +1055,11 @@ process_from_async(pcintr_coroutine_t co, pcintr_stack_frame_t frame)
         return -1;
     }
 
-    data->async_id = pcintr_load_from_uri_async(stack, ctxt->from_uri,
+    data->from_uri = strdup(ctxt->from_uri);
+    data->cache_key = ctxt->cache_key;
+    ctxt->cache_key = NULL;
+
+    data->async_id = pcintr_load_data_from_uri_async(stack, ctxt->from_uri,
             method, params, on_async_complete, data, dest);
     purc_variant_unref(dest);
 
@@ -1135,6 +1173,19 @@ process_from(pcintr_coroutine_t co)
     struct ctxt_for_init *ctxt;
     ctxt = (struct ctxt_for_init*)frame->ctxt;
 
+    /* a cached response is bound at once, even if asynchronously */
+    ctxt->cache_key = pcintr_fetch_cache_key(stack, "init", ctxt->from_uri,
+            pcintr_method_from_via(ctxt->via), params_from_with(ctxt));
+    purc_variant_t cached = pcintr_fetch_cache_get(ctxt->cache_key);
+    if (cached != PURC_VARIANT_INVALID) {
+        int r = post_process(co, frame, cached);
+        purc_variant_unref(cached);
+        if (r) {
+            frame->next_step = NEXT_STEP_ON_POPPING;
+        }
+        return r;
+    }
+
     if (ctxt->async) {
         return process_from_async(co, frame);
     }
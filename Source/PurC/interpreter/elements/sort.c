@@ -325,64 +325,80 @@ variant_to_string(purc_variant_t v)
     return buf;
 }
 
-static int
-comp_raw(purc_variant_t l, purc_variant_t r, bool by_number,
-        bool ascendingly, bool casesensitively)
-{
-    if (by_number) {
-        double dl = l ? purc_variant_numerify(l) : 0.0f;
-        double dr = r ? purc_variant_numerify(r) : 0.0f;
-        return comp_number(dl, dr, ascendingly);
-    }
+/* the value of a sort key of a member, computed once before sorting */
+struct key_value {
+    double number;
+    char *string;
+};
 
-    char *buf_l = variant_to_string(l);
-    char *buf_r = variant_to_string(r);
-    int ret = comp_string(buf_l, buf_r, ascendingly, casesensitively);
+struct member_keys {
+    size_t nr_keys;
+    struct key_value values[];
+};
 
-    if (buf_l) {
-        free(buf_l);
-    }
-    if (buf_r) {
-        free(buf_r);
+static void
+free_member_keys(void *data)
+{
+    struct member_keys *mkeys = data;
+    for (size_t i = 0; i < mkeys->nr_keys; i++) {
+        free(mkeys->values[i].string);
     }
-
-    return ret;
+    free(mkeys);
 }
 
-static int
-comp_by_key(purc_variant_t l, purc_variant_t r, const char *key, bool by_number,
-        bool ascendingly, bool casesensitively)
+static void *
+get_member_keys(purc_variant_t member, void *data)
 {
-    purc_variant_t lv = PURC_VARIANT_INVALID;
-    purc_variant_t rv = PURC_VARIANT_INVALID;
-    if (purc_variant_is_object(l)) {
-        lv = purc_variant_object_get_by_ckey(l, key);
-        purc_clr_error();
+    struct ctxt_for_sort *ctxt = data;
+    size_t nr_keys = pcutils_arrlist_length(ctxt->keys);
+    struct member_keys *mkeys = calloc(1, sizeof(struct member_keys) +
+            sizeof(struct key_value) * nr_keys);
+    if (mkeys == NULL) {
+        return NULL;
     }
+    mkeys->nr_keys = nr_keys;
 
-    if (purc_variant_is_object(r)) {
-        rv = purc_variant_object_get_by_ckey(r, key);
-        purc_clr_error();
+    for (size_t i = 0; i < nr_keys; i++) {
+        struct sort_key *key = pcutils_arrlist_get_idx(ctxt->keys, i);
+        purc_variant_t v = member;
+        if (key->key) {
+            v = PURC_VARIANT_INVALID;
+            if (purc_variant_is_object(member)) {
+                v = purc_variant_object_get_by_ckey(member, key->key);
+                purc_clr_error();
+            }
+        }
+
+        struct key_value *value = mkeys->values + i;
+        if (key->by_number) {
+            value->number = v ? purc_variant_numerify(v) : 0.0f;
+            continue;
+        }
+
+        /* a missing value equals to any string as before */
+        value->string = variant_to_string(v);
     }
 
-    return comp_raw(lv, rv, by_number, ascendingly, casesensitively);
+    return mkeys;
 }
 
 static int
-sort_cmp(purc_variant_t l, purc_variant_t r, void *data)
+sort_cmp(const void *l, const void *r, void *data)
 {
     struct ctxt_for_sort *ctxt = data;
-    size_t nr_keys = pcutils_arrlist_length(ctxt->keys);
-    for (size_t i = 0; i < nr_keys; i++) {
+    const struct member_keys *lkeys = l;
+    const struct member_keys *rkeys = r;
+    for (size_t i = 0; i < lkeys->nr_keys; i++) {
         struct sort_key *key = pcutils_arrlist_get_idx(ctxt->keys, i);
+        const struct key_value *lv = lkeys->values + i;
+        const struct key_value *rv = rkeys->values + i;
         int ret = 0;
-        if (key->key == NULL) {
-            ret = comp_raw(l, r, key->by_number, ctxt->ascendingly,
-                    ctxt->casesensitively);
+        if (key->by_number) {
+            ret = comp_number(lv->number, rv->number, ctxt->ascendingly);
         }
         else {
-            ret = comp_by_key(l, r, key->key, key->by_number,
-                    ctxt->ascendingly, ctxt->casesensitively);
+            ret = comp_string(lv->string, rv->string, ctxt->ascendingly,
+                    ctxt->casesensitively);
         }
         if (ret != 0) {
             return ret;
@@ -457,7 +473,8 @@ sort_array(struct ctxt_for_sort *ctxt, purc_variant_t array,
             }
         }
     }
-    pcvariant_array_sort(array, ctxt, sort_cmp);
+    pcvariant_array_sort_by_keys(array, ctxt, get_member_keys, sort_cmp,
+            free_member_keys);
 }
 
 
@@ -510,7 +527,8 @@ sort_set(struct ctxt_for_sort *ctxt, purc_variant_t set, purc_variant_t against)
             }
         }
     }
-    pcvariant_set_sort(set, ctxt, sort_cmp);
+    pcvariant_set_sort_by_keys(set, ctxt, get_member_keys, sort_cmp,
+            free_member_keys);
 }
 
 static int
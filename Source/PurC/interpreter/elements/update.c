@@ -86,11 +86,13 @@ struct ctxt_for_update {
 
     purc_variant_t                sync_id;
     purc_variant_t                params;
+    char                         *cache_key;
     pcintr_coroutine_t            co;
 
     int                           ret_code;
     int                           err;
     purc_rwstream_t               resp;
+    purc_variant_t                decoded;
     enum hvml_update_op           op;
     bool                          individually;
 };
@@ -109,10 +111,12 @@ ctxt_for_update_destroy(struct ctxt_for_update *ctxt)
         PURC_VARIANT_SAFE_CLEAR(ctxt->template_data_type);
         PURC_VARIANT_SAFE_CLEAR(ctxt->sync_id);
         PURC_VARIANT_SAFE_CLEAR(ctxt->params);
+        PURC_VARIANT_SAFE_CLEAR(ctxt->decoded);
         if (ctxt->resp) {
             purc_rwstream_destroy(ctxt->resp);
             ctxt->resp = NULL;
         }
+        free(ctxt->cache_key);
         free(ctxt);
     }
 }
@@ -168,6 +172,9 @@ static void on_sync_complete(purc_variant_t request_id, void *ud,
 
     ctxt->ret_code = resp_header->ret_code;
     ctxt->resp = resp;
+    if (resp_header->decoded)
+        ctxt->decoded = purc_variant_ref(resp_header->decoded);
+    ctxt->err = resp_header->decode_error;
 
     if (ctxt->co->stack.exited) {
         return;
@@ -242,12 +249,21 @@ observer_handle(pcintr_coroutine_t cor, struct pcintr_observer *observer,
         goto out;
     }
 
-    purc_variant_t ret = purc_variant_load_from_json_stream(ctxt->resp);
+    if (ctxt->err) {
+        frame->next_step = NEXT_STEP_ON_POPPING;
+        purc_set_error(ctxt->err);
+        goto out;
+    }
+
+    purc_variant_t ret = ctxt->decoded ? purc_variant_ref(ctxt->decoded) :
+        purc_variant_load_from_json_stream(ctxt->resp);
     if (ret == PURC_VARIANT_INVALID) {
         frame->next_step = NEXT_STEP_ON_POPPING;
         goto out;
     }
 
+    pcintr_fetch_cache_put(&cor->stack, ctxt->cache_key,
+            purc_variant_get_string_const(ctxt->from), ret);
     ctxt->from_result = ret;
 
 out:
@@ -293,8 +309,15 @@ get_source_by_from(pcintr_coroutine_t co, struct pcintr_stack_frame *frame,
     purc_variant_t params;
     params = params_from_with(ctxt);
 
+    ctxt->cache_key = pcintr_fetch_cache_key(&co->stack, "update", uri,
+            method, params);
+    ctxt->from_result = pcintr_fetch_cache_get(ctxt->cache_key);
+    if (ctxt->from_result != PURC_VARIANT_INVALID) {
+        return 0;
+    }
+
     ctxt->co = co;
-    purc_variant_t v = pcintr_load_from_uri_async(&co->stack, uri,
+    purc_variant_t v = pcintr_load_data_from_uri_async(&co->stack, uri,
             method, params, on_sync_complete, frame, PURC_VARIANT_INVALID);
     if (v == PURC_VARIANT_INVALID)
         return -1;
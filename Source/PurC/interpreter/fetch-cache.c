@@ -0,0 +1,356 @@
+/*
+ * @file fetch-cache.c
+ * @date 2026/10/19
+ * @brief The cache of the parsed responses loaded by `init` and `update`.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "internal.h"
+
+#include "purc-variant.h"
+#include "purc-helpers.h"
+#include "private/instance.h"
+#include "private/interpreter.h"
+#include "private/dvobjs.h"
+#include "private/map.h"
+#include "private/list.h"
+#include "private/debug.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/*
+ * The cache is owned by the interpreter heap of an instance, so it is shared
+ * by all coroutines of a runner and needs no lock. The key of an entry is
+ * made of the parser, the request method, the effective URL and the
+ * serialized parameters; only GET requests are cached.
+ *
+ * An entry of a local file (file://) is revalidated against the inode, size
+ * and modification time of the file on every hit, which plays the role of
+ * Last-Modified. The fetcher does not report any validator (ETag or
+ * Last-Modified) of a remote response, so an entry of a remote URL is simply
+ * served until its TTL expires; the TTL is given in seconds by the
+ * environment variable PURC_FETCH_CACHE_TTL and defaults to zero, i.e.,
+ * remote responses are not cached unless asked for.
+ *
+ * A cached container is never shared with a page: the value handed out is
+ * bound to a variable or becomes the content of a frame (`$^`), and the page
+ * may change it in place, e.g., by `update`, while the variants have no
+ * copy-on-write. So the cache keeps its own tree, cloned when the response
+ * is put, and hands out a clone on a hit. Only the containers are cloned;
+ * the strings and other scalars in them are shared by reference. A value
+ * which is not a container is shared as is.
+ */
+
+#define FETCH_CACHE_MAX_ENTRIES     64
+#define FETCH_CACHE_FILE_SCHEMA     "file://"
+
+struct fetch_cache_entry {
+    struct list_head    ln;         // in the LRU list; the last is the newest
+    char               *key;
+    purc_variant_t      value;
+    time_t              expires;    // zero for a local file
+
+    /* the validators of a local file */
+    char               *file;
+    ino_t               ino;
+    off_t               size;
+    struct timespec     mtime;
+};
+
+struct pcintr_fetch_cache {
+    pcutils_map        *map;        // key -> entry
+    struct list_head    lru;
+    time_t              ttl;
+
+    struct pcintr_fetch_cache_stats stats;
+};
+
+static void entry_destroy(struct fetch_cache_entry *entry)
+{
+    list_del(&entry->ln);
+    PURC_VARIANT_SAFE_CLEAR(entry->value);
+    free(entry->file);
+    free(entry->key);
+    free(entry);
+}
+
+static struct pcintr_fetch_cache *get_cache(bool create)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL || inst->intr_heap == NULL)
+        return NULL;
+
+    struct pcintr_heap *heap = inst->intr_heap;
+    if (heap->fetch_cache || !create)
+        return heap->fetch_cache;
+
+    struct pcintr_fetch_cache *cache = calloc(1, sizeof(*cache));
+    if (cache == NULL)
+        return NULL;
+
+    /* the entries are destroyed via the LRU list */
+    cache->map = pcutils_map_create(NULL, NULL, NULL, NULL,
+            comp_key_string, false);
+    if (cache->map == NULL) {
+        free(cache);
+        return NULL;
+    }
+
+    list_head_init(&cache->lru);
+    const char *env_value = getenv(PURC_ENVV_FETCH_CACHE_TTL);
+    if (env_value) {
+        long ttl = strtol(env_value, NULL, 10);
+        if (ttl > 0)
+            cache->ttl = (time_t)ttl;
+    }
+
+    heap->fetch_cache = cache;
+    return cache;
+}
+
+void
+pcintr_fetch_cache_destroy(struct pcintr_fetch_cache *cache)
+{
+    if (cache == NULL)
+        return;
+
+    struct fetch_cache_entry *p, *n;
+    list_for_each_entry_safe(p, n, &cache->lru, ln) {
+        entry_destroy(p);
+    }
+
+    pcutils_map_destroy(cache->map);
+    free(cache);
+}
+
+static void cache_remove(struct pcintr_fetch_cache *cache,
+        struct fetch_cache_entry *entry)
+{
+    pcutils_map_erase(cache->map, entry->key);
+    entry_destroy(entry);
+    cache->stats.nr_entries--;
+}
+
+/* returns the path of a local file or NULL; the caller frees it */
+static char *local_file_of(const char *base_url, const char *uri)
+{
+    const char *url = uri;
+    char *full = NULL;
+
+    /* resolves the URL in the same way as the local fetcher */
+    if (base_url && strncmp(uri, base_url, strlen(base_url)) != 0) {
+        full = malloc(strlen(base_url) + strlen(uri) + 1);
+        if (full == NULL)
+            return NULL;
+        strcpy(full, base_url);
+        strcat(full, uri);
+        url = full;
+    }
+
+    char *file = NULL;
+    if (strncasecmp(url, FETCH_CACHE_FILE_SCHEMA,
+                sizeof(FETCH_CACHE_FILE_SCHEMA) - 1) == 0) {
+        const char *path = url + sizeof(FETCH_CACHE_FILE_SCHEMA) - 1;
+        file = strndup(path, strcspn(path, "?#"));
+    }
+
+    free(full);
+    return file;
+}
+
+char *
+pcintr_fetch_cache_key(pcintr_stack_t stack, const char *parser,
+        const char *uri, enum pcfetcher_request_method method,
+        purc_variant_t params)
+{
+    if (method != PCFETCHER_REQUEST_METHOD_GET)
+        return NULL;
+
+    purc_rwstream_t rws = purc_rwstream_new_buffer(LEN_INI_SERIALIZE_BUF,
+            LEN_MAX_SERIALIZE_BUF);
+    if (rws == NULL)
+        return NULL;
+
+    const char *base_url = stack->co->base_url_string;
+    purc_rwstream_write(rws, parser, strlen(parser));
+    purc_rwstream_write(rws, " GET ", 5);
+    if (base_url && strncmp(uri, base_url, strlen(base_url)) != 0)
+        purc_rwstream_write(rws, base_url, strlen(base_url));
+    purc_rwstream_write(rws, uri, strlen(uri));
+    if (params && !(purc_variant_is_object(params) &&
+                purc_variant_object_get_size(params) == 0)) {
+        purc_rwstream_write(rws, " ", 1);
+        if (purc_variant_serialize(params, rws, 0,
+                    PCVRNT_SERIALIZE_OPT_PLAIN, NULL) < 0) {
+            purc_rwstream_destroy(rws);
+            return NULL;
+        }
+    }
+    purc_rwstream_write(rws, "", 1);
+
+    size_t sz_content, sz_buffer;
+    char *key = purc_rwstream_get_mem_buffer_ex(rws, &sz_content,
+            &sz_buffer, true);
+    purc_rwstream_destroy(rws);
+    return key;
+}
+
+static bool is_entry_valid(struct pcintr_fetch_cache *cache,
+        struct fetch_cache_entry *entry)
+{
+    if (entry->file) {
+        struct stat st;
+        cache->stats.nr_revalidations++;
+        return stat(entry->file, &st) == 0 && st.st_ino == entry->ino &&
+            st.st_size == entry->size &&
+            st.st_mtim.tv_sec == entry->mtime.tv_sec &&
+            st.st_mtim.tv_nsec == entry->mtime.tv_nsec;
+    }
+
+    return purc_get_monotoic_time() < entry->expires;
+}
+
+purc_variant_t
+pcintr_fetch_cache_get(const char *key)
+{
+    struct pcintr_fetch_cache *cache = get_cache(true);
+    if (key == NULL || cache == NULL)
+        return PURC_VARIANT_INVALID;
+
+    pcutils_map_entry *me = pcutils_map_find(cache->map, key);
+    if (me == NULL) {
+        cache->stats.nr_misses++;
+        return PURC_VARIANT_INVALID;
+    }
+
+    struct fetch_cache_entry *entry = me->val;
+    if (!is_entry_valid(cache, entry)) {
+        PC_DEBUG("fetch cache: stale entry for %s\n", key);
+        cache_remove(cache, entry);
+        cache->stats.nr_misses++;
+        return PURC_VARIANT_INVALID;
+    }
+
+    list_move_tail(&entry->ln, &cache->lru);
+    cache->stats.nr_hits++;
+
+    /* the page may change the value in place: see above */
+    if (purc_variant_is_type(entry->value, PURC_VARIANT_TYPE_OBJECT) ||
+            purc_variant_is_type(entry->value, PURC_VARIANT_TYPE_ARRAY) ||
+            purc_variant_is_type(entry->value, PURC_VARIANT_TYPE_SET) ||
+            purc_variant_is_type(entry->value, PURC_VARIANT_TYPE_TUPLE))
+        return purc_variant_container_clone_recursively(entry->value);
+
+    return purc_variant_ref(entry->value);
+}
+
+void
+pcintr_fetch_cache_put(pcintr_stack_t stack, const char *key,
+        const char *uri, purc_variant_t value)
+{
+    if (key == NULL || value == PURC_VARIANT_INVALID)
+        return;
+
+    /* a native entity (e.g., a document) can not be copied */
+    if (purc_variant_is_type(value, PURC_VARIANT_TYPE_NATIVE))
+        return;
+
+    char *file = local_file_of(stack->co->base_url_string, uri);
+    struct pcintr_fetch_cache *cache = get_cache(true);
+    if (cache == NULL || (file == NULL && cache->ttl == 0)) {
+        free(file);
+        return;
+    }
+
+    struct fetch_cache_entry *entry = calloc(1, sizeof(*entry));
+    if (entry == NULL) {
+        free(file);
+        return;
+    }
+
+    if (file) {
+        struct stat st;
+        if (stat(file, &st)) {
+            free(file);
+            free(entry);
+            return;
+        }
+        entry->file = file;
+        entry->ino = st.st_ino;
+        entry->size = st.st_size;
+        entry->mtime = st.st_mtim;
+    }
+    else {
+        entry->expires = purc_get_monotoic_time() + cache->ttl;
+    }
+
+    entry->key = strdup(key);
+    /* the caller goes on to hand `value` to the page: see above */
+    if (purc_variant_is_type(value, PURC_VARIANT_TYPE_OBJECT) ||
+            purc_variant_is_type(value, PURC_VARIANT_TYPE_ARRAY) ||
+            purc_variant_is_type(value, PURC_VARIANT_TYPE_SET) ||
+            purc_variant_is_type(value, PURC_VARIANT_TYPE_TUPLE))
+        entry->value = purc_variant_container_clone_recursively(value);
+    else
+        entry->value = purc_variant_ref(value);
+    if (entry->key == NULL || entry->value == PURC_VARIANT_INVALID) {
+        list_head_init(&entry->ln);
+        entry_destroy(entry);
+        return;
+    }
+
+    pcutils_map_entry *me = pcutils_map_find(cache->map, key);
+    if (me) {
+        cache_remove(cache, me->val);
+    }
+
+    while (cache->stats.nr_entries >= FETCH_CACHE_MAX_ENTRIES) {
+        struct fetch_cache_entry *oldest;
+        oldest = list_first_entry(&cache->lru, struct fetch_cache_entry, ln);
+        cache_remove(cache, oldest);
+        cache->stats.nr_evictions++;
+    }
+
+    if (pcutils_map_insert(cache->map, entry->key, entry)) {
+        list_head_init(&entry->ln);
+        entry_destroy(entry);
+        return;
+    }
+
+    list_add_tail(&entry->ln, &cache->lru);
+    cache->stats.nr_entries++;
+}
+
+bool
+pcintr_fetch_cache_get_stats(struct pcintr_fetch_cache_stats *stats)
+{
+    struct pcintr_fetch_cache *cache = get_cache(false);
+    if (cache == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return false;
+    }
+
+    *stats = cache->stats;
+    return true;
+}
@@ -28,6 +28,7 @@
 #include "private/map.h"
 #include "private/fetcher.h"
 #include "private/ports.h"
+#include "private/rwstream.h"
 #include "../hvml/hvml-gen.h"
 
 #include <time.h>
@@ -261,7 +262,7 @@ purc_load_hvml_from_file(const char* file)
     vdom = find_vdom_in_cache(md5);
     if (vdom == NULL) {
         purc_rwstream_t in;
-        in = purc_rwstream_new_from_file(file, "r");
+        in = pcrwstream_new_from_file_for_read(file);
         if (!in) {
             goto failed;
         }
@@ -204,9 +204,36 @@ pcintr_load_from_uri_async(pcintr_stack_t stack, const char* uri,
         pcfetcher_response_handler handler, void* ctxt,
         purc_variant_t progress_event_dest);
 
+/* Like pcintr_load_from_uri_async(), but a SQL result set (lsql:// or
+   rsql://) is decoded while it is received: the handler gets the document
+   in resp_header->decoded and an empty response stream. */
+purc_variant_t
+pcintr_load_data_from_uri_async(pcintr_stack_t stack, const char* uri,
+        enum pcfetcher_request_method method, purc_variant_t params,
+        pcfetcher_response_handler handler, void* ctxt,
+        purc_variant_t progress_event_dest);
+
 bool
 pcintr_save_async_request_id(pcintr_stack_t stack, purc_variant_t req_id);
 
+/* the cache of the parsed responses, see fetch-cache.c; the key is
+   prefixed by the parser (element) since the same body may be parsed
+   differently; returns NULL if the request is not cacheable */
+char *
+pcintr_fetch_cache_key(pcintr_stack_t stack, const char *parser,
+        const char *uri, enum pcfetcher_request_method method,
+        purc_variant_t params);
+
+purc_variant_t
+pcintr_fetch_cache_get(const char *key);
+
+void
+pcintr_fetch_cache_put(pcintr_stack_t stack, const char *key,
+        const char *uri, purc_variant_t value);
+
+void
+pcintr_fetch_cache_destroy(struct pcintr_fetch_cache *cache);
+
 bool
 pcintr_remove_async_request_id(pcintr_stack_t stack, purc_variant_t req_id);
 
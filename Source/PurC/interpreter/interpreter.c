@@ -363,6 +363,16 @@ stack_release(pcintr_stack_t stack)
         stack->vcm_ctxt = NULL;
     }
 
+    if (stack->vcm_const_values) {
+        pcutils_map_destroy(stack->vcm_const_values);
+        stack->vcm_const_values = NULL;
+    }
+
+    if (stack->vcm_var_sites) {
+        pcutils_map_destroy(stack->vcm_var_sites);
+        stack->vcm_var_sites = NULL;
+    }
+
     if (stack->curr_edom_elem_text_content) {
         pcutils_str_destroy(stack->curr_edom_elem_text_content,
                 stack->mraw, true);
@@ -405,6 +415,11 @@ coroutine_release(pcintr_coroutine_t co)
         PURC_VARIANT_SAFE_CLEAR(co->doc_contents);
         PURC_VARIANT_SAFE_CLEAR(co->doc_wrotten_len);
 
+        if (co->waiting_chan) {
+            pcchan_shared_unref(co->waiting_chan);
+            co->waiting_chan = NULL;
+        }
+
         struct list_head *children = &co->children;
         struct list_head *p, *n;
         list_for_each_safe(p, n, children) {
@@ -529,6 +544,11 @@ static void _cleanup_instance(struct pcinst* inst)
         heap->event_timer = NULL;
     }
 
+    if (heap->timers_wheel) {
+        pcintr_timers_wheel_destroy(heap->timers_wheel);
+        heap->timers_wheel = NULL;
+    }
+
     if (heap->name_chan_map) {
         pcutils_map_destroy(heap->name_chan_map);
         heap->name_chan_map = NULL;
@@ -539,6 +559,11 @@ static void _cleanup_instance(struct pcinst* inst)
         heap->token_crtn_map = NULL;
     }
 
+    if (heap->fetch_cache) {
+        pcintr_fetch_cache_destroy(heap->fetch_cache);
+        heap->fetch_cache = NULL;
+    }
+
     free(heap);
     inst->intr_heap = NULL;
 }
@@ -588,6 +613,7 @@ static int _init_instance(struct pcinst* inst,
     inst->running_loop = purc_runloop_get_current();
     inst->intr_heap = heap;
     heap->owner     = inst;
+    heap->var_bindings_gen = 1;     // zero is reserved for no cache
 
     heap->running_coroutine = NULL;
 
@@ -623,6 +649,9 @@ static int _init_once(void)
     PC_ASSERT(runloop);
     init_ops();
 
+    if (pcchan_shared_init_once())
+        return -1;
+
     return pcintr_init_loader_once();
 }
 
@@ -1431,15 +1460,18 @@ pcintr_exception_copy(struct pcintr_exception *exception)
     if (!exception)
         return;
 
-    const struct pcinst *inst = pcinst_current();
+    struct pcinst *inst = pcinst_current();
+    pcinst_settle_error(inst);
+
     exception->errcode        = inst->errcode;
     exception->error_except   = inst->error_except;
     exception->err_element    = inst->err_element;
 
-    if (inst->err_exinfo)
-        purc_variant_ref(inst->err_exinfo);
+    purc_variant_t exinfo = pcinst_get_error_exinfo(inst);
+    if (exinfo)
+        purc_variant_ref(exinfo);
     PURC_VARIANT_SAFE_CLEAR(exception->exinfo);
-    exception->exinfo = inst->err_exinfo;
+    exception->exinfo = exinfo;
 
     if (inst->bt)
         pcdebug_backtrace_ref(inst->bt);
@@ -1631,7 +1663,7 @@ execute_one_step_for_exiting_co(pcintr_coroutine_t co)
     if (heap->keep_alive == 0 && list_empty(&heap->crtns)
             && list_empty(&heap->stopped_crtns))
     {
-        purc_runloop_stop(inst->running_loop);
+        pcrun_stop_running_loop(inst);
     }
 
     return;
@@ -2198,6 +2230,10 @@ struct load_async_data {
     pcintr_stack_t             requesting_stack;
     purc_variant_t             request_id;
     purc_variant_t             progress_event_dest;
+
+    /* the decoder of a streamed SQL result */
+    struct pcfetcher_sql_decoder *decoder;
+    int                        decode_error;
 };
 
 static void
@@ -2206,6 +2242,10 @@ release_load_async_data(struct load_async_data *data)
     if (data) {
         PURC_VARIANT_SAFE_CLEAR(data->progress_event_dest);
         PURC_VARIANT_SAFE_CLEAR(data->request_id);
+        if (data->decoder) {
+            pcfetcher_sql_decoder_destroy(data->decoder);
+            data->decoder = NULL;
+        }
         data->handler           = NULL;
         data->ctxt              = NULL;
         data->requesting_thread = 0;
@@ -2222,6 +2262,57 @@ destroy_load_async_data(struct load_async_data *data)
     }
 }
 
+static void
+post_rows_event(struct load_async_data *data, size_t nr_rows)
+{
+    purc_variant_t payload = purc_variant_make_object(0,
+            PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
+    if (!payload) {
+        return;
+    }
+
+    purc_variant_t count = purc_variant_make_ulongint(nr_rows);
+    if (!count) {
+        purc_variant_unref(payload);
+        return;
+    }
+    purc_variant_object_set_by_static_ckey(payload, "rows",
+            pcfetcher_sql_decoder_rows(data->decoder));
+    purc_variant_object_set_by_static_ckey(payload, "count", count);
+    purc_variant_unref(count);
+
+    pcintr_coroutine_post_event(data->requesting_stack->co->cid,
+            PCRDR_MSG_EVENT_REDUCE_OPT_KEEP,
+            data->progress_event_dest, MSG_TYPE_CHANGE,
+            MSG_SUB_TYPE_ROWS, payload,
+            PURC_VARIANT_INVALID);
+
+    purc_variant_unref(payload);
+}
+
+static void
+pcintr_fetcher_data_consumer(purc_variant_t request_id,
+        void* ctxt, const char *buf, size_t sz_buf)
+{
+    UNUSED_PARAM(request_id);
+    struct load_async_data *data = (struct load_async_data*)ctxt;
+
+    /* the rest of a body failed to decode is ignored */
+    if (data->decode_error)
+        return;
+
+    ssize_t nr_rows = pcfetcher_sql_decoder_feed(data->decoder, buf, sz_buf);
+    if (nr_rows < 0) {
+        data->decode_error = purc_get_last_error();
+        purc_clr_error();
+        return;
+    }
+
+    if (nr_rows > 0 && data->progress_event_dest) {
+        post_rows_event(data, nr_rows);
+    }
+}
+
 static void
 on_load_async_done(
         purc_variant_t request_id, void* ctxt,
@@ -2230,7 +2321,22 @@ on_load_async_done(
 {
     struct load_async_data *data;
     data = (struct load_async_data*)ctxt;
-    data->handler(request_id, data->ctxt, resp_header, resp);
+    if (data->decoder) {
+        struct pcfetcher_resp_header header = *resp_header;
+        if (header.ret_code == 200 && !data->decode_error) {
+            header.decoded = pcfetcher_sql_decoder_finish(data->decoder);
+            if (header.decoded == PURC_VARIANT_INVALID) {
+                data->decode_error = purc_get_last_error();
+                purc_clr_error();
+            }
+        }
+        header.decode_error = data->decode_error;
+        data->handler(request_id, data->ctxt, &header, resp);
+        PURC_VARIANT_SAFE_CLEAR(header.decoded);
+    }
+    else {
+        data->handler(request_id, data->ctxt, resp_header, resp);
+    }
     destroy_load_async_data(data);
 }
 
@@ -2263,11 +2369,11 @@ void pcintr_fetcher_progress_tracker(purc_variant_t request_id,
     }
 }
 
-purc_variant_t
-pcintr_load_from_uri_async(pcintr_stack_t stack, const char* uri,
+static purc_variant_t
+load_from_uri_async(pcintr_stack_t stack, const char* uri,
         enum pcfetcher_request_method method, purc_variant_t params,
         pcfetcher_response_handler handler, void* ctxt,
-        purc_variant_t progress_event_dest)
+        purc_variant_t progress_event_dest, bool decode_data)
 {
     PC_ASSERT(stack);
     PC_ASSERT(uri);
@@ -2286,6 +2392,8 @@ pcintr_load_from_uri_async(pcintr_stack_t stack, const char* uri,
     data->requesting_thread    = pthread_self();
     data->requesting_stack     = stack;
     data->request_id           = PURC_VARIANT_INVALID;
+    data->decoder              = NULL;
+    data->decode_error         = PURC_ERROR_OK;
     if (progress_event_dest) {
         data->progress_event_dest = purc_variant_ref(progress_event_dest);
     }
@@ -2293,6 +2401,17 @@ pcintr_load_from_uri_async(pcintr_stack_t stack, const char* uri,
         data->progress_event_dest = PURC_VARIANT_INVALID;
     }
 
+    /* decode a SQL result while it is received instead of buffering it */
+    pcfetcher_data_consumer consumer = NULL;
+    if (decode_data && pcfetcher_is_sql_uri(uri)) {
+        data->decoder = pcfetcher_sql_decoder_create();
+        if (data->decoder == NULL) {
+            destroy_load_async_data(data);
+            return PURC_VARIANT_INVALID;
+        }
+        consumer = pcintr_fetcher_data_consumer;
+    }
+
     if (stack->co->base_url_string) {
         pcfetcher_set_base_url(stack->co->base_url_string);
     }
@@ -2306,6 +2425,8 @@ pcintr_load_from_uri_async(pcintr_stack_t stack, const char* uri,
             on_load_async_done,
             data,
             pcintr_fetcher_progress_tracker,
+            data,
+            consumer,
             data);
 
     if (data->request_id == PURC_VARIANT_INVALID) {
@@ -2316,6 +2437,26 @@ pcintr_load_from_uri_async(pcintr_stack_t stack, const char* uri,
     return data->request_id;
 }
 
+purc_variant_t
+pcintr_load_from_uri_async(pcintr_stack_t stack, const char* uri,
+        enum pcfetcher_request_method method, purc_variant_t params,
+        pcfetcher_response_handler handler, void* ctxt,
+        purc_variant_t progress_event_dest)
+{
+    return load_from_uri_async(stack, uri, method, params, handler, ctxt,
+            progress_event_dest, false);
+}
+
+purc_variant_t
+pcintr_load_data_from_uri_async(pcintr_stack_t stack, const char* uri,
+        enum pcfetcher_request_method method, purc_variant_t params,
+        pcfetcher_response_handler handler, void* ctxt,
+        purc_variant_t progress_event_dest)
+{
+    return load_from_uri_async(stack, uri, method, params, handler, ctxt,
+            progress_event_dest, true);
+}
+
 bool
 pcintr_save_async_request_id(pcintr_stack_t stack, purc_variant_t req_id)
 {
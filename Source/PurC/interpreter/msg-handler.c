@@ -30,6 +30,7 @@
 #include "private/instance.h"
 #include "private/msg-queue.h"
 #include "private/interpreter.h"
+#include "private/channel.h"
 #include "private/regex.h"
 
 #include <sys/time.h>
@@ -508,6 +509,8 @@ pcintr_conn_event_handler(pcrdr_conn *conn, const pcrdr_msg *msg)
     struct pcinst *inst = pcinst_current();
 
     if (msg->target == PCRDR_MSG_TARGET_COROUTINE) {
+        if (pcchan_shared_handle_wakeup(inst, msg))
+            return;
         dispatch_coroutine_event_from_move_buffer(inst, msg);
         return;
     }
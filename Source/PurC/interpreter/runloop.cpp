@@ -36,8 +36,11 @@
 
 #include <wtf/Threading.h>
 #include <wtf/RunLoop.h>
+#include <wtf/HashMap.h>
+#include <wtf/Vector.h>
 #include <wtf/threads/BinarySemaphore.h>
 
+#include <atomic>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -178,6 +181,387 @@ void purc_runloop_remove_fd_monitor(purc_runloop_t runloop, uintptr_t handle)
     ((RunLoop*)runloop)->removeFdMonitor(handle);
 }
 
+#define RUNNER_WORKER_THREAD_NAME   "hvml-worker"
+#define MAX_RUNNER_WORKERS          64
+
+/* An instance prepared or running in a worker thread. */
+struct hosted_instance {
+    struct pcinst          *inst;
+    /* the fd monitor of the connection to the renderer */
+    uintptr_t               conn_monitor;
+};
+
+/* A worker thread hosting some instances (M:N mode). The worker runs one
+   scheduling pass of its instances in turn in a function dispatched to its
+   run loop when an instance is added, a message is moved to an instance,
+   a timer, a fd monitor (e.g., the one of the connection to the renderer)
+   or a dispatched function of an instance was called, or the next idle
+   event of an instance is due; it keeps dispatching the passes while any
+   instance is busy. Otherwise, the run loop sleeps until one of the events
+   above. The instances are pinned to the worker because their timers and
+   fd monitors are bound to the run loop of the worker. */
+struct runner_worker {
+    RefPtr<Thread>          thread;
+    RunLoop                *runloop { nullptr };
+    std::unique_ptr<RunLoop::Timer<runner_worker>> idle_timer;
+
+    /* whether a scheduling pass has been dispatched but not run */
+    std::atomic<bool>       scheduled { false };
+
+    /* only accessed in the worker thread */
+    Vector<struct pcinst *> insts;
+    /* the hosted instances by the serial number */
+    HashMap<uintptr_t, struct hosted_instance> hosted;
+    std::atomic<unsigned>   nr_insts { 0 };
+
+    void idleTimerFired();
+};
+
+static struct runner_worker *_workers;
+static unsigned _nr_workers;
+static pthread_once_t _workers_once_control = PTHREAD_ONCE_INIT;
+
+/* the callbacks bound to the run loop of a worker carry the serial number
+   of the instance instead of the instance, so that the ones left by
+   a retired instance are dropped instead of switching to a freed one. */
+static std::atomic<uintptr_t> _hosted_serial;
+
+static thread_local struct runner_worker *_my_worker;
+
+static void worker_run_instances(struct runner_worker *worker);
+
+/* dispatches a scheduling pass to the worker; callable in any thread */
+static void worker_schedule(struct runner_worker *worker)
+{
+    if (worker->scheduled.exchange(true))
+        return;
+
+    /* the pass switches to the instances itself: do not bind it to
+       the instance current in the worker thread */
+    struct pcinst *old = NULL;
+    if (_my_worker == worker)
+        old = pcinst_switch(NULL);
+
+    worker->runloop->dispatch([worker] {
+            worker_run_instances(worker);
+            });
+
+    if (_my_worker == worker)
+        pcinst_switch(old);
+}
+
+void runner_worker::idleTimerFired()
+{
+    worker_schedule(this);
+}
+
+static void worker_wakeup_for_message(purc_atom_t owner, void *ctxt)
+{
+    UNUSED_PARAM(owner);
+    worker_schedule((struct runner_worker *)ctxt);
+}
+
+/* registers an instance being initialized in the worker thread */
+static void worker_add_hosted(struct runner_worker *worker,
+        struct pcinst *inst)
+{
+    inst->hosted_serial = ++_hosted_serial;
+    worker->hosted.add(inst->hosted_serial, hosted_instance { inst, 0 });
+}
+
+/* drops the instance and the callbacks left by it */
+static void worker_remove_hosted(struct runner_worker *worker,
+        struct pcinst *inst)
+{
+    auto it = worker->hosted.find(inst->hosted_serial);
+    if (it == worker->hosted.end())
+        return;
+
+    if (it->value.conn_monitor)
+        worker->runloop->removeFdMonitor(it->value.conn_monitor);
+    worker->hosted.remove(it);
+}
+
+/* wakes the worker up for the messages from the renderer instead of
+   polling the connection; the instance is current */
+static void worker_monitor_conn(struct runner_worker *worker,
+        struct pcinst *inst)
+{
+    struct pcrdr_conn *conn = purc_get_conn_to_renderer();
+    int fd = conn ? pcrdr_conn_fd(conn) : -1;
+    if (fd < 0)
+        return;
+
+    auto it = worker->hosted.find(inst->hosted_serial);
+    if (it == worker->hosted.end())
+        return;
+
+    /* the context hooks schedule the worker after the callback;
+       a broken connection is handled in the pass, then not monitored */
+    it->value.conn_monitor = worker->runloop->addFdMonitor(fd,
+            (GIOCondition)(G_IO_IN | G_IO_HUP | G_IO_ERR),
+            [] (gint fd, GIOCondition condition) -> gboolean {
+                UNUSED_PARAM(fd);
+                return !(condition & (G_IO_HUP | G_IO_ERR | G_IO_NVAL));
+            });
+}
+
+static void retire_instance(struct runner_worker *worker,
+        struct pcinst *inst)
+{
+    purc_atom_t atom = inst->intr_heap->move_buff;
+
+    worker_remove_hosted(worker, inst);
+
+    pcinst_switch(inst);
+    pcrun_notify_instmgr(PCRUN_EVENT_inst_stopped, atom);
+
+    purc_cond_handler handler = inst->intr_heap->cond_handler;
+    if (handler) {
+        handler(PURC_COND_STOPPED, (void *)(uintptr_t)atom, NULL);
+    }
+
+    purc_cleanup();
+    pcinst_switch(NULL);
+    free(inst);
+}
+
+static void worker_run_instances(struct runner_worker *worker)
+{
+    bool busy = false;
+    double next_idle = 0;
+
+    worker->scheduled = false;
+
+    for (size_t i = 0; i < worker->insts.size();) {
+        struct pcinst *inst = worker->insts[i];
+
+        pcinst_switch(inst);
+        if (pcintr_schedule_once(inst)) {
+            busy = true;
+        }
+        else {
+            double t = pcintr_next_idle_event_time(inst);
+            if (t > 0 && (next_idle == 0 || t < next_idle))
+                next_idle = t;
+        }
+        pcinst_switch(NULL);
+
+        if (inst->hosted_stopped) {
+            worker->insts.remove(i);
+            worker->nr_insts--;
+            retire_instance(worker, inst);
+            continue;
+        }
+
+        i++;
+    }
+
+    if (busy) {
+        /* the events and timers get their turn before the next pass */
+        worker_schedule(worker);
+    }
+    else if (next_idle > 0) {
+        /* the idle event is broadcast once the time has passed */
+        double delay = next_idle + 1 - pcintr_get_current_time();
+        worker->idle_timer->startOneShot(
+                Seconds::fromMilliseconds(delay > 0 ? delay : 0));
+    }
+    else {
+        worker->idle_timer->stop();
+    }
+}
+
+/* the context of a run loop is the instance hosted by the worker */
+static void *hosted_context(RunLoop& target)
+{
+    if (_my_worker && _my_worker->runloop == &target) {
+        struct pcinst *inst = pcinst_current();
+        if (inst && inst->is_hosted)
+            return (void *)inst->hosted_serial;
+    }
+
+    return nullptr;
+}
+
+/* called around the timers, the fd monitors and the functions dispatched
+   by the hosted instances; the instance left may have become runnable. */
+static bool switch_hosted_context(void *context, void **old)
+{
+    struct pcinst *inst = NULL;
+
+    if (context) {
+        assert(_my_worker);
+        auto it = _my_worker->hosted.find((uintptr_t)context);
+        if (it == _my_worker->hosted.end())
+            return false;   /* retired */
+        inst = it->value.inst;
+    }
+
+    struct pcinst *left = pcinst_switch(inst);
+    if (left && left->is_hosted) {
+        *old = (void *)left->hosted_serial;
+        worker_schedule(_my_worker);
+    }
+
+    return true;
+}
+
+static void _workers_init_once(void)
+{
+    const char *env_value = getenv(PURC_ENVV_RUNNER_WORKERS);
+    if (env_value == NULL)
+        return;
+
+    long nr = strtol(env_value, NULL, 10);
+    if (nr <= 0)
+        return;
+    if (nr > MAX_RUNNER_WORKERS)
+        nr = MAX_RUNNER_WORKERS;
+
+    RunLoop::setContextHooks(hosted_context, switch_hosted_context);
+
+    _workers = new runner_worker[nr];
+    for (long i = 0; i < nr; i++) {
+        struct runner_worker *worker = _workers + i;
+        BinarySemaphore semaphore;
+
+        worker->thread = Thread::create(RUNNER_WORKER_THREAD_NAME, [&] {
+                _my_worker = worker;
+                worker->runloop = &RunLoop::current();
+                worker->idle_timer = makeUnique<RunLoop::Timer<runner_worker>>(
+                        *worker->runloop, worker,
+                        &runner_worker::idleTimerFired);
+                semaphore.signal();
+
+                RunLoop::run();
+                });
+        worker->thread->detach();
+        semaphore.wait();
+    }
+
+    _nr_workers = nr;
+    PC_DEBUG("%u runner workers started\n", _nr_workers);
+}
+
+static struct runner_worker *get_least_loaded_worker(void)
+{
+    pthread_once(&_workers_once_control, _workers_init_once);
+
+    struct runner_worker *found = NULL;
+    for (unsigned i = 0; i < _nr_workers; i++) {
+        if (found == NULL || _workers[i].nr_insts < found->nr_insts)
+            found = _workers + i;
+    }
+
+    return found;
+}
+
+/* initializes an instance in the worker thread without starting it */
+static struct pcinst *prepare_hosted_instance(struct runner_worker *worker,
+        const char *app_name, const char *runner_name,
+        struct purc_instance_extra_info *extra_info)
+{
+    struct pcinst *inst = (struct pcinst *)calloc(1, sizeof(*inst));
+    if (inst == NULL)
+        return NULL;
+
+    /* mark it before initializing to bind the timers to the instance */
+    inst->is_hosted = 1;
+    worker_add_hosted(worker, inst);
+    pcinst_switch(inst);
+
+    int ret = purc_init_ex(PURC_MODULE_HVML, app_name, runner_name,
+            extra_info);
+    pcinst_switch(NULL);
+    if (ret != PURC_ERROR_OK) {
+        worker_remove_hosted(worker, inst);
+        free(inst);
+        return NULL;
+    }
+
+    assert(inst->intr_heap);
+    return inst;
+}
+
+/* starts a prepared instance in the worker thread; the instance is current */
+static purc_atom_t start_hosted_instance(struct runner_worker *worker,
+        struct pcinst *inst, purc_cond_handler cond_handler,
+        struct purc_instance_extra_info *extra_info)
+{
+    purc_atom_t atom = inst->intr_heap->move_buff;
+
+    /* what purc_run() does for an instance running in its own thread */
+    inst->intr_heap->keep_alive = 0;
+    inst->intr_heap->cond_handler = cond_handler;
+    pcinst_set_move_buffer_wakeup(worker_wakeup_for_message, worker);
+    worker_monitor_conn(worker, inst);
+
+    if (cond_handler) {
+        cond_handler(PURC_COND_STARTED, (void *)(uintptr_t)atom, extra_info);
+    }
+
+    worker->insts.append(inst);
+    worker->nr_insts++;
+    worker_schedule(worker);
+    return atom;
+}
+
+/* called in the worker thread */
+static purc_atom_t host_instance(struct runner_worker *worker,
+        const char *app_name, const char *runner_name,
+        purc_cond_handler cond_handler,
+        struct purc_instance_extra_info *extra_info)
+{
+    struct pcinst *inst = prepare_hosted_instance(worker, app_name,
+            runner_name, extra_info);
+    if (inst == NULL)
+        return 0;
+
+    pcinst_switch(inst);
+    purc_atom_t atom = start_hosted_instance(worker, inst, cond_handler,
+            extra_info);
+    pcinst_switch(NULL);
+    return atom;
+}
+
+extern "C" void
+pcrun_stop_running_loop(struct pcinst *inst)
+{
+    if (inst->is_hosted) {
+        /* the worker retires the instance after this scheduling pass */
+        inst->hosted_stopped = 1;
+    }
+    else {
+        purc_runloop_stop(inst->running_loop);
+    }
+}
+
+static void *get_self_thread(void)
+{
+#if USE(PTHREADS)
+    pthread_t *my_th = (pthread_t *)malloc(sizeof(pthread_t));
+    *my_th = pthread_self();
+    return (void *)my_th;
+#else
+#error "Need code when not using PThreads"
+#endif
+}
+
+/* runs the current instance in its own thread until it stops */
+static void run_instance(struct pcinst *inst, purc_atom_t atom,
+        purc_cond_handler handler)
+{
+    purc_run(handler);
+
+    pcrun_notify_instmgr(PCRUN_EVENT_inst_stopped, atom);
+    if ((handler = inst->intr_heap->cond_handler)) {
+        handler(PURC_COND_STOPPED, (void *)(uintptr_t)atom, NULL);
+    }
+
+    purc_cleanup();
+}
+
 extern "C" purc_atom_t
 pcrun_create_inst_thread(const char *app_name, const char *runner_name,
         purc_cond_handler cond_handler,
@@ -186,6 +570,20 @@ pcrun_create_inst_thread(const char *app_name, const char *runner_name,
     purc_atom_t atom = 0;
     BinarySemaphore semaphore;
 
+    struct runner_worker *worker = get_least_loaded_worker();
+    if (worker) {
+        worker->runloop->dispatch([&] {
+                atom = host_instance(worker, app_name, runner_name,
+                        cond_handler, extra_info);
+                semaphore.signal();
+                });
+        semaphore.wait();
+
+        /* no thread of its own */
+        *th = NULL;
+        return atom;
+    }
+
     RefPtr<Thread> inst_th =
         Thread::create("hvml-instance", [&] {
                 int ret = purc_init_ex(PURC_MODULE_HVML,
@@ -202,28 +600,14 @@ pcrun_create_inst_thread(const char *app_name, const char *runner_name,
 
                     purc_cond_handler my_handler = cond_handler;
 
-#if USE(PTHREADS)
-                    pthread_t *my_th = (pthread_t *)malloc(sizeof(pthread_t));
-                    *my_th = pthread_self();
-                    *th = (void *)my_th;
-#else
-#error "Need code when not using PThreads"
-#endif
+                    *th = get_self_thread();
                     if (cond_handler) {
                         cond_handler(PURC_COND_STARTED,
                                 (void *)(uintptr_t)atom, extra_info);
                     }
                     semaphore.signal();
 
-                    purc_run(my_handler);
-
-                    pcrun_notify_instmgr(PCRUN_EVENT_inst_stopped, my_atom);
-                    if ((my_handler = inst->intr_heap->cond_handler)) {
-                        my_handler(PURC_COND_STOPPED,
-                                (void *)(uintptr_t)my_atom, NULL);
-                    }
-
-                    purc_cleanup();
+                    run_instance(inst, my_atom, my_handler);
                 }
             });
 
@@ -233,6 +617,382 @@ pcrun_create_inst_thread(const char *app_name, const char *runner_name,
     return atom;
 }
 
+#define WARM_RUNNER_NAME_FORMAT     "_warm%u"
+/* the maximal number of warm instances of all apps */
+#define MAX_WARM_INSTANCES          32
+
+/* A createInstance request which claims a pre-warmed instance. */
+struct claim_info {
+    const char                         *app_name;
+    const char                         *runner_name;
+    purc_cond_handler                   cond_handler;
+    struct purc_instance_extra_info    *extra_info;
+    void                              **th;
+
+    purc_atom_t                         atom { 0 };
+    BinarySemaphore                     done;
+};
+
+/* An idle instance initialized with a placeholder runner name. */
+struct warm_instance {
+    struct pcinst          *inst { nullptr };
+    /* the worker hosting the instance; NULL if it has its own thread */
+    struct runner_worker   *worker { nullptr };
+    /* the own thread; joined when the instance is torn down */
+    RefPtr<Thread>          thread;
+
+    /* signaled when the initialization is done */
+    BinarySemaphore         ready;
+    bool                    is_ready { false };
+
+    /* the own thread waits for being claimed; no claim to tear it down */
+    BinarySemaphore         claimed;
+    struct claim_info      *claim { nullptr };
+};
+
+struct warm_pool {
+    char                           *app_name;
+    /* the serial number of the last claim, for the eviction */
+    unsigned                        last_claimed;
+    Vector<struct warm_instance *>  warming;
+    Vector<struct warm_instance *>  idle;
+};
+
+/* the pools are only accessed in the thread of the instance manager */
+static unsigned _warm_pool_size;
+static Vector<struct warm_pool *> _warm_pools;
+static unsigned _warm_serial;
+static unsigned _nr_claims;
+/* the number of the warm instances being initialized or idle */
+static unsigned _nr_warm_insts;
+
+/* read by purc_get_warm_runner_stats() in any thread */
+static std::atomic<unsigned> _nr_warm_hits;
+static std::atomic<unsigned> _nr_warm_misses;
+static std::atomic<unsigned> _nr_idle_warm_insts;
+
+static void _warm_pools_init(void)
+{
+    const char *env_value = getenv(PURC_ENVV_RUNNER_POOL_SIZE);
+    if (env_value == NULL)
+        return;
+
+    long nr = strtol(env_value, NULL, 10);
+    if (nr <= 0)
+        return;
+
+    _warm_pool_size = (nr > MAX_WARM_INSTANCES) ? MAX_WARM_INSTANCES : nr;
+}
+
+/* only the instances without a renderer can be renamed */
+static bool can_use_warm_instance(
+        const struct purc_instance_extra_info *extra_info)
+{
+    if (_warm_pool_size == 0)
+        return false;
+
+    return extra_info == NULL ||
+        (extra_info->renderer_comm == PURC_RDRCOMM_HEADLESS &&
+         extra_info->renderer_uri == NULL &&
+         extra_info->workspace_name == NULL &&
+         extra_info->workspace_title == NULL &&
+         extra_info->workspace_layout == NULL);
+}
+
+static struct warm_pool *find_warm_pool(const char *app_name, bool create)
+{
+    for (struct warm_pool *pool : _warm_pools) {
+        if (strcmp(pool->app_name, app_name) == 0)
+            return pool;
+    }
+
+    if (!create)
+        return NULL;
+
+    struct warm_pool *pool = new warm_pool { strdup(app_name), 0, { }, { } };
+    _warm_pools.append(pool);
+    return pool;
+}
+
+/* cleans up an instance which has not been claimed up and frees it */
+static void tear_down_warm_instance(struct warm_instance *warm)
+{
+    struct runner_worker *worker = warm->worker;
+    struct pcinst *inst = warm->inst;
+
+    if (worker && inst) {
+        BinarySemaphore done;
+        worker->runloop->dispatch([worker, inst, &done] {
+                worker_remove_hosted(worker, inst);
+                pcinst_switch(inst);
+                purc_cleanup();
+                pcinst_switch(NULL);
+                free(inst);
+                done.signal();
+                });
+        done.wait();
+    }
+    else if (warm->thread) {
+        warm->claim = NULL;
+        warm->claimed.signal();
+        warm->thread->waitForCompletion();
+    }
+
+    _nr_warm_insts--;
+    delete warm;
+}
+
+/* called in the thread of the instance manager, or when draining */
+static void warm_instance_ready(struct warm_pool *pool,
+        struct warm_instance *warm)
+{
+    if (warm->is_ready)
+        return;
+
+    warm->is_ready = true;
+    pool->warming.removeFirst(warm);
+    if (warm->inst == NULL) {
+        tear_down_warm_instance(warm);
+        return;
+    }
+
+    pool->idle.append(warm);
+    _nr_idle_warm_insts++;
+}
+
+/* called in the thread initializing the warm instance */
+static void notify_warm_instance_ready(struct warm_pool *pool,
+        struct warm_instance *warm)
+{
+    warm->ready.signal();
+    RunLoop::main().dispatch([pool, warm] {
+            warm_instance_ready(pool, warm);
+            });
+}
+
+/* renames the current instance and starts it; called in its thread */
+static purc_atom_t activate_warm_instance(struct pcinst *inst,
+        struct claim_info *claim)
+{
+    int ret = pcinst_rename(claim->app_name, claim->runner_name);
+    if (ret) {
+        PC_DEBUG("Failed to rename a warm instance: %d\n", ret);
+        purc_cleanup();
+        return 0;
+    }
+
+    return inst->intr_heap->move_buff;
+}
+
+static void warm_up_in_own_thread(struct warm_pool *pool,
+        struct warm_instance *warm, char *runner_name)
+{
+    warm->thread = Thread::create("hvml-instance", [pool, warm, runner_name] {
+            int ret = purc_init_ex(PURC_MODULE_HVML,
+                    pool->app_name, runner_name, NULL);
+            free(runner_name);
+
+            struct pcinst *inst = NULL;
+            if (ret == PURC_ERROR_OK)
+                warm->inst = inst = pcinst_current();
+            notify_warm_instance_ready(pool, warm);
+            if (inst == NULL)
+                return;
+
+            /* the claimer frees `warm` after `claim->done` is signaled */
+            warm->claimed.wait();
+            struct claim_info *claim = warm->claim;
+            if (claim == NULL) {
+                purc_cleanup();
+                return;
+            }
+
+            purc_atom_t atom = activate_warm_instance(inst, claim);
+            if (atom == 0) {
+                claim->done.signal();
+                return;
+            }
+
+            purc_cond_handler handler = claim->cond_handler;
+            *claim->th = get_self_thread();
+            if (handler) {
+                handler(PURC_COND_STARTED, (void *)(uintptr_t)atom,
+                        claim->extra_info);
+            }
+            claim->atom = atom;
+            claim->done.signal();
+
+            run_instance(inst, atom, handler);
+            });
+}
+
+static void warm_up_in_worker(struct warm_pool *pool,
+        struct warm_instance *warm, char *runner_name)
+{
+    struct runner_worker *worker = warm->worker;
+
+    worker->runloop->dispatch([worker, pool, warm, runner_name] {
+            warm->inst = prepare_hosted_instance(worker, pool->app_name,
+                    runner_name, NULL);
+            free(runner_name);
+            notify_warm_instance_ready(pool, warm);
+            });
+}
+
+/* tears down an idle instance of the pool claimed least recently
+   other than `except`; returns false if there is none. */
+static bool evict_warm_instance(struct warm_pool *except)
+{
+    struct warm_pool *victim = NULL;
+    for (struct warm_pool *pool : _warm_pools) {
+        if (pool == except || pool->idle.isEmpty())
+            continue;
+        if (victim == NULL || pool->last_claimed < victim->last_claimed)
+            victim = pool;
+    }
+
+    if (victim == NULL)
+        return false;
+
+    PC_DEBUG("InstMgr evicts a warm instance of %s\n", victim->app_name);
+    struct warm_instance *warm = victim->idle.first();
+    victim->idle.remove(0);
+    _nr_idle_warm_insts--;
+    tear_down_warm_instance(warm);
+    return true;
+}
+
+extern "C" void
+pcrun_replenish_warm_instances(const char *app_name,
+        const struct purc_instance_extra_info *extra_info)
+{
+    if (!can_use_warm_instance(extra_info))
+        return;
+
+    struct warm_pool *pool = find_warm_pool(app_name, true);
+    while (pool->idle.size() + pool->warming.size() < _warm_pool_size) {
+        if (_nr_warm_insts >= MAX_WARM_INSTANCES && !evict_warm_instance(pool))
+            break;
+
+        char runner_name[PURC_LEN_RUNNER_NAME + 1];
+        snprintf(runner_name, sizeof(runner_name), WARM_RUNNER_NAME_FORMAT,
+                ++_warm_serial);
+
+        struct warm_instance *warm = new warm_instance();
+        warm->worker = get_least_loaded_worker();
+        pool->warming.append(warm);
+        _nr_warm_insts++;
+
+        if (warm->worker)
+            warm_up_in_worker(pool, warm, strdup(runner_name));
+        else
+            warm_up_in_own_thread(pool, warm, strdup(runner_name));
+    }
+}
+
+extern "C" purc_atom_t
+pcrun_claim_warm_instance(const char *app_name, const char *runner_name,
+        purc_cond_handler cond_handler,
+        struct purc_instance_extra_info *extra_info, void **th)
+{
+    if (!can_use_warm_instance(extra_info))
+        return 0;
+
+    struct warm_pool *pool = find_warm_pool(app_name, false);
+    if (pool)
+        pool->last_claimed = ++_nr_claims;
+
+    while (pool && !pool->idle.isEmpty()) {
+        struct warm_instance *warm = pool->idle.takeLast();
+        _nr_idle_warm_insts--;
+        _nr_warm_insts--;
+
+        struct claim_info claim;
+        claim.app_name = app_name;
+        claim.runner_name = runner_name;
+        claim.cond_handler = cond_handler;
+        claim.extra_info = extra_info;
+        claim.th = th;
+
+        struct runner_worker *worker = warm->worker;
+        if (worker) {
+            struct pcinst *inst = warm->inst;
+            worker->runloop->dispatch([worker, inst, &claim] {
+                    pcinst_switch(inst);
+                    purc_atom_t atom = activate_warm_instance(inst, &claim);
+                    if (atom) {
+                        claim.atom = start_hosted_instance(worker, inst,
+                                claim.cond_handler, claim.extra_info);
+                    }
+                    pcinst_switch(NULL);
+                    if (atom == 0) {
+                        worker_remove_hosted(worker, inst);
+                        free(inst);
+                    }
+                    claim.done.signal();
+                    });
+            *th = NULL;
+        }
+        else {
+            /* the instance runs in the thread until it stops */
+            warm->thread->detach();
+            warm->claim = &claim;
+            warm->claimed.signal();
+        }
+
+        claim.done.wait();
+        delete warm;
+
+        if (claim.atom) {
+            _nr_warm_hits++;
+            PC_DEBUG("InstMgr claimed a warm instance for %s/%s\n",
+                    app_name, runner_name);
+            return claim.atom;
+        }
+    }
+
+    _nr_warm_misses++;
+    return 0;
+}
+
+/* tears down all warm instances and frees the pools when the instance
+   manager quits */
+static void drain_warm_pools(void)
+{
+    for (struct warm_pool *pool : _warm_pools) {
+        /* the notifications dispatched to the run loop are not handled */
+        while (!pool->warming.isEmpty()) {
+            struct warm_instance *warm = pool->warming.first();
+            warm->ready.wait();
+            warm_instance_ready(pool, warm);
+        }
+
+        while (!pool->idle.isEmpty()) {
+            _nr_idle_warm_insts--;
+            tear_down_warm_instance(pool->idle.takeLast());
+        }
+
+        free(pool->app_name);
+        delete pool;
+    }
+
+    _warm_pools.clear();
+}
+
+extern "C" int
+purc_get_warm_runner_stats(unsigned *nr_hits, unsigned *nr_misses,
+        unsigned *nr_warm)
+{
+    if (nr_hits)
+        *nr_hits = _nr_warm_hits;
+    if (nr_misses)
+        *nr_misses = _nr_warm_misses;
+    if (nr_warm)
+        *nr_warm = _nr_idle_warm_insts;
+
+    return (_warm_pool_size > 0) ? 0 : -1;
+}
+
 static void my_sa_free(void *sortv, void *data)
 {
     (void)sortv;
@@ -242,6 +1002,15 @@ static void my_sa_free(void *sortv, void *data)
 
 #define MAIN_RUNLOOP_THREAD_NAME    "__purc_main_runloop_thread"
 
+static void instmgr_wakeup(purc_atom_t owner, void *ctxt)
+{
+    UNUSED_PARAM(owner);
+    struct instmgr_info *info = (struct instmgr_info *)ctxt;
+    RunLoop::main().dispatch([info]() {
+            pcrun_instmgr_handle_message(info);
+            });
+}
+
 static RefPtr<Thread> _main_thread;
 static pthread_once_t _main_once_control = PTHREAD_ONCE_INIT;
 
@@ -278,16 +1047,28 @@ static void _runloop_init_main(void)
             semaphore.signal();
 
             pcinst_current()->is_instmgr = 1;
+            _warm_pools_init();
             info.sa_insts = pcutils_sorted_array_create(SAFLAG_DEFAULT, 0,
                     my_sa_free, NULL);
 
-            purc_runloop_func func = pcrun_instmgr_handle_message;
-            runloop.setIdleCallback([func, &info]() {
-                    func(&info);
+            /* drain the move buffer when a message is moved in instead of
+               polling it in the idle callback */
+            pcinst_set_move_buffer_wakeup(instmgr_wakeup, &info);
+            runloop.dispatch([&info]() {
+                    pcrun_instmgr_handle_message(&info);
                     });
 
             runloop.run();
 
+            pcinst_set_move_buffer_wakeup(NULL, NULL);
+
+            if (_warm_pool_size > 0) {
+                purc_log_info("InstMgr claimed warm instances: "
+                        "%u hits, %u misses\n", (unsigned)_nr_warm_hits,
+                        (unsigned)_nr_warm_misses);
+                drain_warm_pools();
+            }
+
             pcutils_sorted_array_destroy(info.sa_insts);
 
             size_t n = purc_inst_destroy_move_buffer();
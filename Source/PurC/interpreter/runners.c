@@ -195,7 +195,7 @@ static void shutdown_instance(purc_atom_t requester,
 
     if (inst->intr_heap->keep_alive == 0 && list_empty(&inst->intr_heap->crtns)
             && list_empty(&inst->intr_heap->stopped_crtns)) {
-        purc_runloop_stop(inst->running_loop);
+        pcrun_stop_running_loop(inst);
     }
 
     response->type = PCRDR_MSG_TYPE_RESPONSE;
@@ -452,13 +452,18 @@ static void create_instance(struct instmgr_info *mgr_info,
     }
 
     void *th = NULL;
-    atom = pcrun_create_inst_thread(app_name, runner_name, cond_handler,
+    atom = pcrun_claim_warm_instance(app_name, runner_name, cond_handler,
             &info, &th);
+    if (atom == 0) {
+        atom = pcrun_create_inst_thread(app_name, runner_name, cond_handler,
+                &info, &th);
+    }
     if (atom) {
         pcutils_sorted_array_add(mgr_info->sa_insts,
                 (void *)(uintptr_t)atom, th, NULL);
         mgr_info->nr_insts++;
     }
+    pcrun_replenish_warm_instances(app_name, &info);
 
 done:
     response->type = PCRDR_MSG_TYPE_RESPONSE;
@@ -618,24 +623,8 @@ static void kill_instance(struct instmgr_info *info,
     }
 }
 
-void pcrun_instmgr_handle_message(void *ctxt)
+static void handle_message(struct instmgr_info *info, pcrdr_msg *msg)
 {
-    struct instmgr_info *info = ctxt;
-
-    size_t n;
-    int ret = purc_inst_holding_messages_count(&n);
-    if (ret) {
-        purc_log_error("Failed to check messages in move buffer: %d\n", ret);
-        return;
-    }
-    else if (n == 0) {
-        // sleep 1ms to take a breath
-        pcutils_usleep(1000);
-        return;
-    }
-
-    /* there is a new message */
-    pcrdr_msg *msg = purc_inst_take_away_message(0);
     if (msg->type == PCRDR_MSG_TYPE_REQUEST) {
         const char* source_uri;
         purc_atom_t requester;
@@ -749,6 +738,31 @@ void pcrun_instmgr_handle_message(void *ctxt)
     pcrdr_release_message(msg);
 }
 
+void pcrun_instmgr_handle_message(void *ctxt)
+{
+    struct instmgr_info *info = ctxt;
+
+    /* called when messages are moved in; handle all of them */
+    while (true) {
+        size_t n;
+        int ret = purc_inst_holding_messages_count(&n);
+        if (ret) {
+            purc_log_error("Failed to check messages in move buffer: %d\n",
+                    ret);
+            break;
+        }
+        else if (n == 0) {
+            break;
+        }
+
+        pcrdr_msg *msg = purc_inst_take_away_message(0);
+        if (msg == NULL)
+            break;
+
+        handle_message(info, msg);
+    }
+}
+
 
 purc_atom_t
 purc_inst_create_or_get(const char *app_name, const char *runner_name,
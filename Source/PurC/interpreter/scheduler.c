@@ -758,23 +758,16 @@ again:
     return is_busy;
 }
 
-void
-pcintr_schedule(void *ctxt)
+bool
+pcintr_schedule_once(struct pcinst *inst)
 {
     bool step_is_busy;
     bool event_is_busy;
-    struct pcinst *inst = (struct pcinst *)ctxt;
-    if (!inst) {
-        goto out_sleep;
-    }
-
     struct pcintr_heap *heap = inst->intr_heap;
     if (!heap) {
-        goto out_sleep;
+        return false;
     }
 
-again:
-
     // 1. exec one step for all ready coroutines and
     // return whether step is busy
     step_is_busy = execute_one_step(inst);
@@ -782,10 +775,10 @@ again:
     // 2. dispatch event for observing / stopped coroutines
     event_is_busy = dispatch_event(inst);
 
-    // 3. its busy, goto next scheduler without sleep
+    // 3. its busy, call the scheduler again without sleep
     if (step_is_busy || event_is_busy) {
         pcintr_update_timestamp(inst);
-        goto again;
+        return true;
     }
 
     // 5. broadcast idle event
@@ -795,10 +788,41 @@ again:
         pcintr_update_timestamp(inst);
     }
 
-out_sleep:
-    pcutils_usleep(SCHEDULE_SLEEP);
+    return false;
+}
+
+double
+pcintr_next_idle_event_time(struct pcinst *inst)
+{
+    struct pcintr_heap *heap = inst->intr_heap;
+    if (!heap) {
+        return 0;
+    }
 
-    return;
+    pcintr_coroutine_t co;
+    list_for_each_entry(co, &heap->crtns, ln) {
+        if (co->stack.observe_idle)
+            return heap->timestamp + IDLE_EVENT_TIMEOUT;
+    }
+
+    list_for_each_entry(co, &heap->stopped_crtns, ln) {
+        if (co->stack.observe_idle)
+            return heap->timestamp + IDLE_EVENT_TIMEOUT;
+    }
+
+    return 0;
+}
+
+void
+pcintr_schedule(void *ctxt)
+{
+    struct pcinst *inst = (struct pcinst *)ctxt;
+    if (inst) {
+        while (pcintr_schedule_once(inst))
+            ;
+    }
+
+    pcutils_usleep(SCHEDULE_SLEEP);
 }
 
 int pcintr_yield(
@@ -0,0 +1,994 @@
+/*
+ * @file shared-channel.c
+ * @date 2026/10/19
+ * @brief The implementation of the channel shared by runners.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//#undef NDEBUG
+
+#include "config.h"
+
+#include "internal.h"
+
+#include "purc-variant.h"
+#include "purc-helpers.h"
+#include "purc-ports.h"
+#include "private/channel.h"
+#include "private/instance.h"
+#include "private/interpreter.h"
+#include "private/variant.h"
+#include "private/map.h"
+#include "private/debug.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <time.h>
+
+/* this feature needs C11 (stdatomic.h) or above */
+#if HAVE(STDATOMIC_H)
+
+#include <stdatomic.h>
+
+/*
+ * A shared channel is a bounded lock-free MPMC ring buffer (after Dmitry
+ * Vyukov's algorithm) which holds variants living in the move heap.
+ * The senders and the receivers may live in different runners (threads).
+ *
+ * The lock of a channel only protects the lists of the parked coroutines.
+ * A parked coroutine is identified by the runner identifier and the
+ * coroutine identifier, and it is woken up by a PCCHAN_EVENT_WAKEUP event
+ * moved to the runner, so a peer never touches the coroutine directly.
+ */
+
+struct pcchan_cell {
+    atomic_size_t       seq;
+    purc_variant_t      vrt;
+};
+
+struct pcchan_waiter {
+    struct list_head    ln;
+    purc_atom_t         rid;
+    purc_atom_t         cid;
+};
+
+struct pcchan_shared {
+    /* the name of the channel */
+    char               *name;
+
+    /* size of the circular queue */
+    size_t              qsize;
+    struct pcchan_cell *cells;
+
+    /* positions to send and receive */
+    atomic_size_t       sendx;
+    atomic_size_t       recvx;
+
+    /* the registry and the entities, coroutines bound to this channel */
+    atomic_uint         refc;
+    atomic_bool         closed;
+
+    /* protects the following lists */
+    purc_mutex          lock;
+    /* list of coroutines waiting to send */
+    struct list_head    send_waiters;
+    /* list of coroutines waiting to receive */
+    struct list_head    recv_waiters;
+
+    /* statistics */
+    struct timespec     opened;
+    atomic_ullong       nr_sent;
+    atomic_ullong       nr_recv;
+    atomic_ullong       nr_send_waits;
+    atomic_ullong       nr_recv_waits;
+    atomic_ullong       nr_cloned;
+    atomic_size_t       peak_len;
+};
+
+#define WAITER_KIND_SEND        "send"
+#define WAITER_KIND_RECV        "recv"
+
+static purc_mutex       shchan_lock;
+static pcutils_map     *shchan_map;
+
+static void
+shchan_cleanup_once(void)
+{
+    if (shchan_map) {
+        /* the channels not closed are left to the system */
+        size_t n = pcutils_map_get_size(shchan_map);
+        if (n > 0) {
+            PC_WARN("%u shared channels not closed\n", (unsigned)n);
+        }
+
+        pcutils_map_destroy(shchan_map);
+        shchan_map = NULL;
+    }
+
+    if (shchan_lock.native_impl) {
+        purc_mutex_clear(&shchan_lock);
+        shchan_lock.native_impl = NULL;
+    }
+}
+
+int
+pcchan_shared_init_once(void)
+{
+    purc_mutex_init(&shchan_lock);
+    if (shchan_lock.native_impl == NULL)
+        goto fail_lock;
+
+    shchan_map = pcutils_map_create(NULL, NULL, NULL, NULL,
+            comp_key_string, false);
+    if (shchan_map == NULL)
+        goto fail_map;
+
+    if (atexit(shchan_cleanup_once))
+        goto fail_atexit;
+
+    return 0;
+
+fail_atexit:
+    pcutils_map_destroy(shchan_map);
+    shchan_map = NULL;
+
+fail_map:
+    purc_mutex_clear(&shchan_lock);
+    shchan_lock.native_impl = NULL;
+
+fail_lock:
+    return -1;
+}
+
+static bool
+ring_push(pcchan_shared_t chan, purc_variant_t vrt)
+{
+    struct pcchan_cell *cell;
+    size_t pos = atomic_load_explicit(&chan->sendx, memory_order_relaxed);
+
+    for (;;) {
+        cell = chan->cells + (pos % chan->qsize);
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&chan->sendx,
+                        &pos, pos + 1,
+                        memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0) {
+            /* full */
+            return false;
+        }
+        else {
+            pos = atomic_load_explicit(&chan->sendx, memory_order_relaxed);
+        }
+    }
+
+    cell->vrt = vrt;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+static purc_variant_t
+ring_pop(pcchan_shared_t chan)
+{
+    struct pcchan_cell *cell;
+    size_t pos = atomic_load_explicit(&chan->recvx, memory_order_relaxed);
+
+    for (;;) {
+        cell = chan->cells + (pos % chan->qsize);
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&chan->recvx,
+                        &pos, pos + 1,
+                        memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0) {
+            /* empty */
+            return PURC_VARIANT_INVALID;
+        }
+        else {
+            pos = atomic_load_explicit(&chan->recvx, memory_order_relaxed);
+        }
+    }
+
+    purc_variant_t vrt = cell->vrt;
+    cell->vrt = PURC_VARIANT_INVALID;
+    atomic_store_explicit(&cell->seq, pos + chan->qsize,
+            memory_order_release);
+    return vrt;
+}
+
+static size_t
+ring_length(pcchan_shared_t chan)
+{
+    size_t recvx = atomic_load_explicit(&chan->recvx, memory_order_relaxed);
+    size_t sendx = atomic_load_explicit(&chan->sendx, memory_order_relaxed);
+
+    if (sendx <= recvx)
+        return 0;
+    if (sendx - recvx > chan->qsize)
+        return chan->qsize;
+    return sendx - recvx;
+}
+
+/* unref a variant living in the move heap */
+static void
+discard_moved_variant(purc_variant_t vrt)
+{
+    pcvariant_use_move_heap();
+    purc_variant_unref(vrt);
+    pcvariant_use_norm_heap();
+}
+
+static unsigned int
+discard_data(pcchan_shared_t chan)
+{
+    unsigned int nr = 0;
+    purc_variant_t vrt;
+
+    while ((vrt = ring_pop(chan))) {
+        discard_moved_variant(vrt);
+        nr++;
+    }
+
+    return nr;
+}
+
+static pcchan_shared_t
+shchan_new(const char *chan_name, unsigned int cap)
+{
+    pcchan_shared_t chan = calloc(1, sizeof(*chan));
+    if (chan == NULL)
+        goto failed;
+
+    chan->cells = calloc(cap, sizeof(struct pcchan_cell));
+    if (chan->cells == NULL)
+        goto failed;
+
+    chan->name = strdup(chan_name);
+    if (chan->name == NULL)
+        goto failed;
+
+    purc_mutex_init(&chan->lock);
+    if (chan->lock.native_impl == NULL)
+        goto failed;
+
+    chan->qsize = cap;
+    for (size_t i = 0; i < cap; i++) {
+        atomic_init(&chan->cells[i].seq, i);
+    }
+
+    atomic_init(&chan->sendx, 0);
+    atomic_init(&chan->recvx, 0);
+    atomic_init(&chan->refc, 1);
+    atomic_init(&chan->closed, false);
+    list_head_init(&chan->send_waiters);
+    list_head_init(&chan->recv_waiters);
+
+    clock_gettime(CLOCK_MONOTONIC, &chan->opened);
+    atomic_init(&chan->nr_sent, 0);
+    atomic_init(&chan->nr_recv, 0);
+    atomic_init(&chan->nr_send_waits, 0);
+    atomic_init(&chan->nr_recv_waits, 0);
+    atomic_init(&chan->nr_cloned, 0);
+    atomic_init(&chan->peak_len, 0);
+    return chan;
+
+failed:
+    if (chan) {
+        free(chan->name);
+        free(chan->cells);
+        free(chan);
+    }
+    return NULL;
+}
+
+static void
+free_waiters(struct list_head *waiters)
+{
+    struct list_head *p, *n;
+    list_for_each_safe(p, n, waiters) {
+        struct pcchan_waiter *waiter;
+        waiter = list_entry(p, struct pcchan_waiter, ln);
+        list_del(p);
+        free(waiter);
+    }
+}
+
+static void
+shchan_destroy(pcchan_shared_t chan)
+{
+    unsigned int nr = discard_data(chan);
+    if (nr > 0) {
+        PC_WARN("destroying a shared channel not empty: %s (%u)\n",
+                chan->name, nr);
+    }
+
+    free_waiters(&chan->send_waiters);
+    free_waiters(&chan->recv_waiters);
+    purc_mutex_clear(&chan->lock);
+    free(chan->cells);
+    free(chan->name);
+    free(chan);
+}
+
+static inline pcchan_shared_t
+shchan_ref(pcchan_shared_t chan)
+{
+    atomic_fetch_add(&chan->refc, 1);
+    return chan;
+}
+
+void
+pcchan_shared_unref(pcchan_shared_t chan)
+{
+    unsigned int refc = atomic_fetch_sub(&chan->refc, 1);
+    assert(refc > 0);
+    if (refc == 1) {
+        shchan_destroy(chan);
+    }
+}
+
+pcchan_shared_t
+pcchan_shared_open(const char *chan_name, unsigned int cap)
+{
+    if (UNLIKELY(chan_name == NULL || chan_name[0] == '\0' || cap == 0)) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    pcchan_shared_t chan = NULL;
+    pcutils_map_entry *entry;
+
+    purc_mutex_lock(&shchan_lock);
+    entry = pcutils_map_find(shchan_map, chan_name);
+    if (entry) {
+        chan = shchan_ref(entry->val);
+        goto done;
+    }
+
+    chan = shchan_new(chan_name, cap);
+    if (chan == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto done;
+    }
+
+    if (pcutils_map_insert(shchan_map, chan->name, chan)) {
+        shchan_destroy(chan);
+        chan = NULL;
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto done;
+    }
+
+    /* one for the registry and one for the caller */
+    shchan_ref(chan);
+
+done:
+    purc_mutex_unlock(&shchan_lock);
+    return chan;
+}
+
+pcchan_shared_t
+pcchan_shared_retrieve(const char *chan_name)
+{
+    pcchan_shared_t chan = NULL;
+    pcutils_map_entry *entry;
+
+    if (UNLIKELY(chan_name == NULL || chan_name[0] == '\0')) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    purc_mutex_lock(&shchan_lock);
+    entry = pcutils_map_find(shchan_map, chan_name);
+    if (entry) {
+        chan = shchan_ref(entry->val);
+    }
+    purc_mutex_unlock(&shchan_lock);
+
+    if (chan == NULL)
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+    return chan;
+}
+
+static bool
+resume_parked_coroutine(pcchan_shared_t chan, purc_atom_t cid)
+{
+    pcintr_coroutine_t crtn = pcintr_coroutine_get_by_id(cid);
+
+    if (crtn && crtn->state == CO_STATE_STOPPED &&
+            crtn->waiting_chan == chan) {
+        crtn->waiting_chan = NULL;
+        pcintr_resume_coroutine(crtn);
+        pcchan_shared_unref(chan);
+        return true;
+    }
+
+    return false;
+}
+
+static bool
+wake_waiter(pcchan_shared_t chan, struct pcchan_waiter *waiter,
+        const char *kind)
+{
+    struct pcinst *inst = pcinst_current();
+
+    if (inst && waiter->rid == inst->endpoint_atom) {
+        return resume_parked_coroutine(chan, waiter->cid);
+    }
+
+    pcrdr_msg *msg = pcrdr_make_event_message(
+            PCRDR_MSG_TARGET_COROUTINE, waiter->cid,
+            PCCHAN_EVENT_WAKEUP, NULL,
+            PCRDR_MSG_ELEMENT_TYPE_ID, chan->name, kind,
+            PCRDR_MSG_DATA_TYPE_VOID, NULL, 0);
+    if (msg == NULL)
+        return false;
+
+    /* zero if the runner has gone */
+    size_t n = purc_inst_move_message(waiter->rid, msg);
+    pcrdr_release_message(msg);
+    return n > 0;
+}
+
+/* wake up the first live waiter in the list */
+static void
+wake_one(pcchan_shared_t chan, struct list_head *waiters, const char *kind)
+{
+    for (;;) {
+        struct pcchan_waiter *waiter = NULL;
+
+        purc_mutex_lock(&chan->lock);
+        if (!list_empty(waiters)) {
+            waiter = list_first_entry(waiters, struct pcchan_waiter, ln);
+            list_del(&waiter->ln);
+        }
+        purc_mutex_unlock(&chan->lock);
+
+        if (waiter == NULL)
+            break;
+
+        bool woken = wake_waiter(chan, waiter, kind);
+        free(waiter);
+        if (woken)
+            break;
+    }
+}
+
+static void
+wake_all(pcchan_shared_t chan, struct list_head *waiters, const char *kind)
+{
+    struct list_head list;
+    list_head_init(&list);
+
+    purc_mutex_lock(&chan->lock);
+    list_splice_init(waiters, &list);
+    purc_mutex_unlock(&chan->lock);
+
+    struct list_head *p, *n;
+    list_for_each_safe(p, n, &list) {
+        struct pcchan_waiter *waiter;
+        waiter = list_entry(p, struct pcchan_waiter, ln);
+        list_del(p);
+        wake_waiter(chan, waiter, kind);
+        free(waiter);
+    }
+}
+
+void
+pcchan_shared_close(pcchan_shared_t chan)
+{
+    if (atomic_exchange(&chan->closed, true))
+        return;
+
+    bool registered = false;
+    purc_mutex_lock(&shchan_lock);
+    pcutils_map_entry *entry = pcutils_map_find(shchan_map, chan->name);
+    if (entry && entry->val == chan) {
+        pcutils_map_erase(shchan_map, chan->name);
+        registered = true;
+    }
+    purc_mutex_unlock(&shchan_lock);
+
+    unsigned int nr = discard_data(chan);
+    PC_DEBUG("closed shared channel %s; %u variants discarded\n",
+            chan->name, nr);
+
+    wake_all(chan, &chan->send_waiters, WAITER_KIND_SEND);
+    wake_all(chan, &chan->recv_waiters, WAITER_KIND_RECV);
+
+    if (registered)
+        pcchan_shared_unref(chan);
+}
+
+bool
+pcchan_shared_handle_wakeup(struct pcinst *inst, const pcrdr_msg *msg)
+{
+    UNUSED_PARAM(inst);
+
+    if (msg->type != PCRDR_MSG_TYPE_EVENT ||
+            msg->target != PCRDR_MSG_TARGET_COROUTINE ||
+            msg->elementType != PCRDR_MSG_ELEMENT_TYPE_ID)
+        return false;
+
+    const char *event = purc_variant_get_string_const(msg->eventName);
+    if (event == NULL || strcmp(event, PCCHAN_EVENT_WAKEUP))
+        return false;
+
+    const char *name = purc_variant_get_string_const(msg->elementValue);
+    const char *kind = purc_variant_get_string_const(msg->property);
+    if (name == NULL || kind == NULL)
+        return true;
+
+    pcintr_coroutine_t crtn = pcintr_coroutine_get_by_id(msg->targetValue);
+    if (crtn && crtn->waiting_chan &&
+            strcmp(crtn->waiting_chan->name, name) == 0 &&
+            resume_parked_coroutine(crtn->waiting_chan, crtn->cid))
+        return true;
+
+    /* the waiter has gone or timed out; pass the chance to the next one */
+    pcchan_shared_t chan = pcchan_shared_retrieve(name);
+    if (chan) {
+        if (strcmp(kind, WAITER_KIND_SEND) == 0)
+            wake_one(chan, &chan->send_waiters, WAITER_KIND_SEND);
+        else
+            wake_one(chan, &chan->recv_waiters, WAITER_KIND_RECV);
+        pcchan_shared_unref(chan);
+    }
+    else {
+        purc_clr_error();
+    }
+
+    return true;
+}
+
+/* park the current coroutine;
+   returns 1 if parked, 0 if no need to park any more, -1 on error. */
+static int
+park_coroutine(pcchan_shared_t chan, pcintr_coroutine_t crtn,
+        struct list_head *waiters, bool for_send)
+{
+    struct pcinst *inst = pcinst_current();
+    struct pcchan_waiter *waiter = calloc(1, sizeof(*waiter));
+    if (waiter == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    waiter->rid = inst->endpoint_atom;
+    waiter->cid = crtn->cid;
+
+    bool recheck;
+    purc_mutex_lock(&chan->lock);
+    struct pcchan_waiter *p;
+    list_for_each_entry(p, waiters, ln) {
+        if (p->rid == waiter->rid && p->cid == waiter->cid) {
+            free(waiter);
+            waiter = NULL;
+            break;
+        }
+    }
+    if (waiter)
+        list_add_tail(&waiter->ln, waiters);
+
+    /* check again after registered to avoid a lost wakeup */
+    if (for_send)
+        recheck = ring_length(chan) < chan->qsize;
+    else
+        recheck = ring_length(chan) > 0;
+    purc_mutex_unlock(&chan->lock);
+
+    if (recheck || atomic_load(&chan->closed)) {
+        return 0;
+    }
+
+    crtn->waiting_chan = shchan_ref(chan);
+    pcintr_stop_coroutine(crtn, &crtn->timeout);
+    if (for_send)
+        atomic_fetch_add(&chan->nr_send_waits, 1);
+    else
+        atomic_fetch_add(&chan->nr_recv_waits, 1);
+    return 1;
+}
+
+static void
+forget_waiter(pcchan_shared_t chan, pcintr_coroutine_t crtn)
+{
+    struct pcinst *inst = pcinst_current();
+    struct list_head *lists[] = { &chan->send_waiters, &chan->recv_waiters };
+
+    purc_mutex_lock(&chan->lock);
+    for (size_t i = 0; i < PCA_TABLESIZE(lists); i++) {
+        struct list_head *p, *n;
+        list_for_each_safe(p, n, lists[i]) {
+            struct pcchan_waiter *waiter;
+            waiter = list_entry(p, struct pcchan_waiter, ln);
+            if (waiter->rid == inst->endpoint_atom &&
+                    waiter->cid == crtn->cid) {
+                list_del(p);
+                free(waiter);
+            }
+        }
+    }
+    purc_mutex_unlock(&chan->lock);
+
+    if (crtn->waiting_chan) {
+        crtn->waiting_chan = NULL;
+        pcchan_shared_unref(chan);
+    }
+}
+
+static void
+update_peak_length(pcchan_shared_t chan)
+{
+    size_t len = ring_length(chan);
+    size_t peak = atomic_load_explicit(&chan->peak_len, memory_order_relaxed);
+    while (len > peak) {
+        if (atomic_compare_exchange_weak(&chan->peak_len, &peak, len))
+            break;
+    }
+}
+
+static purc_variant_t
+send_getter(void *native_entity, size_t nr_args, purc_variant_t *argv,
+                unsigned call_flags)
+{
+    pcchan_shared_t chan = native_entity;
+    pcintr_coroutine_t crtn = pcintr_get_coroutine();
+
+    if (call_flags & PCVRT_CALL_FLAG_AGAIN &&
+            call_flags & PCVRT_CALL_FLAG_TIMEOUT) {
+        if (crtn) {
+            forget_waiter(chan, crtn);
+            purc_set_error(PURC_ERROR_TIMEOUT);
+        }
+        else {
+            purc_set_error(PURC_ERROR_INTERNAL_FAILURE);
+        }
+        goto failed;
+    }
+
+    if (nr_args < 1) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        goto failed;
+    }
+
+    if (purc_variant_is_undefined(argv[0])) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto failed;
+    }
+
+again:
+    if (atomic_load(&chan->closed)) {
+        purc_set_error(PURC_ERROR_ENTITY_GONE);
+        goto failed;
+    }
+
+    if (ring_length(chan) < chan->qsize) {
+        /* a temporary string or byte sequence is handed over without
+           copying; other values are cloned into the move heap */
+        bool cloned;
+        purc_variant_t vrt = pcvariant_move_heap_in_borrowed(argv[0], &cloned);
+        if (vrt == PURC_VARIANT_INVALID)
+            goto failed;
+        if (cloned)
+            atomic_fetch_add_explicit(&chan->nr_cloned, 1,
+                    memory_order_relaxed);
+
+        if (ring_push(chan, vrt)) {
+            atomic_fetch_add_explicit(&chan->nr_sent, 1, memory_order_relaxed);
+            update_peak_length(chan);
+            wake_one(chan, &chan->recv_waiters, WAITER_KIND_RECV);
+            return purc_variant_make_boolean(true);
+        }
+
+        /* lost the race to another sender */
+        discard_moved_variant(vrt);
+    }
+
+    if (crtn) {
+        int r = park_coroutine(chan, crtn, &chan->send_waiters, true);
+        if (r < 0)
+            goto failed;
+        else if (r == 0)
+            goto again;
+    }
+
+    purc_set_error(PURC_ERROR_AGAIN);
+    return PURC_VARIANT_INVALID;
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+recv_getter(void *native_entity, size_t nr_args, purc_variant_t *argv,
+                unsigned call_flags)
+{
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    pcchan_shared_t chan = native_entity;
+    pcintr_coroutine_t crtn = pcintr_get_coroutine();
+
+    if (call_flags & PCVRT_CALL_FLAG_AGAIN &&
+            call_flags & PCVRT_CALL_FLAG_TIMEOUT) {
+        if (crtn) {
+            forget_waiter(chan, crtn);
+            purc_set_error(PURC_ERROR_TIMEOUT);
+        }
+        else {
+            purc_set_error(PURC_ERROR_INTERNAL_FAILURE);
+        }
+        goto failed;
+    }
+
+again:
+    if (atomic_load(&chan->closed)) {
+        purc_set_error(PURC_ERROR_ENTITY_GONE);
+        goto failed;
+    }
+
+    purc_variant_t vrt = ring_pop(chan);
+    if (vrt) {
+        atomic_fetch_add_explicit(&chan->nr_recv, 1, memory_order_relaxed);
+        wake_one(chan, &chan->send_waiters, WAITER_KIND_SEND);
+        return pcvariant_move_heap_out(vrt);
+    }
+
+    if (crtn) {
+        int r = park_coroutine(chan, crtn, &chan->recv_waiters, false);
+        if (r < 0)
+            goto failed;
+        else if (r == 0)
+            goto again;
+    }
+
+    purc_set_error(PURC_ERROR_AGAIN);
+    return PURC_VARIANT_INVALID;
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_undefined();
+
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+cap_getter(void *native_entity, size_t nr_args, purc_variant_t *argv,
+                unsigned call_flags)
+{
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    pcchan_shared_t chan = native_entity;
+    if (atomic_load(&chan->closed)) {
+        purc_set_error(PURC_ERROR_ENTITY_GONE);
+        goto failed;
+    }
+
+    return purc_variant_make_ulongint(chan->qsize);
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+len_getter(void *native_entity, size_t nr_args, purc_variant_t *argv,
+                unsigned call_flags)
+{
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    pcchan_shared_t chan = native_entity;
+    if (atomic_load(&chan->closed)) {
+        purc_set_error(PURC_ERROR_ENTITY_GONE);
+        goto failed;
+    }
+
+    return purc_variant_make_ulongint(ring_length(chan));
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+
+    return PURC_VARIANT_INVALID;
+}
+
+/* the throughput statistics of the channel */
+static purc_variant_t
+stats_getter(void *native_entity, size_t nr_args, purc_variant_t *argv,
+                unsigned call_flags)
+{
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    pcchan_shared_t chan = native_entity;
+    double elapsed = purc_get_elapsed_seconds(&chan->opened, NULL);
+    unsigned long long nr_sent = atomic_load(&chan->nr_sent);
+    unsigned long long nr_recv = atomic_load(&chan->nr_recv);
+
+    purc_variant_t vals[] = {
+        purc_variant_make_ulongint(nr_sent),
+        purc_variant_make_ulongint(nr_recv),
+        purc_variant_make_ulongint(atomic_load(&chan->nr_send_waits)),
+        purc_variant_make_ulongint(atomic_load(&chan->nr_recv_waits)),
+        purc_variant_make_ulongint(atomic_load(&chan->peak_len)),
+        purc_variant_make_number(elapsed),
+        purc_variant_make_number(elapsed > 0 ? nr_recv / elapsed : 0),
+        purc_variant_make_ulongint(atomic_load(&chan->nr_cloned)),
+    };
+
+    purc_variant_t retv = purc_variant_make_object_by_static_ckey(
+            PCA_TABLESIZE(vals),
+            "sent", vals[0], "received", vals[1],
+            "sendWaits", vals[2], "recvWaits", vals[3],
+            "peakLength", vals[4], "elapsed", vals[5],
+            "recvRate", vals[6], "cloned", vals[7]);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(vals); i++) {
+        if (vals[i])
+            purc_variant_unref(vals[i]);
+    }
+
+    if (retv == PURC_VARIANT_INVALID)
+        goto failed;
+
+    return retv;
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_nvariant_method
+property_getter(void *entity, const char *name)
+{
+    UNUSED_PARAM(entity);
+    switch (name[0]) {
+    case 's':
+        if (strcmp(name, "send") == 0) {
+            return send_getter;
+        }
+        else if (strcmp(name, "stats") == 0) {
+            return stats_getter;
+        }
+        break;
+
+    case 'r':
+        if (strcmp(name, "recv") == 0) {
+            return recv_getter;
+        }
+        break;
+
+    case 'c':
+        if (strcmp(name, "cap") == 0) {
+            return cap_getter;
+        }
+        break;
+
+    case 'l':
+        if (strcmp(name, "len") == 0) {
+            return len_getter;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return NULL;
+}
+
+static void
+on_release(void *native_entity)
+{
+    pcchan_shared_unref(native_entity);
+}
+
+purc_variant_t
+pcchan_shared_make_entity(pcchan_shared_t chan)
+{
+    static const struct purc_native_ops ops = {
+        .property_getter = property_getter,
+        .on_observe = NULL,
+        .on_forget = NULL,
+        .on_release = on_release,
+    };
+
+    if (atomic_load(&chan->closed)) {
+        pcchan_shared_unref(chan);
+        purc_set_error(PURC_ERROR_ENTITY_GONE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    purc_variant_t retv = purc_variant_make_native(chan, &ops);
+    if (retv == PURC_VARIANT_INVALID) {
+        pcchan_shared_unref(chan);
+    }
+
+    return retv;
+}
+
+#else   /* HAVE(STDATOMIC_H) */
+
+int
+pcchan_shared_init_once(void)
+{
+    return 0;
+}
+
+pcchan_shared_t
+pcchan_shared_open(const char *chan_name, unsigned int cap)
+{
+    UNUSED_PARAM(chan_name);
+    UNUSED_PARAM(cap);
+    purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+    return NULL;
+}
+
+pcchan_shared_t
+pcchan_shared_retrieve(const char *chan_name)
+{
+    UNUSED_PARAM(chan_name);
+    purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+    return NULL;
+}
+
+void
+pcchan_shared_close(pcchan_shared_t chan)
+{
+    UNUSED_PARAM(chan);
+}
+
+void
+pcchan_shared_unref(pcchan_shared_t chan)
+{
+    UNUSED_PARAM(chan);
+}
+
+purc_variant_t
+pcchan_shared_make_entity(pcchan_shared_t chan)
+{
+    UNUSED_PARAM(chan);
+    purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+    return PURC_VARIANT_INVALID;
+}
+
+bool
+pcchan_shared_handle_wakeup(struct pcinst *inst, const pcrdr_msg *msg)
+{
+    UNUSED_PARAM(inst);
+    UNUSED_PARAM(msg);
+    return false;
+}
+
+#endif  /* not HAVE(STDATOMIC_H) */
@@ -31,6 +31,7 @@
 #include "private/errors.h"
 #include "private/timer.h"
 #include "private/interpreter.h"
+#include "private/list.h"
 #include "purc-runloop.h"
 
 #include <wtf/RunLoop.h>
@@ -38,6 +39,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 class Timer : public PurCWTF::RunLoop::TimerBase {
     public:
@@ -160,10 +162,45 @@ pcintr_timer_destroy(pcintr_timer_t timer)
 #define TIMERS_STR_TIMERS           "TIMERS"
 #define TIMERS_STR_EXPIRED          "expired"
 
+/*
+ * The timers in $TIMERS of all coroutines of an instance live in one hashed
+ * timing wheel whose tick is one millisecond: a timer is linked into the
+ * slot of its expiry tick, so starting, stopping and restarting a timer are
+ * O(1) and leave nothing behind in the run loop. The wheel is driven by a
+ * single one-shot run loop timer armed for the earliest expiry; all timers
+ * expiring in the same tick are fired by the same wake-up. A bitmap of the
+ * non-empty slots and the earliest expiry of each slot let a wake-up visit
+ * only the slots which are due.
+ */
+#define TIMERS_WHEEL_SLOTS          256     // must be a power of two
+#define TIMERS_WHEEL_MASK           (TIMERS_WHEEL_SLOTS - 1)
+#define TIMERS_WHEEL_WORDS          (TIMERS_WHEEL_SLOTS / 64)
+
+struct pcintr_timers_wheel {
+    struct list_head    slots[TIMERS_WHEEL_SLOTS];
+    /* the earliest expiry in a slot; it may be earlier than the one of the
+       timers left in the slot, which only costs a wake-up for nothing */
+    uint64_t            slot_min[TIMERS_WHEEL_SLOTS];
+    uint64_t            busy[TIMERS_WHEEL_WORDS];   // the non-empty slots
+    uint64_t            curr;       // the last tick processed
+    uint64_t            armed;      // the tick the driver fires at; 0 for none
+    size_t              nr_active;
+    pcintr_timer_t      driver;
+};
+
+struct timers_entry {
+    struct list_head    ln;         // in a slot of the wheel when active
+    struct pcintr_timers_wheel *wheel;
+    purc_coroutine_t    cor;
+    char               *id;
+    uint32_t            interval;   // in milliseconds
+    uint64_t            expires;    // the tick to fire at
+};
+
 struct pcintr_timers {
     purc_variant_t timers_var;
     struct pcvar_listener* timer_listener;
-    pcutils_map* timers_map; // id : pcintr_timer_t
+    pcutils_uomap* entries; // id : struct timers_entry
     pcutils_map* listener_map; // variant : struct pcvar_listener
 };
 
@@ -202,70 +239,256 @@ listener_map_remove_listener(pcutils_map *map, purc_variant_t obj)
     purc_variant_revoke_listener(obj, listener);
 }
 
+static uint64_t
+wheel_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void wheel_fire_func(pcintr_timer_t timer, const char *id, void *data);
+
+static struct pcintr_timers_wheel *
+get_wheel(purc_coroutine_t cor)
+{
+    struct pcintr_heap *heap = cor->owner;
+    if (heap->timers_wheel) {
+        return heap->timers_wheel;
+    }
+
+    struct pcintr_timers_wheel *wheel = (struct pcintr_timers_wheel *)
+        calloc(1, sizeof(*wheel));
+    if (!wheel) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    wheel->driver = pcintr_timer_create(NULL, NULL, wheel_fire_func, wheel);
+    if (!wheel->driver) {
+        free(wheel);
+        return NULL;
+    }
 
+    for (size_t i = 0; i < TIMERS_WHEEL_SLOTS; i++) {
+        list_head_init(&wheel->slots[i]);
+        wheel->slot_min[i] = UINT64_MAX;
+    }
+    wheel->curr = wheel_now();
+    heap->timers_wheel = wheel;
+    return wheel;
+}
 
-static void* map_copy_val(const void* val)
+void
+pcintr_timers_wheel_destroy(struct pcintr_timers_wheel *wheel)
 {
-    return (void*)val;
+    if (wheel) {
+        /* the timers have gone with the coroutines */
+        PC_ASSERT(wheel->nr_active == 0);
+        pcintr_timer_destroy(wheel->driver);
+        free(wheel);
+    }
 }
 
-static void map_free_val(void* val)
+static void
+wheel_arm(struct pcintr_timers_wheel *wheel, uint64_t expires, uint64_t now)
 {
-    if (val) {
-        pcintr_timer_destroy((pcintr_timer_t)val);
+    if (wheel->armed && wheel->armed <= expires) {
+        return;
     }
+
+    pcintr_timer_set_interval(wheel->driver,
+            (uint32_t)(expires > now ? expires - now : 0));
+    pcintr_timer_start_oneshot(wheel->driver);
+    wheel->armed = expires;
 }
 
-static void timer_fire_func(pcintr_timer_t timer, const char *id, void *data)
+static inline bool
+slot_is_busy(struct pcintr_timers_wheel *wheel, size_t slot)
 {
-    UNUSED_PARAM(timer);
-    PC_ASSERT(pcintr_get_heap());
+    return wheel->busy[slot / 64] & ((uint64_t)1 << (slot % 64));
+}
+
+static void
+slot_reset(struct pcintr_timers_wheel *wheel, size_t slot)
+{
+    wheel->busy[slot / 64] &= ~((uint64_t)1 << (slot % 64));
+    wheel->slot_min[slot] = UINT64_MAX;
+}
+
+static void
+wheel_link(struct pcintr_timers_wheel *wheel, struct timers_entry *entry,
+        uint64_t now)
+{
+    entry->expires = now + (entry->interval ? entry->interval : 1);
+
+    size_t slot = entry->expires & TIMERS_WHEEL_MASK;
+    list_add_tail(&entry->ln, &wheel->slots[slot]);
+    wheel->busy[slot / 64] |= (uint64_t)1 << (slot % 64);
+    if (entry->expires < wheel->slot_min[slot])
+        wheel->slot_min[slot] = entry->expires;
+    wheel->nr_active++;
+}
+
+/* returns the earliest expiry of the busy slots, or UINT64_MAX for none */
+static uint64_t
+wheel_earliest(struct pcintr_timers_wheel *wheel)
+{
+    uint64_t earliest = UINT64_MAX;
+    for (size_t i = 0; i < TIMERS_WHEEL_WORDS; i++) {
+        uint64_t bits = wheel->busy[i];
+        while (bits) {
+            size_t slot = i * 64 + __builtin_ctzll(bits);
+            if (wheel->slot_min[slot] < earliest)
+                earliest = wheel->slot_min[slot];
+            bits &= bits - 1;
+        }
+    }
+
+    return earliest;
+}
 
-    purc_coroutine_t cor = (purc_coroutine_t)data;
+static void
+wheel_add(struct pcintr_timers_wheel *wheel, struct timers_entry *entry,
+        uint64_t now)
+{
+    wheel_link(wheel, entry, now);
+    wheel_arm(wheel, entry->expires, now);
+}
+
+static void
+wheel_remove(struct pcintr_timers_wheel *wheel, struct timers_entry *entry)
+{
+    if (!list_empty(&entry->ln)) {
+        size_t slot = entry->expires & TIMERS_WHEEL_MASK;
+        list_del_init(&entry->ln);
+        if (list_empty(&wheel->slots[slot]))
+            slot_reset(wheel, slot);
+        wheel->nr_active--;
+        /* the driver is left armed: a wake-up for nothing is cheaper than
+           rescheduling it in the run loop */
+    }
+}
+
+static void
+entry_fire(struct timers_entry *entry)
+{
+    purc_coroutine_t cor = entry->cor;
     if (cor->stack.exited) {
         return;
     }
 
     pcintr_coroutine_post_event(cor->cid,
         PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY,
-        cor->timers->timers_var, TIMERS_STR_EXPIRED, id,
+        cor->timers->timers_var, TIMERS_STR_EXPIRED,
+        entry->id,
         PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
 }
 
-static bool
-is_euqal(purc_variant_t var, const char* comp)
+static void
+wheel_fire_func(pcintr_timer_t timer, const char *id, void *data)
 {
-    if (var && comp) {
-        return (strcmp(purc_variant_get_string_const(var), comp) == 0);
+    UNUSED_PARAM(timer);
+    UNUSED_PARAM(id);
+    PC_ASSERT(pcintr_get_heap());
+
+    struct pcintr_timers_wheel *wheel = (struct pcintr_timers_wheel *)data;
+    uint64_t now = wheel_now();
+    wheel->armed = 0;
+
+    /* collect the expired timers from the due slots of the elapsed ticks;
+       a slot also holds the timers of the later rounds */
+    struct list_head expired;
+    list_head_init(&expired);
+    uint64_t nr_ticks = now - wheel->curr;
+    if (nr_ticks > TIMERS_WHEEL_SLOTS)
+        nr_ticks = TIMERS_WHEEL_SLOTS;
+    for (uint64_t tick = wheel->curr + 1; tick <= wheel->curr + nr_ticks;
+            tick++) {
+        size_t slot = tick & TIMERS_WHEEL_MASK;
+        if (!slot_is_busy(wheel, slot) || wheel->slot_min[slot] > now)
+            continue;
+
+        uint64_t slot_min = UINT64_MAX;
+        struct timers_entry *p, *n;
+        list_for_each_entry_safe(p, n, &wheel->slots[slot], ln) {
+            if (p->expires <= now) {
+                list_move_tail(&p->ln, &expired);
+            }
+            else if (p->expires < slot_min) {
+                slot_min = p->expires;
+            }
+        }
+
+        if (list_empty(&wheel->slots[slot]))
+            slot_reset(wheel, slot);
+        else
+            wheel->slot_min[slot] = slot_min;
+    }
+    wheel->curr = now;
+
+    /* the timers of $TIMERS are repeating ones */
+    while (!list_empty(&expired)) {
+        struct timers_entry *entry = list_first_entry(&expired,
+                struct timers_entry, ln);
+        list_del(&entry->ln);
+        wheel->nr_active--;
+        wheel_link(wheel, entry, now);
+        entry_fire(entry);
+    }
+
+    /* arm the driver for the earliest expiry left */
+    uint64_t earliest = wheel_earliest(wheel);
+    if (earliest != UINT64_MAX) {
+        wheel_arm(wheel, earliest, now);
     }
-    return false;
 }
 
-pcintr_timer_t
-find_timer(struct pcintr_timers* timers, const char* id)
+static void
+entry_start(struct timers_entry *entry)
 {
-    pcutils_map_entry* entry = pcutils_map_find(timers->timers_map, id);
-    return entry ? (pcintr_timer_t) entry->val : NULL;
+    wheel_remove(entry->wheel, entry);
+    wheel_add(entry->wheel, entry, wheel_now());
 }
 
-bool
-add_timer(struct pcintr_timers* timers, const char* id, pcintr_timer_t timer)
+static void
+entry_stop(struct timers_entry *entry)
 {
-    int r;
-    r = pcutils_map_replace_or_insert(timers->timers_map, id, timer, NULL);
-    if (0 == r) {
-        return true;
+    wheel_remove(entry->wheel, entry);
+}
+
+static bool
+entry_is_active(struct timers_entry *entry)
+{
+    return !list_empty(&entry->ln);
+}
+
+static void entry_free(void *val)
+{
+    struct timers_entry *entry = (struct timers_entry *)val;
+    wheel_remove(entry->wheel, entry);
+    free(entry->id);
+    free(entry);
+}
+
+static bool
+is_euqal(purc_variant_t var, const char* comp)
+{
+    if (var && comp) {
+        return (strcmp(purc_variant_get_string_const(var), comp) == 0);
     }
     return false;
 }
 
-void
-remove_timer(struct pcintr_timers* timers, const char* id)
+static struct timers_entry *
+find_entry(struct pcintr_timers* timers, const char *id)
 {
-    pcutils_map_erase(timers->timers_map, (void*)id);
+    pcutils_uomap_entry* entry = pcutils_uomap_find(timers->entries, id);
+    return entry ? (struct timers_entry *)pcutils_uomap_entry_val(entry) :
+        NULL;
 }
 
-static pcintr_timer_t
+static struct timers_entry *
 get_inner_timer(purc_coroutine_t cor , purc_variant_t timer_var)
 {
     purc_variant_t id = purc_variant_object_get_by_ckey(timer_var,
@@ -276,21 +499,39 @@ get_inner_timer(purc_coroutine_t cor , purc_variant_t timer_var)
     }
 
     const char* idstr = purc_variant_get_string_const(id);
-    pcintr_timer_t timer = find_timer(cor->timers, idstr);
-    if (timer) {
-        return timer;
+    if (!idstr) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    struct timers_entry *entry = find_entry(cor->timers, idstr);
+    if (entry) {
+        return entry;
     }
 
-    timer = pcintr_timer_create(NULL, idstr, timer_fire_func, cor);
-    if (timer == NULL) {
+    struct pcintr_timers_wheel *wheel = get_wheel(cor);
+    if (!wheel) {
         return NULL;
     }
 
-    if (!add_timer(cor->timers, idstr, timer)) {
-        pcintr_timer_destroy(timer);
+    entry = (struct timers_entry *)calloc(1, sizeof(*entry));
+    if (!entry || !(entry->id = strdup(idstr))) {
+        free(entry);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
     }
-    return timer;
+    list_head_init(&entry->ln);
+    entry->wheel = wheel;
+    entry->cor = cor;
+
+    /* keyed by the id kept in the entry, which goes with the entry */
+    if (pcutils_uomap_insert(cor->timers->entries, entry->id, entry)) {
+        free(entry->id);
+        free(entry);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+    return entry;
 }
 
 static void
@@ -303,24 +544,14 @@ destroy_inner_timer(purc_coroutine_t cor, purc_variant_t timer_var)
     }
 
     const char* idstr = purc_variant_get_string_const(id);
-    pcintr_timer_t timer = find_timer(cor->timers, idstr);
-    if (timer) {
-        remove_timer(cor->timers, idstr);
+    if (idstr && find_entry(cor->timers, idstr)) {
+        pcutils_uomap_erase(cor->timers->entries, idstr);
     }
 }
 
-bool
-timer_listener_handler(purc_variant_t source, pcvar_op_t msg_type,
-        void* ctxt, size_t nr_args, purc_variant_t* argv)
+static void
+update_inner_timer(struct timers_entry *entry, purc_variant_t nv)
 {
-    UNUSED_PARAM(source);
-    UNUSED_PARAM(msg_type);
-    UNUSED_PARAM(ctxt);
-    UNUSED_PARAM(nr_args);
-    UNUSED_PARAM(argv);
-    purc_variant_t nv = source;
-    pcintr_timer_t timer = (pcintr_timer_t)ctxt;
-
     purc_variant_t interval = purc_variant_object_get_by_ckey(nv,
             TIMERS_STR_INTERVAL);
     purc_variant_t active = purc_variant_object_get_by_ckey(nv,
@@ -328,15 +559,12 @@ timer_listener_handler(purc_variant_t source, pcvar_op_t msg_type,
     if (interval != PURC_VARIANT_INVALID) {
         uint64_t ret = 0;
         purc_variant_cast_to_ulongint(interval, &ret, false);
-        uint32_t oval = pcintr_timer_get_interval(timer);
-        if (oval != ret) {
-            pcintr_timer_set_interval(timer, ret);
-        }
+        entry->interval = (uint32_t)ret;
     }
     else {
         purc_clr_error();
     }
-    bool next_active = pcintr_timer_is_active(timer);
+    bool next_active = entry_is_active(entry);
     if (active != PURC_VARIANT_INVALID) {
         if (is_euqal(active, TIMERS_STR_YES)) {
             next_active = true;
@@ -347,11 +575,22 @@ timer_listener_handler(purc_variant_t source, pcvar_op_t msg_type,
     }
 
     if (next_active) {
-        pcintr_timer_start(timer);
+        entry_start(entry);
     }
     else {
-        pcintr_timer_stop(timer);
+        entry_stop(entry);
     }
+}
+
+bool
+timer_listener_handler(purc_variant_t source, pcvar_op_t msg_type,
+        void* ctxt, size_t nr_args, purc_variant_t* argv)
+{
+    UNUSED_PARAM(msg_type);
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    update_inner_timer((struct timers_entry *)ctxt, source);
     return true;
 }
 
@@ -371,13 +610,13 @@ timers_set_grow(purc_variant_t source, pcvar_op_t msg_type,
             TIMERS_STR_INTERVAL);
     purc_variant_t active = purc_variant_object_get_by_ckey(argv[0],
             TIMERS_STR_ACTIVE);
-    pcintr_timer_t timer = get_inner_timer(cor, argv[0]);
-    if (!timer) {
+    struct timers_entry *entry = get_inner_timer(cor, argv[0]);
+    if (!entry) {
         return false;
     }
 
     listener = purc_variant_register_post_listener(argv[0],
-            PCVAR_OPERATION_CHANGE, timer_listener_handler, timer);
+            PCVAR_OPERATION_CHANGE, timer_listener_handler, entry);
     if (!listener) {
         return false;
     }
@@ -385,9 +624,9 @@ timers_set_grow(purc_variant_t source, pcvar_op_t msg_type,
 
     uint64_t ret = 0;
     purc_variant_cast_to_ulongint(interval, &ret, false);
-    pcintr_timer_set_interval(timer, ret);
+    entry->interval = (uint32_t)ret;
     if (is_euqal(active, TIMERS_STR_YES)) {
-        pcintr_timer_start(timer);
+        entry_start(entry);
     }
     return true;
 }
@@ -420,50 +659,20 @@ timers_set_change(purc_variant_t source, pcvar_op_t msg_type,
     struct pcvar_listener *listener = NULL;
 
     purc_variant_t nv = argv[1];
-    pcintr_timer_t timer = get_inner_timer(cor, nv);
-    if (!timer) {
+    struct timers_entry *entry = get_inner_timer(cor, nv);
+    if (!entry) {
         return false;
     }
 
     listener_map_remove_listener(cor->timers->listener_map, argv[0]);
     listener = purc_variant_register_post_listener(nv,
-            PCVAR_OPERATION_CHANGE, timer_listener_handler, timer);
+            PCVAR_OPERATION_CHANGE, timer_listener_handler, entry);
     if (!listener) {
         return false;
     }
     listener_map_set_listener(cor->timers->listener_map, nv, listener);
 
-    purc_variant_t interval = purc_variant_object_get_by_ckey(nv,
-            TIMERS_STR_INTERVAL);
-    purc_variant_t active = purc_variant_object_get_by_ckey(nv,
-            TIMERS_STR_ACTIVE);
-    if (interval != PURC_VARIANT_INVALID) {
-        uint64_t ret = 0;
-        purc_variant_cast_to_ulongint(interval, &ret, false);
-        uint32_t oval = pcintr_timer_get_interval(timer);
-        if (oval != ret) {
-            pcintr_timer_set_interval(timer, ret);
-        }
-    }
-    else {
-        purc_clr_error();
-    }
-    bool next_active = pcintr_timer_is_active(timer);
-    if (active != PURC_VARIANT_INVALID) {
-        if (is_euqal(active, TIMERS_STR_YES)) {
-            next_active = true;
-        }
-        else {
-            next_active = false;
-        }
-    }
-
-    if (next_active) {
-        pcintr_timer_start(timer);
-    }
-    else {
-        pcintr_timer_stop(timer);
-    }
+    update_inner_timer(entry, nv);
     return true;
 }
 
@@ -513,9 +722,9 @@ pcintr_timers_init(purc_coroutine_t cor)
     timers->timers_var = ret;
     purc_variant_ref(ret);
 
-    timers->timers_map = pcutils_map_create (copy_key_string, free_key_string,
-                          map_copy_val, map_free_val, comp_key_string, false);
-    if (!timers->timers_map) {
+    timers->entries = pcutils_uomap_create(NULL, NULL, NULL, entry_free,
+            NULL, NULL, false);
+    if (!timers->entries) {
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         goto failure;
     }
@@ -567,9 +776,9 @@ pcintr_timers_destroy(struct pcintr_timers* timers)
         }
 
         // remove inner timer
-        if (timers->timers_map) {
-            pcutils_map_destroy(timers->timers_map);
-            timers->timers_map = NULL;
+        if (timers->entries) {
+            pcutils_uomap_destroy(timers->entries);
+            timers->entries = NULL;
         }
 
         if (timers->listener_map) {
@@ -112,6 +112,26 @@ failed:
     return PURC_VARIANT_INVALID;
 }
 
+/* Any change of the bindings invalidates the resolutions cached by the
+   reference sites; see find_named_var(). */
+static inline uint64_t
+bindings_gen(void)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL || inst->intr_heap == NULL)
+        return 0;
+
+    return inst->intr_heap->var_bindings_gen;
+}
+
+static void
+bindings_changed(void)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst && inst->intr_heap)
+        inst->intr_heap->var_bindings_gen++;
+}
+
 static bool mgr_grow_handler(purc_variant_t source, pcvar_op_t msg_type,
         void* ctxt, size_t nr_args, purc_variant_t* argv)
 {
@@ -196,6 +216,8 @@ static bool mgr_change_handler(purc_variant_t source, pcvar_op_t msg_type,
 static bool mgr_handler(purc_variant_t source, pcvar_op_t msg_type,
         void* ctxt, size_t nr_args, purc_variant_t* argv)
 {
+    bindings_changed();
+
     switch (msg_type) {
     case PCVAR_OPERATION_GROW:
         return mgr_grow_handler(source, msg_type, ctxt, nr_args, argv);
@@ -268,6 +290,7 @@ int pcvarmgr_destroy(pcvarmgr_t mgr)
         }
         purc_variant_unref(mgr->object);
         free(mgr);
+        bindings_changed();
     }
     return 0;
 }
@@ -361,92 +384,66 @@ bool pcvarmgr_dispatch_except(pcvarmgr_t mgr, const char* name,
     return true;
 }
 
-static purc_variant_t
-_find_named_scope_var_in_vdom(purc_coroutine_t cor,
-        pcvdom_element_t elem, const char* name, pcvarmgr_t* mgr)
+/*
+ * The lookups below are done for every `$name` evaluated and most levels
+ * miss, so they do not format any error message; only the final miss of
+ * pcintr_find_named_var() does.
+ */
+static inline purc_variant_t
+find_in_mgr(pcvarmgr_t mgr, const char *name)
 {
-    if (!elem || !name) {
-        PC_ASSERT(name); // FIXME: still recoverable???
-        purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND, "name:%s", name);
+    if (mgr == NULL || purc_variant_object_get_size(mgr->object) <= 0)
         return PURC_VARIANT_INVALID;
-    }
 
-    purc_variant_t v;
+    return purc_variant_object_get_by_ckey(mgr->object, name);
+}
 
-again:
+static purc_variant_t
+_find_named_scope_var_in_vdom(purc_coroutine_t cor,
+        pcvdom_element_t elem, const char* name)
+{
+    while (elem) {
+        purc_variant_t v;
+        v = find_in_mgr(pcintr_get_scope_variables(cor, elem), name);
+        if (v)
+            return v;
 
-    v = pcintr_get_scope_variable(cor, elem, name);
-    if (v) {
-        if (mgr) {
-            *mgr = pcintr_get_scope_variables(cor, elem);
-        }
-        return v;
+        elem = pcvdom_element_parent(elem);
     }
 
-    elem = pcvdom_element_parent(elem);
-    if (elem)
-        goto again;
-
-    purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND, "name:%s", name);
     return PURC_VARIANT_INVALID;
 }
 
 static purc_variant_t
 _find_named_scope_var(purc_coroutine_t cor,
-        struct pcintr_stack_frame *frame, const char* name, pcvarmgr_t* mgr)
+        struct pcintr_stack_frame *frame, const char* name)
 {
-    if (frame->scope)
-        return _find_named_scope_var_in_vdom(cor, frame->scope, name, mgr);
-
-    pcvdom_element_t elem = frame->pos;
-
-    if (!elem || !name) {
-        PC_ASSERT(name); // FIXME: still recoverable???
-        purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND, "name:%s", name);
-        return PURC_VARIANT_INVALID;
-    }
-
-    purc_variant_t v;
-
-again:
+    while (frame) {
+        if (frame->scope)
+            return _find_named_scope_var_in_vdom(cor, frame->scope, name);
 
-    v = pcintr_get_scope_variable(cor, elem, name);
-    if (v) {
-        if (mgr) {
-            *mgr = pcintr_get_scope_variables(cor, elem);
-        }
-        return v;
-    }
+        pcvdom_element_t elem = frame->pos;
+        if (!elem)
+            break;
 
-    frame = pcintr_stack_frame_get_parent(frame);
-    if (frame) {
-        if (frame->scope)
-            return _find_named_scope_var_in_vdom(cor, frame->scope, name, mgr);
+        purc_variant_t v;
+        v = find_in_mgr(pcintr_get_scope_variables(cor, elem), name);
+        if (v)
+            return v;
 
-        elem = frame->pos;
-        if (elem)
-            goto again;
+        frame = pcintr_stack_frame_get_parent(frame);
     }
 
-    purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND, "name:%s", name);
     return PURC_VARIANT_INVALID;
 }
 
-static purc_variant_t
+static inline purc_variant_t
 find_cor_level_var(purc_coroutine_t cor, const char* name)
 {
-    PC_ASSERT(name);
-    if (!cor) {
-        purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND, "name:%s", name);
+    if (!cor || !cor->vdom)
         return PURC_VARIANT_INVALID;
-    }
 
-    purc_variant_t v = purc_coroutine_get_variable(cor, name);
-    if (v) {
-        return v;
-    }
-    purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND, "name:%s", name);
-    return PURC_VARIANT_INVALID;
+    return find_in_mgr(cor->variables, name);
 }
 
 purc_variant_t
@@ -472,45 +469,42 @@ purc_get_runner_variable(const char* name)
 static inline purc_variant_t
 find_inst_var(const char *name)
 {
-    return purc_get_runner_variable(name);
+    return find_in_mgr(pcinst_get_variables(), name);
 }
 
+/* Walks the temporary variables and mixes the positions and scopes of all
+   frames into `chain`, which identifies the frame chain for the cache. */
 static purc_variant_t
-_find_named_temp_var(struct pcintr_stack_frame *frame, const char *name)
+_find_named_temp_var(struct pcintr_stack_frame *frame, const char *name,
+        uint64_t *chain)
 {
-    struct pcintr_stack_frame *p = frame;
-
-again:
+    uint64_t hash = 0xcbf29ce484222325ULL;
 
-    if (p == NULL) {
-        purc_set_error(PURC_ERROR_ENTITY_NOT_FOUND);
-        return PURC_VARIANT_INVALID;
-    }
+    for (struct pcintr_stack_frame *p = frame; p;
+            p = pcintr_stack_frame_get_parent(p)) {
+        hash = (hash ^ (uint64_t)(uintptr_t)p->pos) * 0x100000001b3ULL;
+        hash = (hash ^ (uint64_t)(uintptr_t)p->scope) * 0x100000001b3ULL;
 
-    do {
         purc_variant_t tmp;
         tmp = pcintr_get_exclamation_var(p);
-        if (tmp == PURC_VARIANT_INVALID)
-            break;
-
-        if (purc_variant_is_object(tmp) == false)
-            break;
+        if (tmp == PURC_VARIANT_INVALID || !purc_variant_is_object(tmp) ||
+                purc_variant_object_get_size(tmp) <= 0)
+            continue;
 
         purc_variant_t v;
         v = purc_variant_object_get_by_ckey(tmp, name);
-        if (v == PURC_VARIANT_INVALID)
-            break;
-
-        return v;
-    } while (0);
-
-    p = pcintr_stack_frame_get_parent(p);
+        if (v)
+            return v;
+    }
 
-    goto again;
+    if (chain)
+        *chain = hash;
+    return PURC_VARIANT_INVALID;
 }
 
-purc_variant_t
-pcintr_find_named_var(pcintr_stack_t stack, const char* name)
+static purc_variant_t
+find_named_var(pcintr_stack_t stack, const char* name,
+        struct pcintr_var_site *site)
 {
     if (!stack || !name) {
         PC_ASSERT(0); // FIXME: still recoverable???
@@ -520,27 +514,46 @@ pcintr_find_named_var(pcintr_stack_t stack, const char* name)
     struct pcintr_stack_frame* frame = pcintr_stack_get_bottom_frame(stack);
     PC_ASSERT(frame);
 
+    /* the temporary variables are ordinary objects which can be changed
+       by anyone, so they are never cached. */
+    uint64_t chain = 0;
     purc_variant_t v;
-    v = _find_named_temp_var(frame, name);
+    v = _find_named_temp_var(frame, name, site ? &chain : NULL);
     if (v) {
         purc_clr_error();
         return v;
     }
 
-    v = _find_named_scope_var(stack->co, frame, name, NULL);
-    if (v) {
-        purc_clr_error();
-        return v;
+    uint64_t gen = 0;
+    if (site) {
+        gen = bindings_gen();
+        if (gen && site->gen == gen &&
+                site->pos == frame->pos && site->chain == chain) {
+            purc_clr_error();
+            return site->value;
+        }
     }
 
-    v = find_cor_level_var(stack->co, name);
-    if (v) {
-        purc_clr_error();
-        return v;
-    }
+    do {
+        v = _find_named_scope_var(stack->co, frame, name);
+        if (v)
+            break;
+
+        v = find_cor_level_var(stack->co, name);
+        if (v)
+            break;
+
+        v = find_inst_var(name);
+    } while (0);
 
-    v = find_inst_var(name);
     if (v) {
+        if (gen) {
+            site->gen = gen;
+            site->chain = chain;
+            site->pos = frame->pos;
+            site->value = v;
+        }
+
         purc_clr_error();
         return v;
     }
@@ -549,6 +562,19 @@ pcintr_find_named_var(pcintr_stack_t stack, const char* name)
     return PURC_VARIANT_INVALID;
 }
 
+purc_variant_t
+pcintr_find_named_var(pcintr_stack_t stack, const char* name)
+{
+    return find_named_var(stack, name, NULL);
+}
+
+purc_variant_t
+pcintr_find_named_var_at(pcintr_stack_t stack, const char* name,
+        struct pcintr_var_site *site)
+{
+    return find_named_var(stack, name, site);
+}
+
 enum purc_symbol_var _to_symbol(char symbol)
 {
     switch (symbol) {
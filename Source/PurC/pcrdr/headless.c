@@ -40,6 +40,7 @@
 #include <time.h>
 #include <errno.h>
 #include <assert.h>
+#include <unistd.h>
 
 #define LEN_BUFF_LONGLONGINT    128
 
@@ -1403,6 +1404,47 @@ static int my_disconnect(pcrdr_conn* conn)
 
 #define SCHEMA_LOCAL_FILE  "file://"
 
+int pcrdr_headless_rename(pcrdr_conn *conn, const char *app_name,
+        const char *runner_name)
+{
+    if (conn->prot != PURC_RDRCOMM_HEADLESS)
+        return PURC_ERROR_NOT_SUPPORTED;
+
+    if (conn->uri == NULL) {
+        char old_path[PATH_MAX + 1], new_path[PATH_MAX + 1];
+        int n;
+
+        n = snprintf(old_path, sizeof(old_path),
+                PCRDR_HEADLESS_LOGFILE_PATH_FORMAT,
+                conn->app_name, conn->runner_name);
+        if (n < 0 || (size_t)n >= sizeof(old_path))
+            return PURC_ERROR_TOO_SMALL_BUFF;
+
+        n = snprintf(new_path, sizeof(new_path),
+                PCRDR_HEADLESS_LOGFILE_PATH_FORMAT, app_name, runner_name);
+        if (n < 0 || (size_t)n >= sizeof(new_path))
+            return PURC_ERROR_TOO_SMALL_BUFF;
+
+        fflush(conn->prot_data->fp);
+        if (access(new_path, F_OK) == 0) {
+            /* keep appending to the existing log file */
+            FILE *fp = fopen(new_path, "a");
+            if (fp == NULL)
+                return PURC_ERROR_BAD_STDC_CALL;
+            fclose(conn->prot_data->fp);
+            conn->prot_data->fp = fp;
+            unlink(old_path);
+        }
+        else if (rename(old_path, new_path)) {
+            return PURC_ERROR_BAD_STDC_CALL;
+        }
+    }
+
+    conn->app_name = app_name;
+    conn->runner_name = runner_name;
+    return PURC_ERROR_OK;
+}
+
 pcrdr_msg *pcrdr_headless_connect(const char* renderer_uri,
         const char* app_name, const char* runner_name, pcrdr_conn** conn)
 {
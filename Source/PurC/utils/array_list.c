@@ -28,9 +28,13 @@
 #include "private/array_list.h"
 
 #include "private/debug.h"
+#include "private/list.h"
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
 
 static inline size_t
 align(size_t n)
@@ -261,3 +265,487 @@ pcutils_array_list_sort(struct pcutils_array_list *al,
     }
 }
 
+
+/* the nodes with less keys than this are sorted in the calling thread */
+#define MIN_KEYS_TO_SORT_IN_PARALLEL    (1 << 14)
+#define MAX_SORTING_THREADS             8
+
+/* the buckets with less string keys than this are sorted by comparing */
+#define MIN_KEYS_TO_SORT_BY_RADIX       32
+/* the string keys are merge-sorted after dispatching so many bytes */
+#define MAX_RADIX_LEVELS                16
+
+struct sort_entry {
+    union {
+        uint64_t                        bits;
+        const void                     *key;
+    };
+    struct pcutils_array_list_node     *node;
+};
+
+static void
+put_sorted_entries(struct pcutils_array_list *al, struct sort_entry *entries)
+{
+    for (size_t i = 0; i < al->nr; ++i) {
+        al->nodes[i] = entries[i].node;
+        al->nodes[i]->idx = i;
+    }
+}
+
+struct key_sorter {
+    void *ud;
+    int (*cmp)(const void *l, const void *r, void *ud);
+};
+
+static void
+merge_entries(const struct key_sorter *sorter, const struct sort_entry *l,
+        size_t nr_l, const struct sort_entry *r, size_t nr_r,
+        struct sort_entry *dst)
+{
+    size_t i = 0, j = 0;
+
+    while (i < nr_l && j < nr_r) {
+        /* take the left one when equal to keep the sort stable */
+        if (sorter->cmp(r[j].key, l[i].key, sorter->ud) < 0)
+            *dst++ = r[j++];
+        else
+            *dst++ = l[i++];
+    }
+
+    memcpy(dst, l + i, sizeof(*dst) * (nr_l - i));
+    dst += nr_l - i;
+    memcpy(dst, r + j, sizeof(*dst) * (nr_r - j));
+}
+
+/* sorts entries into entries (to_tmp is false) or tmp (to_tmp is true) */
+static void
+merge_sort_entries(const struct key_sorter *sorter, struct sort_entry *entries,
+        struct sort_entry *tmp, size_t nr, bool to_tmp)
+{
+    if (nr <= 8) {
+        /* insertion sort for short runs */
+        for (size_t i = 1; i < nr; i++) {
+            struct sort_entry e = entries[i];
+            size_t j = i;
+            while (j > 0 && sorter->cmp(e.key, entries[j - 1].key,
+                        sorter->ud) < 0) {
+                entries[j] = entries[j - 1];
+                j--;
+            }
+            entries[j] = e;
+        }
+
+        if (to_tmp)
+            memcpy(tmp, entries, sizeof(*tmp) * nr);
+        return;
+    }
+
+    size_t half = nr / 2;
+    merge_sort_entries(sorter, entries, tmp, half, !to_tmp);
+    merge_sort_entries(sorter, entries + half, tmp + half, nr - half, !to_tmp);
+
+    if (to_tmp)
+        merge_entries(sorter, entries, half, entries + half, nr - half, tmp);
+    else
+        merge_entries(sorter, tmp, half, tmp + half, nr - half, entries);
+}
+
+struct sort_job {
+    const struct key_sorter    *sorter;
+    struct sort_entry          *src;
+    struct sort_entry          *dst;
+    size_t                      start;
+    size_t                      middle;     /* 0 to sort a run */
+    size_t                      end;
+};
+
+/* the jobs of a call; the calling thread runs them with the pool */
+struct sort_batch {
+    struct list_head            ln;
+    struct sort_job            *jobs;
+    unsigned int                nr_jobs;
+    unsigned int                next_job;
+    unsigned int                nr_done;
+};
+
+/* The threads sorting in parallel are created on the first long list,
+   shared by all instances, and joined at exit. */
+static struct sort_pool {
+    pthread_mutex_t             lock;
+    /* signaled when a batch is submitted or the pool quits */
+    pthread_cond_t              job_cond;
+    /* signaled when the last job of a batch is done */
+    pthread_cond_t              done_cond;
+    /* the batches having jobs not taken yet */
+    struct list_head            batches;
+    pthread_t                   threads[MAX_SORTING_THREADS - 1];
+    unsigned int                nr_threads;
+    bool                        quit;
+} sort_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .job_cond = PTHREAD_COND_INITIALIZER,
+    .done_cond = PTHREAD_COND_INITIALIZER,
+};
+
+static pthread_once_t sort_pool_once = PTHREAD_ONCE_INIT;
+
+static void
+run_sort_job(struct sort_job *job)
+{
+    if (job->middle == 0) {
+        merge_sort_entries(job->sorter, job->src + job->start,
+                job->dst + job->start, job->end - job->start, false);
+    }
+    else {
+        merge_entries(job->sorter,
+                job->src + job->start, job->middle - job->start,
+                job->src + job->middle, job->end - job->middle,
+                job->dst + job->start);
+    }
+}
+
+/* takes the next job of the batch; called with the lock of the pool */
+static struct sort_job *
+take_sort_job(struct sort_batch *batch)
+{
+    struct sort_job *job = batch->jobs + batch->next_job++;
+    if (batch->next_job == batch->nr_jobs)
+        list_del(&batch->ln);
+    return job;
+}
+
+static void *
+sort_worker(void *arg)
+{
+    UNUSED_PARAM(arg);
+
+    pthread_mutex_lock(&sort_pool.lock);
+    while (true) {
+        while (!sort_pool.quit && list_empty(&sort_pool.batches))
+            pthread_cond_wait(&sort_pool.job_cond, &sort_pool.lock);
+        if (sort_pool.quit)
+            break;
+
+        struct sort_batch *batch;
+        batch = list_first_entry(&sort_pool.batches, struct sort_batch, ln);
+        struct sort_job *job = take_sort_job(batch);
+
+        pthread_mutex_unlock(&sort_pool.lock);
+        run_sort_job(job);
+        pthread_mutex_lock(&sort_pool.lock);
+
+        /* the batch is gone once the caller sees all jobs done */
+        if (++batch->nr_done == batch->nr_jobs)
+            pthread_cond_broadcast(&sort_pool.done_cond);
+    }
+    pthread_mutex_unlock(&sort_pool.lock);
+
+    return NULL;
+}
+
+static void
+cleanup_sort_pool(void)
+{
+    pthread_mutex_lock(&sort_pool.lock);
+    sort_pool.quit = true;
+    pthread_cond_broadcast(&sort_pool.job_cond);
+    pthread_mutex_unlock(&sort_pool.lock);
+
+    for (unsigned int i = 0; i < sort_pool.nr_threads; i++)
+        pthread_join(sort_pool.threads[i], NULL);
+    sort_pool.nr_threads = 0;
+}
+
+static void
+init_sort_pool(void)
+{
+    long nr_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    INIT_LIST_HEAD(&sort_pool.batches);
+    while (sort_pool.nr_threads < MAX_SORTING_THREADS - 1 &&
+            (long)sort_pool.nr_threads + 1 < nr_cpus) {
+        if (pthread_create(sort_pool.threads + sort_pool.nr_threads, NULL,
+                    sort_worker, NULL))
+            break;
+        sort_pool.nr_threads++;
+    }
+
+    if (sort_pool.nr_threads > 0 && atexit(cleanup_sort_pool))
+        cleanup_sort_pool();
+}
+
+/* runs the jobs with the threads of the pool and the calling thread,
+   which runs all of them if there is no thread in the pool */
+static void
+run_sort_jobs(struct sort_job *jobs, unsigned int nr_jobs)
+{
+    struct sort_batch batch = { .jobs = jobs, .nr_jobs = nr_jobs };
+
+    pthread_mutex_lock(&sort_pool.lock);
+    list_add_tail(&batch.ln, &sort_pool.batches);
+    if (nr_jobs > 1)
+        pthread_cond_broadcast(&sort_pool.job_cond);
+
+    while (batch.next_job < batch.nr_jobs) {
+        struct sort_job *job = take_sort_job(&batch);
+
+        pthread_mutex_unlock(&sort_pool.lock);
+        run_sort_job(job);
+        pthread_mutex_lock(&sort_pool.lock);
+
+        batch.nr_done++;
+    }
+
+    while (batch.nr_done < batch.nr_jobs)
+        pthread_cond_wait(&sort_pool.done_cond, &sort_pool.lock);
+    pthread_mutex_unlock(&sort_pool.lock);
+}
+
+static unsigned int
+nr_sorting_runs(size_t nr)
+{
+    if (nr < MIN_KEYS_TO_SORT_IN_PARALLEL)
+        return 1;
+
+    pthread_once(&sort_pool_once, init_sort_pool);
+
+    /* a power of two to merge the runs pairwise */
+    unsigned int nr_runs = 1;
+    while (nr_runs * 2 <= sort_pool.nr_threads + 1 &&
+            nr / (nr_runs * 2) >= MIN_KEYS_TO_SORT_IN_PARALLEL / 2)
+        nr_runs *= 2;
+
+    return nr_runs;
+}
+
+/* sorts the runs in parallel, then merges them pairwise in parallel */
+static struct sort_entry *
+parallel_sort_entries(const struct key_sorter *sorter,
+        struct sort_entry *entries, struct sort_entry *tmp, size_t nr,
+        unsigned int nr_runs)
+{
+    struct sort_job jobs[MAX_SORTING_THREADS];
+    size_t bounds[MAX_SORTING_THREADS + 1];
+
+    for (unsigned int i = 0; i <= nr_runs; i++)
+        bounds[i] = nr * i / nr_runs;
+
+    for (unsigned int i = 0; i < nr_runs; i++) {
+        jobs[i].sorter = sorter;
+        jobs[i].src = entries;
+        jobs[i].dst = tmp;
+        jobs[i].start = bounds[i];
+        jobs[i].middle = 0;
+        jobs[i].end = bounds[i + 1];
+    }
+    run_sort_jobs(jobs, nr_runs);
+
+    struct sort_entry *src = entries, *dst = tmp;
+    for (unsigned int width = 1; width < nr_runs; width *= 2) {
+        unsigned int nr_jobs = 0;
+        for (unsigned int i = 0; i < nr_runs; i += width * 2) {
+            jobs[nr_jobs].sorter = sorter;
+            jobs[nr_jobs].src = src;
+            jobs[nr_jobs].dst = dst;
+            jobs[nr_jobs].start = bounds[i];
+            jobs[nr_jobs].middle = bounds[i + width];
+            jobs[nr_jobs].end = bounds[i + width * 2];
+            nr_jobs++;
+        }
+        run_sort_jobs(jobs, nr_jobs);
+
+        struct sort_entry *t = src;
+        src = dst;
+        dst = t;
+    }
+
+    return src;
+}
+
+int
+pcutils_array_list_sort_by_keys(struct pcutils_array_list *al,
+        const void **keys, void *ud,
+        int (*cmp)(const void *l, const void *r, void *ud))
+{
+    size_t nr = al->nr;
+    if (nr < 2)
+        return 0;
+
+    struct sort_entry *entries = malloc(sizeof(*entries) * nr * 2);
+    if (entries == NULL)
+        return -1;
+
+    for (size_t i = 0; i < nr; ++i) {
+        entries[i].key = keys[i];
+        entries[i].node = al->nodes[i];
+    }
+
+    struct key_sorter sorter = { ud, cmp };
+    struct sort_entry *sorted = entries;
+    unsigned int nr_runs = nr_sorting_runs(nr);
+    if (nr_runs > 1) {
+        sorted = parallel_sort_entries(&sorter, entries, entries + nr, nr,
+                nr_runs);
+    }
+    else {
+        merge_sort_entries(&sorter, entries, entries + nr, nr, false);
+    }
+
+    put_sorted_entries(al, sorted);
+    free(entries);
+    return 0;
+}
+
+int
+pcutils_array_list_sort_by_integers(struct pcutils_array_list *al,
+        const uint64_t *keys, bool desc)
+{
+    size_t nr = al->nr;
+    if (nr < 2)
+        return 0;
+
+    struct sort_entry *entries = malloc(sizeof(*entries) * nr * 2);
+    size_t (*counts)[256] = calloc(8, sizeof(*counts));
+    if (entries == NULL || counts == NULL) {
+        free(entries);
+        free(counts);
+        return -1;
+    }
+
+    /* count the bytes of all digits in one pass */
+    for (size_t i = 0; i < nr; ++i) {
+        uint64_t bits = desc ? ~keys[i] : keys[i];
+
+        entries[i].bits = bits;
+        entries[i].node = al->nodes[i];
+        for (int d = 0; d < 8; d++)
+            counts[d][(bits >> (d * 8)) & 0xFF]++;
+    }
+
+    /* LSD radix sort; a digit shared by all keys needs no pass */
+    struct sort_entry *src = entries, *dst = entries + nr;
+    for (int d = 0; d < 8; d++) {
+        size_t *count = counts[d];
+        unsigned int shift = d * 8;
+
+        if (count[(src[0].bits >> shift) & 0xFF] == nr)
+            continue;
+
+        size_t offset = 0;
+        for (int b = 0; b < 256; b++) {
+            size_t c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+
+        for (size_t i = 0; i < nr; ++i)
+            dst[count[(src[i].bits >> shift) & 0xFF]++] = src[i];
+
+        struct sort_entry *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    put_sorted_entries(al, src);
+    free(counts);
+    free(entries);
+    return 0;
+}
+
+static int
+cmp_strings_asc(const void *l, const void *r, void *ud)
+{
+    UNUSED_PARAM(ud);
+    return strcmp(l, r);
+}
+
+static int
+cmp_strings_desc(const void *l, const void *r, void *ud)
+{
+    UNUSED_PARAM(ud);
+    return strcmp(r, l);
+}
+
+/* the bucket of a key for the byte at `depth`; the keys ending there
+   come first in ascending order and last in descending order */
+static inline unsigned int
+string_bucket(const struct sort_entry *entry, size_t depth, bool desc)
+{
+    unsigned int c = ((const unsigned char *)entry->key)[depth];
+    return desc ? 255 - c : c;
+}
+
+/* MSD radix sort of the keys sharing the first `depth` bytes */
+static void
+radix_sort_strings(struct sort_entry *entries, struct sort_entry *tmp,
+        size_t nr, size_t depth, unsigned int level, bool desc)
+{
+    const struct key_sorter sorter = { NULL,
+        desc ? cmp_strings_desc : cmp_strings_asc };
+    const unsigned int end_bucket = desc ? 255 : 0;
+    size_t count[256];
+
+    while (nr >= MIN_KEYS_TO_SORT_BY_RADIX && level < MAX_RADIX_LEVELS) {
+        memset(count, 0, sizeof(count));
+        for (size_t i = 0; i < nr; i++)
+            count[string_bucket(entries + i, depth, desc)]++;
+
+        /* a byte shared by all keys needs no pass */
+        unsigned int first = string_bucket(entries, depth, desc);
+        if (count[first] == nr) {
+            if (first == end_bucket)
+                return;     /* all the keys are equal */
+            depth++;
+            continue;
+        }
+
+        size_t offset = 0;
+        for (unsigned int b = 0; b < 256; b++) {
+            size_t c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+
+        /* count[b] becomes the end of the bucket b */
+        for (size_t i = 0; i < nr; i++)
+            tmp[count[string_bucket(entries + i, depth, desc)]++] = entries[i];
+        memcpy(entries, tmp, sizeof(*entries) * nr);
+
+        size_t start = 0;
+        for (unsigned int b = 0; b < 256; b++) {
+            if (b != end_bucket && count[b] - start > 1)
+                radix_sort_strings(entries + start, tmp + start,
+                        count[b] - start, depth + 1, level + 1, desc);
+            start = count[b];
+        }
+        return;
+    }
+
+    /* the keys share the first `depth` bytes, so comparing the whole
+       keys gives the same order */
+    merge_sort_entries(&sorter, entries, tmp, nr, false);
+}
+
+int
+pcutils_array_list_sort_by_strings(struct pcutils_array_list *al,
+        const char **keys, bool desc)
+{
+    size_t nr = al->nr;
+    if (nr < 2)
+        return 0;
+
+    struct sort_entry *entries = malloc(sizeof(*entries) * nr * 2);
+    if (entries == NULL)
+        return -1;
+
+    for (size_t i = 0; i < nr; ++i) {
+        entries[i].key = keys[i];
+        entries[i].node = al->nodes[i];
+    }
+
+    radix_sort_strings(entries, entries + nr, nr, 0, 0, desc);
+
+    put_sorted_entries(al, entries);
+    free(entries);
+    return 0;
+}
@@ -22,6 +22,8 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "config.h"
+
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
@@ -33,21 +35,48 @@
 #include "purc-errors.h"
 #include "private/instance.h"
 #include "private/map.h"
+#include "private/hashtable.h"
+#include "private/tls.h"
 #include "private/utils.h"
 
 #if PURC_ATOM_BUCKET_BITS > 16
 #error "Too many bits reserved for bucket"
 #endif
 
-static struct atom_bucket {
-    purc_atom_t     bucket_bits;
-    purc_atom_t     atom_seq_id;
-
-    pcutils_uomap   *atom_map;
-    char**          quarks;
-} atom_buckets[PURC_ATOM_BUCKETS_NR];
+/*
+ * Only the writers (creating or removing an atom) take `atom_rwlock`.
+ *
+ * The strings of a bucket are kept in segments which never move once
+ * allocated: the segment `k` holds `ATOM_BLOCK_SIZE << k` strings. A writer
+ * stores the string before publishing the new sequence identifier with a
+ * release store, so a reader converts an atom to the string lock-free.
+ *
+ * A string to atom lookup is served by a small direct-mapped cache local to
+ * the thread, and an entry of the cache is validated against the segments;
+ * only a miss takes the reader lock to look up the hash table.
+ *
+ * The copy of a string is never freed before the process exits, even if the
+ * atom is removed, since a reader may still be comparing it.
+ */
+#if HAVE(STDATOMIC_H)
+#   include <stdatomic.h>
+#   define ATOMIC_TYPE(type)        _Atomic(type)
+#   define LOAD_ACQUIRE(var)        \
+    atomic_load_explicit(&(var), memory_order_acquire)
+#   define STORE_RELEASE(var, val)  \
+    atomic_store_explicit(&(var), (val), memory_order_release)
+#   define READER_LOCK()
+#   define READER_UNLOCK()
+#else
+#   define ATOMIC_TYPE(type)        type
+#   define LOAD_ACQUIRE(var)        (var)
+#   define STORE_RELEASE(var, val)  ((var) = (val))
+#   define READER_LOCK()            purc_rwlock_reader_lock(&atom_rwlock)
+#   define READER_UNLOCK()          purc_rwlock_reader_unlock(&atom_rwlock)
+#endif
 
 #define ATOM_BITS_NR        (sizeof(purc_atom_t) << 3)
+#define ATOM_SEQ_BITS_NR    (ATOM_BITS_NR - PURC_ATOM_BUCKET_BITS)
 
 #define BUCKET_BITS(bucket)       \
     ((purc_atom_t)bucket << (ATOM_BITS_NR - PURC_ATOM_BUCKET_BITS))
@@ -62,26 +91,96 @@ static struct atom_bucket {
     (seq < ((purc_atom_t)1 << (ATOM_BITS_NR - PURC_ATOM_BUCKET_BITS)))
 
 #define ATOM_BLOCK_SIZE         (1024 >> PURC_ATOM_BUCKET_BITS)
+#define ATOM_SEGMENTS_NR        ((int)ATOM_SEQ_BITS_NR)
 #define ATOM_STRING_BLOCK_SIZE  (4096 - sizeof (size_t))
 
-static inline purc_atom_t
-atom_new(struct atom_bucket *bucket, char *string, bool need_free);
+#define ATOM_CACHE_SIZE         256     // must be a power of 2
+
+typedef ATOMIC_TYPE(char *) atom_quark_t;
+
+static struct atom_bucket {
+    purc_atom_t     bucket_bits;
+    ATOMIC_TYPE(purc_atom_t) atom_seq_id;
+
+    pcutils_uomap   *atom_map;
+    ATOMIC_TYPE(atom_quark_t *) segments[ATOM_SEGMENTS_NR];
+} atom_buckets[PURC_ATOM_BUCKETS_NR];
+
+struct atom_cache_slot {
+    uint32_t        hash;
+    purc_atom_t     atom;
+};
+
+struct atom_cache {
+    struct atom_cache_slot slots[ATOM_CACHE_SIZE];
+};
+
+PURC_DEFINE_THREAD_LOCAL(struct atom_cache, atom_cache);
+
+/* the blocks holding the copies of the strings */
+struct atom_string_block {
+    struct atom_string_block *next;
+    char            strings[0];
+};
+
+static purc_atom_t
+atom_new(struct atom_bucket *bucket, char *string);
 
 static purc_rwlock atom_rwlock;
-static char *atom_block = NULL;
-static int  atom_block_offset = 0;
+static struct atom_string_block *atom_blocks = NULL;
+static size_t atom_block_offset = ATOM_STRING_BLOCK_SIZE;
+
+/* returns the segment holding the sequence identifier and the offset in it */
+static inline int seq_to_segment(purc_atom_t seq, purc_atom_t *offset)
+{
+    purc_atom_t q = seq / ATOM_BLOCK_SIZE + 1;
+    int k;
+
+#if COMPILER(GCC)
+    k = (int)(sizeof(unsigned int) * 8 - 1) - __builtin_clz(q);
+#else
+    k = 0;
+    while (q >>= 1)
+        k++;
+#endif
+
+    *offset = seq - ATOM_BLOCK_SIZE * (((purc_atom_t)1 << k) - 1);
+    return k;
+}
+
+static inline atom_quark_t *
+atom_quark_slot(struct atom_bucket *bucket, purc_atom_t seq)
+{
+    purc_atom_t offset;
+    int k = seq_to_segment(seq, &offset);
+
+    atom_quark_t *segment = LOAD_ACQUIRE(bucket->segments[k]);
+    return segment + offset;
+}
+
+/* returns the string of a sequence identifier; no lock needed */
+static inline const char *
+atom_quark(struct atom_bucket *bucket, purc_atom_t seq)
+{
+    if (seq >= LOAD_ACQUIRE(bucket->atom_seq_id))
+        return NULL;
+
+    return LOAD_ACQUIRE(*atom_quark_slot(bucket, seq));
+}
 
+/* HOLDS: purc_atom_rwlock_writer_lock */
 static void atom_init_bucket(struct atom_bucket *bucket)
 {
-    assert (bucket->atom_seq_id == 0);
+    assert (LOAD_ACQUIRE(bucket->atom_seq_id) == 0);
 
     bucket->atom_map = pcutils_uomap_create(NULL, NULL, NULL, NULL,
             pchash_fnv1a_str_hash, comp_key_string, false);
-    bucket->quarks = (char **)malloc(sizeof(char *) * ATOM_BLOCK_SIZE);
-    bucket->quarks[0] = NULL;
-    bucket->atom_seq_id = 1;
+    assert(bucket->atom_map != NULL);
 
-    assert(bucket->quarks != NULL);
+    atom_quark_t *segment = calloc(ATOM_BLOCK_SIZE, sizeof(atom_quark_t));
+    assert(segment != NULL);
+    STORE_RELEASE(bucket->segments[0], segment);
+    STORE_RELEASE(bucket->atom_seq_id, 1);
 }
 
 static inline struct atom_bucket *atom_get_bucket(int bucket)
@@ -89,9 +188,13 @@ static inline struct atom_bucket *atom_get_bucket(int bucket)
     assert(bucket >= 0 && bucket < PURC_ATOM_BUCKETS_NR);
 
     struct atom_bucket *atom_bucket = atom_buckets + bucket;
-    if (UNLIKELY(atom_bucket->atom_seq_id == 0)) {
-        atom_init_bucket(atom_bucket);
-        atom_bucket->bucket_bits = BUCKET_BITS(bucket);
+    if (UNLIKELY(LOAD_ACQUIRE(atom_bucket->atom_seq_id) == 0)) {
+        purc_rwlock_writer_lock(&atom_rwlock);
+        if (LOAD_ACQUIRE(atom_bucket->atom_seq_id) == 0) {
+            atom_bucket->bucket_bits = BUCKET_BITS(bucket);
+            atom_init_bucket(atom_bucket);
+        }
+        purc_rwlock_writer_unlock(&atom_rwlock);
     }
 
     return atom_bucket;
@@ -104,11 +207,54 @@ static inline void atom_put_bucket(int bucket)
     struct atom_bucket *atom_bucket = atom_buckets + bucket;
     if (LIKELY(atom_bucket->atom_map)) {
         pcutils_uomap_destroy(atom_bucket->atom_map);
-        free(atom_bucket->quarks);
+        for (int k = 0; k < ATOM_SEGMENTS_NR; k++) {
+            atom_quark_t *segment = LOAD_ACQUIRE(atom_bucket->segments[k]);
+            if (segment == NULL)
+                break;
+            free(segment);
+        }
         memset(atom_bucket, 0, sizeof(*atom_bucket));
     }
 }
 
+static inline struct atom_cache_slot *
+atom_cache_slot(uint32_t hash)
+{
+    struct atom_cache *cache = PURC_GET_THREAD_LOCAL(atom_cache);
+    if (UNLIKELY(cache == NULL))
+        return NULL;
+
+    return cache->slots + (hash & (ATOM_CACHE_SIZE - 1));
+}
+
+/* looks up the cache of the current thread; no lock needed */
+static inline purc_atom_t
+atom_cache_lookup(struct atom_cache_slot *slot, int bucket, uint32_t hash,
+        const char *string)
+{
+    if (slot == NULL || slot->atom == 0 || slot->hash != hash ||
+            ATOM_TO_BUCKET(slot->atom) != bucket)
+        return 0;
+
+    /* a removed atom no longer has a string */
+    const char *quark = atom_quark(atom_buckets + bucket,
+            ATOM_TO_SEQUENCE(slot->atom));
+    if (quark && strcmp(quark, string) == 0)
+        return slot->atom;
+
+    return 0;
+}
+
+static inline void
+atom_cache_update(struct atom_cache_slot *slot, uint32_t hash,
+        purc_atom_t atom)
+{
+    if (slot && atom) {
+        slot->hash = hash;
+        slot->atom = atom;
+    }
+}
+
 purc_atom_t
 purc_atom_try_string_ex(int bucket, const char *string)
 {
@@ -119,12 +265,21 @@ purc_atom_try_string_ex(int bucket, const char *string)
     if (string == NULL || atom_bucket == NULL)
         return 0;
 
+    uint32_t hash = pchash_fnv1a_str_hash(string);
+    struct atom_cache_slot *slot = atom_cache_slot(hash);
+    READER_LOCK();
+    atom = atom_cache_lookup(slot, bucket, hash, string);
+    READER_UNLOCK();
+    if (atom)
+        return atom;
+
     purc_rwlock_reader_lock(&atom_rwlock);
     if ((entry = pcutils_uomap_find(atom_bucket->atom_map, string))) {
         atom = (purc_atom_t)(uintptr_t)pcutils_uomap_entry_val(entry);
     }
     purc_rwlock_reader_unlock(&atom_rwlock);
 
+    atom_cache_update(slot, hash, atom);
     return atom;
 }
 
@@ -145,7 +300,7 @@ purc_atom_remove_string_ex(int bucket, const char *string)
         atom = (purc_atom_t)(uintptr_t)pcutils_uomap_entry_val(entry);
         pcutils_uomap_erase_entry_nolock(atom_bucket->atom_map, entry);
         atom = ATOM_TO_SEQUENCE(atom);
-        atom_bucket->quarks[atom] = NULL;
+        STORE_RELEASE(*atom_quark_slot(atom_bucket, atom), NULL);
         ret = true;
     }
     else {
@@ -158,27 +313,45 @@ purc_atom_remove_string_ex(int bucket, const char *string)
 
 /* HOLDS: atom_rwlock_lock */
 static char *
-atom_strdup(const char *string, bool *need_free)
+atom_strdup(const char *string)
 {
+    struct atom_string_block *block;
     char *copy;
     size_t len;
 
     len = strlen(string) + 1;
 
-    /* For strings longer than half the block size, fall back
-       to strdup so that we fill our blocks at least 50%. */
-    if (len > ATOM_STRING_BLOCK_SIZE / 2 ||
-            atom_block_offset + len > ATOM_STRING_BLOCK_SIZE) {
-        *need_free = true;
-        return strdup(string);
+    /* For strings longer than half the block size, use a block of its own
+       so that we fill our blocks at least 50%. */
+    if (len > ATOM_STRING_BLOCK_SIZE / 2) {
+        block = malloc(sizeof(*block) + len);
+        if (block == NULL)
+            return NULL;
+
+        if (atom_blocks) {
+            block->next = atom_blocks->next;
+            atom_blocks->next = block;
+        }
+        else {
+            block->next = NULL;
+            atom_blocks = block;
+            atom_block_offset = ATOM_STRING_BLOCK_SIZE;
+        }
+
+        return memcpy(block->strings, string, len);
     }
 
-    *need_free = false;
-    if (atom_block == NULL) {
-        atom_block = malloc(ATOM_STRING_BLOCK_SIZE);
+    if (atom_block_offset + len > ATOM_STRING_BLOCK_SIZE) {
+        block = malloc(sizeof(*block) + ATOM_STRING_BLOCK_SIZE);
+        if (block == NULL)
+            return NULL;
+
+        block->next = atom_blocks;
+        atom_blocks = block;
+        atom_block_offset = 0;
     }
 
-    copy = atom_block + atom_block_offset;
+    copy = atom_blocks->strings + atom_block_offset;
     memcpy(copy, string, len);
     atom_block_offset += len;
 
@@ -202,29 +375,42 @@ atom_from_string(struct atom_bucket *bucket, const char *string,
             *newly_created = false;
     }
     else {
-        bool need_free;
         if (duplicate)
-            string = atom_strdup(string, &need_free);
-        else
-            need_free = false;
-        atom = atom_new(bucket, (char *)string, need_free);
+            string = atom_strdup(string);
+        if (string)
+            atom = atom_new(bucket, (char *)string);
 
         if (newly_created)
-            *newly_created = true;
+            *newly_created = (atom != 0);
     }
 
     return atom;
 }
 
 static inline purc_atom_t
-atom_from_string_locked(struct atom_bucket *bucket, const char *string,
+atom_from_string_locked(int bucket, const char *string,
         bool duplicate, bool *newly_created)
 {
+    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
     purc_atom_t atom = 0;
+
+    /* most of the strings have been atoms already */
+    uint32_t hash = pchash_fnv1a_str_hash(string);
+    struct atom_cache_slot *slot = atom_cache_slot(hash);
+    READER_LOCK();
+    atom = atom_cache_lookup(slot, bucket, hash, string);
+    READER_UNLOCK();
+    if (atom) {
+        if (newly_created)
+            *newly_created = false;
+        return atom;
+    }
+
     purc_rwlock_writer_lock(&atom_rwlock);
-    atom = atom_from_string(bucket, string, duplicate, newly_created);
+    atom = atom_from_string(atom_bucket, string, duplicate, newly_created);
     purc_rwlock_writer_unlock(&atom_rwlock);
 
+    atom_cache_update(slot, hash, atom);
     return atom;
 }
 
@@ -234,8 +420,7 @@ purc_atom_from_string_ex2(int bucket, const char *string, bool *newly_created)
     if (!string)
         return 0;
 
-    return atom_from_string_locked(atom_get_bucket(bucket), string,
-            true, newly_created);
+    return atom_from_string_locked(bucket, string, true, newly_created);
 }
 
 purc_atom_t
@@ -245,77 +430,53 @@ purc_atom_from_static_string_ex2(int bucket, const char *string,
     if (!string)
         return 0;
 
-    return atom_from_string_locked(atom_get_bucket(bucket), string,
-            false, newly_created);
+    return atom_from_string_locked(bucket, string, false, newly_created);
 }
 
 const char *
 purc_atom_to_string(purc_atom_t atom)
 {
-    int bucket;
-    char* result = NULL;
+    const char* result;
 
     if (atom == 0)
         return NULL;
 
-    bucket = ATOM_TO_BUCKET(atom);
-    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
-    atom = ATOM_TO_SEQUENCE(atom);
-    purc_rwlock_reader_lock(&atom_rwlock);
-    if (atom < atom_bucket->atom_seq_id)
-        result = atom_bucket->quarks[atom];
-    purc_rwlock_reader_unlock(&atom_rwlock);
+    /* an uninitialized bucket has no sequence identifier */
+    struct atom_bucket *atom_bucket = atom_buckets + ATOM_TO_BUCKET(atom);
+    READER_LOCK();
+    result = atom_quark(atom_bucket, ATOM_TO_SEQUENCE(atom));
+    READER_UNLOCK();
 
     return result;
 }
 
-static void free_dup_key(void *key, void *data)
-{
-    UNUSED_PARAM(data);
-    if (key)
-        free(key);
-}
-
 /* HOLDS: purc_atom_rwlock_writer_lock */
-static inline purc_atom_t
-atom_new(struct atom_bucket *bucket, char *string, bool need_free)
+static purc_atom_t
+atom_new(struct atom_bucket *bucket, char *string)
 {
-    purc_atom_t atom;
-    char **atoms_new;
-
-    if (bucket->atom_seq_id % ATOM_BLOCK_SIZE == 0) {
-        atoms_new = (char **)malloc(sizeof (char *) *
-                (bucket->atom_seq_id + ATOM_BLOCK_SIZE));
-        if (bucket->atom_seq_id != 0)
-            memcpy(atoms_new, bucket->quarks,
-                    sizeof (char *) * bucket->atom_seq_id);
-        memset(atoms_new + bucket->atom_seq_id, 0,
-                sizeof (char *) * ATOM_BLOCK_SIZE);
-
-        /*
-         * The implementation in glib did not free the old quarks array.
-         * The author said: `This leaks the old quarks array. Its unfortunate,
-         * but it allows us to do lockless lookup of the arrays, and there
-         * shouldn't be that many quarks in an app`.
-         *
-         * In our implementation, we do free the old quarks.
-         * Indeed, we can use realloc() instead of malloc() and memcpy()
-         */
-        free(bucket->quarks);
-        bucket->quarks = atoms_new;
+    purc_atom_t atom = LOAD_ACQUIRE(bucket->atom_seq_id);
+    purc_atom_t offset;
+    int k = seq_to_segment(atom, &offset);
+
+    assert(IS_VALID_SEQ_ID(atom + 1));
+
+    atom_quark_t *segment = LOAD_ACQUIRE(bucket->segments[k]);
+    if (segment == NULL) {
+        assert(offset == 0);
+        segment = calloc((size_t)ATOM_BLOCK_SIZE << k, sizeof(atom_quark_t));
+        if (segment == NULL)
+            return 0;
+        STORE_RELEASE(bucket->segments[k], segment);
     }
 
-    atom = bucket->atom_seq_id;
-    bucket->quarks[atom] = string;
-    atom |= bucket->bucket_bits;
-    pcutils_uomap_insert_ex(bucket->atom_map,
-                string, (void *)(uintptr_t)atom,
-                need_free ? free_dup_key : NULL);
-    bucket->atom_seq_id++;
+    STORE_RELEASE(segment[offset], string);
+    pcutils_uomap_insert(bucket->atom_map,
+                string, (void *)(uintptr_t)(atom | bucket->bucket_bits));
 
-    assert(IS_VALID_SEQ_ID(bucket->atom_seq_id));
+    /* publish the string to the readers */
+    STORE_RELEASE(bucket->atom_seq_id, atom + 1);
 
-    return atom;
+    return atom | bucket->bucket_bits;
 }
 
 static void
@@ -329,8 +490,12 @@ atom_cleanup_once(void)
 
     if (atom_rwlock.native_impl)
         purc_rwlock_clear(&atom_rwlock);
-    if (atom_block)
-        free(atom_block);
+
+    while (atom_blocks) {
+        struct atom_string_block *next = atom_blocks->next;
+        free(atom_blocks);
+        atom_blocks = next;
+    }
 }
 
 static int
@@ -354,10 +519,6 @@ atom_init_once(void)
 
 fail_atexit:
     atom_put_bucket(0);
-    if (atom_block) {
-        free(atom_block);
-        atom_block = NULL;
-    }
 
 fail_atom:
     purc_rwlock_clear(&atom_rwlock);
@@ -373,4 +534,3 @@ struct pcmodule _module_atom = {
     .init_once       = atom_init_once,
     .init_instance   = NULL,
 };
-
@@ -28,6 +28,7 @@
 #include "purc-utils.h"
 #include "private/errors.h"
 #include "private/instance.h"
+#include "private/rwstream.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -36,6 +37,8 @@
 
 #if OS(UNIX)
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <fcntl.h>
 #endif // 0S(UNIX)
@@ -119,12 +122,28 @@ struct buffer_rwstream
     bool buff_reserved;
 };
 
+/* a read-only memory stream over a buffer shared with its owner,
+   which is released when the stream is destroyed */
+struct view_rwstream
+{
+    struct mem_rwstream mem;
+    pcrws_cb_release release;
+    void* ctxt;
+};
+
 #if OS(LINUX) || OS(UNIX) || OS(DARWIN)
 struct fd_rwstream
 {
     purc_rwstream rwstream;
     int fd;
 };
+
+/* a read-only memory stream over a private mapping of a whole file */
+struct mmap_rwstream
+{
+    struct mem_rwstream mem;
+    size_t sz_map;
+};
 #endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
 
 static off_t stdio_seek (purc_rwstream_t rws, off_t offset, int whence);
@@ -163,6 +182,20 @@ static rwstream_funcs mem_funcs = {
     mem_get_mem_buffer
 };
 
+static int view_destroy (purc_rwstream_t rws);
+static void* view_get_mem_buffer (purc_rwstream_t rws,
+        size_t *sz_content, size_t *sz_buffer, bool res_buff);
+
+static rwstream_funcs view_funcs = {
+    mem_seek,
+    mem_tell,
+    mem_read,
+    NULL,           // write
+    NULL,           // flush
+    view_destroy,
+    view_get_mem_buffer
+};
+
 static off_t buffer_seek (purc_rwstream_t rws, off_t offset, int whence);
 static off_t buffer_tell (purc_rwstream_t rws);
 static ssize_t buffer_read (purc_rwstream_t rws, void* buf, size_t count);
@@ -200,6 +233,20 @@ static rwstream_funcs fd_funcs = {
     fd_destroy,
     NULL,
 };
+
+static int mmap_destroy (purc_rwstream_t rws);
+static void* mmap_get_mem_buffer (purc_rwstream_t rws,
+        size_t *sz_content, size_t *sz_buffer, bool res_buff);
+
+static rwstream_funcs mmap_funcs = {
+    mem_seek,
+    mem_tell,
+    mem_read,
+    NULL,           // write
+    NULL,           // flush
+    mmap_destroy,
+    mmap_get_mem_buffer,
+};
 #endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
 
 static size_t get_min_size(size_t sz_min, size_t sz_max) {
@@ -266,6 +313,95 @@ purc_rwstream_t purc_rwstream_new_from_file (const char* file, const char* mode)
     return purc_rwstream_new_from_fp(fp);
 }
 
+purc_rwstream_t purc_rwstream_new_from_file_mapped (const char* file)
+{
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+    struct stat st;
+    int fd = open(file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        purc_set_error_with_info(PURC_ERROR_BAD_SYSTEM_CALL,
+                "open(%s): %s", file, strerror(errno));
+        return NULL;
+    }
+
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode)) {
+        close(fd);
+        pcinst_set_error(PURC_ERROR_BAD_SYSTEM_CALL);
+        return NULL;
+    }
+
+    struct mmap_rwstream* rws = (struct mmap_rwstream*) calloc(
+            1, sizeof(struct mmap_rwstream));
+    if (rws == NULL) {
+        close(fd);
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    static uint8_t empty_file[1];
+
+    rws->mem.rwstream.funcs = &mmap_funcs;
+    rws->mem.base = empty_file;
+    if (st.st_size > 0) {
+        void *addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE,
+                fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            free(rws);
+            purc_set_error_with_info(PURC_ERROR_BAD_SYSTEM_CALL,
+                    "mmap(%s): %s", file, strerror(errno));
+            return NULL;
+        }
+
+#ifdef MADV_SEQUENTIAL
+        madvise(addr, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+        rws->sz_map = (size_t)st.st_size;
+        rws->mem.base = addr;
+    }
+    close(fd);
+
+    rws->mem.here = rws->mem.base;
+    rws->mem.stop = rws->mem.base + rws->sz_map;
+    return (purc_rwstream_t)rws;
+#else
+    return purc_rwstream_new_from_file(file, "r");
+#endif
+}
+
+purc_rwstream_t pcrwstream_new_from_file_for_read (const char* file)
+{
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+    struct stat st;
+    if (stat(file, &st) == 0 && S_ISREG(st.st_mode) &&
+            st.st_size >= PCRWSTREAM_MAP_THRESHOLD) {
+        purc_rwstream_t rws = purc_rwstream_new_from_file_mapped(file);
+        if (rws)
+            return rws;
+    }
+#endif
+    return purc_rwstream_new_from_file(file, "r");
+}
+
+purc_rwstream_t pcrwstream_new_view (const void* mem, size_t sz,
+        pcrws_cb_release release, void* ctxt)
+{
+    struct view_rwstream* rws = (struct view_rwstream*) calloc(
+            1, sizeof(struct view_rwstream));
+    if (rws == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    rws->mem.rwstream.funcs = &view_funcs;
+    rws->mem.base = (uint8_t*)mem;
+    rws->mem.here = rws->mem.base;
+    rws->mem.stop = rws->mem.base + sz;
+    rws->release = release;
+    rws->ctxt = ctxt;
+    return (purc_rwstream_t)rws;
+}
+
 purc_rwstream_t purc_rwstream_new_from_fp (FILE* fp)
 {
     struct stdio_rwstream* rws = (struct stdio_rwstream*) calloc(
@@ -801,6 +937,51 @@ static void* mem_get_mem_buffer (purc_rwstream_t rws,
     return mem->base;
 }
 
+/* view rwstream functions */
+static int view_destroy (purc_rwstream_t rws)
+{
+    struct view_rwstream* view = (struct view_rwstream *)rws;
+    if (view->release) {
+        view->release(view->ctxt);
+    }
+    free(rws);
+    return 0;
+}
+
+static void* view_get_mem_buffer (purc_rwstream_t rws,
+        size_t *sz_content, size_t *sz_buffer, bool res_buff)
+{
+    struct view_rwstream* view = (struct view_rwstream *)rws;
+    size_t sz = view->mem.stop - view->mem.base;
+
+    if (sz_content) {
+        *sz_content = sz;
+    }
+
+    if (sz_buffer) {
+        *sz_buffer = sz;
+    }
+
+    if (!res_buff) {
+        return view->mem.base;
+    }
+
+    /* the caller will free() the buffer: hand out a null-terminated copy */
+    uint8_t *buf = malloc(sz + 1);
+    if (buf == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    if (sz)
+        memcpy(buf, view->mem.base, sz);
+    buf[sz] = 0;
+    if (sz_buffer) {
+        *sz_buffer = sz + 1;
+    }
+    return buf;
+}
+
 /* buffer rwstream functions */
 static int buffer_extend (struct buffer_rwstream* buffer, size_t size)
 {
@@ -996,4 +1177,48 @@ static int fd_destroy (purc_rwstream_t rws)
     return 0;
 }
 
+/* memory-mapped file rwstream functions */
+static int mmap_destroy (purc_rwstream_t rws)
+{
+    struct mmap_rwstream* mmap_rws = (struct mmap_rwstream *)rws;
+    if (mmap_rws->sz_map) {
+        munmap(mmap_rws->mem.base, mmap_rws->sz_map);
+    }
+    free(rws);
+    return 0;
+}
+
+static void* mmap_get_mem_buffer (purc_rwstream_t rws,
+        size_t *sz_content, size_t *sz_buffer, bool res_buff)
+{
+    struct mmap_rwstream* mmap_rws = (struct mmap_rwstream *)rws;
+
+    if (sz_content) {
+        *sz_content = mmap_rws->sz_map;
+    }
+
+    if (sz_buffer) {
+        *sz_buffer = mmap_rws->sz_map;
+    }
+
+    if (!res_buff) {
+        return mmap_rws->mem.base;
+    }
+
+    /* the caller will free() the buffer: hand out a null-terminated copy */
+    uint8_t *buf = malloc(mmap_rws->sz_map + 1);
+    if (buf == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    if (mmap_rws->sz_map)
+        memcpy(buf, mmap_rws->mem.base, mmap_rws->sz_map);
+    buf[mmap_rws->sz_map] = 0;
+    if (sz_buffer) {
+        *sz_buffer = mmap_rws->sz_map + 1;
+    }
+    return buf;
+}
+
 #endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
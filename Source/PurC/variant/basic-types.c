@@ -339,6 +339,159 @@ purc_variant_t purc_variant_make_string_static(const char* str_utf8,
     return value;
 }
 
+/*
+ * A string built by appending bytes to another one (e.g., $STR.join($buf, $s))
+ * lives in an append-only buffer shared with the string it was built from:
+ * sz_ptr[0] is the length plus one as for other strings, while sz_ptr[1]
+ * points to the buffer. Only the longest string in a buffer, i.e., the last
+ * one built, is followed by the terminating null byte, and only that one can
+ * be appended to in place, so accumulating text is linear.
+ *
+ * Before its bytes are accessed, a string in a shared buffer is settled to
+ * a flat one: the last string takes the buffer over if it is the only user,
+ * otherwise the string is copied out. As a result, a pointer to the bytes
+ * handed out never changes and is always null-terminated.
+ *
+ * The memory of a shared buffer is not counted in the statistics until it
+ * is settled.
+ */
+struct pcvrnt_string_buf {
+    size_t          refc;
+    size_t          len;        // the length of the longest string
+    size_t          sz_buf;
+    char           *bytes;
+};
+
+#define MIN_SZ_STRING_BUF       32
+
+static void string_buf_unref(struct pcvrnt_string_buf *buf)
+{
+    if (--buf->refc == 0) {
+        free(buf->bytes);
+        free(buf);
+    }
+}
+
+int pcvariant_string_settle(purc_variant_t string)
+{
+    struct pcvrnt_string_buf *buf;
+    buf = (struct pcvrnt_string_buf *)string->sz_ptr[1];
+
+    size_t sz = string->sz_ptr[0];
+    char *bytes;
+    if (buf->refc == 1 && sz == buf->len + 1) {
+        bytes = buf->bytes;
+        if (sz < buf->sz_buf) {
+            /* shrink the buffer to release not used space. */
+            char *shrunk = realloc(bytes, sz);
+            if (shrunk)
+                bytes = shrunk;
+        }
+        free(buf);
+    }
+    else {
+        bytes = malloc(sz);
+        if (bytes == NULL) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+
+        memcpy(bytes, buf->bytes, sz - 1);
+        bytes[sz - 1] = '\0';
+        string_buf_unref(buf);
+    }
+
+    string->flags &= ~PCVRNT_FLAG_STRING_SHARED;
+    string->flags |= PCVRNT_FLAG_EXTRA_SIZE;
+    string->sz_ptr[1] = (uintptr_t)bytes;
+
+    /* counted in the same heap as pcvariant_string_release() discounts */
+    string->sz_ptr[0] = 0;
+    pcvariant_stat_set_extra_size(string, sz);
+    return 0;
+}
+
+purc_variant_t
+pcvariant_string_append(purc_variant_t string, const char *bytes, size_t len,
+        bool check_encoding)
+{
+    PCVRNT_CHECK_FAIL_RET(string && IS_TYPE(string, PURC_VARIANT_TYPE_STRING)
+            && bytes, PURC_VARIANT_INVALID);
+
+    size_t nr_chars;
+    if (check_encoding) {
+        if (!pcutils_string_check_utf8(bytes, len, &nr_chars, NULL)) {
+            pcinst_set_error(PURC_ERROR_BAD_ENCODING);
+            return PURC_VARIANT_INVALID;
+        }
+    }
+    else {
+        nr_chars = pcutils_string_utf8_chars(bytes, len);
+    }
+
+    if (len == 0)
+        return purc_variant_ref(string);
+
+    struct pcvrnt_string_buf *buf = NULL;
+    const char *head;
+    size_t len_head;
+    if (string->flags & PCVRNT_FLAG_STRING_SHARED) {
+        struct pcvrnt_string_buf *shared;
+        shared = (struct pcvrnt_string_buf *)string->sz_ptr[1];
+        head = shared->bytes;
+        len_head = string->sz_ptr[0] - 1;
+        if (len_head == shared->len && len_head + len < shared->sz_buf)
+            buf = shared;
+    }
+    else {
+        head = purc_variant_get_string_const_ex(string, &len_head);
+    }
+
+    size_t sz = len_head + len + 1;
+    if (sz <= len_head) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    purc_variant_t value = pcvariant_get(PURC_VARIANT_TYPE_STRING);
+    if (value == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (buf) {
+        buf->refc++;
+    }
+    else {
+        /* grow geometrically to make appending amortized linear */
+        size_t sz_buf = MAX(sz * 2, MIN_SZ_STRING_BUF);
+        buf = malloc(sizeof(*buf));
+        if (buf == NULL || (buf->bytes = malloc(sz_buf)) == NULL) {
+            free(buf);
+            value->type = PURC_VARIANT_TYPE_STRING;
+            pcvariant_put(value);
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return PURC_VARIANT_INVALID;
+        }
+
+        buf->refc = 1;
+        buf->sz_buf = sz_buf;
+        memcpy(buf->bytes, head, len_head);
+    }
+
+    memcpy(buf->bytes + len_head, bytes, len);
+    buf->bytes[sz - 1] = '\0';
+    buf->len = sz - 1;
+
+    value->type = PURC_VARIANT_TYPE_STRING;
+    value->flags = PCVRNT_FLAG_STRING_SHARED;
+    value->refc = 1;
+    value->extra_size = string->extra_size + nr_chars;
+    value->sz_ptr[0] = (uintptr_t)sz;
+    value->sz_ptr[1] = (uintptr_t)buf;
+    return value;
+}
+
 const char* purc_variant_get_string_const_ex(purc_variant_t string,
         size_t *str_len)
 {
@@ -349,6 +502,9 @@ const char* purc_variant_get_string_const_ex(purc_variant_t string,
     const char *str_str = NULL;
 
     if (IS_TYPE(string, PURC_VARIANT_TYPE_STRING)) {
+        if (PCVRNT_STRING_SETTLE(string))
+            return NULL;
+
         if ((string->flags & PCVRNT_FLAG_EXTRA_SIZE) ||
                 (string->flags & PCVRNT_FLAG_STRING_STATIC)) {
             str_str = (const char *)string->sz_ptr[1];
@@ -381,7 +537,8 @@ bool purc_variant_string_bytes(purc_variant_t string, size_t *length)
 
     if (IS_TYPE(string, PURC_VARIANT_TYPE_STRING)) {
         if ((string->flags & PCVRNT_FLAG_EXTRA_SIZE) ||
-                (string->flags & PCVRNT_FLAG_STRING_STATIC))
+                (string->flags & PCVRNT_FLAG_STRING_STATIC) ||
+                (string->flags & PCVRNT_FLAG_STRING_SHARED))
             *length = (size_t)string->sz_ptr[0];
         else
             *length = string->size;
@@ -415,7 +572,16 @@ void pcvariant_string_release (purc_variant_t string)
     PC_ASSERT(string);
 
     if (IS_TYPE (string, PURC_VARIANT_TYPE_STRING)) {
-        if (string->flags & PCVRNT_FLAG_EXTRA_SIZE) {
+        if (string->flags & PCVRNT_FLAG_KEY_INTERNED) {
+            struct pcinst *inst = pcinst_current();
+            pcvariant_object_key_forget(inst ? inst->org_vrt_heap : NULL,
+                    string);
+        }
+
+        if (string->flags & PCVRNT_FLAG_STRING_SHARED) {
+            string_buf_unref((struct pcvrnt_string_buf *)string->sz_ptr[1]);
+        }
+        else if (string->flags & PCVRNT_FLAG_EXTRA_SIZE) {
             // VWNOTE: sz_ptr[0] will be set in pcvariant_stat_set_extra_size
             pcvariant_stat_set_extra_size (string, 0);
             free ((void *)string->sz_ptr[1]);
@@ -138,6 +138,12 @@ move_variant_in(struct pcinst *inst, purc_variant_t v)
 {
     /* move directly and change the stat info */
 
+    /* the shared strings have been settled by settle_strings() */
+    PC_ASSERT(!(v->flags & PCVRNT_FLAG_STRING_SHARED));
+
+    if (v->flags & PCVRNT_FLAG_KEY_INTERNED)
+        pcvariant_object_key_forget(inst->org_vrt_heap, v);
+
     if (IS_CONTAINER(v->type) ||
             ((v->type == PURC_VARIANT_TYPE_STRING ||
                 v->type == PURC_VARIANT_TYPE_BSEQUENCE) &&
@@ -168,6 +174,11 @@ move_or_clone_immutable(struct pcinst *inst, purc_variant_t v)
     if (IS_CONTAINER(v->type))
         return retv;
 
+    if (PCVRNT_STRING_SETTLE(v)) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return retv;
+    }
+
     if (v == &inst->org_vrt_heap->v_undefined) {
         retv = &move_heap.v_undefined;
         v->refc--;
@@ -207,6 +218,7 @@ move_or_clone_immutable(struct pcinst *inst, purc_variant_t v)
         retv = pcvariant_alloc();
         memcpy(retv, v, sizeof(*retv));
         retv->refc = 1;
+        retv->flags &= ~PCVRNT_FLAG_KEY_INTERNED;
 
         /* copy the extra space */
         if ((v->type == PURC_VARIANT_TYPE_STRING ||
@@ -782,12 +794,16 @@ move_or_clone_immutable_descendants_in_object(struct travel_context *ctxt,
 
         default:
             retk = move_or_clone_immutable(ctxt->inst, k);
+            if (retk == PURC_VARIANT_INVALID)
+                return false;
             if (retk != k) {
                 _node->key = retk;
                 pcutils_arrlist_append(ctxt->vrts_to_unref, k);
             }
 
             retv = move_or_clone_immutable(ctxt->inst, v);
+            if (retv == PURC_VARIANT_INVALID)
+                return false;
             if (retv != v) {
                 _node->val = retv;
                 if (!(v->flags & PCVRNT_FLAG_NOFREE))
@@ -929,6 +945,62 @@ static void cb_free_element(void *data)
     purc_variant_unref(data);
 }
 
+/*
+ * The buffer of a shared string is not shared across instances: settles
+ * the shared strings in the variant, the keys included, before anything
+ * is moved, so that the move never fails half way. Returns false if out of
+ * memory.
+ */
+static bool
+settle_strings(purc_variant_t v)
+{
+    purc_variant_t m;
+    size_t idx;
+
+    switch (v->type) {
+    case PURC_VARIANT_TYPE_STRING:
+        return PCVRNT_STRING_SETTLE(v) == 0;
+
+    case PURC_VARIANT_TYPE_ARRAY:
+        foreach_value_in_variant_array(v, m, idx) {
+            UNUSED_PARAM(idx);
+            if (!settle_strings(m))
+                return false;
+        } end_foreach;
+        break;
+
+    case PURC_VARIANT_TYPE_OBJECT: {
+        purc_variant_t k;
+        foreach_key_value_in_variant_object(v, k, m) {
+            if (!settle_strings(k) || !settle_strings(m))
+                return false;
+        } end_foreach;
+        break;
+    }
+
+    case PURC_VARIANT_TYPE_SET:
+        foreach_value_in_variant_set(v, m) {
+            if (!settle_strings(m))
+                return false;
+        } end_foreach;
+        break;
+
+    case PURC_VARIANT_TYPE_TUPLE: {
+        purc_variant_t *members = tuple_members(v, &idx);
+        for (size_t i = 0; i < idx; i++) {
+            if (!settle_strings(members[i]))
+                return false;
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    return true;
+}
+
 // move the variant from the current instance to the move heap.
 purc_variant_t pcvariant_move_heap_in(purc_variant_t v)
 {
@@ -936,6 +1008,11 @@ purc_variant_t pcvariant_move_heap_in(purc_variant_t v)
     struct pcinst *inst = pcinst_current();
     struct travel_context ctxt;
 
+    if (!settle_strings(v)) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return retv;
+    }
+
     ctxt.inst = pcinst_current();
     ctxt.vrts_to_unref = pcutils_arrlist_new(cb_free_element);
     if (ctxt.vrts_to_unref == NULL) {
@@ -981,6 +1058,68 @@ purc_variant_t pcvariant_move_heap_in(purc_variant_t v)
     return retv;
 }
 
+/*
+ * Take the value over from a temporary string or byte sequence held by
+ * the caller: the payload is swapped into a new variant and the caller keeps
+ * an empty one of the same type, so nothing is copied. Containers are not
+ * taken over because their members keep edges to the parent variant.
+ */
+static purc_variant_t
+take_over_value(purc_variant_t v)
+{
+    purc_variant_t hull;
+
+    if (v->refc != 1 ||
+            (v->flags & (PCVRNT_FLAG_NOFREE | PCVRNT_FLAG_KEY_INTERNED)))
+        return PURC_VARIANT_INVALID;
+
+    if (v->type == PURC_VARIANT_TYPE_STRING) {
+        if (PCVRNT_STRING_SETTLE(v))
+            return PURC_VARIANT_INVALID;
+        hull = purc_variant_make_string("", false);
+    }
+    else if (v->type == PURC_VARIANT_TYPE_BSEQUENCE) {
+        hull = purc_variant_make_byte_sequence_empty();
+    }
+    else
+        return PURC_VARIANT_INVALID;
+
+    if (hull == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    /* both live in the same heap; the statistics need no change */
+    purc_variant tmp;
+    memcpy(&tmp, v, sizeof(tmp));
+    memcpy(v, hull, sizeof(tmp));
+    memcpy(hull, &tmp, sizeof(tmp));
+    v->refc = 1;
+    hull->refc = 1;
+    INIT_LIST_HEAD(&v->listeners);
+    INIT_LIST_HEAD(&hull->listeners);
+    return hull;
+}
+
+// move a variant borrowed from the caller to the move heap; the caller
+// keeps its reference. `cloned` tells whether the value had to be cloned.
+purc_variant_t pcvariant_move_heap_in_borrowed(purc_variant_t v, bool *cloned)
+{
+    purc_variant_t taken = take_over_value(v);
+
+    if (taken != PURC_VARIANT_INVALID) {
+        *cloned = false;
+        purc_variant_t retv = pcvariant_move_heap_in(taken);
+        if (retv == PURC_VARIANT_INVALID)
+            purc_variant_unref(taken);
+        return retv;
+    }
+
+    *cloned = true;
+    purc_variant_t retv = pcvariant_move_heap_in(purc_variant_ref(v));
+    if (retv == PURC_VARIANT_INVALID)
+        purc_variant_unref(v);
+    return retv;
+}
+
 // move the variant from the move heap to the current instance.
 // we only need to update the stat information.
 static void move_container_self_out(purc_variant_t v)
@@ -896,6 +896,12 @@ static int vrtcmp(purc_variant_t l, purc_variant_t r, void *ud)
     return retv;
 }
 
+static purc_variant_t
+node_val(struct pcutils_array_list_node *node)
+{
+    return container_of(node, struct arr_node, node)->val;
+}
+
 int pcvariant_array_sort(purc_variant_t arr, void *ud,
         int (*cmp)(purc_variant_t l, purc_variant_t r, void *ud))
 {
@@ -910,6 +916,9 @@ int pcvariant_array_sort(purc_variant_t arr, void *ud,
     };
 
     if (d.cmp == NULL) {
+        // sort by the keys computed once per member if possible
+        if (pcvar_sort_nodes(&data->al, (uintptr_t)ud, node_val) == 0)
+            return 0;
         d.cmp = vrtcmp;
     }
 
@@ -918,6 +927,19 @@ int pcvariant_array_sort(purc_variant_t arr, void *ud,
     return 0;
 }
 
+int pcvariant_array_sort_by_keys(purc_variant_t arr, void *ud,
+        void *(*get_key)(purc_variant_t member, void *ud),
+        int (*cmp)(const void *l, const void *r, void *ud),
+        void (*free_key)(void *key))
+{
+    if (!arr || arr->type != PURC_VARIANT_TYPE_ARRAY)
+        return -1;
+
+    variant_arr_t data = pcvar_arr_get_data(arr);
+    return pcvar_sort_nodes_by_keys(&data->al, node_val, ud,
+            get_key, cmp, free_key);
+}
+
 purc_variant_t
 pcvariant_array_clone(purc_variant_t arr, bool recursively)
 {
@@ -73,6 +73,37 @@ void pcvariant_set_release     (purc_variant_t value)    WTF_INTERNAL;
 void pcvariant_tuple_release   (purc_variant_t value)    WTF_INTERNAL;
 void pcvariant_sorted_array_release (purc_variant_t value)    WTF_INTERNAL;
 
+/*
+ * Convert a string variant living in an append-only buffer
+ * (PCVRNT_FLAG_STRING_SHARED) to a flat one with the flag
+ * PCVRNT_FLAG_EXTRA_SIZE. Every code accessing the bytes of a string variant
+ * directly should call this function first.
+ *
+ * Returns 0 on success, -1 if out of memory (the string is left unchanged).
+ */
+int pcvariant_string_settle(purc_variant_t string) WTF_INTERNAL;
+
+#define PCVRNT_STRING_SETTLE(v)                                 \
+    (((v)->type == PURC_VARIANT_TYPE_STRING &&                  \
+      ((v)->flags & PCVRNT_FLAG_STRING_SHARED)) ?               \
+        pcvariant_string_settle(v) : 0)
+
+// forget an interned key of objects; called when the key is released or moved
+void pcvariant_object_key_forget(struct pcvariant_heap *heap,
+        purc_variant_t key) WTF_INTERNAL;
+
+// sort the nodes of an array or a set by the keys computed once per member
+int
+pcvar_sort_nodes(struct pcutils_array_list *al, uintptr_t sort_flags,
+        purc_variant_t (*node_val)(struct pcutils_array_list_node *node))
+    WTF_INTERNAL;
+int
+pcvar_sort_nodes_by_keys(struct pcutils_array_list *al,
+        purc_variant_t (*node_val)(struct pcutils_array_list_node *node),
+        void *ud, void *(*get_key)(purc_variant_t member, void *ud),
+        int (*cmp)(const void *l, const void *r, void *ud),
+        void (*free_key)(void *key)) WTF_INTERNAL;
+
 variant_arr_t
 pcvar_arr_get_data(purc_variant_t arr) WTF_INTERNAL;
 variant_obj_t
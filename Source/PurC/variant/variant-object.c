@@ -26,6 +26,9 @@
 #include "config.h"
 #include "private/variant.h"
 #include "private/errors.h"
+#include "private/instance.h"
+#include "private/hashtable.h"
+#include "private/utils.h"
 #include "purc-errors.h"
 #include "variant-internals.h"
 
@@ -127,6 +130,113 @@ pcvar_obj_get_data(purc_variant_t obj)
     return data;
 }
 
+/*
+ * The keys of objects are interned per instance: the heap maps a string to
+ * a key variant, so objects of the same shape share their key variants, and
+ * a lookup with a shared key matches by the pointer without strcmp().
+ *
+ * The map holds weak references: a key is forgotten when it is released or
+ * moved to another heap, so the interning does not change the lifetime or
+ * the reference count of any variant. The members are still ordered by
+ * strcmp(), since the order of the keys is observable by the iterators and
+ * the serializer.
+ */
+#define LEN_MAX_INTERNED_KEY    64
+#define NR_MAX_INTERNED_KEYS    4096
+
+static inline const char *
+key_string(purc_variant_t key)
+{
+    if (PCVRNT_STRING_SETTLE(key))
+        return "";  // out of memory
+    if (key->flags & (PCVRNT_FLAG_EXTRA_SIZE | PCVRNT_FLAG_STRING_STATIC))
+        return (const char *)key->sz_ptr[1];
+    return (const char *)key->bytes;
+}
+
+static inline int
+compare_keys(const char *sk, const char *sko)
+{
+    return (sk == sko) ? 0 : strcmp(sk, sko);
+}
+
+static pcutils_uomap *
+get_key_map(bool create)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL)
+        return NULL;
+
+    /* never intern the keys made in the move heap */
+    struct pcvariant_heap *heap = inst->org_vrt_heap;
+    if (heap == NULL || inst->variant_heap != heap)
+        return NULL;
+
+    if (heap->obj_keys == NULL && create) {
+        heap->obj_keys = pcutils_uomap_create(NULL, NULL, NULL, NULL,
+                pchash_fnv1a_str_hash, comp_key_string, false);
+    }
+
+    return heap->obj_keys;
+}
+
+static purc_variant_t
+find_interned_key(pcutils_uomap *map, const char *sk)
+{
+    pcutils_uomap_entry *entry = pcutils_uomap_find(map, sk);
+    if (entry)
+        return (purc_variant_t)pcutils_uomap_entry_val(entry);
+    return PURC_VARIANT_INVALID;
+}
+
+static void
+intern_key(purc_variant_t key)
+{
+    if (key->type != PVT(_STRING) || (key->flags & PCVRNT_FLAG_KEY_INTERNED))
+        return;
+
+    const char *sk = key_string(key);
+    if (strlen(sk) > LEN_MAX_INTERNED_KEY)
+        return;
+
+    pcutils_uomap *map = get_key_map(true);
+    if (map == NULL || pcutils_uomap_get_size(map) >= NR_MAX_INTERNED_KEYS ||
+            find_interned_key(map, sk))
+        return;
+
+    if (pcutils_uomap_insert(map, sk, key) == 0)
+        key->flags |= PCVRNT_FLAG_KEY_INTERNED;
+}
+
+void
+pcvariant_object_key_forget(struct pcvariant_heap *heap, purc_variant_t key)
+{
+    key->flags &= ~PCVRNT_FLAG_KEY_INTERNED;
+    if (heap == NULL || heap->obj_keys == NULL)
+        return;
+
+    pcutils_uomap_entry *entry;
+    entry = pcutils_uomap_find(heap->obj_keys, key_string(key));
+    if (entry && pcutils_uomap_entry_val(entry) == key)
+        pcutils_uomap_erase_entry_nolock(heap->obj_keys, entry);
+}
+
+purc_variant_t
+pcvariant_make_object_key(const char *key, bool check_encoding)
+{
+    pcutils_uomap *map = get_key_map(false);
+    if (map) {
+        purc_variant_t k = find_interned_key(map, key);
+        if (k)
+            return purc_variant_ref(k);
+    }
+
+    purc_variant_t k = purc_variant_make_string(key, check_encoding);
+    if (k)
+        intern_key(k);
+    return k;
+}
+
 static purc_variant_t v_object_new_with_capacity(void)
 {
     purc_variant_t var = pcvariant_get(PVT(_OBJECT));
@@ -218,6 +328,7 @@ obj_node_create(purc_variant_t k, purc_variant_t v)
         return NULL;
     }
 
+    intern_key(k);
     node->key = purc_variant_ref(k);
     node->val = purc_variant_ref(v);
 
@@ -302,8 +413,7 @@ v_object_remove(purc_variant_t obj, const char *key, bool silently,
     while (*pnode) {
         struct obj_node *node;
         node = container_of(*pnode, struct obj_node, node);
-        const char *sk = purc_variant_get_string_const(node->key);
-        int ret = strcmp(key, sk);
+        int ret = compare_keys(key, key_string(node->key));
 
         parent = *pnode;
 
@@ -473,8 +583,7 @@ v_object_set(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
     while (*pnode) {
         struct obj_node *node;
         node = container_of(*pnode, struct obj_node, node);
-        const char *sko = purc_variant_get_string_const(node->key);
-        int ret = strcmp(sk, sko);
+        int ret = compare_keys(sk, key_string(node->key));
 
         parent = *pnode;
 
@@ -608,7 +717,7 @@ v_object_set_kvs_n(purc_variant_t obj, bool check, size_t nr_kv_pairs,
     while (i<nr_kv_pairs) {
         if (is_c) {
             const char *k_c = va_arg(ap, const char*);
-            k = purc_variant_make_string(k_c, true);
+            k = pcvariant_make_object_key(k_c, true);
             if (!k)
                 break;
         } else {
@@ -649,7 +758,7 @@ pv_make_object_by_static_ckey_n (bool check, size_t nr_kv_pairs,
     do {
         int r;
         if (nr_kv_pairs > 0) {
-            purc_variant_t k = purc_variant_make_string(key0, true);
+            purc_variant_t k = pcvariant_make_object_key(key0, true);
             purc_variant_t v = value0;
             r = v_object_set(obj, k, v, check);
             purc_variant_unref(k);
@@ -808,9 +917,7 @@ purc_variant_object_get_by_ckey(purc_variant_t obj, const char* key)
     while (*pnode) {
         struct obj_node *node;
         node = container_of(*pnode, struct obj_node, node);
-        const char *sk = purc_variant_get_string_const(node->key);
-
-        int ret = strcmp(key, sk);
+        int ret = compare_keys(key, key_string(node->key));
 
         parent = *pnode;
 
@@ -848,6 +955,21 @@ bool purc_variant_object_set (purc_variant_t obj,
     return r ? false : true;
 }
 
+bool
+pcvariant_object_set_with_shared_key(purc_variant_t obj, purc_variant_t key,
+        purc_variant_t val)
+{
+    if (key && key->type == PVT(_STRING) &&
+            !(key->flags & PCVRNT_FLAG_KEY_INTERNED)) {
+        pcutils_uomap *map = get_key_map(false);
+        purc_variant_t k;
+        if (map && (k = find_interned_key(map, key_string(key))))
+            key = k;
+    }
+
+    return purc_variant_object_set(obj, key, val);
+}
+
 bool
 purc_variant_object_remove_by_static_ckey(purc_variant_t obj, const char* key,
         bool silently)
@@ -1590,6 +1590,12 @@ cmp_f(struct pcutils_array_list_node *l, struct pcutils_array_list_node *r,
     return d->cmp(nl->val, nr->val, d->ud);
 }
 
+static purc_variant_t
+node_val(struct pcutils_array_list_node *node)
+{
+    return container_of(node, struct set_node, alnode)->val;
+}
+
 int pcvariant_set_sort(purc_variant_t value, void *ud,
         int (*cmp)(purc_variant_t l, purc_variant_t r, void *ud))
 {
@@ -1603,11 +1609,27 @@ int pcvariant_set_sort(purc_variant_t value, void *ud,
         .ud  = ud,
     };
 
+    // sort by the keys computed once per member if possible
+    if (cmp == NULL && pcvar_sort_nodes(al, (uintptr_t)ud, node_val) == 0)
+        return 0;
+
     pcutils_array_list_sort(al, &d, cmp_f);
 
     return 0;
 }
 
+int pcvariant_set_sort_by_keys(purc_variant_t value, void *ud,
+        void *(*get_key)(purc_variant_t member, void *ud),
+        int (*cmp)(const void *l, const void *r, void *ud),
+        void (*free_key)(void *key))
+{
+    PC_ASSERT(value != PURC_VARIANT_INVALID);
+
+    variant_set_t data = pcvar_set_get_data(value);
+    return pcvar_sort_nodes_by_keys(&data->al, node_val, ud,
+            get_key, cmp, free_key);
+}
+
 purc_variant_t
 pcvariant_set_find(purc_variant_t set, purc_variant_t value)
 {
@@ -31,6 +31,7 @@
 #include "private/debug.h"
 #include "private/dvobjs.h"
 #include "private/utils.h"
+#include "private/rwstream.h"
 #include "variant-internals.h"
 
 #include <stdlib.h>
@@ -146,6 +147,12 @@ static void _cleanup_instance(struct pcinst *inst)
     if (heap == NULL)
         return;
 
+    /* the interned keys are weak references */
+    if (heap->obj_keys) {
+        pcutils_uomap_destroy(heap->obj_keys);
+        heap->obj_keys = NULL;
+    }
+
     /* VWNOTE: do not try to release the extra memory here. */
 #if USE(LOOP_BUFFER_FOR_RESERVED)
     for (int i = 0; i < MAX_RESERVED_VARIANTS; i++) {
@@ -674,6 +681,9 @@ bool purc_variant_is_equal_to(purc_variant_t v1, purc_variant_t v2)
 
         case PURC_VARIANT_TYPE_STRING:
         case PURC_VARIANT_TYPE_BSEQUENCE:
+            if (PCVRNT_STRING_SETTLE(v1) || PCVRNT_STRING_SETTLE(v2))
+                return false;
+
             if (v1->flags & PCVRNT_FLAG_STRING_STATIC) {
                 str1 = (const char*)v1->sz_ptr[1];
                 len1 = v1->sz_ptr[0];
@@ -894,7 +904,7 @@ purc_variant_cast_to_int32(purc_variant_t v, int32_t *i32, bool force)
 
         case PURC_VARIANT_TYPE_STRING:
         case PURC_VARIANT_TYPE_BSEQUENCE:
-            if (!force)
+            if (!force || PCVRNT_STRING_SETTLE(v))
                 break;
 
             if (v->flags & PCVRNT_FLAG_STRING_STATIC) {
@@ -1015,7 +1025,7 @@ purc_variant_cast_to_uint32(purc_variant_t v, uint32_t *u32, bool force)
 
         case PURC_VARIANT_TYPE_STRING:
         case PURC_VARIANT_TYPE_BSEQUENCE:
-            if (!force)
+            if (!force || PCVRNT_STRING_SETTLE(v))
                 break;
 
             if (v->flags & PCVRNT_FLAG_STRING_STATIC) {
@@ -1136,7 +1146,7 @@ purc_variant_cast_to_longint(purc_variant_t v, int64_t *i64, bool force)
 
         case PURC_VARIANT_TYPE_STRING:
         case PURC_VARIANT_TYPE_BSEQUENCE:
-            if (!force)
+            if (!force || PCVRNT_STRING_SETTLE(v))
                 break;
 
             if (v->flags & PCVRNT_FLAG_STRING_STATIC) {
@@ -1253,7 +1263,7 @@ purc_variant_cast_to_ulongint(purc_variant_t v, uint64_t *u64, bool force)
 
         case PURC_VARIANT_TYPE_STRING:
         case PURC_VARIANT_TYPE_BSEQUENCE:
-            if (!force)
+            if (!force || PCVRNT_STRING_SETTLE(v))
                 break;
 
             if (v->flags & PCVRNT_FLAG_STRING_STATIC) {
@@ -1331,7 +1341,7 @@ bool purc_variant_cast_to_number(purc_variant_t v, double *d, bool force)
 
         case PURC_VARIANT_TYPE_STRING:
         case PURC_VARIANT_TYPE_BSEQUENCE:
-            if (!force)
+            if (!force || PCVRNT_STRING_SETTLE(v))
                 break;
 
             if (v->flags & PCVRNT_FLAG_STRING_STATIC) {
@@ -1411,7 +1421,7 @@ purc_variant_cast_to_longdouble(purc_variant_t v, long double *d,
 
         case PURC_VARIANT_TYPE_STRING:
         case PURC_VARIANT_TYPE_BSEQUENCE:
-            if (!force)
+            if (!force || PCVRNT_STRING_SETTLE(v))
                 break;
 
             if (v->flags & PCVRNT_FLAG_STRING_STATIC) {
@@ -1452,6 +1462,9 @@ bool purc_variant_cast_to_byte_sequence(purc_variant_t v,
 
         case PURC_VARIANT_TYPE_STRING:
         case PURC_VARIANT_TYPE_BSEQUENCE:
+            if (PCVRNT_STRING_SETTLE(v))
+                return false;
+
             if (v->type == PURC_VARIANT_TYPE_STRING &&
                     v->flags & PCVRNT_FLAG_STRING_STATIC) {
                 *bytes = (void*)v->sz_ptr[1];
@@ -1607,6 +1620,271 @@ int purc_variant_compare_ex (purc_variant_t v1,
     return compare;
 }
 
+static bool is_number_type(purc_variant_t v)
+{
+    return v->type == PURC_VARIANT_TYPE_NUMBER ||
+        v->type == PURC_VARIANT_TYPE_LONGINT ||
+        v->type == PURC_VARIANT_TYPE_ULONGINT ||
+        v->type == PURC_VARIANT_TYPE_LONGDOUBLE;
+}
+
+/* the buffer holding the string sort keys one after another */
+struct string_keys {
+    char       *buf;
+    size_t      len;
+    size_t      sz;
+};
+
+static ssize_t
+string_keys_append(struct string_keys *keys, const char *str)
+{
+    size_t len = strlen(str) + 1;
+
+    if (keys->len + len > keys->sz) {
+        size_t sz = keys->sz ? keys->sz : 1024;
+        while (sz < keys->len + len)
+            sz *= 2;
+
+        char *buf = realloc(keys->buf, sz);
+        if (buf == NULL)
+            return -1;
+        keys->buf = buf;
+        keys->sz = sz;
+    }
+
+    memcpy(keys->buf + keys->len, str, len);
+    keys->len += len;
+    return keys->len - len;
+}
+
+/* the same comparators as compare_string_method() and
+   compare_number_method(), but on the precomputed keys */
+static int
+strcasecmp_asc(const void *l, const void *r, void *ud)
+{
+    UNUSED_PARAM(ud);
+    return pcutils_strcasecmp(l, r);
+}
+
+static int
+strcasecmp_desc(const void *l, const void *r, void *ud)
+{
+    UNUSED_PARAM(ud);
+    return pcutils_strcasecmp(r, l);
+}
+
+static int
+number_cmp(const double *l, const double *r)
+{
+    if (equal_doubles(*l, *r))
+        return 0;
+    return *l < *r ? -1 : 1;
+}
+
+static int
+number_cmp_asc(const void *l, const void *r, void *ud)
+{
+    UNUSED_PARAM(ud);
+    return number_cmp(l, r);
+}
+
+static int
+number_cmp_desc(const void *l, const void *r, void *ud)
+{
+    UNUSED_PARAM(ud);
+    return number_cmp(r, l);
+}
+
+static int
+sort_nodes_by_strings(struct pcutils_array_list *al, bool caseless, bool desc,
+        purc_variant_t (*node_val)(struct pcutils_array_list_node *node))
+{
+    size_t nr = al->nr;
+    struct string_keys arena = { };
+    const char **keys = malloc(sizeof(*keys) * nr);
+    /* the offsets of the keys in the arena, or -1 for borrowed strings */
+    ssize_t *offsets = malloc(sizeof(*offsets) * nr);
+    int ret = -1;
+
+    if (keys == NULL || offsets == NULL)
+        goto failed;
+
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = node_val(al->nodes[i]);
+
+        offsets[i] = -1;
+        if (v->type == PURC_VARIANT_TYPE_STRING) {
+            keys[i] = purc_variant_get_string_const(v);
+            continue;
+        }
+
+        char stackbuf[128];
+        char *buf = compare_stringify(v, stackbuf, sizeof(stackbuf));
+        offsets[i] = string_keys_append(&arena, buf ? buf : stackbuf);
+        free(buf);
+        if (offsets[i] < 0)
+            goto failed;
+    }
+
+    for (size_t i = 0; i < nr; i++) {
+        if (offsets[i] >= 0)
+            keys[i] = arena.buf + offsets[i];
+    }
+
+    /* the keys are not case-folded up front: pcutils_strcasecmp() folds
+       the characters with the locale and compares them as it did */
+    if (caseless)
+        ret = pcutils_array_list_sort_by_keys(al, (const void **)keys, NULL,
+                desc ? strcasecmp_desc : strcasecmp_asc);
+    else
+        ret = pcutils_array_list_sort_by_strings(al, keys, desc);
+
+failed:
+    free(arena.buf);
+    free(offsets);
+    free(keys);
+    return ret;
+}
+
+/* the integers less than this in magnitude are exact doubles, and no two
+   of them are within the epsilon of equal_doubles() */
+#define MAX_EXACT_INTEGER_KEY   (1LL << 52)
+
+/* Sorts the members by their exact values if they are all long integers
+   small enough to order the same way as compare_number_method(). Returns
+   1 if they are not, 0 on success, or -1 when out of memory. */
+static int
+sort_nodes_by_integers(struct pcutils_array_list *al, bool desc,
+        purc_variant_t (*node_val)(struct pcutils_array_list_node *node))
+{
+    size_t nr = al->nr;
+    uint64_t *keys = malloc(sizeof(*keys) * nr);
+    int ret = 1;
+
+    if (keys == NULL)
+        return -1;
+
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = node_val(al->nodes[i]);
+
+        /* flip the sign bit to order the signed values as unsigned */
+        if (v->type == PURC_VARIANT_TYPE_LONGINT &&
+                v->i64 > -MAX_EXACT_INTEGER_KEY &&
+                v->i64 < MAX_EXACT_INTEGER_KEY)
+            keys[i] = (uint64_t)v->i64 ^ 0x8000000000000000ULL;
+        else if (v->type == PURC_VARIANT_TYPE_ULONGINT &&
+                v->u64 < (uint64_t)MAX_EXACT_INTEGER_KEY)
+            keys[i] = v->u64 ^ 0x8000000000000000ULL;
+        else
+            goto done;
+    }
+
+    ret = pcutils_array_list_sort_by_integers(al, keys, desc);
+
+done:
+    free(keys);
+    return ret;
+}
+
+int
+pcvar_sort_nodes(struct pcutils_array_list *al, uintptr_t sort_flags,
+        purc_variant_t (*node_val)(struct pcutils_array_list_node *node))
+{
+    pcvrnt_compare_method_k method;
+    bool desc = (sort_flags & PCVRNT_SORT_DESC) != 0;
+    size_t nr = al->nr;
+
+    method = (pcvrnt_compare_method_k)(sort_flags & PCVRNT_CMPOPT_MASK);
+    if (nr < 2)
+        return 0;
+
+    if (method == PCVRNT_COMPARE_METHOD_AUTO) {
+        /* the method depends on the left operand: we can only decorate
+           the members if they all compare in the same way */
+        size_t nr_numbers = 0;
+        for (size_t i = 0; i < nr; i++) {
+            if (is_number_type(node_val(al->nodes[i])))
+                nr_numbers++;
+        }
+
+        if (nr_numbers == nr)
+            method = PCVRNT_COMPARE_METHOD_NUMBER;
+        else if (nr_numbers == 0)
+            method = PCVRNT_COMPARE_METHOD_CASE;
+        else
+            return -1;
+    }
+
+    if (method != PCVRNT_COMPARE_METHOD_NUMBER) {
+        return sort_nodes_by_strings(al,
+                method == PCVRNT_COMPARE_METHOD_CASELESS, desc, node_val);
+    }
+
+    int ret = sort_nodes_by_integers(al, desc, node_val);
+    if (ret <= 0)
+        return ret;
+
+    /* the numbers within the epsilon of equal_doubles() are equal and
+       keep their order, so do not sort them by the exact values */
+    double *numbers = malloc(sizeof(*numbers) * nr);
+    const double **keys = malloc(sizeof(*keys) * nr);
+    ret = -1;
+    if (numbers == NULL || keys == NULL)
+        goto done;
+
+    for (size_t i = 0; i < nr; i++) {
+        numbers[i] = purc_variant_numerify(node_val(al->nodes[i]));
+        keys[i] = numbers + i;
+    }
+
+    ret = pcutils_array_list_sort_by_keys(al, (const void **)keys, NULL,
+            desc ? number_cmp_desc : number_cmp_asc);
+
+done:
+    free(keys);
+    free(numbers);
+    return ret;
+}
+
+int
+pcvar_sort_nodes_by_keys(struct pcutils_array_list *al,
+        purc_variant_t (*node_val)(struct pcutils_array_list_node *node),
+        void *ud, void *(*get_key)(purc_variant_t member, void *ud),
+        int (*cmp)(const void *l, const void *r, void *ud),
+        void (*free_key)(void *key))
+{
+    size_t nr = al->nr;
+    if (nr < 2)
+        return 0;
+
+    void **keys = calloc(nr, sizeof(*keys));
+    if (keys == NULL)
+        goto out_of_memory;
+
+    for (size_t i = 0; i < nr; i++) {
+        keys[i] = get_key(node_val(al->nodes[i]), ud);
+        if (keys[i] == NULL)
+            goto out_of_memory;
+    }
+
+    if (pcutils_array_list_sort_by_keys(al, (const void **)keys, ud, cmp))
+        goto out_of_memory;
+
+    for (size_t i = 0; i < nr; i++)
+        free_key(keys[i]);
+    free(keys);
+    return 0;
+
+out_of_memory:
+    if (keys) {
+        for (size_t i = 0; i < nr && keys[i]; i++)
+            free_key(keys[i]);
+        free(keys);
+    }
+    pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return -1;
+}
+
 purc_variant_t purc_variant_load_from_json_stream(purc_rwstream_t stream)
 {
     if (stream  == NULL) {
@@ -1646,7 +1924,7 @@ purc_variant_t purc_variant_make_from_json_string(const char* json, size_t sz)
 purc_variant_t purc_variant_load_from_json_file(const char* file)
 {
     purc_variant_t value;
-    purc_rwstream_t rwstream = purc_rwstream_new_from_file(file, "r");
+    purc_rwstream_t rwstream = pcrwstream_new_from_file_for_read(file);
     if (rwstream == NULL)
         return PURC_VARIANT_INVALID;
 
@@ -2604,7 +2882,7 @@ pcvariant_object_set_va(purc_variant_t obj, size_t nr_kvs, va_list ap)
         const char *val = va_arg(ap, const char*);
         PC_ASSERT(key);
         PC_ASSERT(val);
-        purc_variant_t k = purc_variant_make_string(key, true);
+        purc_variant_t k = pcvariant_make_object_key(key, true);
         if (k == PURC_VARIANT_INVALID)
             return -1;
         purc_variant_t v = purc_variant_make_string(val, true);
@@ -2777,7 +3055,7 @@ struct purc_ejson_parsing_tree *
 purc_variant_ejson_parse_file(const char *fname)
 {
     struct purc_ejson_parsing_tree *ptree;
-    purc_rwstream_t rwstream = purc_rwstream_new_from_file(fname, "r");
+    purc_rwstream_t rwstream = pcrwstream_new_from_file_for_read(fname);
     if (rwstream == NULL)
         return NULL;
 
@@ -33,9 +33,11 @@
 #include "purc-rwstream.h"
 
 #include "private/errors.h"
+#include "private/instance.h"
 #include "private/stack.h"
 #include "private/interpreter.h"
 #include "private/utils.h"
+#include "private/variant.h"
 
 #include "eval.h"
 #include "ops.h"
@@ -494,6 +496,228 @@ has_fatal_error(int err)
     return (err == PURC_ERROR_OUT_OF_MEMORY);
 }
 
+static int comp_const_node(const void *key1, const void *key2)
+{
+    if ((uintptr_t)key1 < (uintptr_t)key2)
+        return -1;
+    return (key1 == key2) ? 0 : 1;
+}
+
+/* the value of a constant node: the master is never handed out, and the
+   copy handed out last is handed out again while it is unchanged */
+struct const_value {
+    purc_variant_t          master;
+    purc_variant_t          copy;
+};
+
+static void free_const_value(void *val)
+{
+    struct const_value *cv = (struct const_value *)val;
+    purc_variant_unref(cv->master);
+    PURC_VARIANT_SAFE_CLEAR(cv->copy);
+    free(cv);
+}
+
+/* builds the value of a literal subtree in the same way as the ops do */
+static purc_variant_t
+make_const_value(struct pcvcm_node *node)
+{
+    purc_variant_t ret = PURC_VARIANT_INVALID;
+    struct pcvcm_node *child = pcvcm_node_first_child(node);
+    size_t i = 0;
+
+    switch (node->type) {
+    case PCVCM_NODE_TYPE_UNDEFINED:
+        return purc_variant_make_undefined();
+    case PCVCM_NODE_TYPE_NULL:
+        return purc_variant_make_null();
+    case PCVCM_NODE_TYPE_BOOLEAN:
+        return purc_variant_make_boolean(node->b);
+    case PCVCM_NODE_TYPE_NUMBER:
+        return purc_variant_make_number(node->d);
+    case PCVCM_NODE_TYPE_LONG_INT:
+        return purc_variant_make_longint(node->i64);
+    case PCVCM_NODE_TYPE_ULONG_INT:
+        return purc_variant_make_ulongint(node->u64);
+    case PCVCM_NODE_TYPE_LONG_DOUBLE:
+        return purc_variant_make_longdouble(node->ld);
+    case PCVCM_NODE_TYPE_STRING:
+        return purc_variant_make_string((char*)node->sz_ptr[1], false);
+    case PCVCM_NODE_TYPE_BYTE_SEQUENCE:
+        return (node->sz_ptr[0] > 0) ? purc_variant_make_byte_sequence(
+                (void*)node->sz_ptr[1], node->sz_ptr[0])
+            : purc_variant_make_byte_sequence_empty();
+
+    case PCVCM_NODE_TYPE_OBJECT:
+        ret = purc_variant_make_object(0, PURC_VARIANT_INVALID,
+                PURC_VARIANT_INVALID);
+        while (ret && child) {
+            struct pcvcm_node *next = (struct pcvcm_node *)
+                pctree_node_next(&child->tree_node);
+            purc_variant_t k = make_const_value(child);
+            purc_variant_t v = next ? make_const_value(next) :
+                PURC_VARIANT_INVALID;
+            if (!k || !v || !pcvariant_object_set_with_shared_key(ret, k, v)) {
+                PURC_VARIANT_SAFE_CLEAR(ret);
+            }
+            PURC_VARIANT_SAFE_CLEAR(k);
+            PURC_VARIANT_SAFE_CLEAR(v);
+            child = next ? (struct pcvcm_node *)
+                pctree_node_next(&next->tree_node) : NULL;
+        }
+        return ret;
+
+    case PCVCM_NODE_TYPE_ARRAY:
+        ret = purc_variant_make_array(0, PURC_VARIANT_INVALID);
+        break;
+
+    case PCVCM_NODE_TYPE_TUPLE:
+        ret = purc_variant_make_tuple(pcvcm_node_children_count(node), NULL);
+        break;
+
+    default:
+        return PURC_VARIANT_INVALID;
+    }
+
+    for (; ret && child; i++) {
+        purc_variant_t v = make_const_value(child);
+        bool ok = v && ((node->type == PCVCM_NODE_TYPE_ARRAY) ?
+                purc_variant_array_append(ret, v) :
+                purc_variant_tuple_set(ret, i, v));
+        if (!ok) {
+            PURC_VARIANT_SAFE_CLEAR(ret);
+        }
+        PURC_VARIANT_SAFE_CLEAR(v);
+        child = (struct pcvcm_node *)pctree_node_next(&child->tree_node);
+    }
+    return ret;
+}
+
+/*
+ * Returns true if the container copied from master is held only by its
+ * parent (or by the cache for the root) and has not been changed. The
+ * scalars are shared by the copy, so they are compared by address.
+ */
+static bool
+is_unchanged_copy(purc_variant_t master, purc_variant_t copy)
+{
+    if (!purc_variant_is_container(master)) {
+        return master == copy;
+    }
+
+    if (copy->type != master->type || copy->refc != 1 ||
+            !list_empty(&copy->listeners)) {
+        return false;
+    }
+
+    if (master->type == PURC_VARIANT_TYPE_OBJECT) {
+        variant_obj_t m = (variant_obj_t)master->sz_ptr[1];
+        variant_obj_t c = (variant_obj_t)copy->sz_ptr[1];
+        if (m->size != c->size) {
+            return false;
+        }
+
+        /* the members of both are ordered by the keys */
+        struct rb_node *pm = pcutils_rbtree_first(&m->kvs);
+        struct rb_node *pc = pcutils_rbtree_first(&c->kvs);
+        for (; pm && pc; pm = pcutils_rbtree_next(pm),
+                pc = pcutils_rbtree_next(pc)) {
+            struct obj_node *nm = container_of(pm, struct obj_node, node);
+            struct obj_node *nc = container_of(pc, struct obj_node, node);
+            if (nm->key != nc->key || !is_unchanged_copy(nm->val, nc->val)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t sz_m, sz_c;
+    if (!purc_variant_linear_container_size(master, &sz_m) ||
+            !purc_variant_linear_container_size(copy, &sz_c) ||
+            sz_m != sz_c) {
+        return false;
+    }
+
+    for (size_t i = 0; i < sz_m; i++) {
+        if (!is_unchanged_copy(purc_variant_linear_container_get(master, i),
+                    purc_variant_linear_container_get(copy, i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Returns the value of a container marked by pcvcm_node_mark_const(), or
+ * PURC_VARIANT_INVALID to evaluate it as usual. The value is built once per
+ * coroutine, which holds the vDOM. Since the page may change the container
+ * it gets, a copy is handed out; the copy is made again only if the last one
+ * is still held by someone else or has been changed.
+ */
+static purc_variant_t
+const_value(struct pcvcm_node *node)
+{
+    if (!(node->extra & EXTRA_CONST_FLAG)) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    pcintr_stack_t stack = pcintr_get_stack();
+    if (!stack) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (!stack->vcm_const_values) {
+        stack->vcm_const_values = pcutils_map_create(NULL, NULL, NULL,
+                free_const_value, comp_const_node, false);
+        if (!stack->vcm_const_values) {
+            return PURC_VARIANT_INVALID;
+        }
+    }
+
+    struct const_value *cv;
+    const void *key = (const void *)(uintptr_t)node->serial;
+    pcutils_map_entry *me = pcutils_map_find(stack->vcm_const_values, key);
+    if (me) {
+        cv = (struct const_value *)me->val;
+    }
+    else {
+        cv = (struct const_value *)calloc(1, sizeof(*cv));
+        if (!cv) {
+            return PURC_VARIANT_INVALID;
+        }
+
+        cv->master = make_const_value(node);
+        if (!cv->master) {
+            free(cv);
+            purc_clr_error();
+            return PURC_VARIANT_INVALID;
+        }
+
+        /* see get_var_site() in vcm.c */
+        if (pcutils_map_get_size(stack->vcm_const_values) >=
+                PCVCM_MAX_CACHED_NODES) {
+            pcutils_map_clear(stack->vcm_const_values);
+        }
+        if (pcutils_map_insert(stack->vcm_const_values, key, cv)) {
+            free_const_value(cv);
+            return PURC_VARIANT_INVALID;
+        }
+    }
+
+    if (cv->copy && !is_unchanged_copy(cv->master, cv->copy)) {
+        PURC_VARIANT_SAFE_CLEAR(cv->copy);
+    }
+
+    if (!cv->copy) {
+        cv->copy = purc_variant_container_clone_recursively(cv->master);
+        if (!cv->copy) {
+            return PURC_VARIANT_INVALID;
+        }
+    }
+
+    return purc_variant_ref(cv->copy);
+}
+
 purc_variant_t
 eval_frame(struct pcvcm_eval_ctxt *ctxt, int32_t frame_idx, size_t return_pos)
 {
@@ -542,6 +766,12 @@ eval_frame(struct pcvcm_eval_ctxt *ctxt, int32_t frame_idx, size_t return_pos)
                         }
                         break;
                     }
+                    val = const_value(param->node);
+                    if (val) {
+                        pcvcm_set_frame_result(ctxt, frame_idx, frame->pos,
+                                val);
+                        continue;
+                    }
                     param_frame = push_frame(ctxt, param, frame->pos);
                     if (!param_frame) {
                         goto out;
@@ -680,46 +910,155 @@ static void assign_idx_cb(struct pctree_node *node,  void *data)
     n->idx = (*idx)++;
 }
 
-static void build_eval_nodes_cb(struct pctree_node *node, void *data)
+static void init_eval_node(struct pcvcm_eval_node *p,
+        struct pcvcm_node *node, int32_t idx)
 {
-    struct pcvcm_eval_ctxt *ctxt = (struct pcvcm_eval_ctxt *) data;
-    struct pcvcm_eval_node *p = ctxt->eval_nodes + ctxt->eval_nodes_insert_pos;
-    p->node = (struct pcvcm_node *)node;
-    p->idx = ctxt->eval_nodes_insert_pos;
+    p->node = node;
+    p->idx = idx;
     p->result = PURC_VARIANT_INVALID;
     p->first_child_idx = -1;
-    ctxt->eval_nodes_insert_pos++;
 }
 
-static void build_eval_node_children(struct pctree_node *node, void *data)
+/*
+ * Lays the nodes of the tree out in breadth-first order from the insert
+ * position: the children of a node are adjacent, and the array itself is
+ * the queue of the traversal.
+ */
+static void build_eval_nodes(struct pcvcm_eval_ctxt *ctxt,
+        struct pcvcm_node *node)
+{
+    struct pcvcm_eval_node *nodes = ctxt->eval_nodes;
+    int32_t pos = ctxt->eval_nodes_insert_pos;
+
+    init_eval_node(nodes + pos, node, pos);
+    for (int32_t i = pos++; i < pos; i++) {
+        struct pcvcm_node *child = pcvcm_node_first_child(nodes[i].node);
+        if (child) {
+            nodes[i].first_child_idx = pos;
+        }
+        while (child) {
+            init_eval_node(nodes + pos, child, pos);
+            pos++;
+            child = (struct pcvcm_node *)pctree_node_next(&child->tree_node);
+        }
+    }
+    ctxt->eval_nodes_insert_pos = pos;
+}
+
+/*
+ * The arrays of eval nodes and frames used by pcvcm_eval_full() are taken
+ * from a pool of the instance and put back after the evaluation, instead
+ * of being sized on the C stack for every call. The evaluation may be
+ * nested (e.g., a dynamic method evaluates an expression), so the pool is
+ * a LIFO list; a context which has to outlive the call (PURC_ERROR_AGAIN)
+ * is duplicated on the heap as before.
+ */
+#define NR_MAX_POOLED_BUFFS     8
+#define NR_MAX_POOLED_NODES     1024
+#define NR_MIN_BUFF_NODES       16
+
+struct eval_buff {
+    struct eval_buff               *next;
+    size_t                          nr_nodes;   // the capacity
+    struct pcvcm_eval_node         *eval_nodes;
+    struct pcvcm_eval_stack_frame  *frames;
+};
+
+struct pcvcm_eval_pool {
+    struct eval_buff               *free_buffs;
+    size_t                          nr_free_buffs;
+};
+
+static void free_eval_buff(struct eval_buff *buff)
+{
+    free(buff->eval_nodes);
+    free(buff->frames);
+    free(buff);
+}
+
+void
+pcvcm_eval_pool_destroy(struct pcvcm_eval_pool *pool)
 {
-    if (!node->first_child) {
+    if (!pool) {
         return;
     }
 
-    struct pcvcm_eval_ctxt *ctxt = (struct pcvcm_eval_ctxt *) data;
-    int32_t pos = ctxt->eval_nodes_insert_pos;
-    for (int32_t i = pos - 1 ; i >= 0; i--) {
-        struct pcvcm_eval_node *p = ctxt->eval_nodes + i;
-        if (p->node == (struct pcvcm_node *)node) {
-            p->first_child_idx = pos;
-            break;
+    while (pool->free_buffs) {
+        struct eval_buff *buff = pool->free_buffs;
+        pool->free_buffs = buff->next;
+        free_eval_buff(buff);
+    }
+    free(pool);
+}
+
+static struct eval_buff *
+acquire_eval_buff(size_t nr_nodes)
+{
+    struct pcinst *inst = pcinst_current();
+    struct pcvcm_eval_pool *pool = inst ? inst->vcm_eval_pool : NULL;
+    struct eval_buff *buff;
+
+    if (pool && pool->free_buffs) {
+        buff = pool->free_buffs;
+        pool->free_buffs = buff->next;
+        pool->nr_free_buffs--;
+    }
+    else {
+        buff = (struct eval_buff *)calloc(1, sizeof(*buff));
+        if (!buff) {
+            goto failed;
         }
     }
 
-    pctree_node_children_for_each(node, build_eval_nodes_cb, data);
-    pctree_node_children_for_each(node, build_eval_node_children, data);
+    if (buff->nr_nodes < nr_nodes) {
+        size_t n = (nr_nodes < NR_MIN_BUFF_NODES) ? NR_MIN_BUFF_NODES :
+            nr_nodes;
+        void *p = realloc(buff->eval_nodes, n * sizeof(*buff->eval_nodes));
+        if (!p) {
+            goto failed_buff;
+        }
+        buff->eval_nodes = (struct pcvcm_eval_node *)p;
+
+        p = realloc(buff->frames, n * sizeof(*buff->frames));
+        if (!p) {
+            goto failed_buff;
+        }
+        buff->frames = (struct pcvcm_eval_stack_frame *)p;
+        buff->nr_nodes = n;
+    }
+
+    return buff;
+
+failed_buff:
+    free_eval_buff(buff);
+failed:
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return NULL;
 }
 
-static void build_eval_nodes(struct pcvcm_eval_ctxt *ctxt,
-        struct pcvcm_node *node)
+static void
+release_eval_buff(struct eval_buff *buff)
 {
-    struct pcvcm_eval_node *p = ctxt->eval_nodes + ctxt->eval_nodes_insert_pos;
-    p->node = (struct pcvcm_node *)node;
-    p->idx = ctxt->eval_nodes_insert_pos;
-    p->result = PURC_VARIANT_INVALID;
-    ctxt->eval_nodes_insert_pos++;
-    build_eval_node_children(&node->tree_node, ctxt);
+    struct pcinst *inst = pcinst_current();
+    if (!inst || buff->nr_nodes > NR_MAX_POOLED_NODES) {
+        free_eval_buff(buff);
+        return;
+    }
+
+    if (!inst->vcm_eval_pool) {
+        inst->vcm_eval_pool = (struct pcvcm_eval_pool *)calloc(1,
+                sizeof(struct pcvcm_eval_pool));
+    }
+
+    struct pcvcm_eval_pool *pool = inst->vcm_eval_pool;
+    if (!pool || pool->nr_free_buffs >= NR_MAX_POOLED_BUFFS) {
+        free_eval_buff(buff);
+        return;
+    }
+
+    buff->next = pool->free_buffs;
+    pool->free_buffs = buff;
+    pool->nr_free_buffs++;
 }
 
 static bool _init_by_env = false;
@@ -759,6 +1098,13 @@ purc_variant_t pcvcm_eval_full(struct pcvcm_node *tree,
 
     purc_clr_error();
 
+    if (tree && (result = const_value(tree))) {
+        if (ctxt_out) {
+            *ctxt_out = NULL;
+        }
+        return result;
+    }
+
     if (!tree) {
         result = silently ? purc_variant_make_undefined() :
             PURC_VARIANT_INVALID;
@@ -773,17 +1119,15 @@ purc_variant_t pcvcm_eval_full(struct pcvcm_node *tree,
         nr_nodes = tree->nr_nodes;
     }
 
-    struct pcvcm_eval_node eval_nodes[nr_nodes];
-    struct pcvcm_eval_stack_frame frames[nr_nodes];
-
-    if (nr_nodes) {
+    struct eval_buff *buff = NULL;
+    if (nr_nodes && (buff = acquire_eval_buff(nr_nodes))) {
         ctxt->enable_log = enable_log;
         ctxt->node = tree;
         ctxt->frame_idx = -1;
         ctxt->nr_eval_nodes = nr_nodes;
-        ctxt->eval_nodes = eval_nodes;
+        ctxt->eval_nodes = buff->eval_nodes;
         ctxt->nr_frames = nr_nodes;
-        ctxt->frames = frames;
+        ctxt->frames = buff->frames;
 
         build_eval_nodes(ctxt, tree);
 
@@ -830,6 +1174,10 @@ purc_variant_t pcvcm_eval_full(struct pcvcm_node *tree,
             *ctxt_out = NULL;
         }
     }
+
+    if (buff) {
+        release_eval_buff(buff);
+    }
     return result;
 }
 
@@ -179,6 +179,12 @@ purc_variant_t pcvcm_eval_again_full(struct pcvcm_node *tree,
         find_var_fn find_var, void *find_var_ctxt,
         bool silently, bool timeout);
 
+/* Finds the variable referred by the `getVariable` node; the resolution is
+   cached by the node when evaluating in a stack. */
+purc_variant_t
+pcvcm_eval_find_var(struct pcvcm_eval_ctxt *ctxt, struct pcvcm_node *node,
+        const char *name);
+
 purc_variant_t pcvcm_eval_sub_expr_full(struct pcvcm_node *tree,
         struct pcvcm_eval_ctxt *ctxt, purc_variant_t args, bool silently);
 
@@ -26,6 +26,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <errno.h>
+#include <inttypes.h>
 
 #include "config.h"
 #include "purc-utils.h"
@@ -36,13 +37,20 @@
 #include "private/stack.h"
 #include "private/interpreter.h"
 #include "private/utils.h"
+#include "private/variant.h"
 #include "private/vcm.h"
 
 #include "../eval.h"
 #include "../ops.h"
 
-#define MIN_BUF_SIZE         32
-#define MAX_BUF_SIZE         SIZE_MAX
+#define NR_STACK_PARTS      16
+#define LEN_NUMBER_BUF      48
+
+struct part {
+    const char *str;        // NULL if the part is stringified in place
+    size_t      len;
+    char        num[LEN_NUMBER_BUF];
+};
 
 static int
 after_pushed(struct pcvcm_eval_ctxt *ctxt,
@@ -53,51 +61,135 @@ after_pushed(struct pcvcm_eval_ctxt *ctxt,
     return 0;
 }
 
+/* Gets the length of the stringified part; the scalars are converted here
+   in the same way as purc_variant_stringify() does. */
+static void
+measure_part(purc_variant_t v, struct part *part)
+{
+    int n = 0;
+
+    part->str = part->num;
+    switch (purc_variant_get_type(v)) {
+    case PURC_VARIANT_TYPE_UNDEFINED:
+        part->str = "undefined";
+        break;
+
+    case PURC_VARIANT_TYPE_NULL:
+        part->str = "null";
+        break;
+
+    case PURC_VARIANT_TYPE_BOOLEAN:
+        part->str = v->b ? "true" : "false";
+        break;
+
+    case PURC_VARIANT_TYPE_EXCEPTION:
+    case PURC_VARIANT_TYPE_ATOMSTRING:
+    case PURC_VARIANT_TYPE_STRING:
+        part->str = purc_variant_get_string_const_ex(v, &part->len);
+        return;
+
+    case PURC_VARIANT_TYPE_NUMBER:
+        n = snprintf(part->num, sizeof(part->num), "%g", v->d);
+        break;
+
+    case PURC_VARIANT_TYPE_LONGINT:
+        n = snprintf(part->num, sizeof(part->num), "%" PRId64, v->i64);
+        break;
+
+    case PURC_VARIANT_TYPE_ULONGINT:
+        n = snprintf(part->num, sizeof(part->num), "%" PRIu64, v->u64);
+        break;
+
+    case PURC_VARIANT_TYPE_LONGDOUBLE:
+        n = snprintf(part->num, sizeof(part->num), "%Lg", v->ld);
+        break;
+
+    default:
+        /* a null stream only counts the length */
+        part->str = NULL;
+        part->len = 0;
+        if (purc_variant_stringify(NULL, v, 0, &part->len) < 0)
+            part->len = 0;
+        return;
+    }
+
+    if (part->str == part->num) {
+        PC_ASSERT(n >= 0 && (size_t)n < sizeof(part->num));
+        part->len = (size_t)n;
+    }
+    else {
+        part->len = strlen(part->str);
+    }
+}
+
 static purc_variant_t
 eval(struct pcvcm_eval_ctxt *ctxt,
         struct pcvcm_eval_stack_frame *frame)
 {
-    UNUSED_PARAM(ctxt);
-    UNUSED_PARAM(frame);
     purc_variant_t ret = PURC_VARIANT_INVALID;
-    purc_rwstream_t rws = purc_rwstream_new_buffer(MIN_BUF_SIZE, MAX_BUF_SIZE);
-    if (!rws) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto out;
+    struct part stack_parts[NR_STACK_PARTS];
+    struct part *parts = stack_parts;
+    char *buf = NULL;
+
+    if (frame->nr_params > NR_STACK_PARTS) {
+        parts = malloc(sizeof(*parts) * frame->nr_params);
+        if (parts == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            goto out;
+        }
     }
 
+    /* the first pass gets the length of every part */
+    size_t total = 1;       // do not forget tailing-null-terminator
     for (size_t i = 0; i < frame->nr_params; i++) {
         purc_variant_t v = pcvcm_get_frame_result(ctxt, frame->idx, i);
 
         // FIXME: stringify or serialize
-        char *buf = NULL;
-        int total = purc_variant_stringify_alloc(&buf, v);
-        if (total) {
-            purc_rwstream_write(rws, buf, total);
-        }
-        free(buf);
+        measure_part(v, parts + i);
+        total += parts[i].len;
     }
 
-    // do not forget tailing-null-terminator
-    purc_rwstream_write(rws, "", 1);
+    buf = malloc(total);
+    if (buf == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto out;
+    }
 
-    size_t rw_size = 0;
-    size_t content_size = 0;
-    char *rw_string = purc_rwstream_get_mem_buffer_ex(rws,
-            &content_size, &rw_size, true);
+    /* the second pass writes the parts into the exactly-sized buffer */
+    char *p = buf;
+    for (size_t i = 0; i < frame->nr_params; i++) {
+        struct part *part = parts + i;
+        if (part->len == 0)
+            continue;
 
-    if (rw_size && rw_string) {
-        ret = purc_variant_make_string_reuse_buff(rw_string,
-                content_size, false);
-        if (ret == PURC_VARIANT_INVALID) {
-            pcinst_set_error(PURC_ERROR_INVALID_VALUE);
-            ret = PURC_VARIANT_INVALID;
+        if (part->str) {
+            memcpy(p, part->str, part->len);
+        }
+        else {
+            purc_variant_t v = pcvcm_get_frame_result(ctxt, frame->idx, i);
+            purc_rwstream_t rws = purc_rwstream_new_from_mem(p, part->len);
+            if (rws == NULL) {
+                purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+                goto out;
+            }
+            purc_variant_stringify(rws, v, 0, NULL);
+            purc_rwstream_destroy(rws);
         }
+        p += part->len;
+    }
+    *p = '\0';
+
+    ret = purc_variant_make_string_reuse_buff(buf, total, false);
+    if (ret == PURC_VARIANT_INVALID) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        goto out;
     }
+    buf = NULL;
 
 out:
-    if (rws) {
-        purc_rwstream_destroy(rws);
+    free(buf);
+    if (parts != stack_parts) {
+        free(parts);
     }
     return ret;
 }
@@ -94,7 +94,7 @@ eval(struct pcvcm_eval_ctxt *ctxt,
     const char *sname = purc_variant_get_string_const(name);
     ret = find_from_frame(ctxt, sname);
     if (!ret) {
-        ret = ctxt->find_var(ctxt->find_var_ctxt, sname);
+        ret = pcvcm_eval_find_var(ctxt, frame->node, sname);
     }
 
 out:
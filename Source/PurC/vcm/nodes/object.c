@@ -37,6 +37,7 @@
 #include "private/interpreter.h"
 #include "private/utils.h"
 #include "private/vcm.h"
+#include "private/variant.h"
 
 #include "../eval.h"
 #include "../ops.h"
@@ -68,7 +69,9 @@ eval(struct pcvcm_eval_ctxt *ctxt,
     for (size_t i = 0; i < frame->nr_params; i += 2) {
         purc_variant_t key = pcvcm_get_frame_result(ctxt, frame->idx, i);
         purc_variant_t value = pcvcm_get_frame_result(ctxt, frame->idx, i + 1);
-        if (!purc_variant_object_set(object, key, value)) {
+        /* share the interned key with the objects of the same shape */
+        bool ok = pcvariant_object_set_with_shared_key(object, key, value);
+        if (!ok) {
             goto out;
         }
     }
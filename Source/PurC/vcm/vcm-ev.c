@@ -36,18 +36,33 @@
 #include "private/stack.h"
 #include "private/interpreter.h"
 #include "private/utils.h"
+#include "private/variant.h"
+#include "private/map.h"
 #include "private/vcm.h"
 
 #include "eval.h"
 
 #define PCVCM_EV_WITHOUT_ARGS       "__pcvcm_ev_without_args"
 
+#define CONST_HASH_MAX_DEPTH        32
+#define CONST_HASH_FNV_OFFSET       0xcbf29ce484222325ULL
+#define CONST_HASH_FNV_PRIME        0x100000001b3ULL
+
+// a cached result of `eval_const`, keyed by the structural hash of args
+struct const_entry {
+    struct const_entry *next;               // the next one with same hash
+    uint64_t            hash;
+    purc_variant_t      args;               // a deep copy of the arguments
+    purc_variant_t      value;
+};
+
 // expression variable
 struct pcvcm_ev {
     struct pcvcm_node *vcm;
     char *method_name;
     char *const_method_name;
-    purc_variant_t values;                  // object: stringify(args) : value
+    purc_variant_t values;                  // object: md5(args) : value
+    pcutils_map *const_values;              // hash(args) : const_entry
     purc_variant_t last_value;
     bool release_vcm;
     bool constantly;
@@ -92,52 +107,23 @@ cb_calc_md5(void *ctxt, const void *buf, size_t count)
     return count;
 }
 
+/* The fallback key for the arguments which can not be hashed structurally,
+   e.g., the ones containing native entities. */
 static purc_variant_t
-build_const_key(struct pcintr_stack *stack, purc_variant_t args)
+build_const_key(purc_variant_t args)
 {
-    UNUSED_PARAM(stack);
     pcutils_md5_ctxt md5_ctxt;
     purc_variant_t ret = PURC_VARIANT_INVALID;
-    purc_variant_t key = PURC_VARIANT_INVALID;
     purc_rwstream_t stream = purc_rwstream_new_for_dump(&md5_ctxt, cb_calc_md5);
     if (stream == NULL) {
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         goto out;
     }
 
-    key = args;
-    ssize_t nr = purc_variant_tuple_get_size(args);
-    if (nr == 1) {
-        switch (args->type) {
-            case PURC_VARIANT_TYPE_UNDEFINED:
-            case PURC_VARIANT_TYPE_NULL:
-            case PURC_VARIANT_TYPE_BOOLEAN:
-            case PURC_VARIANT_TYPE_EXCEPTION:
-            case PURC_VARIANT_TYPE_NUMBER:
-            case PURC_VARIANT_TYPE_LONGINT:
-            case PURC_VARIANT_TYPE_ULONGINT:
-            case PURC_VARIANT_TYPE_LONGDOUBLE:
-            case PURC_VARIANT_TYPE_ATOMSTRING:
-                key = purc_variant_tuple_get(args, 0);
-                break;
-
-            case PURC_VARIANT_TYPE_STRING:
-            case PURC_VARIANT_TYPE_BSEQUENCE:
-            case PURC_VARIANT_TYPE_DYNAMIC:
-            case PURC_VARIANT_TYPE_NATIVE:
-            case PURC_VARIANT_TYPE_OBJECT:
-            case PURC_VARIANT_TYPE_ARRAY:
-            case PURC_VARIANT_TYPE_SET:
-            case PURC_VARIANT_TYPE_TUPLE:
-            default:
-                key = args;
-                break;
-        }
-    }
-
     pcutils_md5_begin(&md5_ctxt);
-    if (purc_variant_stringify(stream, key,
+    if (purc_variant_stringify(stream, args,
             PCVRNT_STRINGIFY_OPT_BSEQUENCE_BAREBYTES, NULL) < 0) {
+        purc_rwstream_destroy(stream);
         goto out;
     }
 
@@ -146,14 +132,6 @@ build_const_key(struct pcintr_stack *stack, purc_variant_t args)
     unsigned char md5[MD5_DIGEST_SIZE];
     pcutils_md5_end(&md5_ctxt, md5);
 
-
-    /* add scope */
-    struct pcintr_stack_frame *frame = pcintr_stack_get_bottom_frame(stack);
-    if (frame && frame->pos) {
-        uintptr_t p = (uintptr_t)frame->pos;
-        pcutils_md5_hash(&md5_ctxt, (char*)p, sizeof(uintptr_t));
-    }
-
     char hex[sizeof(md5) * 2 + 1] = {0};
     pcutils_bin2hex(md5, sizeof(md5), hex, true);
     ret  = purc_variant_make_string(hex, false);
@@ -161,6 +139,204 @@ out:
     return ret;
 }
 
+static inline uint64_t
+hash_bytes(uint64_t hash, const void *bytes, size_t nr_bytes)
+{
+    const unsigned char *p = bytes;
+    for (size_t i = 0; i < nr_bytes; i++) {
+        hash = (hash ^ p[i]) * CONST_HASH_FNV_PRIME;
+    }
+    return hash;
+}
+
+/* Hashes the structure and the contents of a variant without serializing
+   it; returns false for a variant which can only be compared by identity. */
+static bool
+hash_variant(purc_variant_t v, uint64_t *hash, int depth)
+{
+    if (depth > CONST_HASH_MAX_DEPTH)
+        return false;
+
+    unsigned char type = (unsigned char)v->type;
+    uint64_t h = hash_bytes(*hash, &type, sizeof(type));
+
+    const void *bytes = NULL;
+    size_t nr_bytes = 0;
+    double d;
+
+    switch (v->type) {
+    case PURC_VARIANT_TYPE_UNDEFINED:
+    case PURC_VARIANT_TYPE_NULL:
+        break;
+
+    case PURC_VARIANT_TYPE_BOOLEAN:
+        h = hash_bytes(h, &v->b, sizeof(v->b));
+        break;
+
+    case PURC_VARIANT_TYPE_EXCEPTION:
+        h = hash_bytes(h, &v->atom, sizeof(v->atom));
+        break;
+
+    case PURC_VARIANT_TYPE_NUMBER:
+        h = hash_bytes(h, &v->d, sizeof(v->d));
+        break;
+
+    case PURC_VARIANT_TYPE_LONGINT:
+        h = hash_bytes(h, &v->i64, sizeof(v->i64));
+        break;
+
+    case PURC_VARIANT_TYPE_ULONGINT:
+        h = hash_bytes(h, &v->u64, sizeof(v->u64));
+        break;
+
+    case PURC_VARIANT_TYPE_LONGDOUBLE:
+        /* the padding bytes of a long double are undefined */
+        d = (double)v->ld;
+        h = hash_bytes(h, &d, sizeof(d));
+        break;
+
+    case PURC_VARIANT_TYPE_ATOMSTRING:
+    case PURC_VARIANT_TYPE_STRING:
+        bytes = purc_variant_get_string_const_ex(v, &nr_bytes);
+        if (v->type == PURC_VARIANT_TYPE_ATOMSTRING && bytes)
+            nr_bytes = strlen(bytes);
+        h = hash_bytes(h, bytes, nr_bytes);
+        break;
+
+    case PURC_VARIANT_TYPE_BSEQUENCE:
+        bytes = purc_variant_get_bytes_const(v, &nr_bytes);
+        h = hash_bytes(h, bytes, nr_bytes);
+        break;
+
+    case PURC_VARIANT_TYPE_OBJECT:
+    {
+        purc_variant_t key, val;
+        foreach_key_value_in_variant_object(v, key, val) {
+            if (!hash_variant(key, &h, depth + 1) ||
+                    !hash_variant(val, &h, depth + 1))
+                return false;
+        } end_foreach;
+        break;
+    }
+
+    case PURC_VARIANT_TYPE_ARRAY:
+    {
+        purc_variant_t val;
+        size_t idx;
+        foreach_value_in_variant_array(v, val, idx) {
+            (void)idx;
+            if (!hash_variant(val, &h, depth + 1))
+                return false;
+        } end_foreach;
+        break;
+    }
+
+    case PURC_VARIANT_TYPE_SET:
+    {
+        purc_variant_t val;
+        foreach_value_in_variant_set(v, val) {
+            if (!hash_variant(val, &h, depth + 1))
+                return false;
+        } end_foreach;
+        break;
+    }
+
+    case PURC_VARIANT_TYPE_TUPLE:
+    {
+        size_t sz = 0;
+        purc_variant_t *members = tuple_members(v, &sz);
+        for (size_t i = 0; i < sz; i++) {
+            if (!hash_variant(members[i], &h, depth + 1))
+                return false;
+        }
+        break;
+    }
+
+    case PURC_VARIANT_TYPE_DYNAMIC:
+    case PURC_VARIANT_TYPE_NATIVE:
+    default:
+        return false;
+    }
+
+    *hash = h;
+    return true;
+}
+
+static int
+comp_const_hash(const void *key1, const void *key2)
+{
+    uint64_t h1 = *(const uint64_t *)key1;
+    uint64_t h2 = *(const uint64_t *)key2;
+    return (h1 < h2) ? -1 : ((h1 > h2) ? 1 : 0);
+}
+
+static void
+const_entries_destroy(void *val)
+{
+    struct const_entry *entry = val;
+    while (entry) {
+        struct const_entry *next = entry->next;
+        purc_variant_unref(entry->args);
+        purc_variant_unref(entry->value);
+        free(entry);
+        entry = next;
+    }
+}
+
+static purc_variant_t
+find_const_value(struct pcvcm_ev *vcm_ev, uint64_t hash, purc_variant_t args)
+{
+    if (vcm_ev->const_values == NULL)
+        return PURC_VARIANT_INVALID;
+
+    pcutils_map_entry *me = pcutils_map_find(vcm_ev->const_values, &hash);
+    if (me == NULL)
+        return PURC_VARIANT_INVALID;
+
+    for (struct const_entry *entry = me->val; entry; entry = entry->next) {
+        if (purc_variant_is_equal_to(entry->args, args))
+            return entry->value;
+    }
+
+    return PURC_VARIANT_INVALID;
+}
+
+static void
+add_const_value(struct pcvcm_ev *vcm_ev, uint64_t hash, purc_variant_t args,
+        purc_variant_t value)
+{
+    if (vcm_ev->const_values == NULL) {
+        vcm_ev->const_values = pcutils_map_create(NULL, NULL, NULL,
+                const_entries_destroy, comp_const_hash, false);
+        if (vcm_ev->const_values == NULL)
+            return;
+    }
+
+    struct const_entry *entry = calloc(1, sizeof(*entry));
+    if (entry == NULL)
+        return;
+
+    /* the arguments may be changed by the caller after the call */
+    entry->args = purc_variant_container_clone_recursively(args);
+    if (entry->args == PURC_VARIANT_INVALID) {
+        free(entry);
+        return;
+    }
+    entry->hash = hash;
+    entry->value = purc_variant_ref(value);
+
+    pcutils_map_entry *me = pcutils_map_find(vcm_ev->const_values, &hash);
+    if (me) {
+        /* the key points to the hash of the first entry */
+        struct const_entry *first = me->val;
+        entry->next = first->next;
+        first->next = entry;
+    }
+    else if (pcutils_map_insert(vcm_ev->const_values, &entry->hash, entry)) {
+        const_entries_destroy(entry);
+    }
+}
+
 static purc_variant_t
 eval_const_getter(void *native_entity, size_t nr_args, purc_variant_t *argv,
         unsigned call_flags)
@@ -174,34 +350,52 @@ eval_const_getter(void *native_entity, size_t nr_args, purc_variant_t *argv,
 
     purc_variant_t key = PURC_VARIANT_INVALID;
     purc_variant_t args = PURC_VARIANT_INVALID;
+    uint64_t hash = CONST_HASH_FNV_OFFSET;
+    bool hashed = false;
     if (argv) {
         args = purc_variant_make_tuple(nr_args, argv);
         if (!args) {
             goto out;
         }
-        key = build_const_key(stack, args);
+
+        hashed = hash_variant(args, &hash, 0);
+        if (hashed) {
+            ret = find_const_value(vcm_ev, hash, args);
+            if (ret) {
+                purc_variant_ref(ret);
+                goto out;
+            }
+        }
+        else {
+            key = build_const_key(args);
+        }
     }
     else {
         key = purc_variant_make_string_static(PCVCM_EV_WITHOUT_ARGS, false);
     }
 
-    if (!key) {
-        goto out;
-    }
+    if (!hashed) {
+        if (!key) {
+            goto out;
+        }
 
-    ret = purc_variant_object_get(vcm_ev->values, key);
-    if (ret) {
-        purc_variant_ref(ret);
-        goto out;
-    }
+        ret = purc_variant_object_get(vcm_ev->values, key);
+        if (ret) {
+            purc_variant_ref(ret);
+            goto out;
+        }
 
-    /* clear not found */
-    purc_clr_error();
+        /* clear not found */
+        purc_clr_error();
+    }
 
     ret = pcvcm_eval_sub_expr(vcm_ev->vcm, stack, args,
             (call_flags & PCVRT_CALL_FLAG_SILENTLY));
     if (ret) {
-        purc_variant_object_set(vcm_ev->values, key, ret);
+        if (hashed)
+            add_const_value(vcm_ev, hash, args, ret);
+        else
+            purc_variant_object_set(vcm_ev->values, key, ret);
     }
 
 out:
@@ -363,6 +557,9 @@ on_release(void *native_entity)
         free(vcm_variant->const_method_name);
     }
     purc_variant_unref(vcm_variant->values);
+    if (vcm_variant->const_values) {
+        pcutils_map_destroy(vcm_variant->const_values);
+    }
     if (vcm_variant->last_value) {
         purc_variant_unref(vcm_variant->last_value);
     }
@@ -26,6 +26,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <errno.h>
+#include <stdatomic.h>
 
 #include "config.h"
 #include "purc-utils.h"
@@ -76,6 +77,8 @@ pcvcm_node_typename(enum pcvcm_node_type type)
     return typenames[type];
 }
 
+static atomic_uint_fast64_t _node_serial;
+
 static struct pcvcm_node *
 pcvcm_node_new(enum pcvcm_node_type type, bool closed)
 {
@@ -86,6 +89,7 @@ pcvcm_node_new(enum pcvcm_node_type type, bool closed)
         return NULL;
     }
     node->type = type;
+    node->serial = atomic_fetch_add(&_node_serial, 1) + 1;
     node->is_closed = closed;
     node->idx = -1;
     node->nr_nodes = -1;
@@ -511,6 +515,76 @@ void pcvcm_node_destroy(struct pcvcm_node *root)
     }
 }
 
+static bool
+is_literal_container(struct pcvcm_node *node)
+{
+    switch (node->type) {
+    case PCVCM_NODE_TYPE_OBJECT:
+    case PCVCM_NODE_TYPE_ARRAY:
+    case PCVCM_NODE_TYPE_TUPLE:
+        return node->is_closed;
+
+    default:
+        return false;
+    }
+}
+
+static bool
+is_literal_leaf(struct pcvcm_node *node)
+{
+    switch (node->type) {
+    case PCVCM_NODE_TYPE_UNDEFINED:
+    case PCVCM_NODE_TYPE_NULL:
+    case PCVCM_NODE_TYPE_BOOLEAN:
+    case PCVCM_NODE_TYPE_NUMBER:
+    case PCVCM_NODE_TYPE_LONG_INT:
+    case PCVCM_NODE_TYPE_ULONG_INT:
+    case PCVCM_NODE_TYPE_LONG_DOUBLE:
+    case PCVCM_NODE_TYPE_STRING:
+    case PCVCM_NODE_TYPE_BYTE_SEQUENCE:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+/* returns true if the subtree is made only of literals */
+static bool
+mark_const(struct pcvcm_node *node)
+{
+    struct pcvcm_node *child = pcvcm_node_first_child(node);
+    if (!child) {
+        /* an empty container is cheaper to make than to copy */
+        return is_literal_leaf(node) || is_literal_container(node);
+    }
+
+    bool literal = is_literal_container(node);
+    while (child) {
+        if (!mark_const(child)) {
+            literal = false;
+        }
+        child = (struct pcvcm_node *)pctree_node_next(&child->tree_node);
+    }
+
+    if (literal) {
+        child = pcvcm_node_first_child(node);
+        while (child) {
+            child->extra &= ~EXTRA_CONST_FLAG;
+            child = (struct pcvcm_node *)pctree_node_next(&child->tree_node);
+        }
+        node->extra |= EXTRA_CONST_FLAG;
+    }
+    return literal;
+}
+
+void pcvcm_node_mark_const(struct pcvcm_node *root)
+{
+    if (root) {
+        mark_const(root);
+    }
+}
+
 static inline bool
 is_digit(char c)
 {
@@ -518,7 +592,7 @@ is_digit(char c)
 }
 
 static purc_variant_t
-find_stack_var(void *ctxt, const char *name)
+find_stack_var_at(void *ctxt, const char *name, struct pcintr_var_site *site)
 {
     struct pcintr_stack *stack = (struct pcintr_stack*)ctxt;
     size_t nr_name = strlen(name);
@@ -547,7 +621,75 @@ find_stack_var(void *ctxt, const char *name)
         return var;
     }
 
-    return pcintr_find_named_var(ctxt, name);
+    return pcintr_find_named_var_at(ctxt, name, site);
+}
+
+static purc_variant_t
+find_stack_var(void *ctxt, const char *name)
+{
+    return find_stack_var_at(ctxt, name, NULL);
+}
+
+static int comp_var_site_node(const void *key1, const void *key2)
+{
+    if ((uintptr_t)key1 < (uintptr_t)key2)
+        return -1;
+    return (key1 == key2) ? 0 : 1;
+}
+
+static void free_var_site(void *val)
+{
+    free(val);
+}
+
+/* returns the resolution cached for a `getVariable` node in a stack */
+static struct pcintr_var_site *
+get_var_site(struct pcintr_stack *stack, struct pcvcm_node *node)
+{
+    if (!stack->vcm_var_sites) {
+        stack->vcm_var_sites = pcutils_map_create(NULL, NULL, NULL,
+                free_var_site, comp_var_site_node, false);
+        if (!stack->vcm_var_sites) {
+            return NULL;
+        }
+    }
+
+    const void *key = (const void *)(uintptr_t)node->serial;
+    pcutils_map_entry *me = pcutils_map_find(stack->vcm_var_sites, key);
+    if (me) {
+        return (struct pcintr_var_site *)me->val;
+    }
+
+    /* the nodes of the evaluated trees which have been freed are
+       forgotten at once when there are too many */
+    if (pcutils_map_get_size(stack->vcm_var_sites) >= PCVCM_MAX_CACHED_NODES) {
+        pcutils_map_clear(stack->vcm_var_sites);
+    }
+
+    struct pcintr_var_site *site = calloc(1, sizeof(*site));
+    if (!site) {
+        return NULL;
+    }
+
+    if (pcutils_map_insert(stack->vcm_var_sites, key, site)) {
+        free_var_site(site);
+        return NULL;
+    }
+
+    return site;
+}
+
+purc_variant_t
+pcvcm_eval_find_var(struct pcvcm_eval_ctxt *ctxt, struct pcvcm_node *node,
+        const char *name)
+{
+    if (ctxt->find_var != find_stack_var)
+        return ctxt->find_var(ctxt->find_var_ctxt, name);
+
+    /* the vDOM is shared by the coroutines of all runners, so the
+       resolution is cached by the stack evaluating the node */
+    struct pcintr_var_site *site = get_var_site(ctxt->find_var_ctxt, node);
+    return find_stack_var_at(ctxt->find_var_ctxt, name, site);
 }
 
 purc_variant_t
@@ -176,14 +176,13 @@ void NetworkDataTaskLsql::dispatchDidCompleteWithError(const ResourceError& erro
 
 void NetworkDataTaskLsql::dispatchDidReceiveResponse()
 {
-    if (m_database.isOpen())
-        m_database.close();
     m_networkLoadMetrics.responseStart = MonotonicTime::now() - m_startTime;
     m_response.setURL(m_currentRequest.url());
     const char* contentType = "application/json";
     m_response.setMimeType(extractMIMETypeFromMediaType(contentType));
     m_response.setTextEncodingName(extractCharsetFromMediaType(contentType));
-    m_response.setExpectedContentLength(m_responseBuffer.size());
+    // the rows are streamed, so the length is unknown here
+    m_response.setExpectedContentLength(0);
     m_response.setHTTPHeaderField(HTTPHeaderName::AccessControlAllowOrigin, "*");
     m_response.setHTTPHeaderField(HTTPHeaderName::Expires, "-1");
     m_response.setHTTPHeaderField(HTTPHeaderName::CacheControl, "no-cache");
@@ -194,13 +193,15 @@ void NetworkDataTaskLsql::dispatchDidReceiveResponse()
 
     didReceiveResponse(ResourceResponse(m_response), NegotiatedLegacyTLS::No, [this, protectedThis = makeRef(*this)](PolicyAction policyAction) {
         if (m_state == State::Canceling || m_state == State::Completed) {
+            if (m_database.isOpen())
+                m_database.close();
             return;
         }
 
         switch (policyAction) {
         case PolicyAction::Use:
             {
-                m_client->didReceiveData(SharedBuffer::create(WTFMove(m_responseBuffer)));
+                runSqlStatements();
                 dispatchDidCompleteWithError({ });
             }
             break;
@@ -208,6 +209,8 @@ void NetworkDataTaskLsql::dispatchDidReceiveResponse()
         case PolicyAction::Ignore:
         case PolicyAction::Download:
         case PolicyAction::StopAllLoads:
+            if (m_database.isOpen())
+                m_database.close();
             break;
         }
     });
@@ -222,7 +225,6 @@ void NetworkDataTaskLsql::createRequest(PurCFetcher::ResourceRequest&& request)
 void NetworkDataTaskLsql::sendRequest()
 {
     runCmdInner();
-    buildResponse();
     dispatchDidReceiveResponse();
 }
 
@@ -267,30 +269,54 @@ void NetworkDataTaskLsql::runCmdInner()
     m_database.disableThreadingChecks();
 
     m_statusCode = 200;
-#if 1
+
+    // the statements are executed after the response has been accepted,
+    // count the ones yielding a result to decide the shape of the response
     int size = m_sqlVec.size();
     for (int i = 0; i < size; i++)
     {
         String& sql = m_sqlVec[i];
-        if (sql.startsWithIgnoringASCIICase(SELECT))
-        {
-            runSqlSelect(sql);
-        }
-        else if (sql.startsWithIgnoringASCIICase(INSERT))
+        if (sql.startsWithIgnoringASCIICase(SELECT)
+                || sql.startsWithIgnoringASCIICase(INSERT)
+                || sql.startsWithIgnoringASCIICase(UPDATE)
+                || sql.startsWithIgnoringASCIICase(DELETE))
         {
-            runSqlInsert(sql);
+            m_nrResults++;
         }
-        else if (sql.startsWithIgnoringASCIICase(UPDATE))
-        {
-            runSqlUpdate(sql);
-        }
-        else if (sql.startsWithIgnoringASCIICase(DELETE))
+    }
+}
+
+void NetworkDataTaskLsql::runSqlStatements()
+{
+    beginResponse();
+
+    if (m_database.isOpen())
+    {
+        int size = m_sqlVec.size();
+        for (int i = 0; i < size; i++)
         {
-            runSqlDelete(sql);
+            String& sql = m_sqlVec[i];
+            if (sql.startsWithIgnoringASCIICase(SELECT))
+            {
+                runSqlSelect(sql);
+            }
+            else if (sql.startsWithIgnoringASCIICase(INSERT))
+            {
+                runSqlInsert(sql);
+            }
+            else if (sql.startsWithIgnoringASCIICase(UPDATE))
+            {
+                runSqlUpdate(sql);
+            }
+            else if (sql.startsWithIgnoringASCIICase(DELETE))
+            {
+                runSqlDelete(sql);
+            }
         }
+        m_database.close();
     }
-#endif
 
+    endResponse();
 }
 
 void NetworkDataTaskLsql::runSqlSelect(String sql)
@@ -299,18 +325,22 @@ void NetworkDataTaskLsql::runSqlSelect(String sql)
         return;
 
     SqlResult sr;
+    beginResult();
     SQLiteStatement statement(m_database, sql);
     if (statement.prepare() != SQLITE_OK) {
         sr.statusCode = 500;
         sr.errorMsg = "Failed to prepare : " + sql;
+        sr.rowsAffected = 0;
 #if 0
         printf("Failed to prepare statement.\n");
 #endif
-        m_sqlResults.append(sr);
+        endResult(sr);
         return;
     }
 
     sr.statusCode = 200;
+    sr.rowsAffected = 0;
+    m_sqlResultColumnNames.clear();
 
     int result;
     while ((result = statement.step()) == SQLITE_ROW) {
@@ -326,17 +356,17 @@ void NetworkDataTaskLsql::runSqlSelect(String sql)
 
             columns.append(statement.getColumnValueH(i));
         }
-        sr.rowsVec.append(columns);
+        appendRow(columns);
+        sr.rowsAffected++;
 
         if (m_state == State::Canceling)
         {
             sr.statusCode = 503;
             sr.errorMsg = "Canceling";
-            m_sqlResults.append(sr);
+            endResult(sr);
             return;
         }
     }
-    sr.rowsAffected = sr.rowsVec.size();
 
     if (result != SQLITE_DONE)
     {
@@ -346,7 +376,7 @@ void NetworkDataTaskLsql::runSqlSelect(String sql)
         printf("Failed to read in all origins from the database.\n");
 #endif
     }
-    m_sqlResults.append(sr);
+    endResult(sr);
 }
 
 void NetworkDataTaskLsql::runSqlInsert(String sql)
@@ -355,21 +385,23 @@ void NetworkDataTaskLsql::runSqlInsert(String sql)
         return;
 
     SqlResult sr;
+    beginResult();
     SQLiteStatement statement(m_database, sql);
     if (statement.prepare() != SQLITE_OK
             || statement.step() != SQLITE_DONE) {
         sr.statusCode = 500;
         sr.errorMsg = "Failed to prepare : " + sql;
+        sr.rowsAffected = 0;
 #if 0
         printf("Failed to prepare statement.\n");
 #endif
-        m_sqlResults.append(sr);
+        endResult(sr);
         return;
     }
 
     sr.statusCode = 200;
     sr.rowsAffected = m_database.lastChanges();
-    m_sqlResults.append(sr);
+    endResult(sr);
 }
 
 void NetworkDataTaskLsql::runSqlUpdate(String sql)
@@ -378,21 +410,23 @@ void NetworkDataTaskLsql::runSqlUpdate(String sql)
         return;
 
     SqlResult sr;
+    beginResult();
     SQLiteStatement statement(m_database, sql);
     if (statement.prepare() != SQLITE_OK
             || statement.step() != SQLITE_DONE) {
         sr.statusCode = 500;
         sr.errorMsg = "Failed to prepare : " + sql;
+        sr.rowsAffected = 0;
 #if 0
         printf("Failed to prepare statement.\n");
 #endif
-        m_sqlResults.append(sr);
+        endResult(sr);
         return;
     }
 
     sr.statusCode = 200;
     sr.rowsAffected = m_database.lastChanges();
-    m_sqlResults.append(sr);
+    endResult(sr);
 }
 
 void NetworkDataTaskLsql::runSqlDelete(String sql)
@@ -401,112 +435,140 @@ void NetworkDataTaskLsql::runSqlDelete(String sql)
         return;
 
     SqlResult sr;
+    beginResult();
     SQLiteStatement statement(m_database, sql);
     if (statement.prepare() != SQLITE_OK
             || statement.step() != SQLITE_DONE) {
         sr.statusCode = 500;
         sr.errorMsg = "Failed to prepare : " + sql;
+        sr.rowsAffected = 0;
 #if 0
         printf("Failed to prepare statement.\n");
 #endif
-        m_sqlResults.append(sr);
+        endResult(sr);
         return;
     }
 
     sr.statusCode = 200;
     sr.rowsAffected = m_database.lastChanges();
-    m_sqlResults.append(sr);
+    endResult(sr);
 }
 
-void NetworkDataTaskLsql::buildResponse()
+/*
+ * The response is sent in chunks of about DEFAULT_READBUFFER_SIZE bytes
+ * while the rows are read from the database. The document is still one
+ * JSON object, but every row is written on its own line, so the receiver
+ * can decode the rows before the whole document arrives:
+ *
+ *  {"rows":[
+ *  {"id":1,"name":"foo"},
+ *  {"id":2,"name":"bar"}
+ *  ],"statusCode":200,"errorMsg":null,"rowsAffected":2}
+ *
+ * For more than one statement, the results are wrapped in an array
+ * keyed by `result`, one result object per statement.
+ */
+void NetworkDataTaskLsql::beginResponse()
 {
-    auto result = JSON::Object::create();
+    m_responseBuffer.clear();
+    m_responseBuffer.reserveCapacity(DEFAULT_READBUFFER_SIZE);
+    m_nrSentResults = 0;
 
-    int resultSize = m_sqlResults.size();
-    switch (resultSize)
+    if (m_nrResults > 1)
     {
-    case 0:
-        {
-            result->setInteger(KEY_STATUS_CODE, m_statusCode);
+        StringBuilder sb;
+        sb.append("{\"", KEY_STATUS_CODE, "\":200,\"", KEY_RESULT, "\":[\n");
+        appendToResponseBuffer(sb.toString());
+    }
+}
 
-            if (m_errorMsg.isEmpty())
-                result->setValue(KEY_ERROR_MSG, JSON::Value::null());
-            else
-                result->setString(KEY_ERROR_MSG, m_errorMsg);
+void NetworkDataTaskLsql::endResponse()
+{
+    if (m_nrResults == 0 || m_nrSentResults == 0)
+    {
+        // no statement was executed (the database may be unavailable)
+        auto result = JSON::Object::create();
+        result->setInteger(KEY_STATUS_CODE, m_statusCode);
 
-            result->setInteger(KEY_ROWSAFFECTED, m_readLines.size());
-            auto array = JSON::Array::create();
-            result->setArray(KEY_ROWS, WTFMove(array));
-        }
-        break;
+        if (m_errorMsg.isEmpty())
+            result->setValue(KEY_ERROR_MSG, JSON::Value::null());
+        else
+            result->setString(KEY_ERROR_MSG, m_errorMsg);
 
-    case 1:
-        {
-            SqlResult& sqlResult = m_sqlResults[0];
-            result->setInteger(KEY_STATUS_CODE, sqlResult.statusCode);
-            if (sqlResult.errorMsg.isEmpty())
-                result->setValue(KEY_ERROR_MSG, JSON::Value::null());
-            else
-                result->setString(KEY_ERROR_MSG, sqlResult.errorMsg);
-            result->setInteger(KEY_ROWSAFFECTED, sqlResult.rowsAffected);
-
-            int rowSize = sqlResult.rowsVec.size();
-            auto array = JSON::Array::create();
-            for (int i = 0; i < rowSize; i++)
-            {
-                if (m_formatArray)
-                {
-                    array->pushValue(formatAsArray(sqlResult.rowsVec[i]));
-                }
-                else
-                {
-                    array->pushValue(formatAsDict(sqlResult.rowsVec[i]));
-                }
-            }
-            result->setArray(KEY_ROWS, WTFMove(array));
-        }
-        break;
+        result->setInteger(KEY_ROWSAFFECTED, m_readLines.size());
+        auto array = JSON::Array::create();
+        result->setArray(KEY_ROWS, WTFMove(array));
 
-    default:
-        {
-            result->setInteger(KEY_STATUS_CODE, 200);
-            auto resultArray = JSON::Array::create();
-            for (int j = 0; j < resultSize; j++)
-            {
-                SqlResult& sqlResult = m_sqlResults[j];
-                auto res = JSON::Object::create();
+        m_responseBuffer.clear();
+        appendToResponseBuffer(result->toJSONString());
+    }
+    else if (m_nrResults > 1)
+    {
+        appendToResponseBuffer("\n]}");
+    }
 
-                if (sqlResult.errorMsg.isEmpty())
-                    res->setValue(KEY_ERROR_MSG, JSON::Value::null());
-                else
-                    res->setString(KEY_ERROR_MSG, sqlResult.errorMsg);
-                res->setInteger(KEY_ROWSAFFECTED, sqlResult.rowsAffected);
+    flushResponseBuffer(true);
+}
 
-                int rowSize = sqlResult.rowsVec.size();
-                auto array = JSON::Array::create();
-                for (int i = 0; i < rowSize; i++)
-                {
-                    if (m_formatArray)
-                    {
-                        array->pushValue(formatAsArray(sqlResult.rowsVec[i]));
-                    }
-                    else
-                    {
-                        array->pushValue(formatAsDict(sqlResult.rowsVec[i]));
-                    }
-                }
-                res->setArray(KEY_ROWS, WTFMove(array));
-                resultArray->pushObject(WTFMove(res));
-            }
-            result->setArray(KEY_RESULT, WTFMove(resultArray));
-        }
-        break;
-    }
+void NetworkDataTaskLsql::beginResult()
+{
+    StringBuilder sb;
+    if (m_nrResults > 1 && m_nrSentResults > 0)
+        sb.append(",\n");
+    sb.append("{\"", KEY_ROWS, "\":[\n");
+    appendToResponseBuffer(sb.toString());
+    m_firstRow = true;
+}
 
-    String json = result->toJSONString();
+void NetworkDataTaskLsql::appendRow(Vector<SQLValueH>& lineColumns)
+{
+    if (!m_firstRow)
+        appendToResponseBuffer(",\n");
+    m_firstRow = false;
 
-    m_responseBuffer.clear();
-    m_responseBuffer.append(json.characters8(), json.length());
+    if (m_formatArray)
+        appendToResponseBuffer(formatAsArray(lineColumns)->toJSONString());
+    else
+        appendToResponseBuffer(formatAsDict(lineColumns)->toJSONString());
+
+    flushResponseBuffer(false);
+}
+
+void NetworkDataTaskLsql::endResult(SqlResult& sqlResult)
+{
+    auto res = JSON::Object::create();
+    if (m_nrResults <= 1)
+        res->setInteger(KEY_STATUS_CODE, sqlResult.statusCode);
+    if (sqlResult.errorMsg.isEmpty())
+        res->setValue(KEY_ERROR_MSG, JSON::Value::null());
+    else
+        res->setString(KEY_ERROR_MSG, sqlResult.errorMsg);
+    res->setInteger(KEY_ROWSAFFECTED, sqlResult.rowsAffected);
+
+    // append the members after the rows: skip the leading brace
+    String json = res->toJSONString();
+    appendToResponseBuffer("\n],");
+    appendToResponseBuffer(json.substring(1));
+    m_nrSentResults++;
+}
+
+void NetworkDataTaskLsql::appendToResponseBuffer(const String& str)
+{
+    CString utf8 = str.utf8();
+    m_responseBuffer.append(utf8.data(), utf8.length());
+}
+
+void NetworkDataTaskLsql::flushResponseBuffer(bool force)
+{
+    if (m_responseBuffer.isEmpty())
+        return;
+
+    if (!force && m_responseBuffer.size() < DEFAULT_READBUFFER_SIZE)
+        return;
+
+    m_client->didReceiveData(SharedBuffer::create(WTFMove(m_responseBuffer)));
+    m_responseBuffer = Vector<char>();
+    m_responseBuffer.reserveCapacity(DEFAULT_READBUFFER_SIZE);
 }
 
 Ref<JSON::Value> NetworkDataTaskLsql::formatAsArray(Vector<SQLValueH>& lineColumns)
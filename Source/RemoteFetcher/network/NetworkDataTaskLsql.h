@@ -69,7 +69,6 @@ public:
     int statusCode;
     String errorMsg;
     int rowsAffected;
-    Vector<Vector<SQLValueH>> rowsVec;
 };
 
 class NetworkDataTaskLsql final : public NetworkDataTask {
@@ -98,13 +97,20 @@ private:
     void sendRequest();
 
     void runCmdInner();
+    void runSqlStatements();
 
     void runSqlSelect(String sql);
     void runSqlInsert(String sql);
     void runSqlUpdate(String sql);
     void runSqlDelete(String sql);
 
-    void buildResponse();
+    void beginResponse();
+    void endResponse();
+    void beginResult();
+    void appendRow(Vector<SQLValueH>& lineColumns);
+    void endResult(SqlResult& sqlResult);
+    void appendToResponseBuffer(const String& str);
+    void flushResponseBuffer(bool force);
 
     void parseQueryString(String query);
     void parseSqlQuery(String sqlQuery);
@@ -131,7 +137,9 @@ private:
     PurCFetcher::SQLiteDatabase m_database;
     Vector<String> m_sqlVec;
     Vector<String> m_sqlResultColumnNames;
-    Vector<SqlResult> m_sqlResults;
+    int m_nrResults { 0 };
+    int m_nrSentResults { 0 };
+    bool m_firstRow { true };
 
     bool m_formatArray;
     String m_sqlQuery;
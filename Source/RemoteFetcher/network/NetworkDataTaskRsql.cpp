@@ -180,7 +180,8 @@ void NetworkDataTaskRsql::dispatchDidReceiveResponse()
     const char* contentType = "application/json";
     m_response.setMimeType(extractMIMETypeFromMediaType(contentType));
     m_response.setTextEncodingName(extractCharsetFromMediaType(contentType));
-    m_response.setExpectedContentLength(m_responseBuffer.size());
+    // the rows are streamed, so the length is unknown here
+    m_response.setExpectedContentLength(0);
     m_response.setHTTPHeaderField(HTTPHeaderName::AccessControlAllowOrigin, "*");
     m_response.setHTTPHeaderField(HTTPHeaderName::Expires, "-1");
     m_response.setHTTPHeaderField(HTTPHeaderName::CacheControl, "no-cache");
@@ -189,13 +190,17 @@ void NetworkDataTaskRsql::dispatchDidReceiveResponse()
 
     didReceiveResponse(ResourceResponse(m_response), NegotiatedLegacyTLS::No, [this, protectedThis = makeRef(*this)](PolicyAction policyAction) {
         if (m_state == State::Canceling || m_state == State::Completed) {
+            if (m_connected) {
+                mysql_close(&m_mysql);
+                m_connected = false;
+            }
             return;
         }
 
         switch (policyAction) {
         case PolicyAction::Use:
             {
-                m_client->didReceiveData(SharedBuffer::create(WTFMove(m_responseBuffer)));
+                runSqlStatements();
                 dispatchDidCompleteWithError({ });
             }
             break;
@@ -203,6 +208,10 @@ void NetworkDataTaskRsql::dispatchDidReceiveResponse()
         case PolicyAction::Ignore:
         case PolicyAction::Download:
         case PolicyAction::StopAllLoads:
+            if (m_connected) {
+                mysql_close(&m_mysql);
+                m_connected = false;
+            }
             break;
         }
     });
@@ -217,7 +226,6 @@ void NetworkDataTaskRsql::createRequest(PurCFetcher::ResourceRequest&& request)
 void NetworkDataTaskRsql::sendRequest()
 {
     runCmdInner();
-    buildResponse();
     dispatchDidReceiveResponse();
 }
 
@@ -280,31 +288,61 @@ void NetworkDataTaskRsql::runCmdInner()
         sb.append(mysql_error(&m_mysql));
         m_errorMsg = sb.toString();
 //        printf("Failed to connect to database: %s\n", m_errorMsg.characters8());
+        mysql_close(&m_mysql);
         return;
     }
+    m_connected = true;
 
     m_statusCode = 200;
+
+    // the statements are executed after the response has been accepted,
+    // count the ones yielding a result to decide the shape of the response
     int size = m_sqlVec.size();
     for (int i = 0; i < size; i++)
     {
         String& sql = m_sqlVec[i];
-        if (sql.startsWithIgnoringASCIICase(SELECT))
-        {
-            runSqlSelect(sql);
-        }
-        else if (sql.startsWithIgnoringASCIICase(INSERT))
+        if (sql.startsWithIgnoringASCIICase(SELECT)
+                || sql.startsWithIgnoringASCIICase(INSERT)
+                || sql.startsWithIgnoringASCIICase(UPDATE)
+                || sql.startsWithIgnoringASCIICase(DELETE))
         {
-            runSqlInsert(sql);
+            m_nrResults++;
         }
-        else if (sql.startsWithIgnoringASCIICase(UPDATE))
-        {
-            runSqlUpdate(sql);
-        }
-        else if (sql.startsWithIgnoringASCIICase(DELETE))
+    }
+}
+
+void NetworkDataTaskRsql::runSqlStatements()
+{
+    beginResponse();
+
+    if (m_connected)
+    {
+        int size = m_sqlVec.size();
+        for (int i = 0; i < size; i++)
         {
-            runSqlDelete(sql);
+            String& sql = m_sqlVec[i];
+            if (sql.startsWithIgnoringASCIICase(SELECT))
+            {
+                runSqlSelect(sql);
+            }
+            else if (sql.startsWithIgnoringASCIICase(INSERT))
+            {
+                runSqlInsert(sql);
+            }
+            else if (sql.startsWithIgnoringASCIICase(UPDATE))
+            {
+                runSqlUpdate(sql);
+            }
+            else if (sql.startsWithIgnoringASCIICase(DELETE))
+            {
+                runSqlDelete(sql);
+            }
         }
+        mysql_close(&m_mysql);
+        m_connected = false;
     }
+
+    endResponse();
 }
 
 void NetworkDataTaskRsql::runSqlSelect(String sql)
@@ -313,6 +351,7 @@ void NetworkDataTaskRsql::runSqlSelect(String sql)
         return;
 
     SqlResult sr;
+    beginResult();
     CString cmd = sql.utf8();
     if (mysql_real_query(&m_mysql, cmd.data(), cmd.length()))
     {
@@ -324,19 +363,24 @@ void NetworkDataTaskRsql::runSqlSelect(String sql)
 
         sr.statusCode = 500;
         sr.errorMsg = sb.toString();
-        m_sqlResults.append(sr);
+        sr.rowsAffected = 0;
+        endResult(sr);
         return;
     }
 
-    MYSQL_RES* res = mysql_store_result(&m_mysql);
+    // fetch the rows one by one instead of buffering the whole result set
+    MYSQL_RES* res = mysql_use_result(&m_mysql);
     if (!res) {
         sr.statusCode = 500;
         sr.errorMsg = "Failed to get result : " + sql;
-        m_sqlResults.append(sr);
+        sr.rowsAffected = 0;
+        endResult(sr);
         return;
     }
 
     sr.statusCode = 200;
+    sr.rowsAffected = 0;
+    m_sqlResultColumnNames.clear();
 
     int num_fields = mysql_num_fields(res);
     MYSQL_FIELD* fields = mysql_fetch_fields(res);
@@ -375,20 +419,25 @@ void NetworkDataTaskRsql::runSqlSelect(String sql)
                     break;
             }
         }
-        sr.rowsVec.append(columns);
+        appendRow(columns);
+        sr.rowsAffected++;
 
         if (m_state == State::Canceling)
         {
             sr.statusCode = 503;
             sr.errorMsg = "Canceling";
-            m_sqlResults.append(sr);
             break;
         }
     }
+
+    if (sr.statusCode == 200 && mysql_errno(&m_mysql))
+    {
+        sr.statusCode = 503;
+        sr.errorMsg = mysql_error(&m_mysql);
+    }
     mysql_free_result(res);
 
-    sr.rowsAffected = sr.rowsVec.size();
-    m_sqlResults.append(sr);
+    endResult(sr);
 }
 
 void NetworkDataTaskRsql::runSqlInsert(String sql)
@@ -397,6 +446,7 @@ void NetworkDataTaskRsql::runSqlInsert(String sql)
         return;
 
     SqlResult sr;
+    beginResult();
     CString cmd = sql.utf8();
     if (mysql_real_query(&m_mysql, cmd.data(), cmd.length()))
     {
@@ -408,13 +458,14 @@ void NetworkDataTaskRsql::runSqlInsert(String sql)
 
         sr.statusCode = 500;
         sr.errorMsg = sb.toString();
-        m_sqlResults.append(sr);
+        sr.rowsAffected = 0;
+        endResult(sr);
         return;
     }
 
     sr.statusCode = 200;
     sr.rowsAffected = mysql_affected_rows(&m_mysql);
-    m_sqlResults.append(sr);
+    endResult(sr);
 }
 
 void NetworkDataTaskRsql::runSqlUpdate(String sql)
@@ -427,95 +478,111 @@ void NetworkDataTaskRsql::runSqlDelete(String sql)
     runSqlInsert(sql);
 }
 
-void NetworkDataTaskRsql::buildResponse()
+/*
+ * The response is streamed in the same row-per-line layout as the one
+ * of NetworkDataTaskLsql; see the comment there.
+ */
+void NetworkDataTaskRsql::beginResponse()
 {
-    auto result = JSON::Object::create();
+    m_responseBuffer.clear();
+    m_responseBuffer.reserveCapacity(DEFAULT_READBUFFER_SIZE);
+    m_nrSentResults = 0;
 
-    int resultSize = m_sqlResults.size();
-    switch (resultSize)
+    if (m_nrResults > 1)
     {
-    case 0:
-        {
-            result->setInteger(KEY_STATUS_CODE, m_statusCode);
+        StringBuilder sb;
+        sb.append("{\"", KEY_STATUS_CODE, "\":200,\"", KEY_RESULT, "\":[\n");
+        appendToResponseBuffer(sb.toString());
+    }
+}
 
-            if (m_errorMsg.isEmpty())
-                result->setValue(KEY_ERROR_MSG, JSON::Value::null());
-            else
-                result->setString(KEY_ERROR_MSG, m_errorMsg);
+void NetworkDataTaskRsql::endResponse()
+{
+    if (m_nrResults == 0 || m_nrSentResults == 0)
+    {
+        // no statement was executed (the database may be unavailable)
+        auto result = JSON::Object::create();
+        result->setInteger(KEY_STATUS_CODE, m_statusCode);
 
-            result->setInteger(KEY_ROWSAFFECTED, m_readLines.size());
-            auto array = JSON::Array::create();
-            result->setArray(KEY_ROWS, WTFMove(array));
-        }
-        break;
+        if (m_errorMsg.isEmpty())
+            result->setValue(KEY_ERROR_MSG, JSON::Value::null());
+        else
+            result->setString(KEY_ERROR_MSG, m_errorMsg);
 
-    case 1:
-        {
-            SqlResult& sqlResult = m_sqlResults[0];
-            result->setInteger(KEY_STATUS_CODE, sqlResult.statusCode);
-            if (sqlResult.errorMsg.isEmpty())
-                result->setValue(KEY_ERROR_MSG, JSON::Value::null());
-            else
-                result->setString(KEY_ERROR_MSG, sqlResult.errorMsg);
-            result->setInteger(KEY_ROWSAFFECTED, sqlResult.rowsAffected);
-
-            int rowSize = sqlResult.rowsVec.size();
-            auto array = JSON::Array::create();
-            for (int i = 0; i < rowSize; i++)
-            {
-                if (m_formatArray)
-                {
-                    array->pushValue(formatAsArray(sqlResult.rowsVec[i]));
-                }
-                else
-                {
-                    array->pushValue(formatAsDict(sqlResult.rowsVec[i]));
-                }
-            }
-            result->setArray(KEY_ROWS, WTFMove(array));
-        }
-        break;
+        result->setInteger(KEY_ROWSAFFECTED, m_readLines.size());
+        auto array = JSON::Array::create();
+        result->setArray(KEY_ROWS, WTFMove(array));
 
-    default:
-        {
-            result->setInteger(KEY_STATUS_CODE, 200);
-            auto resultArray = JSON::Array::create();
-            for (int j = 0; j < resultSize; j++)
-            {
-                SqlResult& sqlResult = m_sqlResults[j];
-                auto res = JSON::Object::create();
+        m_responseBuffer.clear();
+        appendToResponseBuffer(result->toJSONString());
+    }
+    else if (m_nrResults > 1)
+    {
+        appendToResponseBuffer("\n]}");
+    }
 
-                if (sqlResult.errorMsg.isEmpty())
-                    res->setValue(KEY_ERROR_MSG, JSON::Value::null());
-                else
-                    res->setString(KEY_ERROR_MSG, sqlResult.errorMsg);
-                res->setInteger(KEY_ROWSAFFECTED, sqlResult.rowsAffected);
+    flushResponseBuffer(true);
+}
 
-                int rowSize = sqlResult.rowsVec.size();
-                auto array = JSON::Array::create();
-                for (int i = 0; i < rowSize; i++)
-                {
-                    if (m_formatArray)
-                    {
-                        array->pushValue(formatAsArray(sqlResult.rowsVec[i]));
-                    }
-                    else
-                    {
-                        array->pushValue(formatAsDict(sqlResult.rowsVec[i]));
-                    }
-                }
-                res->setArray(KEY_ROWS, WTFMove(array));
-                resultArray->pushObject(WTFMove(res));
-            }
-            result->setArray(KEY_RESULT, WTFMove(resultArray));
-        }
-        break;
-    }
+void NetworkDataTaskRsql::beginResult()
+{
+    StringBuilder sb;
+    if (m_nrResults > 1 && m_nrSentResults > 0)
+        sb.append(",\n");
+    sb.append("{\"", KEY_ROWS, "\":[\n");
+    appendToResponseBuffer(sb.toString());
+    m_firstRow = true;
+}
 
-    String json = result->toJSONString();
+void NetworkDataTaskRsql::appendRow(Vector<SQLValueH>& lineColumns)
+{
+    if (!m_firstRow)
+        appendToResponseBuffer(",\n");
+    m_firstRow = false;
 
-    m_responseBuffer.clear();
-    m_responseBuffer.append(json.characters8(), json.length());
+    if (m_formatArray)
+        appendToResponseBuffer(formatAsArray(lineColumns)->toJSONString());
+    else
+        appendToResponseBuffer(formatAsDict(lineColumns)->toJSONString());
+
+    flushResponseBuffer(false);
+}
+
+void NetworkDataTaskRsql::endResult(SqlResult& sqlResult)
+{
+    auto res = JSON::Object::create();
+    if (m_nrResults <= 1)
+        res->setInteger(KEY_STATUS_CODE, sqlResult.statusCode);
+    if (sqlResult.errorMsg.isEmpty())
+        res->setValue(KEY_ERROR_MSG, JSON::Value::null());
+    else
+        res->setString(KEY_ERROR_MSG, sqlResult.errorMsg);
+    res->setInteger(KEY_ROWSAFFECTED, sqlResult.rowsAffected);
+
+    // append the members after the rows: skip the leading brace
+    String json = res->toJSONString();
+    appendToResponseBuffer("\n],");
+    appendToResponseBuffer(json.substring(1));
+    m_nrSentResults++;
+}
+
+void NetworkDataTaskRsql::appendToResponseBuffer(const String& str)
+{
+    CString utf8 = str.utf8();
+    m_responseBuffer.append(utf8.data(), utf8.length());
+}
+
+void NetworkDataTaskRsql::flushResponseBuffer(bool force)
+{
+    if (m_responseBuffer.isEmpty())
+        return;
+
+    if (!force && m_responseBuffer.size() < DEFAULT_READBUFFER_SIZE)
+        return;
+
+    m_client->didReceiveData(SharedBuffer::create(WTFMove(m_responseBuffer)));
+    m_responseBuffer = Vector<char>();
+    m_responseBuffer.reserveCapacity(DEFAULT_READBUFFER_SIZE);
 }
 
 Ref<JSON::Value> NetworkDataTaskRsql::formatAsArray(Vector<SQLValueH>& lineColumns)
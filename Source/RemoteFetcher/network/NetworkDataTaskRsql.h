@@ -93,13 +93,20 @@ private:
     void sendRequest();
 
     void runCmdInner();
+    void runSqlStatements();
 
     void runSqlSelect(String sql);
     void runSqlInsert(String sql);
     void runSqlUpdate(String sql);
     void runSqlDelete(String sql);
 
-    void buildResponse();
+    void beginResponse();
+    void endResponse();
+    void beginResult();
+    void appendRow(Vector<SQLValueH>& lineColumns);
+    void endResult(SqlResult& sqlResult);
+    void appendToResponseBuffer(const String& str);
+    void flushResponseBuffer(bool force);
 
     void parseQueryString(String query);
     void parseSqlQuery(String sqlQuery);
@@ -126,7 +133,10 @@ private:
     MYSQL m_mysql;
     Vector<String> m_sqlVec;
     Vector<String> m_sqlResultColumnNames;
-    Vector<SqlResult> m_sqlResults;
+    bool m_connected { false };
+    int m_nrResults { 0 };
+    int m_nrSentResults { 0 };
+    bool m_firstRow { true };
 
     bool m_formatArray;
     String m_sqlQuery;
@@ -34,6 +34,8 @@
 namespace PurCWTF {
 
 static RunLoop* s_mainRunLoop;
+static RunLoop::ContextGetter s_contextGetter;
+static RunLoop::ContextSetter s_contextSetter;
 #if USE(WEB_THREAD)
 static RunLoop* s_webRunLoop;
 #endif
@@ -164,14 +166,46 @@ void RunLoop::performWork()
 
 void RunLoop::dispatch(Function<void ()>&& function)
 {
+    Function<void()> bound = bindContext(currentContext(), WTFMove(function));
     {
         auto locker = holdLock(m_functionQueueLock);
-        m_functionQueue.append(WTFMove(function));
+        m_functionQueue.append(WTFMove(bound));
     }
 
     wakeUp();
 }
 
+void RunLoop::setContextHooks(ContextGetter getter, ContextSetter setter)
+{
+    s_contextGetter = getter;
+    s_contextSetter = setter;
+}
+
+void* RunLoop::currentContext()
+{
+    return s_contextGetter ? s_contextGetter(*this) : nullptr;
+}
+
+bool RunLoop::switchContext(void* context, void** old)
+{
+    *old = nullptr;
+    return s_contextSetter ? s_contextSetter(context, old) : true;
+}
+
+Function<void()> RunLoop::bindContext(void* context, Function<void()>&& function)
+{
+    if (!context)
+        return WTFMove(function);
+
+    return [context, function = WTFMove(function)] {
+        void* old;
+        if (!switchContext(context, &old))
+            return;
+        function();
+        switchContext(old, &old);
+    };
+}
+
 void RunLoop::suspendFunctionDispatchForCurrentCycle()
 {
     // Don't suspend if there are already suspended functions to avoid unexecuted function pile-up.
@@ -86,6 +86,20 @@ public:
 
     WTF_EXPORT_PRIVATE void suspendFunctionDispatchForCurrentCycle();
 
+    // The hooks to carry a context (e.g., the PurC instance hosted by
+    // a worker thread) from where a function is dispatched, a timer is
+    // created or a fd is monitored to where the callback is called.
+    // The getter returns the context of the calling thread for the target
+    // run loop or nullptr; the setter switches to a context and stores
+    // the old one to `old`. The setter returns false if the context is gone
+    // (e.g., the instance has been retired); the callback is then dropped.
+    typedef void* (*ContextGetter)(RunLoop& target);
+    typedef bool (*ContextSetter)(void* context, void** old);
+    WTF_EXPORT_PRIVATE static void setContextHooks(ContextGetter, ContextSetter);
+    WTF_EXPORT_PRIVATE void* currentContext();
+    WTF_EXPORT_PRIVATE static bool switchContext(void* context, void** old);
+    WTF_EXPORT_PRIVATE static Function<void()> bindContext(void* context, Function<void()>&&);
+
     enum class CycleResult { Continue, Stop };
     WTF_EXPORT_PRIVATE CycleResult static cycle(RunLoopMode = DefaultRunLoopMode);
 
@@ -159,6 +173,7 @@ public:
 #elif USE(GLIB_EVENT_LOOP)
         void updateReadyTime();
         GRefPtr<GSource> m_source;
+        void* m_context { nullptr };
         bool m_isRepeating { false };
         Seconds m_fireInterval { 0 };
 #elif USE(GENERIC_EVENT_LOOP)
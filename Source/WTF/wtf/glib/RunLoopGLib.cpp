@@ -109,6 +109,16 @@ uintptr_t RunLoop::addFdMonitor(gint fd, GIOCondition condition,
             Function<gboolean(gint, GIOCondition)>&& callback)
 {
     RefPtr<GFdMonitor> monitor = adoptRef(new GFdMonitor());
+    if (void* context = currentContext()) {
+        callback = [context, callback = WTFMove(callback)] (gint fd, GIOCondition condition) -> gboolean {
+            void* old;
+            if (!switchContext(context, &old))
+                return FALSE;
+            gboolean ret = callback(fd, condition);
+            switchContext(old, &old);
+            return ret;
+        };
+    }
     monitor->start(fd, condition, mainContext(), WTFMove(callback));
     m_fdMonitors.append(monitor);
     return (uintptr_t)monitor.get();
@@ -197,7 +207,7 @@ void RunLoop::dispatchAfter(Seconds duration, Function<void()>&& function)
     g_source_set_name(source.get(), "[PurCFetcher] RunLoop dispatchAfter");
     g_source_set_ready_time(source.get(), g_get_monotonic_time() + duration.microsecondsAs<gint64>());
 
-    std::unique_ptr<DispatchAfterContext> context = makeUnique<DispatchAfterContext>(WTFMove(function));
+    std::unique_ptr<DispatchAfterContext> context = makeUnique<DispatchAfterContext>(bindContext(currentContext(), WTFMove(function)));
     g_source_set_callback(source.get(), [](gpointer userData) -> gboolean {
         std::unique_ptr<DispatchAfterContext> context(static_cast<DispatchAfterContext*>(userData));
         context->dispatch();
@@ -209,6 +219,7 @@ void RunLoop::dispatchAfter(Seconds duration, Function<void()>&& function)
 RunLoop::TimerBase::TimerBase(RunLoop& runLoop)
     : m_runLoop(runLoop)
     , m_source(adoptGRef(g_source_new(&runLoopSourceFunctions, sizeof(GSource))))
+    , m_context(runLoop.currentContext())
 {
     g_source_set_priority(m_source.get(), RunLoopSourcePriority::RunLoopTimer);
     g_source_set_name(m_source.get(), "[PurCFetcher] RunLoop::Timer work");
@@ -218,7 +229,13 @@ RunLoop::TimerBase::TimerBase(RunLoop& runLoop)
         // before it is safe to dereference timer again.
         RunLoop::TimerBase* timer = static_cast<RunLoop::TimerBase*>(userData);
         GSource* source = timer->m_source.get();
+        void* context = timer->m_context;
+        void* old = nullptr;
+        if (context && !RunLoop::switchContext(context, &old))
+            return G_SOURCE_REMOVE;
         timer->fired();
+        if (context)
+            RunLoop::switchContext(old, &old);
         if (g_source_is_destroyed(source))
             return G_SOURCE_REMOVE;
         if (timer->m_isRepeating)
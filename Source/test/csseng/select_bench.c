@@ -0,0 +1,643 @@
+/*
+ * Benchmark of css_select_style() run by several threads at once.
+ *
+ * All threads share the same stylesheet and intern their strings into the
+ * same (global) wapcaplet table; every thread owns its selection context
+ * and its document tree.  The throughput of a single thread is compared
+ * with the one of all threads selecting at the same time.
+ *
+ * Usage: select_bench [<threads> [<iterations>]]
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "csseng.h"
+
+#include "utils/utils.h"
+
+#include "testutils.h"
+
+#define NR_DEF_THREADS          4
+#define NR_DEF_ITERATIONS       200
+#define NR_CHILDREN             8
+#define NR_DEPTH                4
+
+typedef struct node {
+	lwc_string *name;
+	lwc_string *id;
+	lwc_string *klass;
+
+	void *node_data;
+
+	struct node *parent;
+	struct node *next;
+	struct node *prev;
+	struct node *children;
+} node;
+
+static const char *bench_sheet =
+	"html { color: black; font-size: 12pt; }\n"
+	"body { margin: 8px; display: block; }\n"
+	"div { display: block; padding: 1px; }\n"
+	"div > p { margin-top: 1em; }\n"
+	"div p span { font-weight: bold; }\n"
+	"p:first-child { text-indent: 2em; }\n"
+	"span + span { margin-left: 2px; }\n"
+	".odd { background-color: #eee; }\n"
+	".even { background-color: #ddd; }\n"
+	"div.even span.odd { color: red; }\n"
+	"#n1 { border-top-width: 1px; }\n"
+	"#n7 .even { border-bottom-width: 2px; }\n"
+	"* { text-align: left; }\n";
+
+static const char *node_names[] = { "html", "div", "p", "span" };
+
+static css_stylesheet *sheet;
+static css_media media;
+
+static css_error node_name(void *pw, void *n, css_qname *qname)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	qname->name = lwc_string_ref(node->name);
+
+	return CSS_OK;
+}
+
+static css_error node_classes(void *pw, void *n,
+		lwc_string ***classes, uint32_t *n_classes)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	*classes = NULL;
+	*n_classes = 0;
+
+	if (node->klass != NULL) {
+		*classes = malloc(sizeof(lwc_string *));
+		if (*classes == NULL)
+			return CSS_NOMEM;
+
+		(*classes)[0] = lwc_string_ref(node->klass);
+		*n_classes = 1;
+	}
+
+	return CSS_OK;
+}
+
+static css_error node_id(void *pw, void *n, lwc_string **id)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	*id = node->id ? lwc_string_ref(node->id) : NULL;
+
+	return CSS_OK;
+}
+
+static bool node_is_named(node *node, const css_qname *qname)
+{
+	bool match;
+
+	return lwc_string_caseless_isequal(node->name, qname->name,
+			&match) == lwc_error_ok && match;
+}
+
+static css_error named_ancestor_node(void *pw, void *n,
+		const css_qname *qname, void **ancestor)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	for (node = node->parent; node != NULL; node = node->parent) {
+		if (node_is_named(node, qname))
+			break;
+	}
+
+	*ancestor = node;
+
+	return CSS_OK;
+}
+
+static css_error named_parent_node(void *pw, void *n,
+		const css_qname *qname, void **parent)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	*parent = NULL;
+	if (node->parent != NULL && node_is_named(node->parent, qname))
+		*parent = node->parent;
+
+	return CSS_OK;
+}
+
+static css_error named_sibling_node(void *pw, void *n,
+		const css_qname *qname, void **sibling)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	*sibling = NULL;
+	if (node->prev != NULL && node_is_named(node->prev, qname))
+		*sibling = node->prev;
+
+	return CSS_OK;
+}
+
+static css_error named_generic_sibling_node(void *pw, void *n,
+		const css_qname *qname, void **sibling)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	for (node = node->prev; node != NULL; node = node->prev) {
+		if (node_is_named(node, qname))
+			break;
+	}
+
+	*sibling = node;
+
+	return CSS_OK;
+}
+
+static css_error parent_node(void *pw, void *n, void **parent)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	*parent = node->parent;
+
+	return CSS_OK;
+}
+
+static css_error sibling_node(void *pw, void *n, void **sibling)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	*sibling = node->prev;
+
+	return CSS_OK;
+}
+
+static css_error node_has_name(void *pw, void *n,
+		const css_qname *qname, bool *match)
+{
+	UNUSED(pw);
+
+	*match = node_is_named(n, qname);
+
+	return CSS_OK;
+}
+
+static css_error node_has_class(void *pw, void *n,
+		lwc_string *name, bool *match)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	*match = false;
+	if (node->klass != NULL)
+		lwc_string_caseless_isequal(node->klass, name, match);
+
+	return CSS_OK;
+}
+
+static css_error node_has_id(void *pw, void *n,
+		lwc_string *name, bool *match)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	*match = false;
+	if (node->id != NULL)
+		lwc_string_caseless_isequal(node->id, name, match);
+
+	return CSS_OK;
+}
+
+static css_error node_has_attribute(void *pw, void *n,
+		const css_qname *qname, bool *match)
+{
+	UNUSED(pw);
+	UNUSED(n);
+	UNUSED(qname);
+
+	*match = false;
+
+	return CSS_OK;
+}
+
+static css_error node_has_attribute_value(void *pw, void *n,
+		const css_qname *qname, lwc_string *value, bool *match)
+{
+	UNUSED(pw);
+	UNUSED(n);
+	UNUSED(qname);
+	UNUSED(value);
+
+	*match = false;
+
+	return CSS_OK;
+}
+
+static css_error node_is_root(void *pw, void *n, bool *match)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	*match = (node->parent == NULL);
+
+	return CSS_OK;
+}
+
+static css_error node_count_siblings(void *pw, void *n,
+		bool same_name, bool after, int32_t *count)
+{
+	node *node = n;
+	struct node *sibling;
+	int32_t cnt = 0;
+	UNUSED(pw);
+
+	sibling = after ? node->next : node->prev;
+	while (sibling != NULL) {
+		if (!same_name || sibling->name == node->name)
+			cnt++;
+		sibling = after ? sibling->next : sibling->prev;
+	}
+
+	*count = cnt;
+
+	return CSS_OK;
+}
+
+static css_error node_is_empty(void *pw, void *n, bool *match)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	*match = (node->children == NULL);
+
+	return CSS_OK;
+}
+
+static css_error node_is_false(void *pw, void *n, bool *match)
+{
+	UNUSED(pw);
+	UNUSED(n);
+
+	*match = false;
+
+	return CSS_OK;
+}
+
+static css_error node_is_lang(void *pw, void *n,
+		lwc_string *lang, bool *match)
+{
+	UNUSED(pw);
+	UNUSED(n);
+	UNUSED(lang);
+
+	*match = false;
+
+	return CSS_OK;
+}
+
+static css_error node_presentational_hint(void *pw, void *n,
+		uint32_t *nhints, css_hint **hints)
+{
+	UNUSED(pw);
+	UNUSED(n);
+
+	*nhints = 0;
+	*hints = NULL;
+
+	return CSS_OK;
+}
+
+static css_error ua_default_for_property(void *pw, uint32_t property,
+		css_hint *hint)
+{
+	UNUSED(pw);
+
+	if (property == CSS_PROP_COLOR) {
+		hint->data.color = 0xff000000;
+		hint->status = CSS_COLOR_COLOR;
+	} else if (property == CSS_PROP_BACKGROUND_COLOR ||
+			property == CSS_PROP_FOIL_COLOR_INFO ||
+			property == CSS_PROP_FOIL_COLOR_WARNING ||
+			property == CSS_PROP_FOIL_COLOR_DANGER ||
+			property == CSS_PROP_FOIL_COLOR_SUCCESS ||
+			property == CSS_PROP_FOIL_COLOR_PRIMARY ||
+			property == CSS_PROP_FOIL_COLOR_SECONDARY) {
+		hint->data.color = 0xffffffff;
+		hint->status = CSS_COLOR_COLOR;
+	} else if (property == CSS_PROP_FONT_FAMILY) {
+		hint->data.strings = NULL;
+		hint->status = CSS_FONT_FAMILY_SANS_SERIF;
+	} else if (property == CSS_PROP_QUOTES) {
+		hint->data.strings = NULL;
+		hint->status = CSS_QUOTES_NONE;
+	} else if (property == CSS_PROP_VOICE_FAMILY) {
+		hint->data.strings = NULL;
+		hint->status = 0;
+	} else {
+		return CSS_INVALID;
+	}
+
+	return CSS_OK;
+}
+
+static css_error compute_font_size(void *pw, const css_hint *parent,
+		css_hint *size)
+{
+	UNUSED(pw);
+	UNUSED(parent);
+
+	size->data.length.value = FLTTOFIX(12.0);
+	size->data.length.unit = CSS_UNIT_PT;
+	size->status = CSS_FONT_SIZE_DIMENSION;
+
+	return CSS_OK;
+}
+
+static css_error set_node_data(void *pw, void *n, void *node_data)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	node->node_data = node_data;
+
+	return CSS_OK;
+}
+
+static css_error get_node_data(void *pw, void *n, void **node_data)
+{
+	node *node = n;
+	UNUSED(pw);
+
+	*node_data = node->node_data;
+
+	return CSS_OK;
+}
+
+static css_select_handler select_handler = {
+	CSS_SELECT_HANDLER_VERSION_1,
+
+	node_name,
+	node_classes,
+	node_id,
+	named_ancestor_node,
+	named_parent_node,
+	named_sibling_node,
+	named_generic_sibling_node,
+	parent_node,
+	sibling_node,
+	node_has_name,
+	node_has_class,
+	node_has_id,
+	node_has_attribute,
+	node_has_attribute_value,
+	node_has_attribute_value,
+	node_has_attribute_value,
+	node_has_attribute_value,
+	node_has_attribute_value,
+	node_has_attribute_value,
+	node_is_root,
+	node_count_siblings,
+	node_is_empty,
+	node_is_false,
+	node_is_false,
+	node_is_false,
+	node_is_false,
+	node_is_false,
+	node_is_false,
+	node_is_false,
+	node_is_false,
+	node_is_false,
+	node_is_lang,
+	node_presentational_hint,
+	ua_default_for_property,
+	compute_font_size,
+	set_node_data,
+	get_node_data
+};
+
+static css_error resolve_url(void *pw,
+		const char *base, lwc_string *rel, lwc_string **abs)
+{
+	UNUSED(pw);
+	UNUSED(base);
+
+	*abs = lwc_string_ref(rel);
+
+	return CSS_OK;
+}
+
+static node *create_tree(node *parent, unsigned depth, unsigned *serial)
+{
+	char buf[32];
+	node *n = calloc(1, sizeof(node));
+	unsigned i;
+
+	assert(n != NULL);
+
+	n->parent = parent;
+
+	strcpy(buf, node_names[depth < 3 ? depth : 3]);
+	assert(lwc_intern_string(buf, strlen(buf), &n->name) == lwc_error_ok);
+
+	strcpy(buf, (*serial & 1) ? "odd" : "even");
+	assert(lwc_intern_string(buf, strlen(buf), &n->klass) == lwc_error_ok);
+
+	snprintf(buf, sizeof(buf), "n%u", *serial);
+	assert(lwc_intern_string(buf, strlen(buf), &n->id) == lwc_error_ok);
+	(*serial)++;
+
+	if (depth < NR_DEPTH) {
+		node *last = NULL;
+
+		for (i = 0; i < NR_CHILDREN; i++) {
+			node *child = create_tree(n, depth + 1, serial);
+
+			child->prev = last;
+			if (last)
+				last->next = child;
+			else
+				n->children = child;
+			last = child;
+		}
+	}
+
+	return n;
+}
+
+static void destroy_tree(node *n)
+{
+	node *child, *next;
+
+	for (child = n->children; child != NULL; child = next) {
+		next = child->next;
+		destroy_tree(child);
+	}
+
+	if (n->node_data != NULL) {
+		css_node_data_handler(&select_handler, CSS_NODE_DELETED,
+				NULL, n, NULL, n->node_data);
+	}
+
+	lwc_string_unref(n->name);
+	lwc_string_unref(n->klass);
+	lwc_string_unref(n->id);
+	free(n);
+}
+
+static size_t select_tree(css_select_ctx *select, node *n)
+{
+	css_select_results *sr;
+	node *child;
+	size_t nr = 1;
+
+	/* Drop the data of the previous round, as for a full restyle */
+	if (n->node_data != NULL) {
+		css_node_data_handler(&select_handler, CSS_NODE_DELETED,
+				NULL, n, NULL, n->node_data);
+		n->node_data = NULL;
+	}
+
+	assert(css_select_style(select, n, &media, NULL,
+			&select_handler, NULL, &sr) == CSS_OK);
+	css_select_results_destroy(sr);
+
+	for (child = n->children; child != NULL; child = child->next)
+		nr += select_tree(select, child);
+
+	return nr;
+}
+
+struct bench_args {
+	unsigned iterations;
+	size_t nr_selected;
+};
+
+static void *bench_thread(void *arg)
+{
+	struct bench_args *args = arg;
+	css_select_ctx *select;
+	unsigned serial = 0;
+	unsigned i;
+	node *tree;
+
+	tree = create_tree(NULL, 0, &serial);
+
+	assert(css_select_ctx_create(&select) == CSS_OK);
+	assert(css_select_ctx_append_sheet(select, sheet,
+			CSS_ORIGIN_AUTHOR, NULL) == CSS_OK);
+
+	for (i = 0; i < args->iterations; i++)
+		args->nr_selected += select_tree(select, tree);
+
+	assert(css_select_ctx_destroy(select) == CSS_OK);
+	destroy_tree(tree);
+
+	return NULL;
+}
+
+static double run_bench(unsigned nr_threads, unsigned iterations)
+{
+	pthread_t *threads = calloc(nr_threads, sizeof(pthread_t));
+	struct bench_args *args = calloc(nr_threads, sizeof(struct bench_args));
+	struct timespec start, end;
+	size_t nr_selected = 0;
+	double secs;
+	unsigned i;
+
+	assert(threads != NULL && args != NULL);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < nr_threads; i++) {
+		args[i].iterations = iterations;
+		assert(pthread_create(threads + i, NULL,
+				bench_thread, args + i) == 0);
+	}
+
+	for (i = 0; i < nr_threads; i++) {
+		pthread_join(threads[i], NULL);
+		nr_selected += args[i].nr_selected;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	secs = (end.tv_sec - start.tv_sec) +
+		(end.tv_nsec - start.tv_nsec) / 1e9;
+
+	printf("%u thread(s): %zu styles selected in %.3f s, %.0f styles/s\n",
+			nr_threads, nr_selected, secs, nr_selected / secs);
+
+	free(threads);
+	free(args);
+
+	return nr_selected / secs;
+}
+
+static void leak_iterator(lwc_string *str, void *pw)
+{
+	bool *leaked = pw;
+
+	printf(" DICT: %*s\n", (int)(lwc_string_length(str)),
+			lwc_string_data(str));
+	*leaked = true;
+}
+
+int main(int argc, char **argv)
+{
+	css_stylesheet_params params;
+	unsigned nr_threads = NR_DEF_THREADS;
+	unsigned iterations = NR_DEF_ITERATIONS;
+	double single, multi;
+	bool leaked = false;
+
+	if (argc > 1)
+		nr_threads = (unsigned)strtoul(argv[1], NULL, 10);
+	if (argc > 2)
+		iterations = (unsigned)strtoul(argv[2], NULL, 10);
+	if (nr_threads == 0)
+		nr_threads = 1;
+
+	memset(&params, 0, sizeof(params));
+	params.params_version = CSS_STYLESHEET_PARAMS_VERSION_1;
+	params.level = CSS_LEVEL_21;
+	params.charset = "UTF-8";
+	params.url = "bench";
+	params.title = "bench";
+	params.resolve = resolve_url;
+
+	assert(css_stylesheet_create(&params, &sheet) == CSS_OK);
+	assert(css_stylesheet_append_data(sheet,
+			(const uint8_t *)bench_sheet, strlen(bench_sheet)) ==
+			CSS_NEEDDATA);
+	assert(css_stylesheet_data_done(sheet) == CSS_OK);
+
+	media.type = CSS_MEDIA_SCREEN;
+
+	single = run_bench(1, iterations);
+	multi = run_bench(nr_threads, iterations);
+	printf("Speedup with %u thread(s): %.2fx\n", nr_threads,
+			multi / single);
+
+	css_stylesheet_destroy(sheet);
+
+	lwc_iterate_strings(leak_iterator, &leaked);
+	assert(leaked == false);
+
+	printf("PASS\n");
+
+	return 0;
+}
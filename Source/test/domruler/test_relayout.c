@@ -0,0 +1,178 @@
+/*
+** This file is part of DOM Ruler. DOM Ruler is a library to
+** maintain a DOM tree, lay out and stylize the DOM nodes by
+** using CSS (Cascaded Style Sheets).
+**
+** Copyright (C) 2022 Beijing FMSoft Technologies Co., Ltd.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General License for more details.
+**
+** You should have received a copy of the GNU Lesser General License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "domruler.h"
+
+/*
+ * Checks the incremental relayout after single-node edits gives the same
+ * boxes as laying out the whole tree with a fresh context, and measures
+ * the cost of both.
+ */
+
+#define NR_ITEMS        200
+#define NR_SUB_ITEMS    5
+
+static const char css[] =
+    "#root { display: block; width: 100%; height: 100%; } \n"
+    ".item { display: block; width: 100%; height: 20px; } \n"
+    ".wide { width: 50%; height: 40px; } \n"
+    ".sub { display: inline-block; width: 10%; height: 10px; } \n";
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static HLDomElement *items[NR_ITEMS];
+
+static HLDomElement *create_tree(void)
+{
+    HLDomElement *root = domruler_element_node_create("div");
+    domruler_element_node_set_id(root, "root");
+
+    for (int i = 0; i < NR_ITEMS; i++) {
+        items[i] = domruler_element_node_create("div");
+        domruler_element_node_set_class(items[i], "item");
+        domruler_element_node_append_as_last_child(items[i], root);
+
+        for (int j = 0; j < NR_SUB_ITEMS; j++) {
+            HLDomElement *sub = domruler_element_node_create("span");
+            domruler_element_node_set_class(sub, "sub");
+            domruler_element_node_append_as_last_child(sub, items[i]);
+        }
+    }
+
+    return root;
+}
+
+static void destroy_tree(HLDomElement *node)
+{
+    HLDomElement *child = domruler_element_node_get_first_child(node);
+    while (child) {
+        HLDomElement *next = domruler_element_node_get_next(child);
+        destroy_tree(child);
+        child = next;
+    }
+    domruler_element_node_destroy(node);
+}
+
+static struct DOMRulerCtxt *create_ctxt(void)
+{
+    struct DOMRulerCtxt *ctxt = domruler_create(1280, 720, 72, 27);
+    assert(ctxt);
+    domruler_append_css(ctxt, css, strlen(css));
+    return ctxt;
+}
+
+struct compare_data {
+    struct DOMRulerCtxt *ctxt;
+    struct DOMRulerCtxt *expected;
+    int nr_diffs;
+};
+
+static void compare_node(HLDomElement *node, void *user_data)
+{
+    struct compare_data *data = user_data;
+    const HLBox *box = domruler_get_node_bounding_box(data->ctxt, node);
+    const HLBox *exp = domruler_get_node_bounding_box(data->expected, node);
+
+    if (box == NULL || exp == NULL || box->x != exp->x || box->y != exp->y ||
+            box->w != exp->w || box->h != exp->h) {
+        HL_LOGE("box differs|node=%s|class=%s\n",
+                domruler_element_node_get_tag_name(node),
+                domruler_element_node_get_class(node));
+        data->nr_diffs++;
+    }
+}
+
+/* lays out the tree incrementally and with a fresh context,
+   then compares the boxes */
+static int check_relayout(const char *name, struct DOMRulerCtxt *ctxt,
+        HLDomElement *root)
+{
+    double t = now_us();
+    int ret = domruler_layout_hldom_elements(ctxt, root);
+    double relayout_us = now_us() - t;
+    if (ret != DOMRULER_OK) {
+        HL_LOGE("%s|relayout failed|code=%d\n", name, ret);
+        return 1;
+    }
+
+    struct DOMRulerCtxt *expected = create_ctxt();
+    t = now_us();
+    ret = domruler_layout_hldom_elements(expected, root);
+    double layout_us = now_us() - t;
+    if (ret != DOMRULER_OK) {
+        HL_LOGE("%s|layout failed|code=%d\n", name, ret);
+        domruler_destroy(expected);
+        return 1;
+    }
+
+    struct compare_data data = { ctxt, expected, 0 };
+    domruler_element_node_depth_first_search_tree(root, compare_node, &data);
+    domruler_destroy(expected);
+
+    fprintf(stderr, "%-16s relayout: %8.1f us, full layout: %8.1f us, "
+            "differences: %d\n", name, relayout_us, layout_us, data.nr_diffs);
+    return data.nr_diffs ? 1 : 0;
+}
+
+int main(void)
+{
+    int failed = 0;
+    HLDomElement *root = create_tree();
+    struct DOMRulerCtxt *ctxt = create_ctxt();
+
+    int ret = domruler_layout_hldom_elements(ctxt, root);
+    assert(ret == DOMRULER_OK);
+
+    // change the style attribute
+    domruler_element_node_set_style(items[NR_ITEMS / 2], "height: 100px;");
+    domruler_mark_dirty(ctxt, items[NR_ITEMS / 2], DOMRULER_DIRTY_STYLE);
+    failed += check_relayout("style", ctxt, root);
+
+    // change the class
+    domruler_element_node_set_class(items[10], "item wide");
+    domruler_mark_dirty(ctxt, items[10], DOMRULER_DIRTY_ATTRS);
+    failed += check_relayout("class", ctxt, root);
+
+    // append a child
+    HLDomElement *sub = domruler_element_node_create("span");
+    domruler_element_node_set_class(sub, "sub");
+    domruler_element_node_append_as_last_child(sub, items[NR_ITEMS - 1]);
+    domruler_mark_dirty(ctxt, items[NR_ITEMS - 1], DOMRULER_DIRTY_CHILDREN);
+    failed += check_relayout("append child", ctxt, root);
+
+    // nothing marked dirty: lay out the whole tree
+    failed += check_relayout("no change", ctxt, root);
+
+    domruler_destroy(ctxt);
+    destroy_tree(root);
+    return failed ? 1 : 0;
+}
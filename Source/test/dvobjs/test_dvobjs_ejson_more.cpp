@@ -719,6 +719,27 @@ TEST(dvobjs, sort)
         { "[\"3\",\"02\",1]",
             "$DATA.serialize($DATA.sort([1, '02', '3'], 'desc', 'auto'))",
             sort, sort_vrtcmp, 0 },
+        { "[-10,-1.5,0,3]",
+            "$DATA.serialize($DATA.sort([0, 3, -1.5, -10]))",
+            sort, sort_vrtcmp, 0 },
+        { "[\"a\",\"b\",\"c\"]",
+            "$DATA.serialize($DATA.sort(['c', 'a', 'b']))",
+            sort, sort_vrtcmp, 0 },
+        { "[3,2,0,-5]",
+            "$DATA.serialize($DATA.sort([0L, 3L, -5L, 2UL], 'desc'))",
+            sort, sort_vrtcmp, 0 },
+        { "[\"\",\"a\",\"ab\",\"abc\"]",
+            "$DATA.serialize($DATA.sort(['ab', 'abc', '', 'a']))",
+            sort, sort_vrtcmp, 0 },
+        { "[\"abc\",\"ab\",\"a\",\"\"]",
+            "$DATA.serialize($DATA.sort(['ab', 'abc', '', 'a'], 'desc'))",
+            sort, sort_vrtcmp, 0 },
+        { "[\"A\",\"b\",\"C\"]",
+            "$DATA.serialize($DATA.sort(['b', 'C', 'A'], 'asc', 'caseless'))",
+            sort, sort_vrtcmp, 0 },
+        { "[\"C\",\"b\",\"A\"]",
+            "$DATA.serialize($DATA.sort(['b', 'A', 'C'], 'desc', 'caseless'))",
+            sort, sort_vrtcmp, 0 },
     };
 
     run_testcases(test_cases, PCA_TABLESIZE(test_cases));
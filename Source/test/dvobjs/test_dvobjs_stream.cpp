@@ -25,6 +25,15 @@
 
 #include <stdio.h>
 #include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <string>
+#include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 
 
@@ -45,3 +54,219 @@ TEST(dvobjs, stream_pipe)
 #endif
 }
 
+
+/* listen on a loopback port chosen by the system */
+static int listen_on_loopback(unsigned *port)
+{
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (lfd < 0)
+        return -1;
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    socklen_t len = sizeof(addr);
+    if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) ||
+            listen(lfd, 1) ||
+            getsockname(lfd, (struct sockaddr *)&addr, &len)) {
+        close(lfd);
+        return -1;
+    }
+
+    /* do not wait forever for a stream which failed to connect */
+    struct timeval tv = { 5, 0 };
+    setsockopt(lfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    *port = ntohs(addr.sin_port);
+    return lfd;
+}
+
+/* write the chunks with a pause in between so that they are read
+   separately, then close the connection */
+static void serve_chunks(int lfd, const std::vector<std::string> &chunks)
+{
+    int fd = accept(lfd, NULL, NULL);
+    if (fd < 0)
+        return;
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (i > 0)
+            usleep(50 * 1000);
+        ssize_t n = write(fd, chunks[i].data(), chunks[i].size());
+        (void)n;
+    }
+
+    close(fd);
+}
+
+/* lines longer than one read are carried across reads; a CR is stripped
+   only right before the LF */
+TEST(dvobjs, stream_inet_lines)
+{
+    TestDVObj tester;
+
+    unsigned port;
+    int lfd = listen_on_loopback(&port);
+    ASSERT_GE(lfd, 0);
+
+    std::string long_line(3000, 'x');
+    std::vector<std::string> chunks = {
+        long_line + "\ntail\r\na\rb\r\npartial" };
+    std::thread peer(serve_chunks, lfd, std::cref(chunks));
+
+    char jsonee[128];
+    snprintf(jsonee, sizeof(jsonee),
+            "$STREAM.open('inet://127.0.0.1:%u', 'read').readlines(5)", port);
+
+    struct purc_ejson_parsing_tree *ptree;
+    ptree = purc_variant_ejson_parse_string(jsonee, strlen(jsonee));
+    purc_variant_t result = purc_ejson_parsing_tree_evalute(ptree,
+            TestDVObj::get_dvobj, &tester, true);
+    purc_ejson_parsing_tree_destroy(ptree);
+
+    peer.join();
+    close(lfd);
+
+    ASSERT_NE(result, nullptr);
+    ASSERT_TRUE(purc_variant_is_array(result));
+    ASSERT_EQ(purc_variant_array_get_size(result), 4);
+
+    purc_variant_t line = purc_variant_array_get(result, 0);
+    ASSERT_STREQ(purc_variant_get_string_const(line), long_line.c_str());
+    line = purc_variant_array_get(result, 1);
+    ASSERT_STREQ(purc_variant_get_string_const(line), "tail");
+    line = purc_variant_array_get(result, 2);
+    ASSERT_STREQ(purc_variant_get_string_const(line), "a\rb");
+    line = purc_variant_array_get(result, 3);
+    ASSERT_STREQ(purc_variant_get_string_const(line), "partial");
+
+    purc_variant_unref(result);
+}
+
+/* collects the records posted by `event:readable` until `event:hangup` */
+static const char *framed_hvml =
+    "<!DOCTYPE hvml>"
+    "<hvml target=\"void\">"
+    "    <init as records with [] />"
+    "    <init as sock with $STREAM.open('inet://127.0.0.1:%u', 'read nonblock %s') />"
+    "    <observe on $sock for \"event:readable\">"
+    "        <update on $records to \"append\" with $? />"
+    "    </observe>"
+    "    <observe on $sock for \"event:hangup\">"
+    "        <exit with $records />"
+    "    </observe>"
+    "</hvml>";
+
+static bool framed_exited;
+static bool framed_matched;
+
+static int framed_cond_handler(purc_cond_k event, void *arg, void *data)
+{
+    if (event == PURC_COND_COR_EXITED) {
+        purc_coroutine_t cor = (purc_coroutine_t)arg;
+        const char *expected =
+            (const char *)purc_coroutine_get_user_data(cor);
+        struct purc_cor_exit_info *info = (struct purc_cor_exit_info *)data;
+
+        purc_variant_t v = purc_variant_make_from_json_string(expected,
+                strlen(expected));
+        framed_exited = true;
+        framed_matched = v && info->result &&
+            purc_variant_is_equal_to(v, info->result);
+        if (v)
+            purc_variant_unref(v);
+    }
+
+    return 0;
+}
+
+static void check_framed_records(const char *framing,
+        const std::vector<std::string> &chunks, const char *expected)
+{
+    int ret = purc_init_ex(PURC_MODULE_HVML, "cn.fmsoft.hvml.test",
+            "dvobjs", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    unsigned port;
+    int lfd = listen_on_loopback(&port);
+    ASSERT_GE(lfd, 0);
+    std::thread peer(serve_chunks, lfd, std::cref(chunks));
+
+    char hvml[1024];
+    snprintf(hvml, sizeof(hvml), framed_hvml, port, framing);
+
+    framed_exited = false;
+    framed_matched = false;
+    purc_vdom_t vdom = purc_load_hvml_from_string(hvml);
+    EXPECT_NE(vdom, nullptr);
+    if (vdom) {
+        purc_coroutine_t cor = purc_schedule_vdom_null(vdom);
+        purc_coroutine_set_user_data(cor, (void *)expected);
+        purc_run(framed_cond_handler);
+    }
+
+    peer.join();
+    close(lfd);
+
+    EXPECT_TRUE(framed_exited) << framing;
+    EXPECT_TRUE(framed_matched) << framing << ": " << expected;
+
+    purc_cleanup();
+}
+
+/* a 32-bit big-endian length followed by the payload */
+static std::string length_prefixed(const std::string &payload)
+{
+    uint32_t len = payload.size();
+    char header[4] = {
+        (char)(len >> 24), (char)(len >> 16), (char)(len >> 8), (char)len };
+    return std::string(header, sizeof(header)) + payload;
+}
+
+/* the records split across reads are reassembled; EOF posts hangup */
+TEST(dvobjs, stream_framed_lines)
+{
+    check_framed_records("lines", { "one\r", "\ntw", "o\nthree" },
+            "[\"one\", \"two\", \"three\"]");
+}
+
+TEST(dvobjs, stream_framed_length_prefixed)
+{
+    std::string data = length_prefixed("hello") + length_prefixed("!") +
+        length_prefixed("world");
+
+    /* split in the middle of a header and of a payload */
+    check_framed_records("length-prefixed",
+            { data.substr(0, 2), data.substr(2, 5), data.substr(7, 5),
+              data.substr(12) },
+            "[bx68656c6c6f, bx21, bx776f726c64]");
+}
+
+TEST(dvobjs, stream_framed_json_records)
+{
+    check_framed_records("json-records",
+            { "{\"a\":1}, [1,\"x]", "y\"]\n{\"b\":", "{\"c\":\"}\\\"\"}}" },
+            "[{\"a\":1}, [1, \"x]y\"], {\"b\":{\"c\":\"}\\\"\"}}]");
+}
+
+/* an oversized or malformed record breaks the stream after the records
+   before it are posted */
+TEST(dvobjs, stream_framed_oversized)
+{
+    std::string data = length_prefixed("ok") + std::string("\xff\xff\xff\xff", 4);
+    check_framed_records("length-prefixed", { data, "more bytes" },
+            "[bx6f6b]");
+}
+
+TEST(dvobjs, stream_framed_garbage)
+{
+    check_framed_records("json-records", { "{\"a\":1} ", "garbage {}" },
+            "[{\"a\":1}]");
+
+    /* balanced brackets but not JSON: the valid record after it
+       is not posted */
+    check_framed_records("json-records",
+            { "{\"a\":1} {\"a\":}", " {\"b\":2}" }, "[{\"a\":1}]");
+}
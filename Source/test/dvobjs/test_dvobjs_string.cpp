@@ -31,6 +31,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <gtest/gtest.h>
+#include <string>
 
 extern purc_variant_t get_variant (char *buf, size_t *length);
 extern void get_variant_total_info (size_t *mem, size_t *value, size_t *resv);
@@ -1211,6 +1212,94 @@ TEST(dvobjs, dvobjs_string_join)
     purc_cleanup ();
 }
 
+TEST(dvobjs, dvobjs_string_join_accumulation)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex (PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "dvobjs", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    purc_variant_t string = purc_dvobj_string_new();
+    ASSERT_NE(string, nullptr);
+
+    purc_variant_t dynamic = purc_variant_object_get_by_ckey (string, "join");
+    ASSERT_NE(dynamic, nullptr);
+    purc_dvariant_method func = purc_variant_dynamic_get_getter (dynamic);
+    ASSERT_NE(func, nullptr);
+
+    size_t sz_total_mem_before = 0;
+    size_t sz_total_values_before = 0;
+    size_t nr_reserved_before = 0;
+    get_variant_total_info (&sz_total_mem_before,
+            &sz_total_values_before, &nr_reserved_before);
+
+    // $buf = $STR.join($buf, $line, $i) many times; keep a middle version
+    std::string expected;
+    std::string expected_half;
+    purc_variant_t buf = purc_variant_make_string ("", false);
+    purc_variant_t half = PURC_VARIANT_INVALID;
+    purc_variant_t line = purc_variant_make_string ("line ", false);
+    for (int i = 0; i < 10000; i++) {
+        purc_variant_t param[3] = { buf, line,
+            purc_variant_make_longint (i % 10) };
+        purc_variant_t result = func (NULL, 3, param, 0);
+        ASSERT_NE(result, nullptr);
+        purc_variant_unref (param[2]);
+
+        expected += "line ";
+        expected += std::to_string (i % 10);
+        purc_variant_unref (buf);
+        buf = result;
+
+        if (i == 4999) {
+            half = purc_variant_ref (buf);
+            expected_half = expected;
+        }
+    }
+
+    size_t length = 0;
+    ASSERT_EQ(purc_variant_string_bytes (buf, &length), true);
+    ASSERT_EQ(length, expected.length() + 1);
+    ASSERT_EQ(purc_variant_string_bytes (half, &length), true);
+    ASSERT_EQ(length, expected_half.length() + 1);
+    ASSERT_STREQ(purc_variant_get_string_const (buf), expected.c_str());
+    ASSERT_STREQ(purc_variant_get_string_const (half), expected_half.c_str());
+
+    purc_variant_t another = purc_variant_make_string (expected.c_str(), false);
+    ASSERT_EQ(purc_variant_is_equal_to (buf, another), true);
+    purc_variant_unref (another);
+
+    purc_variant_unref (half);
+    purc_variant_unref (buf);
+
+    // the last user of a buffer copies out a shorter string and frees the
+    // buffer; a leak is reported when built with ENABLE_SANITIZERS=address
+    purc_variant_t param[2] = { line, line };
+    purc_variant_t shorter = func (NULL, 2, param, 0);
+    ASSERT_NE(shorter, nullptr);
+    param[0] = shorter;
+    purc_variant_t longer = func (NULL, 2, param, 0);
+    ASSERT_NE(longer, nullptr);
+    purc_variant_unref (longer);
+    ASSERT_STREQ(purc_variant_get_string_const (shorter), "line line ");
+    purc_variant_unref (shorter);
+
+    purc_variant_unref (line);
+
+    size_t sz_total_mem_after = 0;
+    size_t sz_total_values_after = 0;
+    size_t nr_reserved_after = 0;
+    get_variant_total_info (&sz_total_mem_after,
+            &sz_total_values_after, &nr_reserved_after);
+    ASSERT_EQ(sz_total_values_before, sz_total_values_after);
+    ASSERT_EQ(sz_total_mem_after,
+            sz_total_mem_before + (nr_reserved_after -
+                nr_reserved_before) * sizeof(purc_variant));
+
+    purc_variant_unref(string);
+    purc_cleanup ();
+}
+
 TEST(dvobjs, dvobjs_string_tolower)
 {
     const char *function[] = {"tolower"};
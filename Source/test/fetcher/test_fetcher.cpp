@@ -26,6 +26,8 @@
 #include "../helpers.h"
 
 #include <gtest/gtest.h>
+#include <string>
+#include <algorithm>
 #include <wtf/RunLoop.h>
 #include <wtf/FileSystem.h>
 #include <wtf/StdLibExtras.h>
@@ -170,6 +172,118 @@ TEST(fetcher, Instance)
     PurCInstance purc("cn.fmsoft.hybridos.sample", "pcfetcher");
 }
 
+// the body of a result set of two statements, as streamed by lsql and rsql
+static std::string make_sql_body(int nr_rows_first, int nr_rows_second)
+{
+    std::string body = "{\"result\":[\n{\"rows\":[\n";
+    for (int i = 0; i < nr_rows_first; i++) {
+        body += "{\"id\":" + std::to_string(i) + ",\"name\":\"row " +
+            std::to_string(i) + "\"}";
+        body += (i + 1 < nr_rows_first) ? ",\n" : "\n";
+    }
+    body += "],\"rowsAffected\":0},\n{\"rows\":[\n";
+    for (int i = 0; i < nr_rows_second; i++) {
+        body += "{\"n\":" + std::to_string(i) + "}";
+        body += (i + 1 < nr_rows_second) ? ",\n" : "\n";
+    }
+    body += "],\"rowsAffected\":0}\n],\"statusCode\":200,\"errorMsg\":null}";
+    return body;
+}
+
+TEST(fetcher, sql_decoder_streaming)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.sample",
+            "pcfetcher", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    ASSERT_TRUE(pcfetcher_is_sql_uri("lsql:///tmp/test.db?q=1"));
+    ASSERT_TRUE(pcfetcher_is_sql_uri("RSQL://localhost/db"));
+    ASSERT_FALSE(pcfetcher_is_sql_uri("file:///tmp/test.json"));
+
+    const int nr_first = 200, nr_second = 3;
+    std::string body = make_sql_body(nr_first, nr_second);
+
+    // cut the body into chunks of various sizes, splitting lines anywhere
+    const size_t sz_chunks[] = { 1, 7, 64, 1000, body.length() };
+    for (size_t sz_chunk : sz_chunks) {
+        struct pcfetcher_sql_decoder *decoder = pcfetcher_sql_decoder_create();
+        ASSERT_NE(decoder, nullptr);
+
+        ssize_t nr_decoded = 0;
+        size_t nr_lines = 0;
+        for (size_t off = 0; off < body.length(); off += sz_chunk) {
+            size_t len = std::min(sz_chunk, body.length() - off);
+            ssize_t n = pcfetcher_sql_decoder_feed(decoder,
+                    body.data() + off, len);
+            ASSERT_GE(n, 0);
+            nr_decoded += n;
+
+            // the rows of the complete lines are decoded at once
+            for (size_t i = off; i < off + len; i++) {
+                if (body[i] == '\n')
+                    nr_lines++;
+            }
+            ssize_t nr_expected = std::min<ssize_t>(
+                    std::max<ssize_t>((ssize_t)nr_lines - 2, 0), nr_first);
+            if (nr_lines > (size_t)nr_first + 4) {
+                nr_expected += std::min<ssize_t>(
+                        nr_lines - nr_first - 4, nr_second);
+            }
+            ASSERT_EQ(nr_decoded, nr_expected) << "chunk: " << sz_chunk;
+
+            // the array of the first statement is still being filled
+            if (nr_decoded > 0 && nr_lines < (size_t)nr_first + 4) {
+                purc_variant_t rows = pcfetcher_sql_decoder_rows(decoder);
+                ASSERT_EQ(purc_variant_array_get_size(rows),
+                        (size_t)nr_decoded);
+            }
+        }
+        ASSERT_EQ(nr_decoded, nr_first + nr_second);
+
+        purc_variant_t doc = pcfetcher_sql_decoder_finish(decoder);
+        ASSERT_NE(doc, PURC_VARIANT_INVALID);
+        pcfetcher_sql_decoder_destroy(decoder);
+
+        purc_variant_t v = purc_variant_object_get_by_ckey(doc, "statusCode");
+        int64_t code = 0;
+        ASSERT_TRUE(purc_variant_cast_to_longint(v, &code, false));
+        ASSERT_EQ(code, 200);
+
+        purc_variant_t list = purc_variant_object_get_by_ckey(doc, "result");
+        ASSERT_EQ(purc_variant_array_get_size(list), 2);
+
+        purc_variant_t rows = purc_variant_object_get_by_ckey(
+                purc_variant_array_get(list, 0), "rows");
+        ASSERT_EQ(purc_variant_array_get_size(rows), (size_t)nr_first);
+        purc_variant_t name = purc_variant_object_get_by_ckey(
+                purc_variant_array_get(rows, nr_first - 1), "name");
+        ASSERT_STREQ(purc_variant_get_string_const(name),
+                ("row " + std::to_string(nr_first - 1)).c_str());
+
+        rows = purc_variant_object_get_by_ckey(
+                purc_variant_array_get(list, 1), "rows");
+        ASSERT_EQ(purc_variant_array_get_size(rows), (size_t)nr_second);
+
+        purc_variant_unref(doc);
+    }
+
+    // a single statement without trailing newline
+    struct pcfetcher_sql_decoder *decoder = pcfetcher_sql_decoder_create();
+    ASSERT_NE(decoder, nullptr);
+    const char *single = "{\"rows\":[\n{\"a\":1},\n{\"a\":2}\n],"
+        "\"statusCode\":200,\"errorMsg\":null,\"rowsAffected\":2}";
+    ASSERT_EQ(pcfetcher_sql_decoder_feed(decoder, single, strlen(single)), 2);
+    purc_variant_t doc = pcfetcher_sql_decoder_finish(decoder);
+    ASSERT_NE(doc, PURC_VARIANT_INVALID);
+    purc_variant_t rows = purc_variant_object_get_by_ckey(doc, "rows");
+    ASSERT_EQ(purc_variant_array_get_size(rows), 2);
+    purc_variant_unref(doc);
+    pcfetcher_sql_decoder_destroy(decoder);
+
+    purc_cleanup();
+}
+
 #if 0                        /* { */
 TEST(fetcher, init_cleanup)
 {
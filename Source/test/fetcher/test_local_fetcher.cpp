@@ -171,3 +171,169 @@ TEST(local_fetcher, async)
     purc_cleanup();
 #endif                        /* } */
 }
+
+struct async_counter {
+    int nr_done;
+    int nr_ok;
+    size_t sz_last;
+};
+
+static void counting_response_handler(
+        purc_variant_t request_id, void* ctxt,
+        const struct pcfetcher_resp_header *resp_header,
+        purc_rwstream_t resp)
+{
+    struct async_counter *counter = (struct async_counter *)ctxt;
+
+    counter->nr_done++;
+    if (resp_header->ret_code == 200 && resp) {
+        counter->nr_ok++;
+        counter->sz_last = resp_header->sz_resp;
+    }
+
+    if (resp)
+        purc_rwstream_destroy(resp);
+    purc_variant_unref(request_id);
+
+    if (counter->nr_done == 3)
+        RunLoop::current().stop();
+}
+
+TEST(local_fetcher, async_pool)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex (PURC_MODULE_HVML, "cn.fmsoft.hybridos.sample",
+            "pcfetcher", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const char* env = "HVML_TEST_LOCAL_FETCHER";
+    char base_uri[PATH_MAX+1] =  {0};
+    getpath_from_env_or_rel(base_uri, sizeof(base_uri), env, "data");
+    pcfetcher_set_base_url(base_uri);
+
+    struct async_counter counter = { };
+    const char *urls[] = { "buttons.json", "buttons.json", "not-exists.json" };
+    for (size_t i = 0; i < PCA_TABLESIZE(urls); i++) {
+        purc_variant_t req = pcfetcher_request_async(urls[i],
+                PCFETCHER_REQUEST_METHOD_GET, NULL, 0,
+                counting_response_handler, &counter,
+                NULL, NULL, NULL, NULL);
+        ASSERT_NE(req, PURC_VARIANT_INVALID);
+    }
+
+    // the handlers are called in this thread by its run loop
+    ASSERT_EQ(counter.nr_done, 0);
+    RunLoop::run();
+
+    ASSERT_EQ(counter.nr_done, 3);
+    ASSERT_EQ(counter.nr_ok, 2);
+    ASSERT_GT(counter.sz_last, 0);
+
+    pcfetcher_set_base_url(NULL);
+    purc_cleanup();
+}
+
+static size_t fetch_sync(const char *url, char *buf, size_t sz_buf)
+{
+    struct pcfetcher_resp_header resp_header = { };
+    purc_rwstream_t resp = pcfetcher_request_sync(url,
+            PCFETCHER_REQUEST_METHOD_GET, NULL, 0, &resp_header);
+    if (resp == NULL)
+        return 0;
+
+    ssize_t n = purc_rwstream_read(resp, buf, sz_buf - 1);
+    buf[n > 0 ? n : 0] = 0;
+    purc_rwstream_destroy(resp);
+    free(resp_header.mime_type);
+    return resp_header.sz_resp;
+}
+
+TEST(local_fetcher, cache_validation)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex (PURC_MODULE_HVML, "cn.fmsoft.hybridos.sample",
+            "pcfetcher", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const char *file = "/tmp/purc-local-fetcher.txt";
+    const char *url = "file:///tmp/purc-local-fetcher.txt";
+    char buf[64];
+
+    FILE *fp = fopen(file, "w");
+    fputs("first", fp);
+    fclose(fp);
+
+    ASSERT_EQ(fetch_sync(url, buf, sizeof(buf)), 5);
+    ASSERT_STREQ(buf, "first");
+    // served from the cache
+    ASSERT_EQ(fetch_sync(url, buf, sizeof(buf)), 5);
+    ASSERT_STREQ(buf, "first");
+
+    // a modified file must not be served from the cache
+    fp = fopen(file, "w");
+    fputs("the second", fp);
+    fclose(fp);
+
+    ASSERT_EQ(fetch_sync(url, buf, sizeof(buf)), 10);
+    ASSERT_STREQ(buf, "the second");
+
+    remove(file);
+    ASSERT_EQ(fetch_sync(url, buf, sizeof(buf)), 0);
+
+    purc_cleanup();
+}
+
+/* the cache hands out read-only views of the same content, which stay
+   valid after the cached content is replaced */
+TEST(local_fetcher, cache_shared_view)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex (PURC_MODULE_HVML, "cn.fmsoft.hybridos.sample",
+            "pcfetcher", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const char *file = "/tmp/purc-local-fetcher-view.txt";
+    const char *url = "file:///tmp/purc-local-fetcher-view.txt";
+
+    FILE *fp = fopen(file, "w");
+    fputs("shared", fp);
+    fclose(fp);
+
+    struct pcfetcher_resp_header header1 = { }, header2 = { };
+    purc_rwstream_t resp1 = pcfetcher_request_sync(url,
+            PCFETCHER_REQUEST_METHOD_GET, NULL, 0, &header1);
+    purc_rwstream_t resp2 = pcfetcher_request_sync(url,
+            PCFETCHER_REQUEST_METHOD_GET, NULL, 0, &header2);
+    ASSERT_NE(resp1, nullptr);
+    ASSERT_NE(resp2, nullptr);
+
+    size_t sz1 = 0, sz2 = 0;
+    const char *data1 = (const char *)purc_rwstream_get_mem_buffer(resp1, &sz1);
+    const char *data2 = (const char *)purc_rwstream_get_mem_buffer(resp2, &sz2);
+    ASSERT_EQ(data1, data2);
+    ASSERT_EQ(sz1, 6);
+
+    // the views are read-only
+    ASSERT_EQ(purc_rwstream_write(resp1, "x", 1), -1);
+
+    // replace the cached content while the views are alive
+    fp = fopen(file, "w");
+    fputs("replaced", fp);
+    fclose(fp);
+    char buf[16];
+    ASSERT_EQ(fetch_sync(url, buf, sizeof(buf)), 8);
+    ASSERT_STREQ(buf, "replaced");
+
+    ssize_t n = purc_rwstream_read(resp2, buf, sizeof(buf) - 1);
+    ASSERT_EQ(n, 6);
+    buf[n] = 0;
+    ASSERT_STREQ(buf, "shared");
+
+    purc_rwstream_destroy(resp1);
+    purc_rwstream_destroy(resp2);
+    free(header1.mime_type);
+    free(header2.mime_type);
+    remove(file);
+
+    purc_cleanup();
+}
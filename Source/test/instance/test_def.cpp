@@ -20,6 +20,7 @@
 #include "purc/purc.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <errno.h>
 #include <gtest/gtest.h>
 
@@ -51,3 +52,52 @@ TEST(instance, def)
     purc_cleanup();
 }
 
+
+TEST(instance, lazy_error_info)
+{
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, NULL, NULL, NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND, "name:%s", "foo");
+    purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND, "name:%s", "bar");
+    ASSERT_EQ(purc_get_last_error(), PCVRNT_ERROR_NOT_FOUND);
+
+    /* the exinfo is made when it is read and kept afterwards */
+    purc_variant_t exinfo = purc_get_last_error_ex();
+    ASSERT_NE(exinfo, PURC_VARIANT_INVALID);
+    ASSERT_STREQ(purc_variant_get_string_const(exinfo), "name:bar");
+    ASSERT_EQ(purc_get_last_error_ex(), exinfo);
+
+    /* the arguments are recorded when the error is set */
+    char name[] = "foo";
+    purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND,
+            "%d %s %c %lu %lld %zu %x%%", -1, name, 'x', 7UL, -8LL,
+            (size_t)9, 0xabU);
+    strcpy(name, "qux");
+    exinfo = purc_get_last_error_ex();
+    ASSERT_NE(exinfo, PURC_VARIANT_INVALID);
+    ASSERT_STREQ(purc_variant_get_string_const(exinfo),
+            "-1 foo x 7 -8 9 ab%");
+
+    /* a conversion which is not recorded: formatted at once */
+    purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND,
+            "%.*s %5.2f", 3, name, 3.14159);
+    strcpy(name, "foo");
+    exinfo = purc_get_last_error_ex();
+    ASSERT_NE(exinfo, PURC_VARIANT_INVALID);
+    ASSERT_STREQ(purc_variant_get_string_const(exinfo), "qux  3.14");
+
+    /* too many arguments to record: formatted at once */
+    purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND,
+            "%d%d%d%d%d%d%d%d%d", 1, 2, 3, 4, 5, 6, 7, 8, 9);
+    exinfo = purc_get_last_error_ex();
+    ASSERT_NE(exinfo, PURC_VARIANT_INVALID);
+    ASSERT_STREQ(purc_variant_get_string_const(exinfo), "123456789");
+
+    purc_set_error_with_info(PCVRNT_ERROR_NOT_FOUND, "name:%s", "foo");
+    purc_clr_error();
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_OK);
+    ASSERT_EQ(purc_get_last_error_ex(), PURC_VARIANT_INVALID);
+
+    purc_cleanup();
+}
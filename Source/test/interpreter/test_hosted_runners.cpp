@@ -0,0 +1,152 @@
+/*
+ * @file test_hosted_runners.cpp
+ * @date 2026/10/19
+ * @brief The program to test the runners hosted by the worker threads:
+ *      - more instances than workers switching in a worker
+ *      - retiring an instance with a pending timer
+ *      - hosting an instance after the retirement
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#undef NDEBUG
+
+#include "purc/purc.h"
+#include "../helpers.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+
+#define NR_WORKERS          "2"
+#define NR_HOSTED           4
+
+static std::atomic<int> nr_started;
+static std::atomic<int> nr_stopped;
+
+static int hosted_cond_handler(purc_cond_k event, void *arg, void *data)
+{
+    (void)data;
+
+    if (event == PURC_COND_STARTED) {
+        purc_atom_t sid = (purc_atom_t)(uintptr_t)arg;
+        assert(purc_atom_to_string(sid));
+        nr_started++;
+    }
+    else if (event == PURC_COND_STOPPED) {
+        purc_atom_t sid = (purc_atom_t)(uintptr_t)arg;
+        assert(purc_atom_to_string(sid));
+        nr_stopped++;
+    }
+
+    return 0;
+}
+
+static int main_cond_handler(purc_cond_k event, void *arg, void *data)
+{
+    (void)event;
+    (void)arg;
+    (void)data;
+    return 0;
+}
+
+static purc_atom_t host_runner(const char *name, const char *hvml)
+{
+    struct purc_instance_extra_info info = { };
+    info.renderer_comm = PURC_RDRCOMM_HEADLESS;
+
+    purc_atom_t inst = purc_inst_create_or_get(APP_NAME, name,
+            hosted_cond_handler, &info);
+    if (inst == 0)
+        return 0;
+
+    purc_vdom_t vdom = purc_load_hvml_from_string(hvml);
+    if (vdom == NULL)
+        return 0;
+
+    purc_atom_t cor = purc_inst_schedule_vdom(inst, vdom, 0,
+            PURC_VARIANT_INVALID, PCRDR_PAGE_TYPE_NULL,
+            NULL, NULL, NULL, NULL, NULL);
+    return cor ? inst : 0;
+}
+
+static bool wait_for_termination(purc_atom_t inst, unsigned max_seconds)
+{
+    unsigned int seconds = 0;
+    while (purc_atom_to_string(inst)) {
+        if (seconds++ >= max_seconds)
+            return false;
+        sleep(1);
+    }
+
+    return true;
+}
+
+TEST(interpreter, hosted_runners)
+{
+    /* the workers are started when the first runner is created */
+    setenv(PURC_ENVV_RUNNER_WORKERS, NR_WORKERS, 1);
+
+    struct purc_instance_extra_info inst_info = { };
+    inst_info.renderer_comm = PURC_RDRCOMM_HEADLESS;
+
+    PurCInstance purc(PURC_MODULE_HVML, APP_NAME, "main", &inst_info);
+    ASSERT_TRUE(purc);
+
+    purc_vdom_t vdom = purc_load_hvml_from_string(
+            "<hvml><body><sleep for 1s /></body></hvml>");
+    ASSERT_NE(vdom, nullptr);
+    purc_coroutine_t co = purc_schedule_vdom_null(vdom);
+    ASSERT_NE(co, nullptr);
+
+    /* more instances than workers: some share a worker and switch */
+    purc_atom_t insts[NR_HOSTED];
+    for (int i = 0; i < NR_HOSTED; i++) {
+        char name[PURC_LEN_RUNNER_NAME + 1];
+        snprintf(name, sizeof(name), "hosted%d", i);
+        insts[i] = host_runner(name,
+                "<hvml><body><sleep for 100ms /><sleep for 100ms />"
+                "</body></hvml>");
+        ASSERT_NE(insts[i], 0);
+    }
+
+    purc_run(main_cond_handler);
+
+    for (int i = 0; i < NR_HOSTED; i++) {
+        purc_inst_ask_to_shutdown(insts[i]);
+        ASSERT_TRUE(wait_for_termination(insts[i], 10));
+    }
+    ASSERT_EQ(nr_started, NR_HOSTED);
+    ASSERT_EQ(nr_stopped, NR_HOSTED);
+
+    /* retire an instance while its timer is still pending */
+    purc_atom_t inst = host_runner("retired",
+            "<hvml><body><sleep for 3s /></body></hvml>");
+    ASSERT_NE(inst, 0);
+    purc_inst_ask_to_shutdown(inst);
+    ASSERT_TRUE(wait_for_termination(inst, 10));
+
+    /* the workers still host new instances afterwards */
+    inst = host_runner("after",
+            "<hvml><body><sleep for 100ms /></body></hvml>");
+    ASSERT_NE(inst, 0);
+    purc_inst_ask_to_shutdown(inst);
+    ASSERT_TRUE(wait_for_termination(inst, 10));
+
+    ASSERT_EQ(nr_started, NR_HOSTED + 2);
+    ASSERT_EQ(nr_stopped, NR_HOSTED + 2);
+}
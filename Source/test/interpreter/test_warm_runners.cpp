@@ -0,0 +1,114 @@
+/*
+ * @file test_warm_runners.cpp
+ * @date 2026/10/19
+ * @brief The program to test the pools of the pre-warmed instances:
+ *      - claiming a warm instance and renaming it after the runner
+ *      - tearing down the warm instances left when the program exits
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#undef NDEBUG
+
+#include "purc/purc.h"
+#include "../helpers.h"
+
+#include <gtest/gtest.h>
+
+static bool wait_for(bool (*cond)(purc_atom_t), purc_atom_t atom)
+{
+    for (unsigned i = 0; i < 100; i++) {
+        if (cond(atom))
+            return true;
+        usleep(100000);
+    }
+
+    return false;
+}
+
+static bool has_warm_instance(purc_atom_t atom)
+{
+    (void)atom;
+
+    unsigned nr_warm;
+    return purc_get_warm_runner_stats(NULL, NULL, &nr_warm) == 0 &&
+        nr_warm > 0;
+}
+
+static bool is_terminated(purc_atom_t atom)
+{
+    return purc_atom_to_string(atom) == NULL;
+}
+
+/* runs in a child process, so that the instance manager quits and tears
+   down the warm instances left when the child exits */
+static void claim_and_exit(const char *nr_workers)
+{
+    if (nr_workers)
+        setenv(PURC_ENVV_RUNNER_WORKERS, nr_workers, 1);
+    setenv(PURC_ENVV_RUNNER_POOL_SIZE, "1", 1);
+
+    {
+        PurCInstance purc(PURC_MODULE_HVML, APP_NAME, "main", NULL);
+        assert(purc);
+
+        /* no warm instance yet: the pool is filled after the miss */
+        purc_atom_t first = purc_inst_create_or_get(APP_NAME, "first",
+                NULL, NULL);
+        assert(first != 0);
+
+        unsigned nr_hits, nr_misses;
+        assert(purc_get_warm_runner_stats(&nr_hits, &nr_misses, NULL) == 0);
+        assert(nr_hits == 0 && nr_misses == 1);
+
+        assert(wait_for(has_warm_instance, 0));
+
+        /* the warm instance is claimed and renamed after the runner */
+        purc_atom_t second = purc_inst_create_or_get(APP_NAME, "second",
+                NULL, NULL);
+        assert(second != 0);
+        assert(purc_get_warm_runner_stats(&nr_hits, &nr_misses, NULL) == 0);
+        assert(nr_hits == 1 && nr_misses == 1);
+
+        char runner_name[PURC_LEN_RUNNER_NAME + 1];
+        purc_extract_runner_name(purc_atom_to_string(second), runner_name);
+        assert(strcmp(runner_name, "second") == 0);
+
+        /* another one is warmed up to replace it, and left at exit */
+        assert(wait_for(has_warm_instance, 0));
+
+        purc_inst_ask_to_shutdown(first);
+        purc_inst_ask_to_shutdown(second);
+        assert(wait_for(is_terminated, first));
+        assert(wait_for(is_terminated, second));
+    }
+
+    exit(0);
+}
+
+TEST(interpreter, warm_runners_own_threads)
+{
+    ::testing::GTEST_FLAG(death_test_style) = "threadsafe";
+    EXPECT_EXIT(claim_and_exit(NULL), ::testing::ExitedWithCode(0), "");
+}
+
+TEST(interpreter, warm_runners_hosted)
+{
+    ::testing::GTEST_FLAG(death_test_style) = "threadsafe";
+    EXPECT_EXIT(claim_and_exit("1"), ::testing::ExitedWithCode(0), "");
+}
@@ -564,6 +564,69 @@ TEST(mem_rwstream, seek_read)
     ASSERT_EQ(ret, 0);
 }
 
+/* test mmap rwstream */
+TEST(mmap_rwstream, read_seek_buffer)
+{
+    char tmp_file[] = "/tmp/rwstream-mmap.txt";
+    char buf[] = "This这 is 测。";
+    size_t buf_len = strlen(buf);
+    create_temp_file(tmp_file, buf, buf_len);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_file_mapped(tmp_file);
+    ASSERT_NE(rws, nullptr);
+
+    char read_buf[100] = {0};
+    uint32_t wc = 0;
+    int read_len = purc_rwstream_read (rws, read_buf, 4);
+    ASSERT_EQ(read_len, 4);
+    ASSERT_STREQ(read_buf, "This");
+
+    memset(read_buf, 0, sizeof(read_buf));
+    read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 3);
+    ASSERT_EQ(wc, 0x8FD9);
+
+    off_t pos = purc_rwstream_seek (rws, 0, SEEK_END);
+    ASSERT_EQ(pos, buf_len);
+    ASSERT_EQ(purc_rwstream_read (rws, read_buf, 1), 0);
+
+    // read-only
+    ASSERT_EQ(purc_rwstream_write (rws, "x", 1), -1);
+
+    // the mapping itself
+    size_t sz_content = 0;
+    const char *mem = (const char *)purc_rwstream_get_mem_buffer (rws,
+            &sz_content);
+    ASSERT_NE(mem, nullptr);
+    ASSERT_EQ(sz_content, buf_len);
+    ASSERT_EQ(memcmp(mem, buf, buf_len), 0);
+    ASSERT_EQ(mem, purc_rwstream_get_mem_buffer (rws, NULL));
+
+    // a reserved buffer is a null-terminated copy owned by the caller
+    char *copy = (char *)purc_rwstream_get_mem_buffer_ex (rws,
+            &sz_content, NULL, true);
+    ASSERT_NE(copy, nullptr);
+    ASSERT_NE(copy, mem);
+    ASSERT_STREQ(copy, buf);
+    free(copy);
+
+    int ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+
+    // an empty file
+    create_temp_file(tmp_file, buf, 0);
+    rws = purc_rwstream_new_from_file_mapped(tmp_file);
+    ASSERT_NE(rws, nullptr);
+    ASSERT_EQ(purc_rwstream_read (rws, read_buf, 1), 0);
+    purc_rwstream_get_mem_buffer (rws, &sz_content);
+    ASSERT_EQ(sz_content, 0);
+    purc_rwstream_destroy (rws);
+
+    remove_temp_file(tmp_file);
+
+    ASSERT_EQ(purc_rwstream_new_from_file_mapped(tmp_file), nullptr);
+}
+
 /* test buffer rwstream */
 TEST(buffer_rwstream, new_destroy)
 {
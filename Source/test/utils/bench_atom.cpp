@@ -0,0 +1,160 @@
+/*
+** Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Stress benchmark of the atom table: a growing number of threads look up
+ * the same set of strings and convert the atoms back to the strings, while
+ * one more thread keeps creating new atoms. Reports the throughput of the
+ * lookups and the scaling against one thread.
+ *
+ * Usage: bench_atom [<iterations per thread> [<max threads>]]
+ */
+
+#include "purc/purc.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NR_DEF_ITERATIONS       2000000
+#define NR_STRINGS              512
+#define LEN_STRING              32
+
+static char strings[NR_STRINGS][LEN_STRING];
+static purc_atom_t atoms[NR_STRINGS];
+
+static long nr_iterations = NR_DEF_ITERATIONS;
+static volatile bool writer_stop;
+static volatile bool failed;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void *reader(void *arg)
+{
+    size_t i = (size_t)(uintptr_t)arg;
+
+    for (long n = 0; n < nr_iterations; n++) {
+        i = (i * 7 + 1) % NR_STRINGS;
+
+        purc_atom_t atom = purc_atom_try_string_ex(PURC_ATOM_BUCKET_DEF,
+                strings[i]);
+        const char *string = purc_atom_to_string(atom);
+        if (atom != atoms[i] || string == NULL || string[0] != 'e') {
+            failed = true;
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static void *writer(void *arg)
+{
+    (void)arg;
+
+    char buf[LEN_STRING];
+    unsigned long n = 0;
+    while (!writer_stop) {
+        snprintf(buf, sizeof(buf), "bench-atom-writer-%lu", n++);
+        purc_atom_from_string_ex(PURC_ATOM_BUCKET_DEF, buf);
+        usleep(100);
+    }
+
+    return NULL;
+}
+
+static double run(long nr_threads)
+{
+    pthread_t *threads = (pthread_t *)calloc(nr_threads, sizeof(pthread_t));
+    pthread_t th_writer;
+
+    writer_stop = false;
+    pthread_create(&th_writer, NULL, writer, NULL);
+
+    double start = now_ns();
+    for (long t = 0; t < nr_threads; t++) {
+        pthread_create(threads + t, NULL, reader, (void *)(uintptr_t)t);
+    }
+    for (long t = 0; t < nr_threads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    double elapsed = now_ns() - start;
+
+    writer_stop = true;
+    pthread_join(th_writer, NULL);
+    free(threads);
+
+    /* lookups per microsecond of all threads */
+    return nr_threads * nr_iterations * 1e3 / elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    long max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (argc > 1)
+        nr_iterations = strtol(argv[1], NULL, 10);
+    if (argc > 2)
+        max_threads = strtol(argv[2], NULL, 10);
+    if (nr_iterations <= 0 || max_threads <= 0) {
+        fprintf(stderr, "Usage: %s [<iterations per thread> [<max threads>]]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    purc_instance_extra_info info = {};
+    if (purc_init_ex(PURC_MODULE_UTILS, "cn.fmsoft.hvml.test",
+                "bench_atom", &info) != PURC_ERROR_OK) {
+        fprintf(stderr, "Failed to initialize PurC\n");
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < NR_STRINGS; i++) {
+        snprintf(strings[i], LEN_STRING, "event-name-%zu", i);
+        atoms[i] = purc_atom_from_string_ex(PURC_ATOM_BUCKET_DEF, strings[i]);
+    }
+
+    int ret = EXIT_SUCCESS;
+    double base = 0;
+    printf("%8s %16s %10s\n", "threads", "lookups/us", "scaling");
+    for (long nr_threads = 1; nr_threads <= max_threads; nr_threads *= 2) {
+        double rate = run(nr_threads);
+        if (failed) {
+            fprintf(stderr, "Bad atom or string with %ld threads\n",
+                    nr_threads);
+            ret = EXIT_FAILURE;
+            break;
+        }
+
+        if (base == 0)
+            base = rate;
+        printf("%8ld %16.1f %10.2f\n", nr_threads, rate, rate / base);
+    }
+
+    purc_cleanup();
+    return ret;
+}
@@ -467,3 +467,66 @@ TEST(object, compare)
     purc_variant_unref(obj2);
 }
 
+
+static purc_variant_t
+first_key(purc_variant_t obj)
+{
+    pcvrnt_object_iterator* it = pcvrnt_object_iterator_create_begin(obj);
+    if (it == NULL)
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t k = pcvrnt_object_iterator_get_key(it);
+    pcvrnt_object_iterator_release(it);
+    return k;
+}
+
+TEST(object, shared_keys)
+{
+    PurCInstance purc;
+
+    purc_variant_t v1 = purc_variant_make_ulongint(1);
+    purc_variant_t v2 = purc_variant_make_ulongint(2);
+
+    // objects made by C string keys share the key variants
+    purc_variant_t obj1 = purc_variant_make_object_by_static_ckey(2,
+            "id", v1, "name", v2);
+    purc_variant_t obj2 = purc_variant_make_object_by_static_ckey(2,
+            "id", v2, "name", v1);
+    ASSERT_NE(obj1, PURC_VARIANT_INVALID);
+    ASSERT_NE(obj2, PURC_VARIANT_INVALID);
+    ASSERT_EQ(first_key(obj1), first_key(obj2));
+    ASSERT_EQ(first_key(obj1)->refc, 2);
+    ASSERT_EQ(purc_variant_object_get_by_ckey(obj2, "id"), v2);
+    ASSERT_EQ(purc_variant_object_get_by_ckey(obj2, "name"), v1);
+
+    // a key given by the caller is never replaced
+    purc_variant_t k = purc_variant_make_string("id", false);
+    purc_variant_t obj3 = purc_variant_make_object(1, k, v1);
+    ASSERT_NE(obj3, PURC_VARIANT_INVALID);
+    ASSERT_EQ(first_key(obj3), k);
+    ASSERT_EQ(k->refc, 2);
+    purc_variant_unref(obj3);
+    ASSERT_EQ(k->refc, 1);
+    purc_variant_unref(k);
+
+    // the keys are forgotten when released
+    purc_variant_unref(obj1);
+    purc_variant_unref(obj2);
+    obj1 = purc_variant_make_object_by_static_ckey(1, "id", v1);
+    ASSERT_NE(obj1, PURC_VARIANT_INVALID);
+    ASSERT_EQ(first_key(obj1)->refc, 1);
+    ASSERT_EQ(purc_variant_object_get_by_ckey(obj1, "id"), v1);
+    purc_variant_unref(obj1);
+
+    // the records parsed from JSON share the keys as well
+    const char *json = "[{\"a\":1,\"b\":2},{\"a\":3,\"b\":4}]";
+    purc_variant_t arr = purc_variant_make_from_json_string(json,
+            strlen(json));
+    ASSERT_NE(arr, PURC_VARIANT_INVALID);
+    ASSERT_EQ(first_key(purc_variant_array_get(arr, 0)),
+            first_key(purc_variant_array_get(arr, 1)));
+    purc_variant_unref(arr);
+
+    purc_variant_unref(v1);
+    purc_variant_unref(v2);
+}
@@ -0,0 +1,125 @@
+/*
+** Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Benchmark of the VCM evaluator: evaluates a few common shapes of
+ * expressions many times and reports the time taken by one evaluation.
+ *
+ * Usage: bench_vcm [<iterations>]
+ */
+
+#include "purc/purc.h"
+#include "private/vcm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NR_DEF_ITERATIONS       200000
+
+static const char *object_ejson =
+    "{ \"title\": \"Object title\", \"id\": 3, \"items\": [ 1, 2, 3 ] }";
+
+static const struct {
+    const char *name;
+    const char *jsonee;
+} cases[] = {
+    { "number",             "3.14" },
+    { "string",             "\"hello, world\"" },
+    { "array of literals",  "[ 1, 2, 3, 4, 5, 6, 7, 8 ]" },
+    { "object of literals", "{ \"a\": 1, \"b\": \"two\", \"c\": [ 3 ] }" },
+    { "variable",           "$X" },
+    { "element",            "$X.title" },
+    { "nested elements",    "$X.items[1]" },
+    { "mixed container",    "[ $X.title, { \"id\": $X.id }, 1, \"s\" ]" },
+};
+
+static purc_variant_t find_var(void *ctxt, const char *name)
+{
+    (void)name;
+    return (purc_variant_t)ctxt;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static struct purc_ejson_parsing_tree *parse(const char *ejson)
+{
+    return purc_variant_ejson_parse_string(ejson, strlen(ejson));
+}
+
+int main(int argc, char *argv[])
+{
+    long nr_iterations = NR_DEF_ITERATIONS;
+    if (argc > 1) {
+        nr_iterations = strtol(argv[1], NULL, 10);
+        if (nr_iterations <= 0) {
+            fprintf(stderr, "Usage: %s [<iterations>]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    purc_instance_extra_info info = {};
+    if (purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+                "bench_vcm", &info) != PURC_ERROR_OK) {
+        fprintf(stderr, "Failed to initialize PurC\n");
+        return EXIT_FAILURE;
+    }
+
+    struct purc_ejson_parsing_tree *ptree = parse(object_ejson);
+    purc_variant_t x = purc_ejson_parsing_tree_evalute(ptree, NULL,
+            PURC_VARIANT_INVALID, false);
+    purc_ejson_parsing_tree_destroy(ptree);
+
+    int ret = EXIT_SUCCESS;
+    printf("%-20s %12s\n", "shape", "ns/eval");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ptree = parse(cases[i].jsonee);
+        if (!ptree) {
+            fprintf(stderr, "Bad expression: %s\n", cases[i].jsonee);
+            ret = EXIT_FAILURE;
+            continue;
+        }
+
+        double start = now_ns();
+        for (long n = 0; n < nr_iterations; n++) {
+            purc_variant_t v = purc_ejson_parsing_tree_evalute(ptree,
+                    find_var, x, false);
+            if (!v) {
+                fprintf(stderr, "Failed to evaluate: %s\n", cases[i].jsonee);
+                ret = EXIT_FAILURE;
+                break;
+            }
+            purc_variant_unref(v);
+        }
+        double elapsed = now_ns() - start;
+
+        printf("%-20s %12.1f\n", cases[i].name, elapsed / nr_iterations);
+        purc_ejson_parsing_tree_destroy(ptree);
+    }
+
+    purc_variant_unref(x);
+    purc_cleanup();
+    return ret;
+}
@@ -228,6 +228,60 @@ vcm_again_variant_create()
     return v;
 }
 
+TEST(vcm, concat_string)
+{
+    purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.test",
+            "vcm_concat", NULL);
+
+    struct pcvcm_node *members[] = {
+        pcvcm_node_new_longint(1),
+        pcvcm_node_new_string("a"),
+    };
+
+    struct pcvcm_node *nodes[] = {
+        pcvcm_node_new_string("x="),
+        pcvcm_node_new_longint(1),
+        pcvcm_node_new_string(", "),
+        pcvcm_node_new_number(2.5),
+        pcvcm_node_new_string(" "),
+        pcvcm_node_new_boolean(true),
+        pcvcm_node_new_ulongint(7),
+        pcvcm_node_new_null(),
+        pcvcm_node_new_string(":"),
+        pcvcm_node_new_array(PCA_TABLESIZE(members), members),
+    };
+
+    struct pcvcm_node *root = pcvcm_node_new_concat_string(0, NULL);
+    ASSERT_NE(root, nullptr);
+    for (size_t i = 0; i < PCA_TABLESIZE(nodes); i++) {
+        pcvcm_node_append_child(root, nodes[i]);
+    }
+
+    purc_variant_t v = pcvcm_eval_ex(root, NULL, NULL, NULL, false);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+    ASSERT_STREQ(purc_variant_get_string_const(v), "x=1, 2.5 true7null:1\na\n");
+    purc_variant_unref(v);
+    pcvcm_node_destroy(root);
+
+    /* more parts than the ones kept on the stack */
+    root = pcvcm_node_new_concat_string(0, NULL);
+    ASSERT_NE(root, nullptr);
+    for (size_t i = 0; i < 20; i++) {
+        pcvcm_node_append_child(root, pcvcm_node_new_string("ab"));
+    }
+
+    v = pcvcm_eval_ex(root, NULL, NULL, NULL, false);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+
+    size_t len = 0;
+    purc_variant_get_string_const_ex(v, &len);
+    ASSERT_EQ(len, 40);
+    purc_variant_unref(v);
+    pcvcm_node_destroy(root);
+
+    purc_cleanup();
+}
+
 purc_variant_t find_var(void* ctxt, const char* name)
 {
     UNUSED_PARAM(name);